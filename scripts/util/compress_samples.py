@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+
+# Losslessly compresses 16 and 24-bit WAV files for the Deluge, which decodes them as it streams them from the card.
+# The format's described in src/deluge/model/sample/sample_block_index.h and src/deluge/storage/audio/lossless_codec.h
+import argparse
+import os
+import struct
+import sys
+
+FORMAT_PCM = 1
+FORMAT_EXTENSIBLE = 0xFFFE
+FORMAT_DELUGE_LOSSLESS = 0xFFFF
+VERBATIM = 7
+MAX_ORDER = 3
+MAX_RICE_PARAM = 30
+MAX_BLOCK_NUM_FRAMES = 4096
+
+
+def predict(samples, n, order):
+    if order == 1:
+        return samples[n - 1]
+    if order == 2:
+        return 2 * samples[n - 1] - samples[n - 2]
+    if order == 3:
+        return 3 * samples[n - 1] - 3 * samples[n - 2] + samples[n - 3]
+    return 0
+
+
+def zigzag(error):
+    return (error << 1) if error >= 0 else ((-error) << 1) - 1
+
+
+class BitWriter:
+    def __init__(self):
+        self.output = bytearray()
+        self.buffer = 0
+        self.num_bits = 0
+
+    def write(self, value, num):
+        self.buffer = (self.buffer << num) | (value & ((1 << num) - 1))
+        self.num_bits += num
+        while self.num_bits >= 8:
+            self.num_bits -= 8
+            self.output.append((self.buffer >> self.num_bits) & 0xFF)
+        self.buffer &= (1 << self.num_bits) - 1
+
+    def finish(self):
+        if self.num_bits:
+            self.output.append((self.buffer << (8 - self.num_bits)) & 0xFF)
+        return bytes(self.output)
+
+
+def rice_num_bits(zigzagged, rice_param):
+    return len(zigzagged) * (rice_param + 1) + sum(u >> rice_param for u in zigzagged)
+
+
+def encode_channel(samples, byte_depth):
+    """Same choices as LosslessCodec::encodeBlock(), so that the output's identical"""
+    num_frames = len(samples)
+    best = (num_frames * byte_depth * 8, VERBATIM, 0, None)
+    for order in range(min(MAX_ORDER, num_frames - 1) + 1):
+        zigzagged = [zigzag(samples[n] - predict(samples, n, order)) for n in range(order, num_frames)]
+        mean = sum(zigzagged) // len(zigzagged)
+        estimate = 0
+        while estimate < MAX_RICE_PARAM and (2 << estimate) <= mean:
+            estimate += 1
+        for rice_param in range(max(estimate - 1, 0), min(estimate + 1, MAX_RICE_PARAM) + 1):
+            num_bits = rice_num_bits(zigzagged, rice_param) + order * byte_depth * 8 + 7
+            if num_bits < best[0]:
+                best = (num_bits, order, rice_param, zigzagged)
+
+    _, order, rice_param, zigzagged = best
+    output = bytearray([(order << 5) | rice_param])
+    if order == VERBATIM:
+        for value in samples:
+            output += (value & ((1 << (byte_depth * 8)) - 1)).to_bytes(byte_depth, "little")
+        return bytes(output)
+
+    for value in samples[:order]:
+        output += (value & ((1 << (byte_depth * 8)) - 1)).to_bytes(byte_depth, "little")
+    writer = BitWriter()
+    for u in zigzagged:
+        writer.write(1, (u >> rice_param) + 1)
+        writer.write(u, rice_param)
+    return bytes(output) + writer.finish()
+
+
+def read_chunks(data):
+    if data[0:4] != b"RIFF" or data[8:12] != b"WAVE":
+        raise ValueError("not a WAV file")
+    pos = 12
+    chunks = []
+    while pos + 8 <= len(data):
+        name, length = struct.unpack_from("<4sI", data, pos)
+        chunks.append((name, data[pos + 8 : pos + 8 + length]))
+        pos += 8 + length + (length & 1)
+    return chunks
+
+
+def compress(data, block_num_frames):
+    chunks = read_chunks(data)
+    fmt = next((body for name, body in chunks if name == b"fmt "), None)
+    audio = next((body for name, body in chunks if name == b"data"), None)
+    if fmt is None or audio is None:
+        raise ValueError("no fmt or data chunk")
+
+    format_tag, num_channels, sample_rate, _, _, bits = struct.unpack_from("<HHIIHH", fmt)
+    if format_tag == FORMAT_EXTENSIBLE and len(fmt) >= 26:
+        format_tag = struct.unpack_from("<H", fmt, 24)[0]
+    if format_tag == FORMAT_DELUGE_LOSSLESS:
+        raise ValueError("already compressed")
+    if format_tag != FORMAT_PCM or bits not in (16, 24) or num_channels not in (1, 2):
+        raise ValueError("only 16 or 24-bit PCM, mono or stereo, can be compressed")
+
+    byte_depth = bits // 8
+    frame_num_bytes = byte_depth * num_channels
+    num_frames = len(audio) // frame_num_bytes
+    if not num_frames:
+        raise ValueError("no audio")
+
+    blocks = []
+    for start in range(0, num_frames, block_num_frames):
+        frames = audio[start * frame_num_bytes : min(start + block_num_frames, num_frames) * frame_num_bytes]
+        block = b""
+        for c in range(num_channels):
+            samples = [
+                int.from_bytes(frames[i : i + byte_depth], "little", signed=True)
+                for i in range(c * byte_depth, len(frames), frame_num_bytes)
+            ]
+            block += encode_channel(samples, byte_depth)
+        blocks.append(block)
+
+    offsets = [0]
+    for block in blocks:
+        offsets.append(offsets[-1] + len(block))
+
+    new_fmt = struct.pack(
+        "<HHIIHH",
+        FORMAT_DELUGE_LOSSLESS,
+        num_channels,
+        sample_rate,
+        sample_rate * frame_num_bytes,
+        frame_num_bytes,
+        bits,
+    )
+    index = struct.pack("<4I", 1, num_frames, block_num_frames, len(blocks)) + struct.pack(
+        "<%dI" % len(offsets), *offsets
+    )
+
+    # The index goes before the audio, so the Deluge has it without reading through the rest. Other chunks it knows
+    # about, like smpl and inst, come along too
+    body = b"WAVE"
+    for name, chunk in [(b"fmt ", new_fmt), (b"dlix", index), (b"data", b"".join(blocks))] + [
+        (name, chunk) for name, chunk in chunks if name in (b"smpl", b"inst", b"clm ")
+    ]:
+        body += struct.pack("<4sI", name, len(chunk)) + chunk + (b"\0" if len(chunk) & 1 else b"")
+    return b"RIFF" + struct.pack("<I", len(body)) + body
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Losslessly compress WAV files for the Deluge.")
+    parser.add_argument("-b", "--block-frames", type=int, default=1024, help="frames per block (default 1024)")
+    parser.add_argument("-o", "--output-dir", help="where to write them (default: next to the originals, as X.dl.wav)")
+    parser.add_argument("files", nargs="+")
+    args = parser.parse_args()
+
+    if not 1 <= args.block_frames <= MAX_BLOCK_NUM_FRAMES:
+        sys.exit("block size must be between 1 and %d frames" % MAX_BLOCK_NUM_FRAMES)
+
+    for path in args.files:
+        with open(path, "rb") as f:
+            data = f.read()
+        try:
+            compressed = compress(data, args.block_frames)
+        except ValueError as e:
+            print("%s: skipped, %s" % (path, e))
+            continue
+
+        name = os.path.splitext(os.path.basename(path))[0] + ".dl.wav"
+        out_path = os.path.join(args.output_dir or os.path.dirname(path), name)
+        with open(out_path, "wb") as f:
+            f.write(compressed)
+        print("%s: %d%% of original size" % (out_path, len(compressed) * 100 // len(data)))
+
+
+if __name__ == "__main__":
+    main()
@@ -17,193 +17,425 @@
 
 #include "task_scheduler.h"
 #include "RZA1/ostm/ostm.h"
+#include "util/container/heap/intrusive_heap.h"
 #include "util/container/static_vector.hpp"
 #include <algorithm>
-// currently 14 are in use
-constexpr int kMaxTasks = 20;
+#include <bit>
+// currently 14 repeating tasks are in use - the rest of the space is for once tasks
+constexpr int kMaxTasks = MAX_NUM_TASKS;
+// Repeating tasks' statistics live in their own, smaller table, as there are far fewer of them than once tasks
+constexpr int kMaxTasksWithTelemetry = MAX_NUM_TASKS_WITH_STATISTICS;
+static_assert(kMaxTasksWithTelemetry <= 32, "telemetryInUse is a uint32_t");
 constexpr double rollTime = ((double)(UINT32_MAX) / DELUGE_CLOCKS_PERf);
-struct Task {
-	TaskHandle handle;
+
+/// seconds since startTime, allowing for the timer having rolled over since
+double timeSince(double startTime) {
+	double time = getTimerValueSeconds(0) - startTime;
+	if (time < 0) {
+		time += rollTime;
+	}
+	return time;
+}
+
+/// Worst cases matter more than averages here - a task that's usually quick but occasionally takes 5ms is what makes
+/// audio glitch. So we keep the extremes, plus log2 histograms which are cheap enough to update on every call
+struct TaskTelemetry {
+	static constexpr int kNumBuckets = TASK_STATISTICS_NUM_BUCKETS;
+
+	uint32_t numCalls{0};
+	double minRunTime{0};
+	double maxRunTime{0};
+	uint32_t numMaxTimeViolations{0};
+	std::array<uint32_t, kNumBuckets> runTimes{};
+	std::array<uint32_t, kNumBuckets> lateness{};
+
+	/// bucket 0 is under 1us, bucket n is 2^(n-1) to 2^n us
+	static int bucketFor(double seconds) {
+		uint32_t microseconds = (seconds > 0) ? std::min(seconds * 1000000, (double)UINT32_MAX) : 0;
+		return std::min<int>(std::bit_width(microseconds), kNumBuckets - 1);
+	}
+
+	void record(double runTime, double secondsLate, bool violatedMaxTime) {
+		minRunTime = numCalls ? std::min(minRunTime, runTime) : runTime;
+		maxRunTime = std::max(maxRunTime, runTime);
+		numCalls++;
+		runTimes[bucketFor(runTime)]++;
+		lateness[bucketFor(secondsLate)]++;
+		if (violatedMaxTime) {
+			numMaxTimeViolations++;
+		}
+	}
+
+	double getP99RunTime() const {
+		uint32_t threshold = numCalls - numCalls / 100;
+		uint32_t count = 0;
+		for (int b = 0; b < kNumBuckets; b++) {
+			count += runTimes[b];
+			if (count >= threshold) {
+				return std::min((double)(1 << b) / 1000000, maxRunTime);
+			}
+		}
+		return maxRunTime;
+	}
+
+	void fill(TaskStatistics& stats) const {
+		stats.numCalls = numCalls;
+		stats.minRunTime = minRunTime;
+		stats.maxRunTime = maxRunTime;
+		stats.p99RunTime = numCalls ? getP99RunTime() : 0;
+		stats.numMaxTimeViolations = numMaxTimeViolations;
+		std::copy(lateness.begin(), lateness.end(), stats.lateness);
+	}
+};
+
+/// Order in the ready queue - highest priority (lowest number) first, then whichever has to start soonest
+struct ReadyKey {
 	uint8_t priority;
-	double lastCallTime;
-	double averageDuration;
-	double minTimeBetweenCalls;
-	double targetTimeBetweenCalls;
-	double maxTimeBetweenCalls;
-	bool removeAfterUse;
+	double latestStart;
+	bool operator<(const ReadyKey& another) const {
+		return priority != another.priority ? priority < another.priority : latestStart < another.latestStart;
+	}
 };
 
-struct SortedTask {
-	uint8_t priority = UINT8_MAX;
-	TaskID task = -1;
-	// priorities are descending, so this puts low pri tasks first
-	bool operator<(const SortedTask& another) const { return priority > another.priority; }
+struct Task {
+	TaskHandle handle{nullptr};
+	uint8_t priority{0};
+	double lastCallTime{0};
+	double averageDuration{0};
+	double minTimeBetweenCalls{0};
+	double targetTimeBetweenCalls{0};
+	double maxTimeBetweenCalls{0};
+	bool removeAfterUse{false};
+	/// false until a repeating task first runs, as until then there's no previous call to measure lateness from
+	bool calledYet{false};
+	const char* name{nullptr};
+	/// index into TaskManager::telemetry, or -1 for once tasks and any repeating ones there wasn't room for
+	int8_t telemetryIndex{-1};
+	/// the last yield this ran during, so that no task runs more than once per yield
+	uint32_t yieldNumber{0};
+
+	// Derived from the above by updateTimes(), and used as the keys for TaskManager's heaps
+	/// when it becomes ready to run - its target time (allowing for how long it takes), but never before its min time
+	double readyTime{0};
+	/// when it needs to start by to finish within its max time
+	double latestStart{0};
+	ReadyKey readyKey{};
+
+	int32_t waitingIndex{-1};
+	int32_t readyIndex{-1};
+	int32_t latestStartIndex{-1};
+
+	void updateTimes() {
+		readyTime = lastCallTime + std::max(targetTimeBetweenCalls - averageDuration, minTimeBetweenCalls);
+		latestStart = lastCallTime + maxTimeBetweenCalls - averageDuration;
+		readyKey = ReadyKey{priority, latestStart};
+	}
 };
 
+template <typename Key, Key Task::*key, int32_t Task::*index>
+using TaskHeap = IntrusiveHeap<Task, Key, key, index, std::less<Key>, deluge::static_vector<Task*, kMaxTasks>>;
+
 /// internal only to the task scheduler, hence all public. External interaction to use the api
+///
+/// Every task is either waiting, in a heap ordered by when it'll become ready, or ready, in a heap ordered by
+/// priority. All of them are also in a heap ordered by when they need to start by at the latest, which is how we spot
+/// tasks which are overdue, or which we shouldn't make wait behind a long-running lower priority one. So no decision
+/// needs to look at every task, and adding or removing one is O(log n).
 struct TaskManager {
+	TaskManager() = default;
+	TaskManager& operator=(const TaskManager& other);
+
 	// All current tasks
 	// Not all entries are filled - removed entries have a null task handle
-	std::array<Task, kMaxTasks> list{nullptr};
-	// Sorted list of the current numActiveTasks, lowest priority first
-	std::array<SortedTask, kMaxTasks> sortedList;
+	std::array<Task, kMaxTasks> list{};
+	std::array<TaskTelemetry, kMaxTasksWithTelemetry> telemetry{};
+	/// bit n set if telemetry[n] belongs to a task
+	uint32_t telemetryInUse{0};
+	TaskHeap<double, &Task::readyTime, &Task::waitingIndex> waiting;
+	TaskHeap<ReadyKey, &Task::readyKey, &Task::readyIndex> ready;
+	TaskHeap<double, &Task::latestStart, &Task::latestStartIndex> byLatestStart;
+	TaskTelemetry onceTaskTelemetry{};
 	uint8_t numActiveTasks = 0;
 	double mustEndBefore = 128;
+	/// total time spent in yield() - see runTask() for how that's used
+	double timeYielded = 0;
+	uint32_t numYields = 0;
 	void start(double duration = 0);
 	void removeTask(TaskID id);
 	void runTask(TaskID id);
-	TaskID chooseBestTask(double deadline);
+	bool yield(uint8_t lowestPriority);
+	TaskID chooseBestTask(double deadline, uint8_t lowestPriority = UINT8_MAX, bool inYield = false);
 	TaskID addRepeatingTask(TaskHandle task, uint8_t priority, double minTimeBetweenCalls,
 	                        double targetTimeBetweenCalls, double maxTimeBetweenCalls);
 	TaskID addOnceTask(TaskHandle task, uint8_t priority, double timeToWait);
-	void createSortedList();
 	void clockRolledOver();
+	double lastLoopTime{0};
+	void checkForRollover();
 	bool running{false};
 	TaskID insertTaskToList(Task task);
+	void schedule(Task& task);
+	void unschedule(Task& task);
+	void moveReadyTasks(double currentTime);
+	TaskID idOf(const Task* task) const { return task - list.data(); }
 };
 
 TaskManager taskManager;
 
-void TaskManager::createSortedList() {
-	int j = 0;
-	for (TaskID i = 0; i < kMaxTasks; i++) {
-		if (list[i].handle != nullptr) {
-			sortedList[j] = (SortedTask{list[i].priority, i});
-			j++;
+/// The heaps point into list, so they can't just be copied - rebuild them instead
+TaskManager& TaskManager::operator=(const TaskManager& other) {
+	waiting.clear();
+	ready.clear();
+	byLatestStart.clear();
+	list = other.list;
+	telemetry = other.telemetry;
+	telemetryInUse = other.telemetryInUse;
+	onceTaskTelemetry = other.onceTaskTelemetry;
+	timeYielded = other.timeYielded;
+	numYields = other.numYields;
+	numActiveTasks = other.numActiveTasks;
+	mustEndBefore = other.mustEndBefore;
+	running = other.running;
+	lastLoopTime = other.lastLoopTime;
+	for (Task& task : list) {
+		task.waitingIndex = task.readyIndex = task.latestStartIndex = -1;
+		if (task.handle != nullptr) {
+			schedule(task);
 		}
 	}
-	if (numActiveTasks > 1) {
-		// &array[size] is UB, or at least Clang + MSVC manages to choke
-		// on it. So grab what is at worst size-1, and then increment
-		// the pointer.
-		std::sort(&sortedList[0], (&sortedList[numActiveTasks - 1]) + 1);
+	return *this;
+}
+
+/// (re)calculate when the task should run, and put it in the heaps accordingly
+void TaskManager::schedule(Task& task) {
+	unschedule(task);
+	task.updateTimes();
+	waiting.push(&task);
+	byLatestStart.push(&task);
+}
+
+void TaskManager::unschedule(Task& task) {
+	waiting.remove(&task);
+	ready.remove(&task);
+	byLatestStart.remove(&task);
+}
+
+void TaskManager::moveReadyTasks(double currentTime) {
+	while (!waiting.empty() && waiting.top()->readyTime < currentTime) {
+		ready.push(waiting.pop());
 	}
 }
 
-TaskID TaskManager::chooseBestTask(double deadline) {
+/// Only tasks of at most lowestPriority are considered - and during a yield, only those which haven't already run in
+/// it. The rest are passed over rather than ending the search, so one that's overdue but can't run doesn't hold up the
+/// others
+TaskID TaskManager::chooseBestTask(double deadline, uint8_t lowestPriority, bool inYield) {
 	double currentTime = getTimerValueSeconds(0);
-	double nextFinishTime = currentTime;
-	TaskID bestTask = -1;
-	uint8_t bestPriority = INT8_MAX;
-	/// Go through all tasks. If a task needs to be called before the current best task finishes, and has a higher
-	/// priority than the current best task, it becomes the best task
-
-	for (int i = 0; i < numActiveTasks; i++) {
-		struct Task t = list[sortedList[i].task];
-		double timeToCall = t.lastCallTime + t.targetTimeBetweenCalls - t.averageDuration;
-		double maxTimeToCall = t.lastCallTime + t.maxTimeBetweenCalls - t.averageDuration;
-		double timeSinceCall = currentTime - t.lastCallTime;
-		// ensure every routine is within its target
-		if (timeSinceCall > t.maxTimeBetweenCalls) {
-			return sortedList[i].task;
+	moveReadyTasks(currentTime);
+
+	auto canRun = [&](Task* t) { return t->priority <= lowestPriority && !(inYield && t->yieldNumber == numYields); };
+
+	// ensure every routine is within its target - anything past its max time runs now, most overdue first
+	Task* overdue = nullptr;
+	byLatestStart.forEachPreceding(currentTime, [&](Task* t) {
+		if (canRun(t) && currentTime - t->lastCallTime > t->maxTimeBetweenCalls
+		    && (!overdue || t->lastCallTime + t->maxTimeBetweenCalls
+		                        < overdue->lastCallTime + overdue->maxTimeBetweenCalls)) {
+			overdue = t;
 		}
-		if (timeToCall < currentTime || maxTimeToCall < nextFinishTime) {
-			if (currentTime + t.averageDuration < deadline) {
-
-				if (t.priority < bestPriority && t.handle) {
-					if (timeSinceCall > t.minTimeBetweenCalls) {
-						bestTask = sortedList[i].task;
-						nextFinishTime = currentTime + t.averageDuration;
-					}
-					else {
-						bestTask = -1;
-						nextFinishTime = maxTimeToCall;
-					}
-					bestPriority = t.priority;
-				}
+	});
+	if (overdue) {
+		return idOf(overdue);
+	}
+
+	// There'll only ever be a few ready tasks, so if the top one can't run, just look through them
+	Task* best = ready.top();
+	if (best && !canRun(best)) {
+		best = nullptr;
+		for (size_t i = 0; i < ready.size(); i++) {
+			Task* t = ready.at(i);
+			if (canRun(t) && (!best || t->readyKey < best->readyKey)) {
+				best = t;
 			}
 		}
 	}
-	// if we didn't find a task because something high priority needs to wait to run, find the next task we can do
-	// before it needs to start
-	if (bestTask == -1) {
-		// first look based on target time
-		for (int i = (numActiveTasks - 1); i >= 0; i--) {
-			struct Task t = list[sortedList[i].task];
-			if (currentTime + t.averageDuration < nextFinishTime
-			    && currentTime - t.lastCallTime > t.targetTimeBetweenCalls) {
-				return sortedList[i].task;
-			}
+	if (!best) {
+		return -1;
+	}
+
+	// If running the best ready task would make a higher priority one start later than it has to, run that one
+	// instead if it's allowed to go yet, or otherwise find something quick enough to do in the meantime
+	double nextFinishTime = currentTime + best->averageDuration;
+	Task* blocking = nullptr;
+	byLatestStart.forEachPreceding(nextFinishTime, [&](Task* t) {
+		if (t->priority < best->priority && canRun(t) && (!blocking || t->latestStart < blocking->latestStart)) {
+			blocking = t;
 		}
-		// then look based on min time just to avoid busy waiting
-		for (int i = (numActiveTasks - 1); i >= 0; i--) {
-			struct Task t = list[sortedList[i].task];
-			if (currentTime + t.averageDuration < nextFinishTime
-			    && currentTime - t.lastCallTime > t.minTimeBetweenCalls) {
-				return sortedList[i].task;
-			}
+	});
+
+	if (!blocking) {
+		return (nextFinishTime < deadline) ? idOf(best) : -1;
+	}
+	if (currentTime - blocking->lastCallTime > blocking->minTimeBetweenCalls) {
+		return (currentTime + blocking->averageDuration < deadline) ? idOf(blocking) : -1;
+	}
+
+	Task* filler = nullptr;
+	nextFinishTime = std::min(blocking->latestStart, deadline);
+	for (size_t i = 0; i < ready.size(); i++) {
+		Task* t = ready.at(i);
+		if (canRun(t) && currentTime + t->averageDuration < nextFinishTime
+		    && (!filler || t->readyKey < filler->readyKey)) {
+			filler = t;
 		}
 	}
-	return bestTask;
+	return filler ? idOf(filler) : -1;
 }
 
 /// insert task into the first empty spot in the list
 TaskID TaskManager::insertTaskToList(Task task) {
+	if (numActiveTasks >= kMaxTasks) {
+		return -1;
+	}
 	int index = 0;
-	while (list[index].handle && index < kMaxTasks) {
+	while (list[index].handle) {
 		index += 1;
 	}
-	if (index < kMaxTasks) {
-		list[index] = task;
-		numActiveTasks++;
-	}
+	list[index] = task;
+	numActiveTasks++;
+	schedule(list[index]);
 
 	return index;
 };
 
 TaskID TaskManager::addRepeatingTask(TaskHandle task, uint8_t priority, double minTimeBetweenCalls,
                                      double targetTimeBetweenCalls, double maxTimeBetweenCalls) {
-	if (numActiveTasks >= (kMaxTasks)) {
-		return -1;
+	TaskID id = insertTaskToList(Task{.handle = task,
+	                                  .priority = priority,
+	                                  .minTimeBetweenCalls = minTimeBetweenCalls,
+	                                  .targetTimeBetweenCalls = targetTimeBetweenCalls,
+	                                  .maxTimeBetweenCalls = maxTimeBetweenCalls});
+	if (id >= 0) {
+		int index = std::countr_one(telemetryInUse);
+		if (index < kMaxTasksWithTelemetry) {
+			telemetryInUse |= 1u << index;
+			telemetry[index] = TaskTelemetry{};
+			list[id].telemetryIndex = index;
+		}
 	}
-	int index = insertTaskToList(
-	    Task{task, priority, 0, 0, minTimeBetweenCalls, targetTimeBetweenCalls, maxTimeBetweenCalls, false});
-
-	createSortedList();
-	return index;
+	return id;
 }
 
 TaskID TaskManager::addOnceTask(TaskHandle task, uint8_t priority, double timeToWait) {
-	if (numActiveTasks >= (kMaxTasks)) {
-		return -1;
-	}
 	double timeToStart = running ? getTimerValueSeconds(0) : 0;
-	int index = insertTaskToList(Task{task, priority, timeToStart, 0, timeToWait, timeToWait, 10 * timeToWait, true});
-	createSortedList();
-	return index;
+	return insertTaskToList(Task{.handle = task,
+	                             .priority = priority,
+	                             .lastCallTime = timeToStart,
+	                             .minTimeBetweenCalls = timeToWait,
+	                             .targetTimeBetweenCalls = timeToWait,
+	                             .maxTimeBetweenCalls = 10 * timeToWait,
+	                             .removeAfterUse = true});
 }
 
 void TaskManager::removeTask(TaskID id) {
-	list[id] = Task{0, 0, 0, 0, 0, 0, false};
+	if (id < 0 || id >= kMaxTasks || list[id].handle == nullptr) {
+		return;
+	}
+	unschedule(list[id]);
+	if (list[id].telemetryIndex >= 0) {
+		telemetryInUse &= ~(1u << list[id].telemetryIndex);
+	}
+	list[id] = Task{};
 	numActiveTasks--;
-	createSortedList();
 	return;
 }
 
 void TaskManager::runTask(TaskID id) {
-	list[id].lastCallTime = getTimerValueSeconds(0);
-	list[id].handle();
-	if (list[id].removeAfterUse) {
+	Task& task = list[id];
+	TaskHandle handle = task.handle;
+	double startTime = getTimerValueSeconds(0);
+	// Once tasks count from when they were added, but a repeating task's first call has nothing to count from
+	double secondsLate = 0;
+	bool violatedMaxTime = false;
+	if (task.removeAfterUse || task.calledYet) {
+		double timeBetweenCalls = timeSince(task.lastCallTime);
+		secondsLate = timeBetweenCalls - task.targetTimeBetweenCalls;
+		violatedMaxTime = timeBetweenCalls > task.maxTimeBetweenCalls;
+	}
+	task.lastCallTime = startTime;
+	task.calledYet = true;
+
+	// Time the task spends yielding to others isn't part of its own run time. Any yields from tasks run during those
+	// are already part of the outer yield, so reset the total afterwards rather than count them twice
+	double timeYieldedBefore = timeYielded;
+	auto getRunTime = [&]() {
+		double yielded = timeYielded - timeYieldedBefore;
+		timeYielded = timeYieldedBefore;
+		return timeSince(startTime) - yielded;
+	};
+
+	if (task.removeAfterUse) {
+		// remove first, so the slot is free again if the task adds another once task
 		removeTask(id);
+		handle();
+		onceTaskTelemetry.record(getRunTime(), secondsLate, violatedMaxTime);
+		return;
 	}
-	else {
-		double runtime = (getTimerValueSeconds(0) - list[id].lastCallTime);
-		if (runtime < 0) {
-			runtime += rollTime;
-		}
 
-		list[id].averageDuration = (list[id].averageDuration + runtime) / 2;
+	// not in any heap while running, so yield() can't run it again from inside itself
+	unschedule(task);
+	handle();
+	double runtime = getRunTime();
+
+	// the task might have removed itself
+	if (task.handle == handle) {
+		if (task.telemetryIndex >= 0) {
+			telemetry[task.telemetryIndex].record(runtime, secondsLate, violatedMaxTime);
+		}
+		task.averageDuration = (task.averageDuration + runtime) / 2;
+		schedule(task);
 	}
 }
+/// Run whatever's due among tasks with at most lowestPriority (i.e. at least that important), each at most once, then
+/// return to the task that called this. The calling task - and any others it was itself run from - aren't scheduled
+/// while they run, so can't be re-entered
+bool TaskManager::yield(uint8_t lowestPriority) {
+	if (!running) {
+		return false;
+	}
+	double startTime = getTimerValueSeconds(0);
+	numYields++;
+	while (true) {
+		checkForRollover();
+		TaskID id = chooseBestTask(mustEndBefore, lowestPriority, true);
+		if (id < 0) {
+			break;
+		}
+		list[id].yieldNumber = numYields;
+		runTask(id);
+	}
+	timeYielded += timeSince(startTime);
+	return true;
+}
+
 void TaskManager::clockRolledOver() {
 	for (int i = 0; i < kMaxTasks; i++) {
 		// just check it exists, otherwise tasks that never run will overflow
 		if (list[i].handle != nullptr) {
+			// every task moves back by the same amount, so the heaps stay in order
 			list[i].lastCallTime -= rollTime;
+			list[i].updateTimes();
 		}
 	}
 }
 
+void TaskManager::checkForRollover() {
+	double newTime = getTimerValueSeconds(0);
+	if (newTime < lastLoopTime) {
+		clockRolledOver();
+	}
+	lastLoopTime = newTime;
+}
+
 /// default duration of 0 signifies infinite loop, intended to be specified only for testing
 void TaskManager::start(double duration) {
 	// set up os timer 0 as a free running timer
@@ -214,17 +446,13 @@ void TaskManager::start(double duration) {
 	setOperatingMode(0, FREE_RUNNING, false);
 	enableTimer(0);
 	double startTime = getTimerValueSeconds(0);
-	double lastLoop = startTime;
+	lastLoopTime = startTime;
 	if (duration != 0) {
 		mustEndBefore = startTime + duration;
 	}
 	running = true;
 	while (duration == 0 || getTimerValueSeconds(0) < startTime + duration) {
-		double newTime = getTimerValueSeconds(0);
-		if (newTime < lastLoop) {
-			clockRolledOver();
-		}
-		lastLoop = newTime;
+		checkForRollover();
 		TaskID task = chooseBestTask(mustEndBefore);
 		if (task >= 0) {
 			runTask(task);
@@ -249,3 +477,34 @@ uint8_t addOnceTask(TaskHandle task, uint8_t priority, double timeToWait) {
 void removeTask(TaskID id) {
 	return taskManager.removeTask(id);
 }
+
+bool yieldToTasks(uint8_t lowestPriority) {
+	return taskManager.yield(lowestPriority);
+}
+
+void setTaskName(TaskID id, const char* name) {
+	if (id >= 0 && id < kMaxTasks && taskManager.list[id].handle != nullptr) {
+		taskManager.list[id].name = name;
+	}
+}
+
+bool getTaskStatistics(TaskID id, TaskStatistics* stats) {
+	if (id < 0 || id >= kMaxTasks || taskManager.list[id].handle == nullptr
+	    || taskManager.list[id].telemetryIndex < 0) {
+		return false;
+	}
+	const Task& task = taskManager.list[id];
+	taskManager.telemetry[task.telemetryIndex].fill(*stats);
+	stats->name = task.name;
+	return true;
+}
+
+void getOnceTaskStatistics(TaskStatistics* stats) {
+	taskManager.onceTaskTelemetry.fill(*stats);
+	stats->name = "once tasks";
+}
+
+void resetTaskStatistics() {
+	taskManager.telemetry.fill(TaskTelemetry{});
+	taskManager.onceTaskTelemetry = TaskTelemetry{};
+}
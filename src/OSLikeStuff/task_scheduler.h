@@ -21,6 +21,12 @@ extern "C" {
 #endif
 
 #include "RZA1/ostm/ostm.h"
+#include <stdbool.h>
+
+#define MAX_NUM_TASKS 100
+/// Only this many repeating tasks get statistics kept - any more still run, but there are none to get for them
+#define MAX_NUM_TASKS_WITH_STATISTICS 24
+#define TASK_STATISTICS_NUM_BUCKETS 16
 
 /// void function with no arguments
 typedef void (*TaskHandle)();
@@ -34,8 +40,38 @@ uint8_t addRepeatingTask(TaskHandle task, uint8_t priority, double minTimeBetwee
 /// Add a task to run once, aiming to run at current time + timeToWait and worst case run at timeToWait*10
 uint8_t addOnceTask(TaskHandle task, uint8_t priority, double timeToWait);
 void removeTask(TaskID id);
+/// For long jobs (loading a song, reading a folder, finishing a recording): let any due tasks of at most
+/// lowestPriority run, then carry on. Call it regularly from inside the job's loops, and audio etc. keep going with
+/// much the same latency as usual. Cheap if nothing's due. Returns false if the scheduler isn't running yet
+bool yieldToTasks(uint8_t lowestPriority);
 /// start the task scheduler
 void startTaskManager();
+
+/// How long a task has taken to run, and how late it's been getting called, since statistics were last reset. Times
+/// are in seconds
+struct TaskStatistics {
+	const char* name;
+	uint32_t numCalls;
+	double minRunTime;
+	double maxRunTime;
+	/// approximate - the top of the histogram bucket the 99th percentile falls in, or maxRunTime if that's lower
+	double p99RunTime;
+	/// calls which started more than maxTimeBetweenCalls after the previous one
+	uint32_t numMaxTimeViolations;
+	/// how much later than targetTimeBetweenCalls each call started. Bucket 0 counts calls less than 1us late, and
+	/// bucket n counts those 2^(n-1) to 2^n us late - except the last, which counts everything later than that. A
+	/// repeating task's first call has no previous one to be late after, so counts as on time
+	uint32_t lateness[TASK_STATISTICS_NUM_BUCKETS];
+};
+
+/// Name shown alongside the task's statistics. Must stay valid for as long as the task exists
+void setTaskName(TaskID id, const char* name);
+/// Fill in stats for the task with the given id. Returns false if there's no such task, or it's one of those which
+/// statistics aren't kept for - see MAX_NUM_TASKS_WITH_STATISTICS
+bool getTaskStatistics(TaskID id, struct TaskStatistics* stats);
+/// Once tasks don't live long enough for their own statistics to be much use, so they're all counted together
+void getOnceTaskStatistics(struct TaskStatistics* stats);
+void resetTaskStatistics();
 #ifdef __cplusplus
 }
 #endif
@@ -137,6 +137,8 @@ DSTATUS disk_initialize(BYTE pdrv /* Physical drive nmuber to identify the drive
     if (diskStatus & STA_NODISK)
         return SD_ERR_NO_CARD;
 
+    waitForSDTransfers(); // In case one was going when the card came out
+
     // Try initializing, configuring and mounting card; return on error
     currentlyAccessingCard = 1;
     int error              = sd_init(SD_PORT, SDCFG_IP1_BASE, &initializationWorkArea[0], SD_CD_SOCKET);
@@ -191,6 +193,8 @@ DRESULT disk_read_without_streaming_first(BYTE pdrv, /* Physical drive nmuber to
 
     logAudioAction("disk_read_without_streaming_first");
 
+    waitForSDTransfers(); // The card can't take anything else til they're done
+
     BYTE err;
 
     if (currentlyAccessingCard)
@@ -241,6 +245,8 @@ DRESULT disk_write(BYTE pdrv, /* Physical drive nmuber to identify the drive */
 
     loadAnyEnqueuedClustersRoutine(); // Always ensure SD streaming is fulfilled before anything else
 
+    waitForSDTransfers(); // The card can't take anything else til they're done
+
     BYTE err;
 
     if (currentlyAccessingCard)
@@ -251,6 +257,12 @@ DRESULT disk_write(BYTE pdrv, /* Physical drive nmuber to identify the drive */
         }
     }
 
+    // If it's from a buffer the caller's said it'll leave alone, it can carry on while we return
+    if (startSDWriteBehind(buff, sector, count))
+    {
+        return RES_OK;
+    }
+
     currentlyAccessingCard = 1;
 
     err = sd_write_sect(SD_PORT, buff, sector, count, 0x0001u);
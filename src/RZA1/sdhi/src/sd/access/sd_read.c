@@ -458,6 +458,157 @@ ErrExit:
 	return hndl->error;
 }
 
+/*****************************************************************************
+ * ID           :
+ * Summary      : start reading sector data from card, without waiting for it
+ * Include      : 
+ * Declaration  : int sd_read_sect_start(int sd_port, unsigned char *buff,unsigned long psn,long cnt);
+ * Functions    : issue CMD18 and set the DMAC going, then return. When the
+ *              : card has sent the lot (or failed to), the SDHI interrupts:
+ *              : sd_sect_trns_ended() becomes true, and sd_sect_trns_end()
+ *              : must be called before the card can be used again
+ *              : 
+ * Argument     : unsigned char *buff : read data buffer
+ *              : unsigned long psn : read physical sector number
+ *              : long cnt : number of read sectors
+ * Return       : SD_OK : started
+ *              : SD_ERR_ILL_FUNC : not a read which can be done this way -
+ *              :   use sd_read_sect()
+ *              : SD_ERR: end of error
+ * Remark       : only does what sd_read_sect() would do as a single CMD18
+ *              : by DMA, with CMD12 issued automatically
+ *****************************************************************************/
+int sd_read_sect_start(int sd_port, unsigned char *buff,unsigned long psn,long cnt)
+{
+	SDHNDL *hndl;
+	int dma_64 = SD_MODE_DMA;
+	int ret;
+
+	if( (sd_port != 0) && (sd_port != 1) ){
+		return SD_ERR;
+	}
+
+	hndl = _sd_get_hndls(sd_port);
+	if(hndl == 0){
+		return SD_ERR;	/* not initilized */
+	}
+
+	if(_sd_bg_trns[sd_port].active){
+		return SD_ERR;	/* one's already running */
+	}
+
+	if(!(hndl->trans_mode & SD_MODE_DMA) || ((unsigned long)buff & 0x03u) != 0
+		|| cnt <= 2 || cnt > TRANS_SECTORS || hndl->media_type == SD_MEDIA_MMC){
+		return SD_ERR_ILL_FUNC;
+	}
+
+	logAudioAction("sd_read_sect_start");
+
+	hndl->error = SD_OK;
+
+	/* ---- check card is mounted ---- */
+	if(hndl->mount != SD_MOUNT_UNLOCKED_CARD){
+		_sd_set_err(hndl,SD_ERR);
+		return hndl->error;	/* not mounted yet */
+	}
+
+	/* ---- is stop compulsory? ---- */
+	if(hndl->stop){
+		hndl->stop = 0;
+		_sd_set_err(hndl,SD_ERR_STOP);
+		return SD_ERR_STOP;
+	}
+
+	/* ---- is card existed? ---- */
+	if(_sd_check_media(hndl) != SD_OK){
+		_sd_set_err(hndl,SD_ERR_NO_CARD);	/* no card */
+		return SD_ERR_NO_CARD;
+	}
+
+	/* access area check */
+	if(psn >= hndl->card_sector_size || psn + cnt > hndl->card_sector_size){
+		_sd_set_err(hndl,SD_ERR);
+		return hndl->error;	/* out of area */
+	}
+
+	#if		(TARGET_RZ_A1 == 1)
+	if(hndl->trans_mode & SD_MODE_DMA_64){
+		dma_64 = SD_MODE_DMA_64;
+	}
+	#endif
+
+	/* transfer size is fixed (512 bytes) */
+	sd_outp(hndl,SD_SIZE,512);
+
+	/* ---- supply clock (data-transfer ratio) ---- */
+	if(_sd_set_clock(hndl,(int)hndl->csd_tran_speed,SD_CLOCK_ENABLE) != SD_OK){
+		return hndl->error;
+	}
+
+	/* ==== check status precede read operation ==== */
+	if(_sd_card_send_cmd_arg(hndl,CMD13,SD_RESP_R1,hndl->rca[0],0x0000) 
+		== SD_OK){
+		if((hndl->resp_status & RES_STATE) != STATE_TRAN){	/* not transfer state */
+			/* a transfer which failed in the background may have left the card going - stop it for next time */
+			_sd_card_send_cmd_arg(hndl,CMD12,SD_RESP_R1b,hndl->rca[0],0x0000);
+			hndl->error = SD_ERR;
+			goto ErrExit;
+		}
+	}
+	else{	/* SDHI error */
+		goto ErrExit;
+	}
+
+	/* enable SD_SECCNT */
+	sd_outp(hndl,SD_STOP,0x0100);
+	sd_outp(hndl,SD_SECCNT,(unsigned short)cnt);
+
+	/* ---- enable RespEnd and ILA ---- */
+	_sd_set_int_mask(hndl,SD_INFO1_MASK_RESP,0);
+	#if		(TARGET_RZ_A1 == 1)
+	if( dma_64 == SD_MODE_DMA_64 ){
+		sd_outp(hndl,EXT_SWAP,0x0100);		/* Set DMASEL for 64byte transfer */
+	}
+	#endif
+	sd_outp(hndl,CC_EXT_MODE,(unsigned short)(sd_inp(hndl,CC_EXT_MODE) | CC_EXT_MODE_DMASDRW));	/* enable DMA */
+
+	/* issue CMD18 (READ_MULTIPLE_BLOCK) */
+	if(_sd_send_mcmd(hndl,CMD18,SET_ACC_ADDR) != SD_OK){
+		goto ErrExit;
+	}
+
+	if(_sd_bg_trns_start_dma(hndl,buff,cnt,SD_TRANS_READ,dma_64) != SD_OK){
+		goto ErrExit;
+	}
+
+	return SD_OK;
+
+ErrExit:
+	sddev_disable_dma(sd_port);
+	sd_outp(hndl,CC_EXT_MODE,(unsigned short)(sd_inp(hndl,CC_EXT_MODE) 
+			& ~CC_EXT_MODE_DMASDRW));	/* disable DMA */
+
+	ret = hndl->error;
+
+	/* ---- clear error bits ---- */
+	_sd_clear_info(hndl,SD_INFO1_MASK_TRNS_RESP,0x837f);
+	/* ---- disable all interrupts ---- */
+	_sd_clear_int_mask(hndl,SD_INFO1_MASK_TRNS_RESP,0x837f);
+
+	sd_outp(hndl,SD_STOP,0x0001);
+	sd_outp(hndl,SD_STOP,0x0000);
+
+	#if		(TARGET_RZ_A1 == 1)
+	sd_outp(hndl,EXT_SWAP,0x0000);		/* Clear DMASEL for 64byte transfer */
+	#endif
+
+	/* ---- halt clock ---- */
+	_sd_set_clock(hndl,0,SD_CLOCK_DISABLE);
+
+	hndl->error = ret;
+	return ret;
+}
+
 /*****************************************************************************
  * ID           :
  * Summary      : read sector data from card by single block transfer
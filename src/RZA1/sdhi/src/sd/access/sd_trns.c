@@ -37,6 +37,7 @@
 *******************************************************************************/
 #include "../../../inc/sdif.h"
 #include "../inc/access/sd.h"
+#include "RZA1/compiler/asm/inc/asm.h"
 #include "deluge/deluge.h"
 
 #ifdef __CC_ARM
@@ -150,4 +151,208 @@ ErrExit:
 	return hndl->error;
 }
 
+/* ==== multiple block transfers left to run by DMA ==== */
+SD_BG_TRNS _sd_bg_trns[NUM_PORT];
+
+/*****************************************************************************
+ * ID           :
+ * Summary      : set the DMAC going for a transfer left to run
+ * Include      : 
+ * Declaration  : int _sd_bg_trns_start_dma(SDHNDL *hndl,unsigned char *buff,
+ *              : long cnt,int dir,int dma_64)
+ * Functions    : the data phase of a multiple block transfer, once CMD18 or
+ *              : CMD25 has been issued - as for one that's waited for,
+ *              : except that it returns straight away. The All end or error
+ *              : interrupt then says it's over
+ *              :
+ * Argument     : SDHNDL *hndl : SD handle
+ *              : unsigned char *buff : data buffer
+ *              : long cnt : number of transfer sectors
+ *              : int dir : SD_TRANS_READ or SD_TRANS_WRITE
+ *              : int dma_64 : SD_MODE_DMA_64 for 64byte transfer
+ * Return       : SD_OK : started
+ *              : SD_ERR_CPU_IF : the DMAC couldn't be set going
+ *****************************************************************************/
+int _sd_bg_trns_start_dma(SDHNDL *hndl,unsigned char *buff,long cnt,int dir,int dma_64)
+{
+	SD_BG_TRNS *trns = &_sd_bg_trns[hndl->sd_port];
+	unsigned long reg_base_here;
+
+	/* ---- disable RespEnd and ILA ---- */
+	_sd_clear_int_mask(hndl,SD_INFO1_MASK_RESP,SD_INFO2_MASK_ILA);
+
+	/* disable card ins&rem interrupt for FIFO */
+	trns->info1_back = (unsigned short)(hndl->int_info1_mask & SD_INFO1_MASK_DET_CD);
+	_sd_clear_int_mask(hndl,SD_INFO1_MASK_DET_CD,0);
+
+	if(dir == SD_TRANS_READ){
+		/* see doActualReadRohan() for why this is done before as well as after */
+		v7_dma_inv_range((intptr_t)buff, (intptr_t)(buff + cnt * 512));
+	}
+	else{
+		v7_dma_flush_range((intptr_t)buff, (intptr_t)(buff + cnt * 512));
+	}
+
+	reg_base_here = hndl->reg_base;
+	if(TARGET_RZ_A1 != 1 || dma_64 != SD_MODE_DMA_64) /* SD_CMD Address for 64byte transfer */
+		reg_base_here += SD_BUF0;
+
+	if(sddev_init_dma(hndl->sd_port, (unsigned long)buff, reg_base_here, cnt*512, dir) != SD_OK){
+		_sd_set_int_mask(hndl,trns->info1_back,0);
+		_sd_set_err(hndl,SD_ERR_CPU_IF);
+		return SD_ERR_CPU_IF;
+	}
+
+	trns->dir = dir;
+	trns->buff = buff;
+	trns->cnt = cnt;
+	_sd_clear_info(hndl,SD_INFO1_MASK_DATA_TRNS,SD_INFO2_MASK_ERR);
+	trns->active = 1;
+
+	/* enable All end and errors last, so the interrupt can't come before there's a transfer to end */
+	_sd_set_int_mask(hndl,SD_INFO1_MASK_DATA_TRNS,SD_INFO2_MASK_ERR);
+
+	return SD_OK;
+}
+
+/*****************************************************************************
+ * ID           :
+ * Summary      : whether a transfer left to run is over
+ * Include      : 
+ * Declaration  : int sd_sect_trns_ended(int sd_port);
+ * Functions    : check for the All end or error interrupt, after
+ *              : sd_read_sect_start() or sd_write_sect_start()
+ *              : 
+ * Argument     : int sd_port : channel no (0 or 1)
+ * Return       : 1 : over - call sd_sect_trns_end()
+ *              : 0 : still going, or none started
+ * Remark       : for the interrupt callback (see sd_set_intcallback())
+ *****************************************************************************/
+int sd_sect_trns_ended(int sd_port)
+{
+	SDHNDL *hndl;
+
+	if( (sd_port != 0) && (sd_port != 1) ){
+		return 0;
+	}
+
+	hndl = _sd_get_hndls(sd_port);
+	if(hndl == 0 || !_sd_bg_trns[sd_port].active){
+		return 0;
+	}
+
+	return ((hndl->int_info1 & SD_INFO1_MASK_DATA_TRNS) || (hndl->int_info2 & SD_INFO2_MASK_ERR)) ? 1 : 0;
+}
+
+/*****************************************************************************
+ * ID           :
+ * Summary      : finish a transfer left to run
+ * Include      : 
+ * Declaration  : int sd_sect_trns_end(int sd_port);
+ * Functions    : stop the DMAC and put the SDHI back how sd_read_sect() and
+ *              : sd_write_sect() leave it. If called before
+ *              : sd_sect_trns_ended(), the transfer is given up on
+ *              : 
+ * Argument     : int sd_port : channel no (0 or 1)
+ * Return       : SD_OK : end of succeed
+ *              : SD_ERR: end of error
+ * Remark       : issues no commands and waits for no interrupts, so may be
+ *              : called from the interrupt callback. So the card's state
+ *              : isn't checked with CMD13 afterwards, as it is for a
+ *              : transfer that's waited for - but the next read or write
+ *              : does that first, and issues CMD12 if it needs to
+ *****************************************************************************/
+int sd_sect_trns_end(int sd_port)
+{
+	SDHNDL *hndl;
+	SD_BG_TRNS *trns;
+	int ret;
+
+	if( (sd_port != 0) && (sd_port != 1) ){
+		return SD_ERR;
+	}
+
+	hndl = _sd_get_hndls(sd_port);
+	trns = &_sd_bg_trns[sd_port];
+	if(hndl == 0 || !trns->active){
+		return SD_ERR;
+	}
+	trns->active = 0;
+
+	hndl->error = SD_OK;
+
+	/* ---- check errors ---- */
+	if(hndl->int_info2 & SD_INFO2_MASK_ERR){
+		_sd_check_info2_err(hndl);
+	}
+	else if(!(hndl->int_info1 & SD_INFO1_MASK_DATA_TRNS)){
+		_sd_set_err(hndl,SD_ERR_HOST_TOE);	/* given up on */
+	}
+	/* All end comes after the last of the data's gone through the FIFO, so this shouldn't wait */
+	else if(sddev_wait_dma_end(sd_port, trns->cnt*512) != SD_OK){
+		_sd_set_err(hndl,SD_ERR_CPU_IF);
+	}
+	/* ---- response to the automatic CMD12 ---- */
+	else if(trns->dir == SD_TRANS_WRITE && (hndl->media_type & SD_MEDIA_SD)){
+		_sd_get_resp(hndl,SD_RESP_R1);	/* sets hndl->error if there's one */
+	}
+
+	sddev_disable_dma(sd_port);	/* disable DMAC */
+	sd_outp(hndl,CC_EXT_MODE,(unsigned short)(sd_inp(hndl,CC_EXT_MODE) & ~CC_EXT_MODE_DMASDRW));
+	_sd_set_int_mask(hndl,trns->info1_back,0);
+
+	ret = hndl->error;
+
+	if(ret == SD_OK){
+		if(trns->dir == SD_TRANS_READ){
+			// Invalidate ram
+			v7_dma_inv_range((uintptr_t)trns->buff, (uintptr_t)(trns->buff + trns->cnt * 512));
+		}
+
+		/* clear All end bit */
+		_sd_clear_info(hndl,SD_INFO1_MASK_DATA_TRNS,0x0000);
+
+		/* disable All end, BRE/BWE and errors */
+		_sd_clear_int_mask(hndl,SD_INFO1_MASK_DATA_TRNS,
+			(trns->dir == SD_TRANS_READ) ? SD_INFO2_MASK_BRE : SD_INFO2_MASK_BWE);
+	}
+	else{
+		/* ---- clear error bits ---- */
+		_sd_clear_info(hndl,SD_INFO1_MASK_TRNS_RESP,0x837f);
+		/* ---- disable all interrupts ---- */
+		_sd_clear_int_mask(hndl,SD_INFO1_MASK_TRNS_RESP,0x837f);
+
+		if((sd_inp(hndl,SD_INFO2) & SD_INFO2_MASK_CBSY) == SD_INFO2_MASK_CBSY){
+			unsigned short sd_option,sd_clk_ctrl;
+
+			/* no waiting for CMD12 here, as sd_read_sect() would - just reset the SDHI */
+			sd_option = sd_inp(hndl,SD_OPTION);
+			sd_clk_ctrl = sd_inp(hndl,SD_CLK_CTRL);
+			#if		(TARGET_RZ_A1 == 1)
+			sd_outp(hndl,SOFT_RST,0x0006);
+			sd_outp(hndl,SOFT_RST,0x0007);
+			#else
+			sd_outp(hndl,SOFT_RST,0);
+			sd_outp(hndl,SOFT_RST,1);
+			#endif
+			sd_outp(hndl,SD_STOP,0x0000);
+			sd_outp(hndl,SD_OPTION,sd_option);
+			sd_outp(hndl,SD_CLK_CTRL,sd_clk_ctrl);
+		}
+
+		sd_outp(hndl,SD_STOP,0x0001);
+		sd_outp(hndl,SD_STOP,0x0000);
+	}
+
+	#if		(TARGET_RZ_A1 == 1)
+	sd_outp(hndl,EXT_SWAP,0x0000);		/* Clear DMASEL for 64byte transfer */
+	#endif
+
+	/* ---- halt clock ---- */
+	_sd_set_clock(hndl,0,SD_CLOCK_DISABLE);
+
+	hndl->error = ret;
+	return ret;
+}
+
 /* End of File */
@@ -116,6 +116,181 @@ int sd_write_sect(int sd_port, unsigned char const*buff,unsigned long psn,long c
 	return hndl->error;
 }
 
+/*****************************************************************************
+ * ID           :
+ * Summary      : start writing sector data to card, without waiting for it
+ * Include      : 
+ * Declaration  : int sd_write_sect_start(int sd_port, unsigned char const*buff,unsigned long psn,
+ *              : long cnt,int writemode);
+ * Functions    : issue CMD25 and set the DMAC going, then return. When the
+ *              : card has taken the lot (or failed to), the SDHI interrupts:
+ *              : sd_sect_trns_ended() becomes true, and sd_sect_trns_end()
+ *              : must be called before the card can be used again. The
+ *              : buffer mustn't be touched til then
+ *              : 
+ * Argument     : unsigned char *buff : write data buffer
+ *              : unsigned long psn : write physical sector number
+ *              : long cnt : number of write sectors
+ *              : int writemode : memory card write mode
+ *              :   SD_WRITE_WITH_PREERASE : pre-erease write
+ *              :   SD_WRITE_OVERWRITE : overwrite
+ * Return       : SD_OK : started
+ *              : SD_ERR_ILL_FUNC : not a write which can be done this way -
+ *              :   use sd_write_sect()
+ *              : SD_ERR: end of error
+ * Remark       : only does what sd_write_sect() would do as a single CMD25
+ *              : by DMA. There's no ACMD22 to count the blocks written if
+ *              : it fails - it just fails
+ *****************************************************************************/
+int sd_write_sect_start(int sd_port, unsigned char const*buff,unsigned long psn,long cnt,int writemode)
+{
+	SDHNDL *hndl;
+	int dma_64 = SD_MODE_DMA;
+	int ret;
+
+	if( (sd_port != 0) && (sd_port != 1) ){
+		return SD_ERR;
+	}
+
+	hndl = _sd_get_hndls(sd_port);
+	if(hndl == 0){
+		return SD_ERR;	/* not initilized */
+	}
+
+	if(_sd_bg_trns[sd_port].active){
+		return SD_ERR;	/* one's already running */
+	}
+
+	if(!(hndl->trans_mode & SD_MODE_DMA) || ((unsigned long)buff & 0x03u) != 0
+		|| cnt <= 2 || cnt > TRANS_SECTORS){
+		return SD_ERR_ILL_FUNC;
+	}
+
+	logAudioAction("sd_write_sect_start");
+
+	hndl->error = SD_OK;
+
+	/* ---- check card is mounted ---- */
+	if(hndl->mount != SD_MOUNT_UNLOCKED_CARD){
+		_sd_set_err(hndl,SD_ERR);
+		return hndl->error;	/* not mounted yet */
+	}
+
+	/* ---- check write protect ---- */
+	if(hndl->write_protect){
+		_sd_set_err(hndl,SD_ERR_WP);
+		return hndl->error;	/* write protect error */
+	}
+
+	/* ---- is stop compulsory? ---- */
+	if(hndl->stop){
+		hndl->stop = 0;
+		_sd_set_err(hndl,SD_ERR_STOP);
+		return hndl->error;
+	}
+
+	/* ---- is card existed? ---- */
+	if(_sd_check_media(hndl) != SD_OK){
+		_sd_set_err(hndl,SD_ERR_NO_CARD);
+		return hndl->error;
+	}
+
+	/* access area check */
+	if(psn >= hndl->card_sector_size || psn + cnt > hndl->card_sector_size){
+		_sd_set_err(hndl,SD_ERR);
+		return hndl->error;	/* out of area */
+	}
+
+	#if		(TARGET_RZ_A1 == 1)
+	if(hndl->trans_mode & SD_MODE_DMA_64){
+		dma_64 = SD_MODE_DMA_64;
+	}
+	#endif
+
+	/* ---- supply clock (data-transfer ratio) ---- */
+	if(_sd_set_clock(hndl,(int)hndl->csd_tran_speed,SD_CLOCK_ENABLE) != SD_OK){
+		return hndl->error;
+	}
+
+	/* ==== check status precede write operation ==== */
+	if(_sd_card_send_cmd_arg(hndl,CMD13,SD_RESP_R1,hndl->rca[0],0x0000) 
+		== SD_OK){
+		if((hndl->resp_status & RES_STATE) != STATE_TRAN){	/* not transfer state */
+			/* a transfer which failed in the background may have left the card going - stop it for next time */
+			_sd_card_send_cmd_arg(hndl,CMD12,SD_RESP_R1b,hndl->rca[0],0x0000);
+			hndl->error = SD_ERR;
+			goto ErrExit;
+		}
+	}
+	else{	/* SDHI error */
+		goto ErrExit;
+	}
+
+	/* if card is SD Memory card and pre-erease write, issue ACMD23 */
+	if((hndl->media_type & SD_MEDIA_SD) && 
+		(writemode == SD_WRITE_WITH_PREERASE)){
+		if(_sd_send_acmd(hndl,ACMD23,0,(unsigned short)cnt) != SD_OK){
+			goto ErrExit;
+		}
+		if(_sd_get_resp(hndl,SD_RESP_R1) != SD_OK){
+			goto ErrExit;
+		}
+	}
+
+	/* transfer size is fixed (512 bytes) */
+	sd_outp(hndl,SD_SIZE,512);
+
+	/* enable SD_SECCNT */
+	sd_outp(hndl,SD_STOP,0x0100);
+	sd_outp(hndl,SD_SECCNT,(unsigned short)cnt);
+
+	#if		(TARGET_RZ_A1 == 1)
+	if( dma_64 == SD_MODE_DMA_64 ){
+		sd_outp(hndl,EXT_SWAP,0x0100);		/* Set DMASEL for 64byte transfer */
+	}
+	#endif
+	sd_outp(hndl,CC_EXT_MODE,(unsigned short)(sd_inp(hndl,CC_EXT_MODE) | CC_EXT_MODE_DMASDRW));	/* enable DMA */
+
+	/* ---- enable RespEnd and ILA ---- */
+	_sd_set_int_mask(hndl,SD_INFO1_MASK_RESP,0);
+	/* issue CMD25 (WRITE_MULTIPLE_BLOCK) */
+	if(_sd_send_mcmd(hndl,CMD25,SET_ACC_ADDR) != SD_OK){
+		goto ErrExit;
+	}
+
+	// It is safe to cast away const here - the DMAC only reads from the buffer in SD_TRANS_WRITE mode
+	if(_sd_bg_trns_start_dma(hndl,(unsigned char*)buff,cnt,SD_TRANS_WRITE,dma_64) != SD_OK){
+		goto ErrExit;
+	}
+
+	return SD_OK;
+
+ErrExit:
+	sddev_disable_dma(sd_port);
+	sd_outp(hndl,CC_EXT_MODE,(unsigned short)(sd_inp(hndl,CC_EXT_MODE) 
+			& ~CC_EXT_MODE_DMASDRW));	/* disable DMA */
+
+	ret = hndl->error;
+
+	/* ---- clear error bits ---- */
+	_sd_clear_info(hndl,SD_INFO1_MASK_TRNS_RESP,0x837f);
+	/* ---- disable all interrupts ---- */
+	_sd_clear_int_mask(hndl,SD_INFO1_MASK_TRNS_RESP,0x837f);
+
+	sd_outp(hndl,SD_STOP,0x0001);
+	sd_outp(hndl,SD_STOP,0x0000);
+
+	#if		(TARGET_RZ_A1 == 1)
+	sd_outp(hndl,EXT_SWAP,0x0000);		/* Clear DMASEL for 64byte transfer */
+	#endif
+
+	/* ---- halt clock ---- */
+	_sd_set_clock(hndl,0,SD_CLOCK_DISABLE);
+
+	hndl->error = ret;
+	return ret;
+}
+
 /*****************************************************************************
  * ID           :
  * Summary      : write sector data to card
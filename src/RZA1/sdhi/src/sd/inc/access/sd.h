@@ -543,6 +543,19 @@ int _esd_get_partition_id(SDHNDL *hndl, int *id);
 int _sd_software_trans(SDHNDL *hndl,unsigned char *buff,long cnt,int dir);
 int _sd_dma_trans(SDHNDL *hndl,long cnt);
 
+/* ---- a multiple block transfer left to run by DMA - see sd_read_sect_start() ---- */
+typedef struct _sd_bg_trns{
+	volatile int	active;
+	int				dir;									/* SD_TRANS_READ or SD_TRANS_WRITE */
+	unsigned short	info1_back;								/* card ins&rem interrupt mask, to put back */
+	unsigned char	*buff;
+	long			cnt;
+}SD_BG_TRNS;
+
+extern SD_BG_TRNS _sd_bg_trns[NUM_PORT];
+
+int _sd_bg_trns_start_dma(SDHNDL *hndl,unsigned char *buff,long cnt,int dir,int dma_64);
+
 /* ---- sdio_trns.c ---- */
 int _sdio_software_trans(SDHNDL *hndl,unsigned char *buff,long cnt,int dir,unsigned short blocklen);
 int _sdio_software_trans2(SDHNDL *hndl,unsigned char *buff,long cnt,int dir);
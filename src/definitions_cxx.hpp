@@ -438,9 +438,10 @@ constexpr int32_t kNumModFXTypes = util::to_underlying(ModFXType::GRAIN) + 1;
 constexpr int32_t SAMPLE_MAX_TRANSPOSE = 24;
 constexpr int32_t SAMPLE_MIN_TRANSPOSE = (-96);
 
-enum WavFormat : uint8_t {
+enum WavFormat : uint16_t {
 	WAV_FORMAT_PCM = 1,
 	WAV_FORMAT_FLOAT = 3,
+	WAV_FORMAT_DELUGE_LOSSLESS = 0xFFFF, // The "development" tag, with a "dlix" chunk - see SampleBlockIndex
 };
 
 enum class PolyphonyMode : uint8_t {
@@ -620,6 +621,8 @@ enum class MIDITransposeControlMethod : uint8_t {
 constexpr auto kNumMIDITransposeControlMethods = util::to_underlying(MIDITransposeControlMethod::CHORD) + 1;
 
 constexpr int32_t kNumClustersLoadedAhead = 2;
+// SampleLowLevelReaders reading quickly, or while the card's slow, hold more - see getNumClustersToLoadAhead()
+constexpr int32_t kMaxNumClustersLoadedAhead = 6;
 
 enum class InputMonitoringMode : uint8_t {
 	SMART,
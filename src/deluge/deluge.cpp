@@ -52,6 +52,7 @@
 #include "model/clip/instrument_clip.h"
 #include "model/clip/instrument_clip_minder.h"
 #include "model/output.h"
+#include "model/sample/sample_files.h"
 #include "model/settings/runtime_feature_settings.h"
 #include "model/song/song.h"
 #include "modulation/params/param_manager.h"
@@ -60,6 +61,8 @@
 #include "processing/engines/audio_engine.h"
 #include "processing/engines/cv_engine.h"
 #include "storage/audio/audio_file_manager.h"
+#include "storage/audio/impulse_response_file.h"
+#include "storage/block/sd_block_device.h"
 #include "storage/flash_storage.h"
 #include "storage/storage_manager.h"
 #include "task_scheduler.h"
@@ -549,9 +552,17 @@ extern "C" volatile uint32_t usbLock;
 
 extern "C" void usb_main_host(void);
 
+/// Names show up in the task statistics, see getTaskStatistics()
+void addNamedRepeatingTask(const char* name, TaskHandle task, uint8_t priority, double minTimeBetweenCalls,
+                           double targetTimeBetweenCalls, double maxTimeBetweenCalls) {
+	setTaskName(addRepeatingTask(task, priority, minTimeBetweenCalls, targetTimeBetweenCalls, maxTimeBetweenCalls),
+	            name);
+}
+
 void registerTasks() {
-	// addRepeatingTask arguments are:
+	// addNamedRepeatingTask arguments are:
 	//
+	// - name, for the task statistics
 	// - priority (lower = more important)
 	// - min time between calls
 	// - target time between calls
@@ -569,42 +580,49 @@ void registerTasks() {
 
 	// 0-9: High priority (10 for dyn tasks)
 	uint8_t p = 0;
-	addRepeatingTask(&(AudioEngine::routine), p++, 8 / 44100., 16 / 44100., 32 / 44100.);
+	addNamedRepeatingTask("audio routine", &(AudioEngine::routine), p++, 8 / 44100., 16 / 44100., 32 / 44100.);
 	// this one runs quickly and frequently to check for encoder changes
-	addRepeatingTask([]() { encoders::readEncoders(); }, p++, 0.0005, 0.001, 0.001);
+	addNamedRepeatingTask("read encoders", []() { encoders::readEncoders(); }, p++, 0.0005, 0.001, 0.001);
 	// formerly part of audio routine, updates midi and clock
-	addRepeatingTask([]() { playbackHandler.routine(); }, p++, 8 / 44100., 16 / 44100, 32 / 44100.);
-	addRepeatingTask([]() { audioFileManager.loadAnyEnqueuedClusters(8, false); }, p++, 0.00001, 0.00001, 0.00002);
+	addNamedRepeatingTask("playback routine", []() { playbackHandler.routine(); }, p++, 8 / 44100., 16 / 44100,
+	                      32 / 44100.);
+	addNamedRepeatingTask("load clusters", []() { audioFileManager.loadAnyEnqueuedClusters(8, false); }, p++, 0.00001,
+	                      0.00001, 0.00002);
+	// everything up to here keeps running while long jobs yield - see AudioEngine::kYieldPriority
+
 	// handles sd card recorders
 	// named "slow" but isn't actually, it handles audio recording setup
-	addRepeatingTask(&AudioEngine::slowRoutine, p++, 0.001, 0.005, 0.05);
-	addRepeatingTask(&(readButtonsAndPadsOnce), p++, 0.005, 0.005, 0.01);
+	addNamedRepeatingTask("audio slow routine", &AudioEngine::slowRoutine, p++, 0.001, 0.005, 0.05);
+	addNamedRepeatingTask("buttons and pads", &(readButtonsAndPadsOnce), p++, 0.005, 0.005, 0.01);
 
 	// 11-19: Medium priority (20 for dyn tasks)
 	p = 11;
-	addRepeatingTask([]() { encoders::interpretEncoders(true); }, p++, 0.005, 0.005, 0.01);
+	addNamedRepeatingTask("interpret encoders (fast)", []() { encoders::interpretEncoders(true); }, p++, 0.005, 0.005,
+	                      0.01);
 	// 30 Hz update desired?
-	addRepeatingTask(&doAnyPendingUIRendering, p++, 0.01, 0.01, 0.03);
+	addNamedRepeatingTask("UI rendering", &doAnyPendingUIRendering, p++, 0.01, 0.01, 0.03);
 	// this one actually actions them
-	addRepeatingTask([]() { encoders::interpretEncoders(false); }, p++, 0.005, 0.005, 0.01);
+	addNamedRepeatingTask("interpret encoders", []() { encoders::interpretEncoders(false); }, p++, 0.005, 0.005, 0.01);
 
 	// 21-29: Low priority (30 for dyn tasks)
 	p = 21;
 	// these ones are actually "slow" -> file manager just checks if an sd card has been inserted, audio recorder checks
 	// if recordings are finished
-	addRepeatingTask([]() { audioFileManager.slowRoutine(); }, p++, 0.1, 0.1, 0.2);
-	addRepeatingTask([]() { audioRecorder.slowRoutine(); }, p++, 0.01, 0.1, 0.1);
+	addNamedRepeatingTask("audio file manager", []() { audioFileManager.slowRoutine(); }, p++, 0.1, 0.1, 0.2);
+	addNamedRepeatingTask("audio recorder", []() { audioRecorder.slowRoutine(); }, p++, 0.01, 0.1, 0.1);
+	// reads clusters only while nothing's waiting to stream, so it stays out of playback's way
+	addNamedRepeatingTask("sample files", &SampleFiles::continueWork, p++, 0.01, 0.02, 0.5);
 
 	// 31-39: Idle priority (40 for dyn tasks)
 	p = 31;
-	addRepeatingTask(&(PIC::flush), p++, 0.001, 0.001, 0.02);
+	addNamedRepeatingTask("PIC flush", &(PIC::flush), p++, 0.001, 0.001, 0.02);
 	if (hid::display::have_oled_screen) {
-		addRepeatingTask(&(oledRoutine), p++, 0.01, 0.01, 0.02);
+		addNamedRepeatingTask("OLED", &(oledRoutine), p++, 0.01, 0.01, 0.02);
 	}
 	// needs to be called very frequently,
 	// handles animations and checks on the timers for any infrequent actions
 	// long term this should probably be made into an idle task
-	addRepeatingTask([]() { uiTimerManager.routine(); }, p++, 0.0001, 0.0007, 0.01);
+	addNamedRepeatingTask("UI timers", []() { uiTimerManager.routine(); }, p++, 0.0001, 0.0007, 0.01);
 
 	// addRepeatingTask([]() { AudioEngine::routineWithClusterLoading(true); }, 0, 1 / 44100., 16 / 44100., 32 / 44100.,
 	// true); addRepeatingTask(&(AudioEngine::routine), 0, 16 / 44100., 64 / 44100., true);
@@ -644,6 +662,7 @@ void mainLoop() {
 		// called in card routine
 		audioFileManager.slowRoutine();
 		AudioEngine::slowRoutine();
+		SampleFiles::continueWork();
 
 		audioRecorder.slowRoutine();
 
@@ -851,6 +870,7 @@ extern "C" int32_t deluge_main(void) {
 
 	// Hopefully we can read these files now
 	runtimeFeatureSettings.readSettingsFromFile(storageManager);
+	ImpulseResponseFile::update();
 	MIDIDeviceManager::readDevicesFromFile(storageManager);
 	midiFollow.readDefaultsFromFile(storageManager);
 	PadLEDs::setBrightnessLevel(FlashStorage::defaultPadBrightness);
@@ -994,6 +1014,14 @@ extern "C" void loadAnyEnqueuedClustersRoutine() {
 	audioFileManager.loadAnyEnqueuedClusters();
 }
 
+extern "C" void waitForSDTransfers() {
+	sdBlockDevice.waitTilIdle();
+}
+
+extern "C" int startSDWriteBehind(uint8_t const* buff, uint32_t sector, uint32_t count) {
+	return sdBlockDevice.startWriteBehind(buff, sector, count);
+}
+
 extern "C" void setNumeric(char* text) {
 	display->setText(text);
 }
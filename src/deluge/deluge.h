@@ -35,6 +35,8 @@ extern void logAudioAction(char const* string);
 extern void consoleTextIfAllBootedUp(char const* text);
 
 extern void routineForSD(void);
+extern void waitForSDTransfers(void);
+extern int startSDWriteBehind(uint8_t const* buff, uint32_t sector, uint32_t count);
 extern void sdCardInserted(void);
 extern void sdCardEjected(void);
 
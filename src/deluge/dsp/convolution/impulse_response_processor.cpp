@@ -0,0 +1,67 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "dsp/convolution/impulse_response_processor.h"
+
+deluge::dsp::PartitionedConvolver::ImpulseResponse ImpulseResponseProcessor::userImpulseResponse;
+uint32_t ImpulseResponseProcessor::userGeneration = 0;
+
+Error ImpulseResponseProcessor::setUserImpulseResponse(std::span<q31_t const> taps) {
+	if (taps.empty() || taps.size() > deluge::dsp::PartitionedConvolver::kMaxNumTaps) {
+		return Error::FILE_UNSUPPORTED;
+	}
+
+	// Nothing gets processed until we return, so the convolvers can be left pointing at the old one until they next
+	// check userGeneration
+	clearUserImpulseResponse();
+	return userImpulseResponse.set(taps);
+}
+
+void ImpulseResponseProcessor::clearUserImpulseResponse() {
+	userImpulseResponse.discard();
+	// Either way, any convolvers set up with the old IR are now out of date
+	userGeneration++;
+	if (userGeneration == 0) {
+		userGeneration = 1;
+	}
+}
+
+bool ImpulseResponseProcessor::updateConvolver() {
+	if (convolverGeneration_ == userGeneration) {
+		return convolver_.isActive();
+	}
+
+	convolverGeneration_ = userGeneration;
+	if (!userImpulseResponse.isValid()) {
+		convolver_.discard();
+		return false;
+	}
+
+	// If there's no room, keep going with the built-in IR until the user's changes
+	return (convolver_.setImpulseResponse(userImpulseResponse) == Error::NONE);
+}
+
+void ImpulseResponseProcessor::process(std::span<StereoSample> buffer) {
+	if (updateConvolver()) {
+		convolver_.process(buffer);
+		return;
+	}
+
+	for (StereoSample& sample : buffer) {
+		process(sample, sample);
+	}
+}
@@ -17,10 +17,16 @@
 
 #pragma once
 
+#include "definitions_cxx.hpp"
+#include "dsp/convolution/partitioned_convolver.h"
 #include "dsp/stereo_sample.h"
 #include "util/fixedpoint.h"
 #include <cstdint>
+#include <span>
 
+/// The analog delay's feedback filter. A fixed 26-tap direct-form FIR, unless the user has loaded their own IR from
+/// the card, which can be thousands of taps long and goes through a PartitionedConvolver instead - adding that
+/// convolver's kBlockSize samples of latency to the delay time
 class ImpulseResponseProcessor {
 	constexpr static size_t IR_SIZE = 26;
 	constexpr static size_t IR_BUFFER_SIZE = (IR_SIZE - 1);
@@ -33,6 +39,25 @@ class ImpulseResponseProcessor {
 
 public:
 	ImpulseResponseProcessor() = default;
+	ImpulseResponseProcessor(const ImpulseResponseProcessor&) = delete;
+	ImpulseResponseProcessor& operator=(const ImpulseResponseProcessor&) = delete;
+
+	/// Every ImpulseResponseProcessor switches to these taps the next time it processes. Taps are scaled as for the
+	/// built-in IR. Their spectra are worked out here, once for all of them, so this isn't for the audio routine. The
+	/// taps needn't be kept
+	static Error setUserImpulseResponse(std::span<q31_t const> taps);
+	/// Back to the built-in IR everywhere
+	static void clearUserImpulseResponse();
+	[[nodiscard]] static bool hasUserImpulseResponse() { return userImpulseResponse.isValid(); }
+
+	/// Filter in place, with the user's IR if there is one
+	void process(std::span<StereoSample> buffer);
+
+	/// Let go of the convolver's memory while nothing's being processed. It gets set up again if needed
+	void discard() {
+		convolver_.discard();
+		convolverGeneration_ = 0;
+	}
 
 	inline void process(const StereoSample input, StereoSample& output) {
 		output.l = buffer_[0].l + multiply_32x32_rshift32_rounded(input.l, ir[0]);
@@ -48,5 +73,14 @@ public:
 	}
 
 private:
+	/// Sets the convolver up with the user's IR, if it isn't already. False if it can't be
+	bool updateConvolver();
+
 	std::array<StereoSample, IR_BUFFER_SIZE> buffer_;
+
+	deluge::dsp::PartitionedConvolver convolver_;
+	uint32_t convolverGeneration_ = 0; // Which of the user's IRs convolver_ has, 0 being none
+
+	static deluge::dsp::PartitionedConvolver::ImpulseResponse userImpulseResponse;
+	static uint32_t userGeneration; // Goes up each time the user's IR changes
 };
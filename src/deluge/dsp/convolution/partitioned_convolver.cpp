@@ -0,0 +1,219 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "dsp/convolution/partitioned_convolver.h"
+#include "dsp/fft/fft_config_manager.h"
+#include "memory/memory_allocator_interface.h"
+#include <algorithm>
+#include <cstring>
+
+namespace deluge::dsp {
+
+namespace {
+
+// The unit tests run this on the host, which only has NE10's plain C FFTs
+#ifdef __arm__
+constexpr auto convolverForwardFFT = ne10_fft_r2c_1d_int32_neon;
+constexpr auto convolverInverseFFT = ne10_fft_c2r_1d_int32_neon;
+#else
+constexpr auto convolverForwardFFT = ne10_fft_r2c_1d_int32_c;
+constexpr auto convolverInverseFFT = ne10_fft_c2r_1d_int32_c;
+#endif
+
+// Shared by every PartitionedConvolver, since they only need them inside processBlock() - or while an ImpulseResponse
+// is being set, which the audio routine won't interrupt
+int32_t convolverTime[PartitionedConvolver::kFFTSize];
+ne10_fft_cpx_int32_t convolverSpectrum[PartitionedConvolver::kNumBins];
+int64_t convolverSumReal[PartitionedConvolver::kNumBins];
+int64_t convolverSumImag[PartitionedConvolver::kNumBins];
+
+// Each product of two spectra is shifted down by this before summing, so that even with the most partitions and the
+// loudest bins the sums can't overflow
+constexpr int32_t kProductShift = 16;
+} // namespace
+
+Error PartitionedConvolver::ImpulseResponse::set(std::span<q31_t const> taps) {
+	discard();
+
+	if (taps.empty() || taps.size() > kMaxNumTaps) {
+		return Error::UNSPECIFIED;
+	}
+
+	ne10_fft_r2c_cfg_int32_t fftConfig = FFTConfigManager::getConfig(kFFTSizeMagnitude);
+	if (!fftConfig) {
+		return Error::INSUFFICIENT_RAM;
+	}
+
+	int32_t numPartitions = (taps.size() + kBlockSize - 1) >> kBlockSizeMagnitude;
+	spectra_ = (ne10_fft_cpx_int32_t*)allocLowSpeed(numPartitions * kNumBins * sizeof(ne10_fft_cpx_int32_t));
+	if (!spectra_) {
+		return Error::INSUFFICIENT_RAM;
+	}
+	numPartitions_ = numPartitions;
+
+	// Each partition's spectrum, padded out to kFFTSize with zeros. Scaling the FFT down by kFFTSize keeps it from
+	// overflowing
+	for (int32_t p = 0; p < numPartitions_; p++) {
+		std::span<q31_t const> partition = taps.subspan(p * kBlockSize);
+		int32_t numTaps = std::min<int32_t>(partition.size(), kBlockSize);
+		memcpy(convolverTime, partition.data(), numTaps * sizeof(int32_t));
+		memset(&convolverTime[numTaps], 0, (kFFTSize - numTaps) * sizeof(int32_t));
+		convolverForwardFFT(&spectra_[p * kNumBins], convolverTime, fftConfig, true);
+	}
+
+	// Then bring them back up as far as the loudest bin allows, keeping a bit spare
+	uint32_t peak = 0;
+	for (int32_t i = 0; i < numPartitions_ * kNumBins; i++) {
+		peak = std::max({peak, (uint32_t)std::abs(spectra_[i].r), (uint32_t)std::abs(spectra_[i].i)});
+	}
+	spectrumShift_ = peak ? std::max(clz(peak) - 2, (int32_t)0) : 0;
+	for (int32_t i = 0; i < numPartitions_ * kNumBins; i++) {
+		spectra_[i].r <<= spectrumShift_;
+		spectra_[i].i <<= spectrumShift_;
+	}
+	return Error::NONE;
+}
+
+void PartitionedConvolver::ImpulseResponse::discard() {
+	if (spectra_ != nullptr) {
+		delugeDealloc(spectra_);
+		spectra_ = nullptr;
+	}
+	numPartitions_ = 0;
+	spectrumShift_ = 0;
+}
+
+Error PartitionedConvolver::setImpulseResponse(ImpulseResponse const& ir) {
+	discard();
+
+	if (!ir.isValid() || !FFTConfigManager::getConfig(kFFTSizeMagnitude)) {
+		return Error::UNSPECIFIED;
+	}
+
+	size_t historySize = ir.numPartitions_ * kNumBins * sizeof(ne10_fft_cpx_int32_t);
+	size_t inputSize = kFFTSize * sizeof(int32_t);
+	size_t outputSize = kBlockSize * sizeof(int32_t);
+
+	memory_ = allocMaxSpeed((historySize + inputSize + outputSize) * 2);
+	if (!memory_) {
+		return Error::INSUFFICIENT_RAM;
+	}
+
+	uint8_t* next = (uint8_t*)memory_;
+	for (int32_t c = 0; c < 2; c++) {
+		history_[c] = (ne10_fft_cpx_int32_t*)next;
+		next += historySize;
+		input_[c] = (int32_t*)next;
+		next += inputSize;
+		output_[c] = (int32_t*)next;
+		next += outputSize;
+	}
+	ir_ = &ir;
+	numPartitions_ = ir.numPartitions_;
+
+	clear();
+	return Error::NONE;
+}
+
+void PartitionedConvolver::discard() {
+	if (memory_ != nullptr) {
+		delugeDealloc(memory_);
+		memory_ = nullptr;
+	}
+	ir_ = nullptr;
+	for (int32_t c = 0; c < 2; c++) {
+		history_[c] = nullptr;
+		input_[c] = nullptr;
+		output_[c] = nullptr;
+	}
+	numPartitions_ = 0;
+}
+
+void PartitionedConvolver::clear() {
+	if (!isActive()) {
+		return;
+	}
+	for (int32_t c = 0; c < 2; c++) {
+		memset(history_[c], 0, numPartitions_ * kNumBins * sizeof(ne10_fft_cpx_int32_t));
+		memset(input_[c], 0, kFFTSize * sizeof(int32_t));
+		memset(output_[c], 0, kBlockSize * sizeof(int32_t));
+	}
+	newestHistory_ = 0;
+	posInBlock_ = 0;
+}
+
+void PartitionedConvolver::process(std::span<StereoSample> buffer) {
+	if (!isActive()) {
+		return;
+	}
+
+	for (StereoSample& sample : buffer) {
+		input_[0][kBlockSize + posInBlock_] = sample.l;
+		input_[1][kBlockSize + posInBlock_] = sample.r;
+		sample.l = output_[0][posInBlock_];
+		sample.r = output_[1][posInBlock_];
+
+		if (++posInBlock_ == kBlockSize) {
+			processBlock();
+			posInBlock_ = 0;
+		}
+	}
+}
+
+[[gnu::hot]] void PartitionedConvolver::processBlock() {
+	ne10_fft_r2c_cfg_int32_t fftConfig = FFTConfigManager::getConfig(kFFTSizeMagnitude);
+
+	newestHistory_ = (newestHistory_ + 1 == numPartitions_) ? 0 : newestHistory_ + 1;
+
+	// Undoes the scaling of both FFTs and of the IR spectra, and brings the sums to where an unscaled inverse FFT
+	// gives samples at the same level direct-form would
+	int32_t sumShift = ir_->spectrumShift_ + kProductShift - kFFTSizeMagnitude;
+
+	for (int32_t c = 0; c < 2; c++) {
+		// NE10 uses its input as scratch space, and we still need this block for the next one
+		memcpy(convolverTime, input_[c], kFFTSize * sizeof(int32_t));
+		convolverForwardFFT(&history_[c][newestHistory_ * kNumBins], convolverTime, fftConfig, true);
+
+		memset(convolverSumReal, 0, sizeof(convolverSumReal));
+		memset(convolverSumImag, 0, sizeof(convolverSumImag));
+
+		// Partition p of the IR meets the input from p blocks ago
+		int32_t h = newestHistory_;
+		for (int32_t p = 0; p < numPartitions_; p++) {
+			ne10_fft_cpx_int32_t const* __restrict__ x = &history_[c][h * kNumBins];
+			ne10_fft_cpx_int32_t const* __restrict__ ir = &ir_->spectra_[p * kNumBins];
+			for (int32_t k = 0; k < kNumBins; k++) {
+				convolverSumReal[k] += ((int64_t)x[k].r * ir[k].r - (int64_t)x[k].i * ir[k].i) >> kProductShift;
+				convolverSumImag[k] += ((int64_t)x[k].r * ir[k].i + (int64_t)x[k].i * ir[k].r) >> kProductShift;
+			}
+			h = (h == 0) ? numPartitions_ - 1 : h - 1;
+		}
+
+		for (int32_t k = 0; k < kNumBins; k++) {
+			convolverSpectrum[k].r = std::clamp<int64_t>(convolverSumReal[k] >> sumShift, INT32_MIN, INT32_MAX);
+			convolverSpectrum[k].i = std::clamp<int64_t>(convolverSumImag[k] >> sumShift, INT32_MIN, INT32_MAX);
+		}
+
+		// Overlap-save: only the second half has no wraparound from the circular convolution
+		convolverInverseFFT(convolverTime, convolverSpectrum, fftConfig, false);
+		memcpy(output_[c], &convolverTime[kBlockSize], kBlockSize * sizeof(int32_t));
+
+		// This block becomes the previous one
+		memcpy(input_[c], &input_[c][kBlockSize], kBlockSize * sizeof(int32_t));
+	}
+}
+} // namespace deluge::dsp
@@ -0,0 +1,115 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "NE10.h"
+#include "definitions_cxx.hpp"
+#include "dsp/stereo_sample.h"
+#include "util/fixedpoint.h"
+#include <cstdint>
+#include <span>
+
+namespace deluge::dsp {
+
+/**
+ * Stereo convolution with an impulse response of any length, for things like cab sims and room IRs which are far too
+ * long for a direct-form FIR like ImpulseResponseProcessor.
+ *
+ * Uniformly partitioned overlap-save: the IR is cut into kBlockSize-tap partitions, each kept as the spectrum of a
+ * 2 * kBlockSize FFT. Once per block, the input's spectrum is pushed into a history of the last numPartitions blocks,
+ * each of those is multiplied by its partition's spectrum and the sum goes back through an inverse FFT. Per sample,
+ * that's two FFTs' worth of log(kBlockSize) work plus one complex multiply per partition per bin - against one
+ * multiply per tap for direct form.
+ *
+ * Output lags input by kBlockSize samples. The two channels share the IR.
+ *
+ * The partitions' spectra are an ImpulseResponse of their own, worked out once and shared read-only by every convolver
+ * using that IR. Each convolver just has its own history and input and output blocks.
+ */
+class PartitionedConvolver {
+public:
+	constexpr static int32_t kBlockSizeMagnitude = 7;
+	constexpr static int32_t kBlockSize = 1 << kBlockSizeMagnitude;
+	constexpr static int32_t kFFTSizeMagnitude = kBlockSizeMagnitude + 1;
+	constexpr static int32_t kFFTSize = 1 << kFFTSizeMagnitude;
+	constexpr static int32_t kNumBins = (kFFTSize >> 1) + 1;
+	constexpr static int32_t kMaxNumPartitions = 128;
+	constexpr static int32_t kMaxNumTaps = kMaxNumPartitions * kBlockSize;
+
+	/// An IR's partitions, as spectra. Setting one up takes an FFT per partition, so isn't for the audio routine
+	class ImpulseResponse {
+	public:
+		ImpulseResponse() = default;
+		~ImpulseResponse() { discard(); }
+		ImpulseResponse(const ImpulseResponse&) = delete;
+		ImpulseResponse& operator=(const ImpulseResponse&) = delete;
+
+		/// Takes the IR's spectrum, so the taps needn't be kept afterwards. Taps are scaled as for
+		/// ImpulseResponseProcessor - each is applied with multiply_32x32_rshift32_rounded(), so a unity-gain IR's taps
+		/// add up to 2^32. Any convolvers using the old one must be discarded or given another first
+		Error set(std::span<q31_t const> taps);
+		void discard();
+
+		[[nodiscard]] constexpr bool isValid() const { return (spectra_ != nullptr); }
+		[[nodiscard]] constexpr int32_t getNumPartitions() const { return numPartitions_; }
+
+	private:
+		friend class PartitionedConvolver;
+
+		ne10_fft_cpx_int32_t* spectra_ = nullptr; // [numPartitions_][kNumBins], in SDRAM
+		int32_t numPartitions_ = 0;
+
+		// How far the spectra were shifted up to use their full range, undone when the products are summed
+		int32_t spectrumShift_ = 0;
+	};
+
+	PartitionedConvolver() = default;
+	~PartitionedConvolver() { discard(); }
+	PartitionedConvolver(const PartitionedConvolver&) = delete;
+	PartitionedConvolver& operator=(const PartitionedConvolver&) = delete;
+
+	/// Convolve with ir from now on, which must stay set until this is discarded or given another. Just allocates this
+	/// convolver's own buffers - no FFTs - so it's fine from the audio routine. Clears any audio history
+	Error setImpulseResponse(ImpulseResponse const& ir);
+	void discard();
+
+	[[nodiscard]] constexpr bool isActive() const { return (memory_ != nullptr); }
+	[[nodiscard]] constexpr int32_t getNumPartitions() const { return numPartitions_; }
+
+	/// Forget all audio so far, as if it had been silent
+	void clear();
+
+	/// Convolve in place
+	void process(std::span<StereoSample> buffer);
+
+private:
+	void processBlock();
+
+	ImpulseResponse const* ir_ = nullptr;
+
+	// All of these live in the one allocation, memory_
+	ne10_fft_cpx_int32_t* history_[2] = {}; // [numPartitions_][kNumBins] per channel, a ring of input spectra
+	int32_t* input_[2] = {};                // [kFFTSize] per channel, the previous block then the current one
+	int32_t* output_[2] = {};               // [kBlockSize] per channel
+	void* memory_ = nullptr;
+
+	int32_t numPartitions_ = 0;
+	int32_t newestHistory_ = 0;
+	int32_t posInBlock_ = 0;
+};
+} // namespace deluge::dsp
@@ -196,6 +196,7 @@ void Delay::hasWrapped() {
 void Delay::discardBuffers() {
 	primaryBuffer.discard();
 	secondaryBuffer.discard();
+	ir_processor.discard();
 	prevFeedback = 0;
 	repeatsUntilAbandon = 0;
 }
@@ -327,9 +328,7 @@ void Delay::process(std::span<StereoSample> buffer, const State& delayWorkingSta
 
 	if (analog) {
 
-		for (StereoSample& sample : working_buffer) {
-			ir_processor.process(sample, sample);
-		}
+		ir_processor.process(working_buffer);
 
 		for (StereoSample& sample : working_buffer) {
 			// impulseResponseProcessor.process(sample, sample);
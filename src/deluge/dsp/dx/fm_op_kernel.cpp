@@ -18,7 +18,9 @@
 
 #include <cstdlib>
 
+#ifdef __arm__
 #define HAVE_NEON
+#endif
 #ifdef HAVE_NEON
 // #include <cpu-features.h>
 #endif
@@ -39,12 +41,13 @@ void FmOpKernel::compute(int32_t* output, int n, const int32_t* input, int32_t p
                          int32_t gain2, int32_t dgain, bool add, bool neon) {
 	int32_t gain = gain1;
 	int32_t phase = phase0;
-	if (neon) {
 #ifdef HAVE_NEON
+	if (neon) {
 		neon_fm_kernel(input, add ? output : zeros, output, n, phase0, freq, gain, dgain);
-#endif
 	}
-	else {
+	else
+#endif
+	{
 		if (add) {
 			for (int i = 0; i < n; i++) {
 				gain += dgain;
@@ -70,12 +73,13 @@ void FmOpKernel::compute_pure(int32_t* output, int n, int32_t phase0, int32_t fr
                               int32_t dgain, bool add, bool neon) {
 	int32_t gain = gain1;
 	int32_t phase = phase0;
-	if (neon) {
 #ifdef HAVE_NEON
+	if (neon) {
 		neon_fm_kernel(zeros, add ? output : zeros, output, n, phase0, freq, gain, dgain);
-#endif
 	}
-	else {
+	else
+#endif
+	{
 		if (add) {
 			for (int i = 0; i < n; i++) {
 				gain += dgain;
@@ -59,6 +59,7 @@ public:
 	inline bool isOn() { return HPFOn || LPFOn; }
 
 private:
+	friend class QuadFilter;
 	FilterMode lpfMode_;
 	FilterMode lastLPFMode_;
 	FilterMode hpfMode_;
@@ -36,6 +36,7 @@ public:
 	}
 
 private:
+	friend class QuadFilter;
 	struct LpLadderState {
 		q31_t noiseLastValue;
 		BasicFilterComponent lpfLPF1;
@@ -0,0 +1,354 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "dsp/filter/quad_filter.h"
+#include "arm_neon_shim.h"
+#include "util/functions.h"
+#include "util/lookuptables/lookuptables.h"
+
+namespace deluge::dsp::filter {
+
+namespace {
+
+constexpr int32_t kNumLanes = QuadFilter::kNumLanes;
+
+// vqdmulh gives (a * b) >> 31, from which both of these come out bit-exact. The one exception is -1 * -1, which
+// vqdmulh saturates
+
+/// multiply_32x32_rshift32() in each lane
+[[gnu::always_inline]] inline int32x4_t multiply32(int32x4_t a, int32x4_t b) {
+	return vshrq_n_s32(vqdmulhq_s32(a, b), 1);
+}
+
+/// 2 * multiply_32x32_rshift32() in each lane
+[[gnu::always_inline]] inline int32x4_t multiply32Doubled(int32x4_t a, int32x4_t b) {
+	return vandq_s32(vqdmulhq_s32(a, b), vdupq_n_s32(~1));
+}
+
+/// multiply_32x32_rshift32_rounded() in each lane
+[[gnu::always_inline]] inline int32x4_t multiplyRounded(int32x4_t a, int32x4_t b) {
+	return vrshrq_n_s32(vqdmulhq_s32(a, b), 1);
+}
+
+/// table[index] for each lane. There's no gather instruction, so this is four scalar loads
+[[gnu::always_inline]] inline int32x4_t lookUp(int16_t const* table, uint32x4_t index) {
+	int32x4_t result = vdupq_n_s32(table[vgetq_lane_u32(index, 0)]);
+	result = vsetq_lane_s32(table[vgetq_lane_u32(index, 1)], result, 1);
+	result = vsetq_lane_s32(table[vgetq_lane_u32(index, 2)], result, 2);
+	result = vsetq_lane_s32(table[vgetq_lane_u32(index, 3)], result, 3);
+	return result;
+}
+
+/// getTanHUnknown() in each lane, giving the same results
+template <int32_t saturationAmount>
+[[gnu::always_inline]] inline int32x4_t getTanHLanes(int32x4_t input) {
+	// lshiftAndSaturate() saturates to the bits which will survive the shift, so clear the ones vqshl saturates into
+	int32x4_t saturated = vbicq_s32(vqshlq_n_s32(input, saturationAmount), vdupq_n_s32((1 << saturationAmount) - 1));
+	uint32x4_t workingValue = vaddq_u32(vreinterpretq_u32_s32(saturated), vdupq_n_u32(2147483648u));
+
+	// interpolateTableSigned(), with table[i] * (65536 - strength2) + table[i + 1] * strength2 rearranged
+	uint32x4_t whichValue = vshrq_n_u32(workingValue, 24);
+	int32x4_t strength2 = vreinterpretq_s32_u32(vandq_u32(vshrq_n_u32(workingValue, 8), vdupq_n_u32(65535)));
+	int32x4_t value1 = lookUp(tanHSmall, whichValue);
+	int32x4_t value2 = lookUp(tanHSmall + 1, whichValue);
+	int32x4_t interpolated = vmlaq_s32(vshlq_n_s32(value1, 16), vsubq_s32(value2, value1), strength2);
+
+	return vshrq_n_s32(interpolated, saturationAmount + 2);
+}
+
+/// Turns four vectors of four consecutive samples from one Voice each into four vectors of one sample from every
+/// Voice - or back again
+[[gnu::always_inline]] inline void transpose(int32x4_t (&rows)[kNumLanes]) {
+	int32x4x2_t rows01 = vtrnq_s32(rows[0], rows[1]);
+	int32x4x2_t rows23 = vtrnq_s32(rows[2], rows[3]);
+	rows[0] = vcombine_s32(vget_low_s32(rows01.val[0]), vget_low_s32(rows23.val[0]));
+	rows[1] = vcombine_s32(vget_low_s32(rows01.val[1]), vget_low_s32(rows23.val[1]));
+	rows[2] = vcombine_s32(vget_high_s32(rows01.val[0]), vget_high_s32(rows23.val[0]));
+	rows[3] = vcombine_s32(vget_high_s32(rows01.val[1]), vget_high_s32(rows23.val[1]));
+}
+
+/// One member of each lane's filter, as a vector
+template <typename F, typename Member>
+int32x4_t gather(std::array<F*, kNumLanes> const& filters, Member member) {
+	int32_t values[kNumLanes];
+	for (int32_t l = 0; l < kNumLanes; l++) {
+		values[l] = member(*filters[l]);
+	}
+	return vld1q_s32(values);
+}
+
+/// Writes each lane of a vector back to a member of that lane's filter
+template <typename F, typename Member>
+void scatter(int32x4_t vector, std::array<F*, kNumLanes> const& filters, Member member) {
+	int32_t values[kNumLanes];
+	vst1q_s32(values, vector);
+	for (int32_t l = 0; l < kNumLanes; l++) {
+		member(*filters[l]) = values[l];
+	}
+}
+
+/// Runs lanes.doSample() over every sample of the buffers
+template <typename Lanes>
+[[gnu::hot]] void renderLanes(Lanes& lanes, std::array<q31_t*, kNumLanes> const& buffers, int32_t numSamples) {
+	int32_t i = 0;
+	for (; i + kNumLanes <= numSamples; i += kNumLanes) {
+		int32x4_t samples[kNumLanes];
+		for (int32_t l = 0; l < kNumLanes; l++) {
+			samples[l] = vld1q_s32(buffers[l] + i);
+		}
+		transpose(samples);
+		for (int32x4_t& sample : samples) {
+			sample = lanes.doSample(sample);
+		}
+		transpose(samples);
+		for (int32_t l = 0; l < kNumLanes; l++) {
+			vst1q_s32(buffers[l] + i, samples[l]);
+		}
+	}
+
+	// Any samples left over when numSamples isn't a multiple of 4
+	for (; i < numSamples; i++) {
+		int32_t values[kNumLanes];
+		for (int32_t l = 0; l < kNumLanes; l++) {
+			values[l] = buffers[l][i];
+		}
+		vst1q_s32(values, lanes.doSample(vld1q_s32(values)));
+		for (int32_t l = 0; l < kNumLanes; l++) {
+			buffers[l][i] = values[l];
+		}
+	}
+}
+} // namespace
+
+/// SVFilter::doSVF() across the lanes
+struct QuadFilter::SVFLanes {
+	std::array<SVFilter*, kNumLanes> filters;
+
+	int32x4_t low;
+	int32x4_t band;
+
+	int32x4_t fc;
+	int32x4_t q;
+	int32x4_t in;
+	int32x4_t cLow;
+	int32x4_t cBand;
+	int32x4_t cHigh;
+	bool bandMode;
+
+	SVFLanes(std::array<SVFilter*, kNumLanes> const& filters_) : filters(filters_) {
+		low = gather(filters, [](SVFilter& f) -> auto& { return f.l.low; });
+		band = gather(filters, [](SVFilter& f) -> auto& { return f.l.band; });
+		fc = gather(filters, [](SVFilter& f) -> auto& { return f.fc; });
+		q = gather(filters, [](SVFilter& f) -> auto& { return f.q; });
+		in = gather(filters, [](SVFilter& f) -> auto& { return f.in; });
+		cLow = gather(filters, [](SVFilter& f) -> auto& { return f.c_low; });
+		cBand = gather(filters, [](SVFilter& f) -> auto& { return f.c_band; });
+		cHigh = gather(filters, [](SVFilter& f) -> auto& { return f.c_high; });
+		bandMode = filters[0]->band_mode;
+	}
+
+	void writeBack() {
+		scatter(low, filters, [](SVFilter& f) -> auto& { return f.l.low; });
+		scatter(band, filters, [](SVFilter& f) -> auto& { return f.l.band; });
+	}
+
+	[[gnu::always_inline]] inline int32x4_t doSample(int32x4_t input) {
+		input = multiply32(in, input);
+
+		int32x4_t lowI = vaddq_s32(low, multiply32Doubled(band, fc));
+		int32x4_t highI = vsubq_s32(vsubq_s32(input, lowI), multiply32Doubled(band, q));
+		int32x4_t bandI = getTanHLanes<3>(vaddq_s32(multiply32Doubled(highI, fc), band));
+
+		// double sample to increase the cutoff frequency
+		low = vaddq_s32(lowI, multiply32Doubled(bandI, fc));
+		int32x4_t high = vsubq_s32(vsubq_s32(input, low), multiply32Doubled(bandI, q));
+		band = vaddq_s32(multiply32Doubled(high, fc), bandI);
+
+		int32x4_t result = multiplyRounded(vaddq_s32(lowI, low), cLow);
+		result = vaddq_s32(result, multiplyRounded(vaddq_s32(highI, high), cHigh));
+		if (bandMode) {
+			result = vaddq_s32(result, multiplyRounded(vaddq_s32(bandI, band), cBand));
+		}
+
+		band = getTanHLanes<3>(band);
+		return vmulq_n_s32(result, 3);
+	}
+};
+
+/// LpLadderFilter::do24dBLPFOnSample() across the lanes
+struct QuadFilter::LadderLanes {
+	std::array<LpLadderFilter*, kNumLanes> filters;
+
+	int32x4_t noiseLastValue;
+	int32x4_t memory[4];
+
+	int32x4_t moveability;
+	int32x4_t feedback[4];
+	int32x4_t processedResonance;
+	int32x4_t divideByTotalMoveabilityAndProcessedResonance;
+	int32x4_t morph;
+	// Lanes where scaleInput() saturates
+	uint32x4_t saturating;
+	bool anySaturating;
+
+	LadderLanes(std::array<LpLadderFilter*, kNumLanes> const& filters_) : filters(filters_) {
+		noiseLastValue = gather(filters, [](LpLadderFilter& f) -> auto& { return f.l.noiseLastValue; });
+		memory[0] = gather(filters, [](LpLadderFilter& f) -> auto& { return f.l.lpfLPF1.memory; });
+		memory[1] = gather(filters, [](LpLadderFilter& f) -> auto& { return f.l.lpfLPF2.memory; });
+		memory[2] = gather(filters, [](LpLadderFilter& f) -> auto& { return f.l.lpfLPF3.memory; });
+		memory[3] = gather(filters, [](LpLadderFilter& f) -> auto& { return f.l.lpfLPF4.memory; });
+
+		moveability = gather(filters, [](LpLadderFilter& f) -> auto& { return f.moveability; });
+		feedback[0] = gather(filters, [](LpLadderFilter& f) -> auto& { return f.lpf1Feedback; });
+		feedback[1] = gather(filters, [](LpLadderFilter& f) -> auto& { return f.lpf2Feedback; });
+		feedback[2] = gather(filters, [](LpLadderFilter& f) -> auto& { return f.lpf3Feedback; });
+		feedback[3] = gather(filters, [](LpLadderFilter& f) -> auto& { return f.divideBy1PlusTannedFrequency; });
+		processedResonance = gather(filters, [](LpLadderFilter& f) -> auto& { return f.processedResonance; });
+		divideByTotalMoveabilityAndProcessedResonance = gather(
+		    filters, [](LpLadderFilter& f) -> auto& { return f.divideByTotalMoveabilityAndProcessedResonance; });
+		morph = gather(filters, [](LpLadderFilter& f) -> auto& { return f.morph; });
+
+		saturating = vorrq_u32(vcgtq_s32(morph, vdupq_n_s32(0)),
+		                       vcgtq_s32(processedResonance, vdupq_n_s32(510000000)));
+		anySaturating = false;
+		for (int32_t l = 0; l < kNumLanes; l++) {
+			anySaturating |= (filters[l]->morph > 0 || filters[l]->processedResonance > 510000000);
+		}
+	}
+
+	void writeBack() {
+		scatter(noiseLastValue, filters, [](LpLadderFilter& f) -> auto& { return f.l.noiseLastValue; });
+		scatter(memory[0], filters, [](LpLadderFilter& f) -> auto& { return f.l.lpfLPF1.memory; });
+		scatter(memory[1], filters, [](LpLadderFilter& f) -> auto& { return f.l.lpfLPF2.memory; });
+		scatter(memory[2], filters, [](LpLadderFilter& f) -> auto& { return f.l.lpfLPF3.memory; });
+		scatter(memory[3], filters, [](LpLadderFilter& f) -> auto& { return f.l.lpfLPF4.memory; });
+	}
+
+	/// BasicFilterComponent::doFilter() across the lanes
+	[[gnu::always_inline]] static inline int32x4_t doFilterComponent(int32x4_t input, int32x4_t& memory,
+	                                                                 int32x4_t moveability) {
+		int32x4_t a = vshlq_n_s32(multiplyRounded(vsubq_s32(input, memory), moveability), 1);
+		int32x4_t b = vaddq_s32(a, memory);
+		memory = vaddq_s32(b, a);
+		return b;
+	}
+
+	[[gnu::always_inline]] inline int32x4_t doSample(int32x4_t input) {
+		// For drive filter, apply some heavily lowpassed noise to the filter frequency, to add analog-ness
+		int32x4_t noise = vdupq_n_s32(getNoise() >> 2);
+		noise = vsetq_lane_s32(getNoise() >> 2, noise, 1);
+		noise = vsetq_lane_s32(getNoise() >> 2, noise, 2);
+		noise = vsetq_lane_s32(getNoise() >> 2, noise, 3);
+		noiseLastValue = vaddq_s32(noiseLastValue, vshrq_n_s32(vsubq_s32(noise, noiseLastValue), 7));
+		int32x4_t noisyM = vaddq_s32(moveability, multiply32(moveability, noiseLastValue));
+
+		int32x4_t feedbacksSum = multiplyRounded(memory[0], feedback[0]);
+		for (int32_t f = 1; f < 4; f++) {
+			feedbacksSum = vaddq_s32(feedbacksSum, multiplyRounded(memory[f], feedback[f]));
+		}
+		feedbacksSum = vshlq_n_s32(feedbacksSum, 2);
+
+		// LpLadderFilter::scaleInput()
+		int32x4_t x = vsubq_s32(input, vshlq_n_s32(multiplyRounded(feedbacksSum, processedResonance), 3));
+		x = vshlq_n_s32(multiplyRounded(x, divideByTotalMoveabilityAndProcessedResonance), 2);
+		if (anySaturating) {
+			int32x4_t extra = multiply32Doubled(input, morph);
+			x = vbslq_s32(saturating, getTanHLanes<2>(vaddq_s32(x, extra)), x);
+		}
+
+		for (int32x4_t& m : memory) {
+			x = doFilterComponent(x, m, noisyM);
+		}
+		return vshlq_n_s32(x, 1);
+	}
+};
+
+bool QuadFilter::supports(FilterMode lpfMode, FilterMode hpfMode, FilterRoute routing) {
+	bool lpfSupported = lpfMode == FilterMode::OFF || lpfMode == FilterMode::TRANSISTOR_24DB
+	                    || lpfMode == FilterMode::SVF_BAND || lpfMode == FilterMode::SVF_NOTCH;
+	bool hpfSupported =
+	    hpfMode == FilterMode::OFF || hpfMode == FilterMode::SVF_BAND || hpfMode == FilterMode::SVF_NOTCH;
+	bool anyOn = lpfMode != FilterMode::OFF || hpfMode != FilterMode::OFF;
+	return anyOn && lpfSupported && hpfSupported && routing != FilterRoute::PARALLEL;
+}
+
+bool QuadFilter::canRender(FilterSet const& filterSet) {
+	// Filter::filterMono() blends in the dry signal while this is fading - and that's rare enough to leave to it
+	if (filterSet.LPFOn) {
+		float dryFade = (filterSet.lpfMode_ == FilterMode::TRANSISTOR_24DB) ? filterSet.lpfilter.ladder.dryFade
+		                                                                     : filterSet.lpfilter.svf.dryFade;
+		if (dryFade >= 0.001) {
+			return false;
+		}
+	}
+	if (filterSet.HPFOn && filterSet.hpfilter.svf.dryFade >= 0.001) {
+		return false;
+	}
+	return true;
+}
+
+void QuadFilter::renderLong(std::array<FilterSet*, kNumLanes> const& filterSets,
+                            std::array<q31_t*, kNumLanes> const& buffers, int32_t numSamples) {
+	if (filterSets[0]->routing_ == FilterRoute::HIGH_TO_LOW) {
+		renderHPF(filterSets, buffers, numSamples);
+		renderLPF(filterSets, buffers, numSamples);
+	}
+	else {
+		renderLPF(filterSets, buffers, numSamples);
+		renderHPF(filterSets, buffers, numSamples);
+	}
+}
+
+void QuadFilter::renderLPF(std::array<FilterSet*, kNumLanes> const& filterSets,
+                           std::array<q31_t*, kNumLanes> const& buffers, int32_t numSamples) {
+	if (!filterSets[0]->LPFOn) {
+		return;
+	}
+	if (filterSets[0]->lpfMode_ == FilterMode::TRANSISTOR_24DB) {
+		std::array<LpLadderFilter*, kNumLanes> ladders;
+		for (int32_t l = 0; l < kNumLanes; l++) {
+			ladders[l] = &filterSets[l]->lpfilter.ladder;
+		}
+		LadderLanes lanes{ladders};
+		renderLanes(lanes, buffers, numSamples);
+		lanes.writeBack();
+	}
+	else {
+		std::array<SVFilter*, kNumLanes> svfs;
+		for (int32_t l = 0; l < kNumLanes; l++) {
+			svfs[l] = &filterSets[l]->lpfilter.svf;
+		}
+		SVFLanes lanes{svfs};
+		renderLanes(lanes, buffers, numSamples);
+		lanes.writeBack();
+	}
+}
+
+void QuadFilter::renderHPF(std::array<FilterSet*, kNumLanes> const& filterSets,
+                           std::array<q31_t*, kNumLanes> const& buffers, int32_t numSamples) {
+	if (!filterSets[0]->HPFOn) {
+		return;
+	}
+	std::array<SVFilter*, kNumLanes> svfs;
+	for (int32_t l = 0; l < kNumLanes; l++) {
+		svfs[l] = &filterSets[l]->hpfilter.svf;
+	}
+	SVFLanes lanes{svfs};
+	renderLanes(lanes, buffers, numSamples);
+	lanes.writeBack();
+}
+} // namespace deluge::dsp::filter
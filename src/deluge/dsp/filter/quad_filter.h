@@ -0,0 +1,62 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "dsp/filter/filter_set.h"
+#include "model/mod_controllable/filters/filter_config.h"
+#include "util/fixedpoint.h"
+#include <array>
+#include <cstdint>
+
+namespace deluge::dsp::filter {
+
+/**
+ * Runs the filters of four Voices side by side, one Voice per NEON lane. Each lane has its own coefficients and
+ * state, which are read from that Voice's FilterSet and written back to it afterwards - so a Voice can go through
+ * here for one render window and FilterSet::renderLong() for the next without any discontinuity.
+ *
+ * Only the SVFs and the 24dB ladder are done here, and only for mono Voices. The SVFs give exactly the same output as
+ * FilterSet. The ladder uses the same noise generator, but the four Voices take turns drawing from it sample by sample
+ * rather than a window at a time, so its analog-ness noise differs.
+ */
+class QuadFilter {
+public:
+	static constexpr int32_t kNumLanes = 4;
+
+	/// Whether Voices set up with these modes and routing can be filtered here. Pass FilterMode::OFF for a filter
+	/// that isn't in use
+	static bool supports(FilterMode lpfMode, FilterMode hpfMode, FilterRoute routing);
+
+	/// Whether this FilterSet can be filtered here this render window - not while it's still fading in after a reset
+	static bool canRender(FilterSet const& filterSet);
+
+	/// Filter numSamples mono samples in place in each buffer, with the FilterSet of the same index. The FilterSets
+	/// must have been configured alike, with a setup supports() accepts, and each must pass canRender()
+	static void renderLong(std::array<FilterSet*, kNumLanes> const& filterSets,
+	                       std::array<q31_t*, kNumLanes> const& buffers, int32_t numSamples);
+
+private:
+	struct SVFLanes;
+	struct LadderLanes;
+
+	static void renderLPF(std::array<FilterSet*, kNumLanes> const& filterSets,
+	                      std::array<q31_t*, kNumLanes> const& buffers, int32_t numSamples);
+	static void renderHPF(std::array<FilterSet*, kNumLanes> const& filterSets,
+	                      std::array<q31_t*, kNumLanes> const& buffers, int32_t numSamples);
+};
+} // namespace deluge::dsp::filter
@@ -35,6 +35,7 @@ public:
 	}
 
 private:
+	friend class QuadFilter;
 	struct SVFState {
 		q31_t low;
 		q31_t band;
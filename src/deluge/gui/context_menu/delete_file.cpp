@@ -21,6 +21,7 @@
 #include "gui/l10n/l10n.h"
 #include "gui/ui/browser/browser.h"
 #include "hid/display/display.h"
+#include "storage/snapshot_file.h"
 
 extern "C" {
 #include "fatfs/ff.h"
@@ -81,6 +82,7 @@ bool DeleteFile::acceptCurrentOption() {
 		// But we'll still go back to the Browser
 	}
 	else {
+		SnapshotFile::deleteFor(filePath.get()); // In case it was a song or preset
 		display->displayPopup(l10n::get(STRING_FOR_FILE_DELETED));
 		browser->currentFileDeleted();
 	}
@@ -435,6 +435,12 @@ PLACE_SDRAM_DATA Language english{
         {STRING_FOR_COMMUNITY_FEATURE_LIGHT_SHIFT, "Light Shift"},
         {STRING_FOR_COMMUNITY_FEATURE_EMULATED_DISPLAY, "Emulated Display"},
         {STRING_FOR_COMMUNITY_FEATURE_DX_SHORTCUTS, "Enable DX shortcuts"},
+        {STRING_FOR_COMMUNITY_FEATURE_WAVEFORM_PEAK_FILES, "Waveform Peak Files"},
+        {STRING_FOR_COMMUNITY_FEATURE_SAMPLE_CACHE_FILES, "Sample Cache Files"},
+        {STRING_FOR_COMMUNITY_FEATURE_PERCUSSIVENESS_FILES, "Percussiveness Files"},
+        {STRING_FOR_COMMUNITY_FEATURE_RESAMPLE_ON_LOAD, "Resample On Load"},
+        {STRING_FOR_COMMUNITY_FEATURE_LOAD_SNAPSHOTS, "Load Snapshots"},
+        {STRING_FOR_COMMUNITY_FEATURE_DELAY_IMPULSE_RESPONSE, "Delay IR File"},
         {STRING_FOR_TRACK_STILL_HAS_CLIPS_IN_SESSION, "Track still has clips in session"},
         {STRING_FOR_DELETE_ALL_TRACKS_CLIPS_FIRST, "Delete all track's clips first"},
         {STRING_FOR_CANT_DELETE_FINAL_CLIP, "Can't delete final Clip"},
@@ -356,6 +356,12 @@ PLACE_SDRAM_DATA Language seven_segment{
         {STRING_FOR_COMMUNITY_FEATURE_LIGHT_SHIFT, "LGSH"},
         {STRING_FOR_COMMUNITY_FEATURE_EMULATED_DISPLAY, "EMUL"},
         {STRING_FOR_COMMUNITY_FEATURE_DX_SHORTCUTS, "DX7S"},
+        {STRING_FOR_COMMUNITY_FEATURE_WAVEFORM_PEAK_FILES, "PEAK"},
+        {STRING_FOR_COMMUNITY_FEATURE_SAMPLE_CACHE_FILES, "CACH"},
+        {STRING_FOR_COMMUNITY_FEATURE_PERCUSSIVENESS_FILES, "PERC"},
+        {STRING_FOR_COMMUNITY_FEATURE_RESAMPLE_ON_LOAD, "RSMP"},
+        {STRING_FOR_COMMUNITY_FEATURE_LOAD_SNAPSHOTS, "SNAP"},
+        {STRING_FOR_COMMUNITY_FEATURE_DELAY_IMPULSE_RESPONSE, "DLIR"},
         {STRING_FOR_TRACK_STILL_HAS_CLIPS_IN_SESSION, "CANT"},
         {STRING_FOR_DELETE_ALL_TRACKS_CLIPS_FIRST, "CANT"},
         {STRING_FOR_CANT_DELETE_FINAL_CLIP, "CANT"},
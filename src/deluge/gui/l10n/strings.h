@@ -459,6 +459,12 @@ enum class String : size_t {
 	STRING_FOR_COMMUNITY_FEATURE_LIGHT_SHIFT,
 	STRING_FOR_COMMUNITY_FEATURE_EMULATED_DISPLAY,
 	STRING_FOR_COMMUNITY_FEATURE_DX_SHORTCUTS,
+	STRING_FOR_COMMUNITY_FEATURE_WAVEFORM_PEAK_FILES,
+	STRING_FOR_COMMUNITY_FEATURE_SAMPLE_CACHE_FILES,
+	STRING_FOR_COMMUNITY_FEATURE_PERCUSSIVENESS_FILES,
+	STRING_FOR_COMMUNITY_FEATURE_RESAMPLE_ON_LOAD,
+	STRING_FOR_COMMUNITY_FEATURE_LOAD_SNAPSHOTS,
+	STRING_FOR_COMMUNITY_FEATURE_DELAY_IMPULSE_RESPONSE,
 
 	STRING_FOR_TRACK_STILL_HAS_CLIPS_IN_SESSION,
 	STRING_FOR_DELETE_ALL_TRACKS_CLIPS_FIRST,
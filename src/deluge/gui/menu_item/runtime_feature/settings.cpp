@@ -16,6 +16,7 @@
  */
 
 #include "settings.h"
+#include "delay_impulse_response.h"
 #include "devSysexSetting.h"
 #include "emulated_display.h"
 #include "setting.h"
@@ -43,6 +44,12 @@ ShiftIsSticky menuShiftIsSticky{};
 Setting menuLightShiftLed(RuntimeFeatureSettingType::LightShiftLed);
 Setting menuEnableGrainFX(RuntimeFeatureSettingType::EnableGrainFX);
 Setting menuEnableDxShortcuts(RuntimeFeatureSettingType::EnableDxShortcuts);
+Setting menuWaveformPeakFiles(RuntimeFeatureSettingType::WaveformPeakFiles);
+Setting menuSampleCacheFiles(RuntimeFeatureSettingType::SampleCacheFiles);
+Setting menuPercussivenessFiles(RuntimeFeatureSettingType::PercussivenessFiles);
+Setting menuResampleOnLoad(RuntimeFeatureSettingType::ResampleOnLoad);
+Setting menuLoadSnapshots(RuntimeFeatureSettingType::LoadSnapshots);
+DelayImpulseResponse menuDelayImpulseResponse{};
 EmulatedDisplay menuEmulatedDisplay{};
 
 std::array<MenuItem*, RuntimeFeatureSettingType::MaxElement - kNonTopLevelSettings> subMenuEntries{
@@ -62,6 +69,12 @@ std::array<MenuItem*, RuntimeFeatureSettingType::MaxElement - kNonTopLevelSettin
     &menuLightShiftLed,
     &menuEnableGrainFX,
     &menuEnableDxShortcuts,
+    &menuWaveformPeakFiles,
+    &menuSampleCacheFiles,
+    &menuPercussivenessFiles,
+    &menuResampleOnLoad,
+    &menuLoadSnapshots,
+    &menuDelayImpulseResponse,
     &menuEmulatedDisplay};
 
 Settings::Settings(l10n::String name, l10n::String title) : menu_item::Submenu(name, title, subMenuEntries) {
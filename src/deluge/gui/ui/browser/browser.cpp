@@ -297,7 +297,9 @@ Error Browser::readFileItemsForFolder(char const* filePrefixHere, bool allowFold
 	while (true) {
 		AudioEngine::logAction("while loop");
 
-		audioFileManager.loadAnyEnqueuedClusters();
+		if (AudioEngine::yieldIsDue()) {
+			AudioEngine::routineWithClusterLoading();
+		}
 		FilePointer thisFilePointer;
 
 		result = f_readdir_get_filepointer(&staticDIR, &staticFNO, &thisFilePointer); /* Read a directory item */
@@ -32,8 +32,9 @@ public:
 	               KeyboardLayout* layout) override;
 
 private:
-	int32_t currentScalePad = currentSong->getCurrentPresetScale();
-	int32_t previousScalePad = currentSong->getCurrentPresetScale();
+	// Not currentSong->getCurrentPresetScale() - these are made during static initialization, before there's a Song
+	int32_t currentScalePad = 0;
+	int32_t previousScalePad = 0;
 	uint8_t scaleModes[8] = {0, 1, 2, 3, 4, 5, 6, 7};
 };
 
@@ -264,7 +264,14 @@ void LoadSongUI::performLoadFixedSM() {
 			playbackHandler.switchToSession();
 		}
 
-		Error error = bdsm->openXMLFile(&currentFileItem->filePointer, smDeserializer, "song");
+		// A snapshot's only used if it's for this exact path, so if there's trouble getting that, just do without
+		String filePath;
+		if (getCurrentFilePath(&filePath) != Error::NONE) {
+			filePath.clear();
+		}
+
+		Deserializer* reader;
+		Error error = bdsm->openSongOrPresetFile(&currentFileItem->filePointer, filePath.get(), &reader, "song");
 		if (error != Error::NONE) {
 			display->displayError(error);
 			return;
@@ -337,7 +344,7 @@ gotErrorAfterCreatingSong:
 
 		// Will return false if we ran out of RAM. This isn't currently detected for while loading ParamNodes, but
 		// chances are, after failing on one of those, it'd try to load something else and that would fail.
-		error = preLoadedSong->readFromFile(smDeserializer);
+		error = preLoadedSong->readFromFile(*reader);
 		if (error != Error::NONE) {
 			goto gotErrorAfterCreatingSong;
 		}
@@ -455,8 +462,17 @@ swapDone:
 			    "Loading"); // To override our popup if we did one. (Still necessary?)
 		}
 		// Ok, the swap's been done, the first tick of the new song has been done, and there are potentially loads of
-		// samples wanting some data loaded. So do that immediately
-		audioFileManager.loadAnyEnqueuedClusters(99999);
+		// samples wanting some data loaded. So do that immediately - a few at a time, keeping audio going in between,
+		// for as long as the queue keeps getting shorter
+		int32_t numClustersQueued;
+		do {
+			numClustersQueued = audioFileManager.loadingQueue.getNumElements();
+			audioFileManager.loadAnyEnqueuedClusters(8);
+			if (AudioEngine::yieldIsDue()) {
+				AudioEngine::routineWithClusterLoading();
+			}
+		} while (audioFileManager.loadingQueue.getNumElements()
+		         && audioFileManager.loadingQueue.getNumElements() < numClustersQueued);
 
 		// Delete the old song
 		AudioEngine::logAction("i");
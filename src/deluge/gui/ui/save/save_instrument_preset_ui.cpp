@@ -32,6 +32,7 @@
 #include "model/song/song.h"
 #include "processing/engines/audio_engine.h"
 #include "processing/sound/sound_instrument.h"
+#include "storage/snapshot_file.h"
 #include "storage/storage_manager.h"
 #include "util/functions.h"
 #include "util/lookuptables/lookuptables.h"
@@ -193,6 +194,8 @@ fail:
 		goto fail;
 	}
 
+	SnapshotFile::writeFor(filePath.get());
+
 	// Give the Instrument in memory its new slot
 	instrumentToSave->name.set(&enteredText);
 	instrumentToSave->dirPath.set(&currentDir);
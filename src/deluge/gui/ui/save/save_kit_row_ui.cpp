@@ -33,6 +33,7 @@
 #include "processing/engines/audio_engine.h"
 #include "processing/sound/sound_drum.h"
 #include "processing/sound/sound_instrument.h"
+#include "storage/snapshot_file.h"
 #include "storage/storage_manager.h"
 #include "util/functions.h"
 #include "util/lookuptables/lookuptables.h"
@@ -151,6 +152,8 @@ fail:
 		goto fail;
 	}
 
+	SnapshotFile::writeFor(filePath.get());
+
 	// Give the Instrument in memory its new slot
 	soundDrumToSave->name.set(&enteredText);
 	soundDrumToSave->path.set(&currentDir);
@@ -28,6 +28,7 @@
 #include "model/song/song.h"
 #include "storage/audio/audio_file_manager.h"
 #include "storage/flash_storage.h"
+#include "storage/snapshot_file.h"
 #include "storage/storage_manager.h"
 #include "util/functions.h"
 #include <string.h>
@@ -130,6 +131,7 @@ gotError:
 	}
 
 	bool fileAlreadyExisted = bdsm.fileExists(filePath.get());
+	uint32_t oldFileSize = fileAlreadyExisted ? staticFNO.fsize : 0; // The new one's likely to be about the same
 
 	if (!mayOverwrite && fileAlreadyExisted) {
 		context_menu::overwriteFile.currentSaveUI = this;
@@ -423,7 +425,7 @@ fail3:
 	D_PRINTLN("creating:  %s", filePathDuringWrite.get());
 
 	// Write the actual song file
-	error = bdsm.createXMLFile(filePathDuringWrite.get(), smSerializer, false, false);
+	error = bdsm.createXMLFile(filePathDuringWrite.get(), smSerializer, false, false, oldFileSize);
 	if (error != Error::NONE) {
 		goto gotError;
 	}
@@ -457,6 +459,8 @@ cardError:
 		}
 	}
 
+	SnapshotFile::writeFor(filePath.get());
+
 	display->removeWorkingAnimation();
 	char const* message = anyErrorMovingTempFiles
 	                          ? (deluge::l10n::get(deluge::l10n::String::STRING_FOR_ERROR_MOVING_TEMP_FILES))
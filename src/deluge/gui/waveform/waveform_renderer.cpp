@@ -21,6 +21,7 @@
 #include "gui/waveform/waveform_render_data.h"
 #include "io/debug/log.h"
 #include "model/sample/sample.h"
+#include "model/sample/sample_peak_pyramid.h"
 #include "model/sample/sample_recorder.h"
 #include "model/voice/voice_sample.h"
 #include "processing/engines/audio_engine.h"
@@ -246,6 +247,13 @@ bool WaveformRenderer::findPeaksPerCol(Sample* sample, int64_t xScrollSamples, u
 
 	uint64_t numValidBytes = numValidSamples * sample->byteDepth * sample->numChannels;
 
+	// Zoomed out this far, we can take everything from the Sample's peak pyramid, if it's been built yet, without
+	// reading any Clusters
+	SamplePeakPyramid* pyramid = nullptr;
+	if (!recorder && SamplePeakPyramid::canRenderZoom(xZoomSamples)) {
+		pyramid = SamplePeakPyramid::getIfReady(sample);
+	}
+
 	bool hadAnyTroubleLoading = false;
 
 	for (int32_t col = xStart; col < xEnd; col++) {
@@ -283,6 +291,11 @@ bool WaveformRenderer::findPeaksPerCol(Sample* sample, int64_t xScrollSamples, u
 			continue;
 		}
 
+		if (pyramid) {
+			pyramid->getPeaks(colStartSample, colEndSample, &data->minPerCol[col], &data->maxPerCol[col]);
+			continue;
+		}
+
 		int32_t colStartByte =
 		    colStartSample * sample->numChannels * sample->byteDepth + sample->audioDataStartPosBytes;
 		int32_t colEndByte = colEndSample * sample->numChannels * sample->byteDepth + sample->audioDataStartPosBytes;
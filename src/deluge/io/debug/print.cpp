@@ -16,8 +16,12 @@
  */
 
 #include "io/debug/print.h"
+#include "OSLikeStuff/task_scheduler.h"
+#include "io/debug/log.h"
 #include "io/midi/midi_engine.h"
 #include "io/midi/sysex.h"
+#include <algorithm>
+#include "storage/audio/audio_file_manager.h"
 
 extern "C" {
 #include "deluge/drivers/uart/uart.h"
@@ -464,4 +468,43 @@ void AverageVOT::clear() {
 #endif
 }
 
+namespace {
+void printTaskStatistics(TaskID id, const TaskStatistics& stats) {
+	if (!stats.numCalls) {
+		return;
+	}
+	D_PRINTLN("task %d (%s): %lu calls, run time min %lu max %lu p99 %lu us, %lu over max time", id,
+	          stats.name ? stats.name : "unnamed", (unsigned long)stats.numCalls,
+	          (unsigned long)(stats.minRunTime * 1000000), (unsigned long)(stats.maxRunTime * 1000000),
+	          (unsigned long)(stats.p99RunTime * 1000000), (unsigned long)stats.numMaxTimeViolations);
+	static_assert(TASK_STATISTICS_NUM_BUCKETS == 16);
+	unsigned long l[TASK_STATISTICS_NUM_BUCKETS];
+	std::copy(stats.lateness, stats.lateness + TASK_STATISTICS_NUM_BUCKETS, l);
+	D_PRINTLN("  late <1us: %lu, <2: %lu, <4: %lu, <8: %lu, <16: %lu, <32: %lu, <64: %lu, <128: %lu, <256: %lu, "
+	          "<512: %lu, <1024: %lu, <2048: %lu, <4096: %lu, <8192: %lu, <16384: %lu, more: %lu",
+	          l[0], l[1], l[2], l[3], l[4], l[5], l[6], l[7], l[8], l[9], l[10], l[11], l[12], l[13], l[14], l[15]);
+}
+} // namespace
+
+void printTaskStatistics() {
+	TaskStatistics stats;
+	for (TaskID id = 0; id < MAX_NUM_TASKS; id++) {
+		if (getTaskStatistics(id, &stats)) {
+			printTaskStatistics(id, stats);
+		}
+	}
+	getOnceTaskStatistics(&stats);
+	printTaskStatistics(-1, stats);
+}
+
+void printAttackHeadStatistics() {
+	uint32_t numHits = audioFileManager.attackHeadNumHits;
+	uint32_t numStarts = numHits + audioFileManager.attackHeadNumMisses;
+	D_PRINTLN("attack heads: %lu hits, %lu misses (%lu%% hit), %ld clusters of %lu bytes held, budget %lu bytes",
+	          (unsigned long)numHits, (unsigned long)audioFileManager.attackHeadNumMisses,
+	          numStarts ? (unsigned long)((uint64_t)numHits * 100 / numStarts) : 0UL,
+	          (long)audioFileManager.attackHeadNumClusters, (unsigned long)audioFileManager.clusterSize,
+	          (unsigned long)kAttackHeadBudgetBytes);
+}
+
 } // namespace Debug
@@ -44,6 +44,10 @@ void printlnfloat(float number);
 void printfloat(float number);
 void print(int32_t number);
 void ResetClock();
+/// Print the task scheduler's statistics for every task - see getTaskStatistics()
+void printTaskStatistics();
+/// Print how often notes have found their sample's attack head loaded - see AudioFileManager::attackHeadNumClusters
+void printAttackHeadStatistics();
 
 class RTimer {
 public:
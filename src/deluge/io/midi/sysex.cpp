@@ -18,9 +18,12 @@
  */
 
 #include "io/midi/sysex.h"
+#include "OSLikeStuff/task_scheduler.h"
 #include "io/debug/print.h"
 #include "io/midi/midi_device.h"
 #include "io/midi/midi_engine.h"
+#include "processing/engines/offline_renderer.h"
+#include "storage/audio/audio_file_manager.h"
 #include "util/chainload.h"
 
 #include "util/pack.h"
@@ -53,6 +56,31 @@ void Debug::sysexReceived(MIDIDevice* device, uint8_t* data, int32_t len) {
 #endif
 		break;
 
+	case 3: {
+		// Offline render benchmark. data[2]: length in seconds, data[3]: window size in multiples of 4 samples
+		uint32_t numSeconds = (len >= 4) ? data[2] : 10;
+		uint32_t windowSize = (len >= 5 && data[3]) ? data[3] * 4 : 128;
+		OfflineRenderer::scheduleRender(numSeconds * kSampleRate, windowSize);
+		break;
+	}
+
+	case 4:
+		// Task scheduler statistics. data[2] == 1 resets them afterwards
+		printTaskStatistics();
+		if (len >= 4 && data[2] == 1) {
+			resetTaskStatistics();
+		}
+		break;
+
+	case 5:
+		// Attack head hit rate. data[2] == 1 resets it afterwards
+		printAttackHeadStatistics();
+		if (len >= 4 && data[2] == 1) {
+			audioFileManager.attackHeadNumHits = 0;
+			audioFileManager.attackHeadNumMisses = 0;
+		}
+		break;
+
 	default:
 		break;
 	}
@@ -1,9 +1,13 @@
 #pragma once
 #include "memory/general_memory_allocator.h"
 #include <cstddef>
+#if defined(__arm__)
 extern "C" {
 void abort(void); // this is defined in reset_handler.S
 }
+#else
+#include <cstdlib>
+#endif
 namespace deluge::memory {
 
 /**
@@ -74,7 +74,8 @@ Clip::Clip(ClipType newType) : type(newType) {
 }
 
 Clip::~Clip() {
-	if (getCurrentClip() == this) {
+	// No currentSong while deleting a Song which failed to load, the old one being gone already
+	if (currentSong && getCurrentClip() == this) {
 		currentSong->setCurrentClip(nullptr);
 	}
 }
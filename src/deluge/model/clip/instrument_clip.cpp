@@ -44,6 +44,7 @@
 #include "processing/engines/cv_engine.h"
 #include "processing/sound/sound_instrument.h"
 #include "storage/storage_manager.h"
+#include "storage/xml_tags.h"
 #include "util/firmware_version.h"
 #include <cmath>
 #include <new>
@@ -2454,19 +2455,22 @@ someError:
 
 		int32_t temp;
 
-		if (!strcmp(tagName, "inKeyMode")) {
+		switch (XMLTags::find(tagName)) {
+		case XMLTags::id("inKeyMode"): {
 			inScaleMode = reader.readTagOrAttributeValueInt();
+			break;
 		}
 
-		else if (!strcmp(tagName, "instrumentPresetSlot")) {
+		case XMLTags::id("instrumentPresetSlot"): {
 			int32_t slotHere = reader.readTagOrAttributeValueInt();
 			String slotChars;
 			slotChars.setInt(slotHere, 3);
 			slotChars.concatenate(&instrumentPresetName);
 			instrumentPresetName.set(&slotChars);
+			break;
 		}
 
-		else if (!strcmp(tagName, "instrumentPresetSubSlot")) {
+		case XMLTags::id("instrumentPresetSubSlot"): {
 			int32_t subSlotHere = reader.readTagOrAttributeValueInt();
 			if (subSlotHere >= 0 && subSlotHere < 26) {
 				char buffer[2];
@@ -2474,129 +2478,158 @@ someError:
 				buffer[1] = 0;
 				instrumentPresetName.concatenate(buffer);
 			}
+			break;
 		}
 
-		else if (!strcmp(tagName, "instrumentPresetName")) {
+		case XMLTags::id("instrumentPresetName"): {
 			reader.readTagOrAttributeValueString(&instrumentPresetName);
+			break;
 		}
 
-		else if (!strcmp(tagName, "instrumentPresetFolder")) {
+		case XMLTags::id("instrumentPresetFolder"): {
 			reader.readTagOrAttributeValueString(&instrumentPresetDirPath);
 			dirPathHasBeenSpecified = true;
+			break;
 		}
 
-		else if (!strcmp(tagName, "midiChannel")) {
+		case XMLTags::id("midiChannel"): {
 			outputTypeWhileLoading = OutputType::MIDI_OUT;
 
 			// if (!instrument) instrument = reader.createNewNonAudioInstrument(OutputType::MIDI_OUT, 0, -1);
 			instrumentPresetSlot = reader.readTagOrAttributeValueInt();
+			break;
 		}
 
-		else if (!strcmp(tagName, "midiChannelSuffix")) {
+		case XMLTags::id("midiChannelSuffix"): {
 			instrumentPresetSubSlot = reader.readTagOrAttributeValueInt();
+			break;
 		}
 
-		else if (!strcmp(tagName, "cvChannel")) {
+		case XMLTags::id("cvChannel"): {
 			outputTypeWhileLoading = OutputType::CV;
 
 			// if (!instrument) instrument = reader.createNewNonAudioInstrument(OutputType::CV, 0, -1);
 			instrumentPresetSlot = reader.readTagOrAttributeValueInt();
+			break;
 		}
 
-		else if (!strcmp(tagName, "midiBank")) {
+		case XMLTags::id("midiBank"): {
 			midiBank = reader.readTagOrAttributeValueInt();
+			break;
 		}
 
-		else if (!strcmp(tagName, "midiSub")) {
+		case XMLTags::id("midiSub"): {
 			midiSub = reader.readTagOrAttributeValueInt();
+			break;
 		}
 
-		else if (!strcmp(tagName, "midiPGM")) {
+		case XMLTags::id("midiPGM"): {
 			midiPGM = reader.readTagOrAttributeValueInt();
+			break;
 		}
 
-		else if (!strcmp(tagName, "yScroll")) {
+		case XMLTags::id("yScroll"): {
 			yScroll = reader.readTagOrAttributeValueInt();
+			break;
 		}
 
-		else if (!strcmp(tagName, "keyboardLayout")) {
+		case XMLTags::id("keyboardLayout"): {
 			keyboardState.currentLayout = (KeyboardLayoutType)reader.readTagOrAttributeValueInt();
+			break;
 		}
 
-		else if (!strcmp(tagName, "yScrollKeyboard")) {
+		case XMLTags::id("yScrollKeyboard"): {
 			keyboardState.isomorphic.scrollOffset = reader.readTagOrAttributeValueInt();
+			break;
 		}
 
-		else if (!strcmp(tagName, "keyboardRowInterval")) {
+		case XMLTags::id("keyboardRowInterval"): {
 			keyboardState.isomorphic.rowInterval = reader.readTagOrAttributeValueInt();
+			break;
 		}
 
-		else if (!strcmp(tagName, "drumsScrollOffset")) {
+		case XMLTags::id("drumsScrollOffset"): {
 			keyboardState.drums.scrollOffset = reader.readTagOrAttributeValueInt();
+			break;
 		}
 
-		else if (!strcmp(tagName, "drumsEdgeSize")) {
+		case XMLTags::id("drumsEdgeSize"): {
 			keyboardState.drums.edgeSize = reader.readTagOrAttributeValueInt();
+			break;
 		}
 
-		else if (!strcmp(tagName, "inKeyScrollOffset")) {
+		case XMLTags::id("inKeyScrollOffset"): {
 			keyboardState.inKey.scrollOffset = reader.readTagOrAttributeValueInt();
+			break;
 		}
 
-		else if (!strcmp(tagName, "inKeyRowInterval")) {
+		case XMLTags::id("inKeyRowInterval"): {
 			keyboardState.inKey.rowInterval = reader.readTagOrAttributeValueInt();
+			break;
 		}
 
-		else if (!strcmp(tagName, "crossScreenEditLevel")) {
+		case XMLTags::id("crossScreenEditLevel"): {
 			wrapEditLevel = reader.readTagOrAttributeValueInt();
 			wrapEditing = true;
+			break;
 		}
 
-		else if (!strcmp(tagName, "onKeyboardScreen")) {
+		case XMLTags::id("onKeyboardScreen"): {
 			onKeyboardScreen = reader.readTagOrAttributeValueInt();
+			break;
 		}
 
-		else if (!strcmp(tagName, "onAutomationInstrumentClipView")) {
+		case XMLTags::id("onAutomationInstrumentClipView"): {
 			onAutomationClipView = reader.readTagOrAttributeValueInt();
+			break;
 		}
 
-		else if (!strcmp(tagName, "lastSelectedParamID")) {
+		case XMLTags::id("lastSelectedParamID"): {
 			lastSelectedParamID = reader.readTagOrAttributeValueInt();
+			break;
 		}
 
-		else if (!strcmp(tagName, "lastSelectedParamKind")) {
+		case XMLTags::id("lastSelectedParamKind"): {
 			lastSelectedParamKind = static_cast<params::Kind>(reader.readTagOrAttributeValueInt());
+			break;
 		}
 
-		else if (!strcmp(tagName, "lastSelectedParamShortcutX")) {
+		case XMLTags::id("lastSelectedParamShortcutX"): {
 			lastSelectedParamShortcutX = reader.readTagOrAttributeValueInt();
+			break;
 		}
 
-		else if (!strcmp(tagName, "lastSelectedParamShortcutY")) {
+		case XMLTags::id("lastSelectedParamShortcutY"): {
 			lastSelectedParamShortcutY = reader.readTagOrAttributeValueInt();
+			break;
 		}
 
-		else if (!strcmp(tagName, "lastSelectedParamArrayPosition")) {
+		case XMLTags::id("lastSelectedParamArrayPosition"): {
 			lastSelectedParamArrayPosition = reader.readTagOrAttributeValueInt();
+			break;
 		}
 
-		else if (!strcmp(tagName, "lastSelectedInstrumentType")) {
+		case XMLTags::id("lastSelectedInstrumentType"): {
 			lastSelectedOutputType = static_cast<OutputType>(reader.readTagOrAttributeValueInt());
+			break;
 		}
 
-		else if (!strcmp(tagName, "lastSelectedPatchSource")) {
+		case XMLTags::id("lastSelectedPatchSource"): {
 			lastSelectedPatchSource = static_cast<PatchSource>(reader.readTagOrAttributeValueInt());
+			break;
 		}
 
-		else if (!strcmp(tagName, "affectEntire")) {
+		case XMLTags::id("affectEntire"): {
 			affectEntire = reader.readTagOrAttributeValueInt();
+			break;
 		}
 
-		else if (!strcmp(tagName, "soundMidiCommand")) { // Only for pre V2.0 song files
+		case XMLTags::id("soundMidiCommand"): { // Only for pre V2.0 song files
 			soundMidiCommand.readChannelFromFile(reader);
+			break;
 		}
 
-		else if (!strcmp(tagName, "modKnobs")) { // Pre V2.0 only - for compatibility
+		case XMLTags::id("modKnobs"): { // Pre V2.0 only - for compatibility
 
 			outputTypeWhileLoading = OutputType::MIDI_OUT;
 
@@ -2618,7 +2651,7 @@ someError:
 			}
 
 			error = ((MIDIInstrument*)output)
-			            ->readModKnobAssignmentsFromFile(storageManager, readAutomationUpToPos, &paramManager);
+			            ->readModKnobAssignmentsFromFile(storageManager, reader, readAutomationUpToPos, &paramManager);
 			if (error != Error::NONE) {
 				return error;
 			}
@@ -2626,9 +2659,10 @@ someError:
 			if (loopLength) {
 				paramManager.getMIDIParamCollection()->makeInterpolatedCCsGoodAgain(loopLength);
 			}
+			break;
 		}
 
-		else if (!strcmp(tagName, "arpeggiator")) {
+		case XMLTags::id("arpeggiator"): {
 			while (*(tagName = reader.readNextTagOrAttributeName())) {
 
 				if (!strcmp(tagName, "rate")) {
@@ -2705,11 +2739,12 @@ someError:
 					reader.exitTag(tagName);
 				}
 			}
+			break;
 		}
 
 		// For song files from before V2.0, where Instruments were stored within the Clip.
 		// Loading Instrument from another Clip.
-		else if (!strcmp(tagName, "instrument")) {
+		case XMLTags::id("instrument"): {
 			if (*(tagName = reader.readNextTagOrAttributeName())) {
 				if (!strcmp(tagName, "referToTrackId")) {
 					if (!output) {
@@ -2734,10 +2769,12 @@ someError:
 					reader.exitTag("referToTrackId");
 				}
 			}
+			break;
 		}
 
 		// For song files from before V2.0, where Instruments were stored within the Clip
-		else if (!strcmp(tagName, "sound") || !strcmp(tagName, "synth")) {
+		case XMLTags::id("sound"):
+		case XMLTags::id("synth"): {
 			if (!output) {
 				{
 					void* instrumentMemory = GeneralMemoryAllocator::get().allocMaxSpeed(sizeof(SoundInstrument));
@@ -2768,10 +2805,11 @@ loadInstrument:
 				// Add the Instrument to the Song
 				song->addOutput(output);
 			}
+			break;
 		}
 
 		// For song files from before V2.0, where Instruments were stored within the Clip
-		else if (!strcmp(tagName, "kit")) {
+		case XMLTags::id("kit"): {
 			if (!output) {
 				void* instrumentMemory = GeneralMemoryAllocator::get().allocMaxSpeed(sizeof(Kit));
 				if (!instrumentMemory) {
@@ -2787,9 +2825,10 @@ loadInstrument:
 				output = kit;
 				goto loadInstrument;
 			}
+			break;
 		}
 
-		else if (!strcmp(tagName, "soundParams")) {
+		case XMLTags::id("soundParams"): {
 			outputTypeWhileLoading = OutputType::SYNTH;
 
 			// Normal case - load in brand new ParamManager
@@ -2817,9 +2856,10 @@ createNewParamManager:
 				}
 			}
 			Sound::readParamsFromFile(reader, &paramManager, readAutomationUpToPos);
+			break;
 		}
 
-		else if (!strcmp(tagName, "kitParams")) {
+		case XMLTags::id("kitParams"): {
 			outputTypeWhileLoading = OutputType::KIT;
 			error = paramManager.setupUnpatched();
 			if (error != Error::NONE) {
@@ -2828,9 +2868,10 @@ createNewParamManager:
 
 			GlobalEffectableForClip::initParams(&paramManager);
 			GlobalEffectableForClip::readParamsFromFile(reader, &paramManager, readAutomationUpToPos);
+			break;
 		}
 
-		else if (!strcmp(tagName, "midiParams")) {
+		case XMLTags::id("midiParams"): {
 			outputTypeWhileLoading = OutputType::MIDI_OUT;
 			error = paramManager.setupMIDI();
 			if (error != Error::NONE) {
@@ -2841,9 +2882,10 @@ createNewParamManager:
 			if (error != Error::NONE) {
 				goto someError;
 			}
+			break;
 		}
 
-		else if (!strcmp(tagName, "noteRows")) {
+		case XMLTags::id("noteRows"): {
 			int32_t minY = -32768;
 			while (*(tagName = reader.readNextTagOrAttributeName())) {
 				if (!strcmp(tagName, "noteRow")) {
@@ -2858,10 +2900,11 @@ createNewParamManager:
 				}
 				reader.exitTag();
 			}
+			break;
 		}
 
 		// These are the expression params for MPE
-		else if (!strcmp(tagName, "pitchBend")) {
+		case XMLTags::id("pitchBend"): {
 			temp = 0;
 doReadExpressionParam:
 			paramManager.ensureExpressionParamSetExists();
@@ -2870,42 +2913,45 @@ doReadExpressionParam:
 			if (expressionParams) {
 				expressionParams->readParam(reader, summary, temp, readAutomationUpToPos);
 			}
+			break;
 		}
 
-		else if (!strcmp(tagName, "yExpression")) {
+		case XMLTags::id("yExpression"): {
 			temp = 1;
 			goto doReadExpressionParam;
 		}
 
-		else if (!strcmp(tagName, "channelPressure")) {
+		case XMLTags::id("channelPressure"): {
 			temp = 2;
 			goto doReadExpressionParam;
 		} // -----------------------------------------------------------------------------------
 
-		else if (!strcmp(tagName, "expressionData")) {
+		case XMLTags::id("expressionData"): {
 			paramManager.ensureExpressionParamSetExists();
 			ParamCollectionSummary* summary = paramManager.getExpressionParamSetSummary();
 			ExpressionParamSet* expressionParams = (ExpressionParamSet*)summary->paramCollection;
 			if (expressionParams) {
 				expressionParams->readFromFile(reader, summary, readAutomationUpToPos);
 			}
+			break;
 		}
 
-		else if (!strcmp(tagName, "bendRange")) {
+		case XMLTags::id("bendRange"): {
 			temp = BEND_RANGE_MAIN;
 doReadBendRange:
 			ExpressionParamSet* expressionParams = paramManager.getOrCreateExpressionParamSet();
 			if (expressionParams) {
 				expressionParams->bendRanges[temp] = reader.readTagOrAttributeValueInt();
 			}
+			break;
 		}
 
-		else if (!strcmp(tagName, "bendRangeMPE")) {
+		case XMLTags::id("bendRangeMPE"): {
 			temp = BEND_RANGE_FINGER_LEVEL;
 			goto doReadBendRange;
 		}
 
-		else {
+		default:
 			readTagFromFile(reader, tagName, song, &readAutomationUpToPos);
 		}
 
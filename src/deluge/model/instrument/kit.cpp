@@ -266,7 +266,7 @@ Error Kit::readFromFile(Deserializer& reader, Song* song, Clip* clip, int32_t re
 				if (!strcmp(tagName, "sample") || !strcmp(tagName, "synth") || !strcmp(tagName, "sound")) {
 					drumType = DrumType::SOUND;
 doReadDrum:
-					Error error = readDrumFromFile(storageManager, song, clip, drumType, readAutomationUpToPos);
+					Error error = readDrumFromFile(storageManager, reader, song, clip, drumType, readAutomationUpToPos);
 					if (error != Error::NONE) {
 						return error;
 					}
@@ -304,7 +304,7 @@ doReadDrum:
 			else {
 				if (Instrument::readTagFromFile(reader, tagName)) {}
 				else {
-					Error result = smDeserializer.tryReadingFirmwareTagFromFile(tagName);
+					Error result = reader.tryReadingFirmwareTagFromFile(tagName);
 					if (result != Error::NONE && result != Error::RESULT_TAG_UNUSED) {
 						return result;
 					}
@@ -326,7 +326,7 @@ doReadDrum:
 	return Error::NONE;
 }
 
-Error Kit::readDrumFromFile(StorageManager& bdsm, Song* song, Clip* clip, DrumType drumType,
+Error Kit::readDrumFromFile(StorageManager& bdsm, Deserializer& reader, Song* song, Clip* clip, DrumType drumType,
                             int32_t readAutomationUpToPos) {
 
 	Drum* newDrum = bdsm.createNewDrum(drumType);
@@ -334,7 +334,6 @@ Error Kit::readDrumFromFile(StorageManager& bdsm, Song* song, Clip* clip, DrumTy
 		return Error::INSUFFICIENT_RAM;
 	}
 
-	Deserializer& reader = smDeserializer;
 	Error error = newDrum->readFromFile(
 	    reader, song, clip,
 	    readAutomationUpToPos); // Will create and "back up" a new ParamManager if anything to read into it
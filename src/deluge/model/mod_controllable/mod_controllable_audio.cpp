@@ -37,6 +37,7 @@
 #include "processing/engines/audio_engine.h"
 #include "processing/sound/sound.h"
 #include "storage/storage_manager.h"
+#include "storage/xml_tags.h"
 
 namespace params = deluge::modulation::params;
 
@@ -990,7 +991,8 @@ bool ModControllableAudio::readParamTagFromFile(Deserializer& reader, char const
 	ParamCollectionSummary* unpatchedParamsSummary = paramManager->getUnpatchedParamSetSummary();
 	UnpatchedParamSet* unpatchedParams = (UnpatchedParamSet*)unpatchedParamsSummary->paramCollection;
 
-	if (!strcmp(tagName, "equalizer")) {
+	switch (XMLTags::find(tagName)) {
+	case XMLTags::id("equalizer"): {
 		while (*(tagName = reader.readNextTagOrAttributeName())) {
 			if (!strcmp(tagName, "bass")) {
 				unpatchedParams->readParam(reader, unpatchedParamsSummary, params::UNPATCHED_BASS,
@@ -1014,44 +1016,51 @@ bool ModControllableAudio::readParamTagFromFile(Deserializer& reader, char const
 			}
 		}
 		reader.exitTag("equalizer");
+		break;
 	}
 
-	else if (!strcmp(tagName, "stutterRate")) {
+	case XMLTags::id("stutterRate"): {
 		unpatchedParams->readParam(reader, unpatchedParamsSummary, params::UNPATCHED_STUTTER_RATE,
 		                           readAutomationUpToPos);
 		reader.exitTag("stutterRate");
+		break;
 	}
 
-	else if (!strcmp(tagName, "sampleRateReduction")) {
+	case XMLTags::id("sampleRateReduction"): {
 		unpatchedParams->readParam(reader, unpatchedParamsSummary, params::UNPATCHED_SAMPLE_RATE_REDUCTION,
 		                           readAutomationUpToPos);
 		reader.exitTag("sampleRateReduction");
+		break;
 	}
 
-	else if (!strcmp(tagName, "bitCrush")) {
+	case XMLTags::id("bitCrush"): {
 		unpatchedParams->readParam(reader, unpatchedParamsSummary, params::UNPATCHED_BITCRUSHING,
 		                           readAutomationUpToPos);
 		reader.exitTag("bitCrush");
+		break;
 	}
 
-	else if (!strcmp(tagName, "modFXOffset")) {
+	case XMLTags::id("modFXOffset"): {
 		unpatchedParams->readParam(reader, unpatchedParamsSummary, params::UNPATCHED_MOD_FX_OFFSET,
 		                           readAutomationUpToPos);
 		reader.exitTag("modFXOffset");
+		break;
 	}
 
-	else if (!strcmp(tagName, "modFXFeedback")) {
+	case XMLTags::id("modFXFeedback"): {
 		unpatchedParams->readParam(reader, unpatchedParamsSummary, params::UNPATCHED_MOD_FX_FEEDBACK,
 		                           readAutomationUpToPos);
 		reader.exitTag("modFXFeedback");
+		break;
 	}
-	else if (!strcmp(tagName, "compressorThreshold")) {
+	case XMLTags::id("compressorThreshold"): {
 		unpatchedParams->readParam(reader, unpatchedParamsSummary, params::UNPATCHED_COMPRESSOR_THRESHOLD,
 		                           readAutomationUpToPos);
 		reader.exitTag("compressorThreshold");
+		break;
 	}
 
-	else {
+	default:
 		return false;
 	}
 
@@ -1065,25 +1074,30 @@ Error ModControllableAudio::readTagFromFile(Deserializer& reader, char const* ta
 
 	int32_t p;
 
-	if (!strcmp(tagName, "lpfMode")) {
+	switch (XMLTags::find(tagName)) {
+	case XMLTags::id("lpfMode"): {
 		lpfMode = stringToLPFType(reader.readTagOrAttributeValue());
 		reader.exitTag("lpfMode");
+		break;
 	}
-	else if (!strcmp(tagName, "hpfMode")) {
+	case XMLTags::id("hpfMode"): {
 		hpfMode = stringToLPFType(reader.readTagOrAttributeValue());
 		reader.exitTag("hpfMode");
+		break;
 	}
-	else if (!strcmp(tagName, "filterRoute")) {
+	case XMLTags::id("filterRoute"): {
 		filterRoute = stringToFilterRoute(reader.readTagOrAttributeValue());
 		reader.exitTag("filterRoute");
+		break;
 	}
 
-	else if (!strcmp(tagName, "clippingAmount")) {
+	case XMLTags::id("clippingAmount"): {
 		clippingAmount = reader.readTagOrAttributeValueInt();
 		reader.exitTag("clippingAmount");
+		break;
 	}
 
-	else if (!strcmp(tagName, "delay")) {
+	case XMLTags::id("delay"): {
 		// Set default values in case they are not configured
 		delay.syncType = SYNC_TYPE_EVEN;
 		delay.syncLevel = SYNC_LEVEL_NONE;
@@ -1137,9 +1151,10 @@ doReadPatchedParam:
 			}
 		}
 		reader.exitTag("delay");
+		break;
 	}
 
-	else if (!strcmp(tagName, "audioCompressor")) {
+	case XMLTags::id("audioCompressor"): {
 		while (*(tagName = reader.readNextTagOrAttributeName())) {
 			if (!strcmp(tagName, "attack")) {
 				q31_t masterCompressorAttack = reader.readTagOrAttributeValueInt();
@@ -1171,9 +1186,11 @@ doReadPatchedParam:
 			}
 		}
 		reader.exitTag("AudioCompressor");
+		break;
 	}
 	// this is actually the sidechain but pre c1.1 songs save it as compressor
-	else if (!strcmp(tagName, "compressor") || !strcmp(tagName, "sidechain")) { // Remember, Song doesn't use this
+	case XMLTags::id("compressor"):
+	case XMLTags::id("sidechain"): { // Remember, Song doesn't use this
 		// Set default values in case they are not configured
 		const char* name = tagName;
 		sidechain.syncType = SYNC_TYPE_EVEN;
@@ -1202,9 +1219,10 @@ doReadPatchedParam:
 			}
 		}
 		reader.exitTag(name);
+		break;
 	}
 
-	else if (!strcmp(tagName, "midiKnobs")) {
+	case XMLTags::id("midiKnobs"): {
 
 		while (*(tagName = reader.readNextTagOrAttributeName())) {
 			if (!strcmp(tagName, "midiKnob")) {
@@ -1270,9 +1288,10 @@ doReadPatchedParam:
 			reader.exitTag();
 		}
 		reader.exitTag("midiKnobs");
+		break;
 	}
 
-	else {
+	default:
 		return Error::RESULT_TAG_UNUSED;
 	}
 
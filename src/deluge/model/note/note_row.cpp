@@ -40,6 +40,7 @@
 #include "processing/sound/sound_drum.h"
 #include "processing/sound/sound_instrument.h"
 #include "storage/storage_manager.h"
+#include "storage/xml_tags.h"
 #include <new>
 #include <string.h>
 
@@ -2942,55 +2943,66 @@ Error NoteRow::readFromFile(Deserializer& reader, int32_t* minY, InstrumentClip*
 	while (*(tagName = reader.readNextTagOrAttributeName())) {
 		// D_PRINTLN(tagName); delayMS(50);
 
-		uint16_t noteHexLength;
+		uint16_t noteNumBytes;
 
-		if (!strcmp(tagName, "muted")) {
+		switch (XMLTags::find(tagName)) {
+		case XMLTags::id("muted"): {
 			muted = reader.readTagOrAttributeValueInt();
+			break;
 		}
 
-		else if (!strcmp(tagName, "y")) {
+		case XMLTags::id("y"): {
 			y = reader.readTagOrAttributeValueInt();
+			break;
 		}
 
-		else if (!strcmp(tagName, "colourOffset")) {
+		case XMLTags::id("colourOffset"): {
 			colourOffset = reader.readTagOrAttributeValueInt();
+			break;
 		}
 
-		else if (!strcmp(tagName, "drumIndex")) {
+		case XMLTags::id("drumIndex"): {
 			drum = (Drum*)reader.readTagOrAttributeValueInt(); // Sneaky - we store an integer in place of this pointer,
 			                                                   // then swap it back to something meaningful later
+			break;
 		}
 
-		else if (!strcmp(tagName, "gateOutput")) {
+		case XMLTags::id("gateOutput"): {
 			int32_t gateChannel = reader.readTagOrAttributeValueInt();
 			gateChannel = std::clamp<int32_t>(gateChannel, 0, NUM_GATE_CHANNELS - 1);
 
 			drum = (Drum*)(0xFFFFFFFE - gateChannel);
+			break;
 		}
 
-		else if (!strcmp(tagName, "muteMidiCommand")) {
+		case XMLTags::id("muteMidiCommand"): {
 			muteMIDICommand.readNoteFromFile(reader);
+			break;
 		}
 
-		else if (!strcmp(tagName, "soundMidiCommand")) {
+		case XMLTags::id("soundMidiCommand"): {
 			midiInput.readNoteFromFile(reader);
+			break;
 		}
 
-		else if (!strcmp(tagName, "length")) {
+		case XMLTags::id("length"): {
 			loopLengthIfIndependent = reader.readTagOrAttributeValueInt();
 			readAutomationUpToPos =
 			    loopLengthIfIndependent; // So we can read automation right up to the actual length of this NoteRow.
+			break;
 		}
 
-		else if (!strcmp(tagName, "sequenceDirection")) {
+		case XMLTags::id("sequenceDirection"): {
 			sequenceDirectionMode = stringToSequenceDirectionMode(reader.readTagOrAttributeValue());
+			break;
 		}
 
-		else if (!strcmp(tagName, "bendRange")) {
+		case XMLTags::id("bendRange"): {
 			newBendRange = reader.readTagOrAttributeValueInt();
+			break;
 		}
 
-		else if (!strcmp(tagName, "soundParams")) {
+		case XMLTags::id("soundParams"): {
 
 			// Sneaky sorta hack for 2016 files - allow more params to be loaded into a ParamManager that already had
 			// some loading done by the Drum
@@ -3016,10 +3028,11 @@ Error NoteRow::readFromFile(Deserializer& reader, int32_t* minY, InstrumentClip*
 
 finishedNormalStuff:
 			Sound::readParamsFromFile(reader, &paramManager, readAutomationUpToPos);
+			break;
 		}
 
 		// Notes stored as XML (before V1.4)
-		else if (!strcmp(tagName, "notes")) {
+		case XMLTags::id("notes"): {
 			// Read each Note
 			uint32_t minPos = 0;
 			while (*(tagName = reader.readNextTagOrAttributeName())) {
@@ -3077,11 +3090,12 @@ finishedNormalStuff:
 					reader.exitTag(tagName);
 				}
 			}
+			break;
 		}
 
 		// Notes stored as hex data (V1.4 onwards)
-		else if (!strcmp(tagName, "noteData")) {
-			noteHexLength = 20;
+		case XMLTags::id("noteData"): {
+			noteNumBytes = 10;
 doReadNoteData:
 			int32_t minPos = 0;
 
@@ -3100,90 +3114,121 @@ doReadNoteData:
 
 			while (true) {
 
-				// Every time we've reached the end of a cluster...
+				// Every time we've reached the end of what the reader has ready for us (a cluster, or all of it)...
 				if (numElementsToAllocateFor <= 0) {
 
-					// See how many more chars before the end of the cluster. If there are any...
+					// See how many more chars there are. If there are any...
 					uint32_t charsRemaining = reader.getNumCharsRemainingInValue();
 					if (charsRemaining) {
 
 						// Allocate space for the right number of notes, and remember how long it'll be before we need
 						// to do this check again
-						numElementsToAllocateFor = (uint32_t)(charsRemaining - 1) / noteHexLength + 1;
+						numElementsToAllocateFor = (uint32_t)(charsRemaining - 1) / (noteNumBytes * 2) + 1;
 						notes.ensureEnoughSpaceAllocated(
 						    numElementsToAllocateFor); // If it returns false... oh well. We'll fail later
 					}
 				}
 
-				char const* hexChars = reader.readNextCharsOfTagOrAttributeValue(noteHexLength);
-				if (!hexChars) {
-					goto getOut;
-				}
-
-				int32_t pos = hexToIntFixedLength(hexChars, 8);
-				int32_t length = hexToIntFixedLength(&hexChars[8], 8);
-				uint8_t velocity = hexToIntFixedLength(&hexChars[16], 2);
-				uint8_t lift, probability;
+				// Take the notes in batches, as bytes - so there's no per-note call to the reader or hex to decode
+				constexpr int32_t kNumNotesPerBatch = 32;
+				uint8_t noteBytes[kNumNotesPerBatch * 11];
+				int32_t numBytesWanted = kNumNotesPerBatch * noteNumBytes;
+				int32_t numBytesRead = reader.readNextHexBytesOfTagOrAttributeValue(noteBytes, numBytesWanted);
+				int32_t numNotesRead = numBytesRead / noteNumBytes;
+
+				// Check them all first, so the ones we're keeping can go on the end of notes in one go. They only ever
+				// go on the end - minPos sees to that
+				struct {
+					int32_t pos;
+					int32_t length;
+					uint8_t velocity;
+					uint8_t lift;
+					uint8_t probability;
+				} notesToAdd[kNumNotesPerBatch];
+				int32_t numNotesToAdd = 0;
+
+				for (int32_t n = 0; n < numNotesRead; n++) {
+					uint8_t const* thisNoteBytes = &noteBytes[n * noteNumBytes];
+					int32_t pos = readBigEndian32(thisNoteBytes);
+					int32_t length = readBigEndian32(&thisNoteBytes[4]);
+					uint8_t velocity = thisNoteBytes[8];
+					uint8_t lift, probability;
+
+					if (noteNumBytes == 11) { // If reading lift...
+						probability = thisNoteBytes[10];
+						lift = thisNoteBytes[9];
+						if (lift == 0 || lift > 127) {
+							lift = kDefaultLiftValue;
+						}
+					}
+					else { // Or if no lift here to read
+						probability = thisNoteBytes[9];
+						lift = kDefaultLiftValue;
+					}
 
-				if (noteHexLength == 22) { // If reading lift...
-					probability = hexToIntFixedLength(&hexChars[20], 2);
-					lift = hexToIntFixedLength(&hexChars[18], 2);
-					if (lift == 0 || lift > 127) {
-						goto useDefaultLift;
+					// See if that's all allowed
+					if (length <= 0) {
+						length = 1; // This happened somehow in Simon Wollwage's song, May 2020
+					}
+					if (pos < minPos || pos > kMaxSequenceLength - length) {
+						continue;
+					}
+					if (velocity == 0 || velocity > 127) {
+						velocity = 64;
+					}
+					if ((probability & 127) > (kNumProbabilityValues + kNumIterationValues)
+					    || probability >= (kNumProbabilityValues | 128)) {
+						probability = kNumProbabilityValues;
 					}
-				}
-				else { // Or if no lift here to read
-					probability = hexToIntFixedLength(&hexChars[18], 2);
-useDefaultLift:
-					lift = kDefaultLiftValue;
-				}
 
-				// See if that's all allowed
-				if (length <= 0) {
-					length = 1; // This happened somehow in Simon Wollwage's song, May 2020
-				}
-				if (pos < minPos || pos > kMaxSequenceLength - length) {
-					continue;
-				}
-				if (velocity == 0 || velocity > 127) {
-					velocity = 64;
+					minPos = pos + length;
+
+					notesToAdd[numNotesToAdd++] = {pos, length, velocity, lift, probability};
 				}
-				if ((probability & 127) > (kNumProbabilityValues + kNumIterationValues)
-				    || probability >= (kNumProbabilityValues | 128)) {
-					probability = kNumProbabilityValues;
+
+				// Ok, make the notes
+				if (numNotesToAdd) {
+					int32_t firstI = notes.getNumElements();
+					Error error = notes.insertAtIndex(firstI, numNotesToAdd);
+					if (error != Error::NONE) {
+						return error;
+					}
+					for (int32_t n = 0; n < numNotesToAdd; n++) {
+						Note* newNote = notes.getElement(firstI + n);
+						newNote->pos = notesToAdd[n].pos;
+						newNote->setLength(notesToAdd[n].length);
+						newNote->setVelocity(notesToAdd[n].velocity);
+						newNote->setLift(notesToAdd[n].lift);
+						newNote->setProbability(notesToAdd[n].probability);
+					}
 				}
 
-				minPos = pos + length;
+				numElementsToAllocateFor -= numNotesRead;
 
-				// Ok, make the note
-				int32_t i = notes.insertAtKey(pos, true);
-				if (i == -1) {
-					return Error::INSUFFICIENT_RAM;
+				// Fewer bytes than we asked for means the value's finished
+				if (numBytesRead < numBytesWanted) {
+					goto getOut;
 				}
-				Note* newNote = notes.getElement(i);
-				newNote->setLength(length);
-				newNote->setVelocity(velocity);
-				newNote->setLift(lift);
-				newNote->setProbability(probability);
-
-				numElementsToAllocateFor--;
 			}
 getOut: {}
+			break;
 		}
 
 		// Notes stored as hex data including lift (V3.2 onwards)
-		else if (!strcmp(tagName, "noteDataWithLift")) {
-			noteHexLength = 22;
+		case XMLTags::id("noteDataWithLift"): {
+			noteNumBytes = 11;
 			goto doReadNoteData;
 		}
 
-		else if (!strcmp(tagName, "expressionData")) {
+		case XMLTags::id("expressionData"): {
 			paramManager.ensureExpressionParamSetExists();
 			ParamCollectionSummary* summary = paramManager.getExpressionParamSetSummary();
 			ExpressionParamSet* expressionParams = (ExpressionParamSet*)summary->paramCollection;
 			if (expressionParams) {
 				expressionParams->readFromFile(reader, summary, readAutomationUpToPos);
 			}
+			break;
+		}
 		}
 
 		reader.exitTag();
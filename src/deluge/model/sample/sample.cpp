@@ -22,7 +22,11 @@
 #include "dsp/timestretch/time_stretcher.h"
 #include "io/debug/log.h"
 #include "memory/general_memory_allocator.h"
+#include "model/sample/sample_block_index.h"
 #include "model/sample/sample_cache.h"
+#include "model/sample/sample_cache_file.h"
+#include "model/sample/sample_peak_pyramid.h"
+#include "model/sample/sample_perc_cache_file.h"
 #include "model/sample/sample_perc_cache_zone.h"
 #include "processing/engines/audio_engine.h"
 #include "storage/audio/audio_file_manager.h"
@@ -60,7 +64,7 @@ struct SampleCacheElement {
 
 Sample::Sample()
     : percCacheZones{sizeof(SamplePercCacheZone), sizeof(SamplePercCacheZone)}, caches(sizeof(SampleCacheElement), 4),
-      AudioFile(AudioFileType::SAMPLE) {
+      extents(sizeof(SampleExtent)), AudioFile(AudioFileType::SAMPLE) {
 	audioDataLengthBytes = 0;
 	audioDataStartPosBytes = 0;
 	lengthInSamples = 0;
@@ -77,6 +81,14 @@ Sample::Sample()
 	percCacheClusters[0] = NULL;
 	percCacheClusters[1] = NULL;
 
+	peakPyramid = NULL;
+
+	blockIndex = NULL;
+	clustersDecoded = false;
+
+	percCacheFromFile = false;
+	percCacheFileFailed = false;
+
 	fileLoopStartSamples = 0;
 	fileLoopEndSamples = 0;
 	midiNoteFromFile = -1;
@@ -104,12 +116,31 @@ Sample::~Sample() {
 	}
 
 	deletePercCache(true);
+	deletePeakPyramid();
+	SamplePercCacheFile::sampleDeleted(this);
 
 	for (int32_t i = 0; i < caches.getNumElements(); i++) {
 		SampleCacheElement* element = (SampleCacheElement*)caches.getElementAddress(i);
 		element->cache->~SampleCache();
 		delugeDealloc(element->cache);
 	}
+
+	if (audioFileManager.decodedBlockSample == this) {
+		audioFileManager.decodedBlockSample = NULL;
+	}
+
+	if (blockIndex) {
+		blockIndex->~SampleBlockIndex();
+		delugeDealloc(blockIndex);
+	}
+}
+
+void Sample::deletePeakPyramid() {
+	if (peakPyramid) {
+		peakPyramid->~SamplePeakPyramid(); // Removes it from the stealable queue
+		delugeDealloc(peakPyramid);
+		peakPyramid = NULL;
+	}
 }
 
 void Sample::deletePercCache(bool beingDestructed) {
@@ -148,6 +179,8 @@ void Sample::deletePercCache(bool beingDestructed) {
 			percCacheZones[reversed].empty();
 		}
 	}
+
+	percCacheFromFile = false;
 }
 
 void Sample::workOutBitMask() {
@@ -231,8 +264,8 @@ SampleCache* Sample::getOrCreateCache(SampleHolder* sampleHolder, int32_t phaseI
 		return NULL;
 	}
 
-	SampleCache* samplePitchAdjustment = new (memory)
-	    SampleCache(this, numClusters, lengthInBytesCached, phaseIncrement, timeStretchRatio, skipSamplesAtStart);
+	SampleCache* samplePitchAdjustment = new (memory) SampleCache(
+	    this, numClusters, lengthInBytesCached, phaseIncrement, timeStretchRatio, skipSamplesAtStart, reversed);
 
 	SampleCacheElement* element = (SampleCacheElement*)caches.getElementAddress(i);
 	element->phaseIncrement = phaseIncrement;
@@ -241,7 +274,8 @@ SampleCache* Sample::getOrCreateCache(SampleHolder* sampleHolder, int32_t phaseI
 	element->skipSamplesAtStart = skipSamplesAtStart;
 	element->reversed = reversed;
 
-	*created = true;
+	// If it's on the card from before, it'll be filled from there - so the caller mustn't write to it
+	*created = !SampleCacheFile::startRestoring(samplePitchAdjustment);
 	return samplePitchAdjustment;
 }
 
@@ -287,14 +321,16 @@ Error Sample::fillPercCache(TimeStretcher* timeStretcher, int32_t startPosSample
 		}
 	}
 
+	// Have the whole thing done in the background, if that's on, so it doesn't depend on where we started playing
+	if (!percCacheFromFile && !percCacheFileFailed) {
+		SamplePercCacheFile::percCacheWanted(this);
+	}
+
 	LOCK_ENTRY
 
 	AudioEngine::logAction("fillPercCache");
 
-	// int32_t lengthInSamplesAfterReduction = ((lengthInSamples + (kPercBufferReductionSize >> 1)) >>
-	// PERC_BUFFER_REDUCTION_MAGNITUDE);
-	int32_t lengthInSamplesAfterReduction = ((lengthInSamples - 1) >> kPercBufferReductionMagnitude) + 1;
-	lengthInSamplesAfterReduction = std::max(lengthInSamplesAfterReduction, 1_i32); // Can't allocate less than 1 byte
+	int32_t lengthInSamplesAfterReduction = getPercCacheLength();
 
 	bool percCacheDoneWithClusters = (lengthInSamplesAfterReduction >= (audioFileManager.clusterSize >> 1));
 
@@ -623,25 +659,7 @@ doLoading:
 
 			while (true) { // I've put reasonable effort into benchmarking / optimizing this loop - I don't think it can
 				           // be improved much more
-				int32_t thisSampleRead =
-				    *(int32_t*)currentPos
-				    >> 2; // Have to make it smaller even if only one, so the "angle" doesn't overflow
-				if (numChannels == 2) {
-					thisSampleRead += *(int32_t*)(currentPos + byteDepth) >> 2;
-				}
-
-				angle = thisSampleRead - percCacheZone->lastSampleRead;
-				percCacheZone->lastSampleRead = thisSampleRead;
-				if (angle < 0) {
-					angle = -angle;
-				}
-
-				for (auto& pole : percCacheZone->angleLPFMem) {
-					int32_t distanceToGo = angle - pole;
-					pole += distanceToGo
-					        >> 9; // multiply_32x32_rshift32_rounded(distanceToGo, 1 << 23); //distanceToGo >> 9;
-					angle = pole;
-				}
+				angle = percCacheZone->addSample(currentPos, bitMask, byteDepth, numChannels);
 
 				currentPos += posIncrement;
 				if (currentPos == endPos) {
@@ -656,17 +674,8 @@ doLoading:
 			int32_t posWithinPercPixel = startPosSamples & (kPercBufferReductionSize - 1);
 
 			if (posWithinPercPixel == (kPercBufferReductionSize >> 1) - reversed) {
-
-				int32_t difference = angle - percCacheZone->lastAngle;
-				if (difference < 0) {
-					difference = -difference;
-				}
-
-				int32_t percussiveness = ((uint64_t)difference * 262144 / angle) >> 1;
-
-				percussiveness = getTanH<23>(percussiveness);
-
-				percCacheNow[startPosSamples >> kPercBufferReductionMagnitude] = percussiveness;
+				percCacheNow[startPosSamples >> kPercBufferReductionMagnitude] =
+				    percCacheZone->getPercussiveness(angle);
 			}
 
 			percCacheZone->lastAngle = angle;
@@ -728,6 +737,88 @@ getOut:
 	return error; // Usually it'll be Error::NONE.
 }
 
+int32_t Sample::getPercCacheLength() {
+	// int32_t lengthInSamplesAfterReduction = ((lengthInSamples + (kPercBufferReductionSize >> 1)) >>
+	// PERC_BUFFER_REDUCTION_MAGNITUDE);
+	int32_t lengthInSamplesAfterReduction = ((lengthInSamples - 1) >> kPercBufferReductionMagnitude) + 1;
+	return std::max(lengthInSamplesAfterReduction, 1_i32); // Can't allocate less than 1 byte
+}
+
+// Replaces the whole perc cache for one play-direction with the given one, getPercCacheLength() bytes long, as worked
+// out in one go by SamplePercCacheFile. Returns false if there wasn't the RAM, in which case fillPercCache() carries on
+// as before
+bool Sample::installPercCache(int32_t reversed, uint8_t const* percussiveness) {
+	int32_t lengthInSamplesAfterReduction = getPercCacheLength();
+	bool percCacheDoneWithClusters = (lengthInSamplesAfterReduction >= (audioFileManager.clusterSize >> 1));
+
+	LOCK_ENTRY
+
+	// Get all the memory first, so we don't leave it half done
+	if (percCacheDoneWithClusters) {
+		if (!percCacheClusters[reversed]) {
+			numPercCacheClusters = ((lengthInSamplesAfterReduction - 1) >> audioFileManager.clusterSizeMagnitude) + 1;
+			int32_t memorySize = numPercCacheClusters * sizeof(Cluster*);
+			percCacheClusters[reversed] = (Cluster**)GeneralMemoryAllocator::get().allocMaxSpeed(memorySize);
+			if (!percCacheClusters[reversed]) {
+				LOCK_EXIT
+				return false;
+			}
+			memset(percCacheClusters[reversed], 0, memorySize);
+		}
+
+		for (int32_t c = 0; c < numPercCacheClusters; c++) {
+			if (!percCacheClusters[reversed][c]) {
+				// As in fillPercCache(), don't steal our other perc cache Clusters, which would alter percCacheZones
+				Cluster* cluster = audioFileManager.allocateCluster(
+				    reversed ? ClusterType::PERC_CACHE_REVERSED : ClusterType::PERC_CACHE_FORWARDS, false, this);
+				if (!cluster) {
+					LOCK_EXIT
+					return false;
+				}
+				cluster->sample = this;
+				cluster->clusterIndex = c;
+				percCacheClusters[reversed][c] = cluster;
+
+				// No TimeStretcher has a reason on it yet, so it can go straight in the queue to be stolen when
+				// there's nothing better
+				GeneralMemoryAllocator::get().putStealableInAppropriateQueue(cluster);
+			}
+		}
+
+		for (int32_t c = 0; c < numPercCacheClusters; c++) {
+			int32_t start = c << audioFileManager.clusterSizeMagnitude;
+			int32_t numBytes = std::min<int32_t>(audioFileManager.clusterSize, lengthInSamplesAfterReduction - start);
+			memcpy(percCacheClusters[reversed][c]->data, &percussiveness[start], numBytes);
+		}
+	}
+
+	else {
+		if (!percCacheMemory[reversed]) {
+			percCacheMemory[reversed] = (uint8_t*)GeneralMemoryAllocator::get().allocLowSpeed(
+			    lengthInSamplesAfterReduction);
+			if (!percCacheMemory[reversed]) {
+				LOCK_EXIT
+				return false;
+			}
+		}
+		memcpy(percCacheMemory[reversed], percussiveness, lengthInSamplesAfterReduction);
+	}
+
+	// And now it's all valid, as one zone
+	percCacheZones[reversed].empty();
+	Error error = percCacheZones[reversed].insertAtIndex(0, 1, this);
+	if (error != Error::NONE) {
+		LOCK_EXIT
+		return false;
+	}
+	SamplePercCacheZone* zone = new (percCacheZones[reversed].getElementAddress(0))
+	    SamplePercCacheZone(reversed ? (int32_t)lengthInSamples - 1 : 0);
+	zone->endPos = reversed ? -1 : (int32_t)lengthInSamples;
+
+	LOCK_EXIT
+	return true;
+}
+
 bool Sample::getAveragesForCrossfade(int32_t* totals, int32_t startBytePos, int32_t crossfadeLengthSamples,
                                      int32_t playDirection, int32_t lengthToAverageEach) {
 
@@ -921,6 +1012,7 @@ void Sample::percCacheClusterStolen(Cluster* cluster) {
 #endif
 
 	percCacheClusters[reversed][cluster->clusterIndex] = NULL;
+	percCacheFromFile = false; // So it'll be read back in from the file, if there's one
 
 	// TODO: while inside this, don't allow further editing to percCacheZones[reversed]
 
@@ -1009,6 +1101,48 @@ deleteThatOneToo:
 	LOCK_EXIT
 }
 
+// Call once every Cluster's sdAddress is known. If there's not enough RAM, there just won't be any extents
+void Sample::findExtents() {
+	extents.empty();
+
+	uint32_t sectorsPerCluster = audioFileManager.clusterSize >> 9;
+	int32_t numClusters = clusters.getNumElements();
+
+	int32_t c = 0;
+	while (c < numClusters) {
+		int32_t firstClusterIndex = c;
+		uint32_t sdAddress = clusters.getElement(c)->sdAddress;
+		do {
+			c++;
+			sdAddress += sectorsPerCluster;
+		} while (c < numClusters && clusters.getElement(c)->sdAddress == sdAddress);
+
+		// If the FAT walk gave up early, the rest aren't worth knowing about
+		if (!clusters.getElement(firstClusterIndex)->sdAddress) {
+			break;
+		}
+
+		int32_t i = extents.insertAtKey(firstClusterIndex, true);
+		if (i == -1) {
+			extents.empty();
+			return;
+		}
+		SampleExtent* extent = (SampleExtent*)extents.getElementAddress(i);
+		extent->numClusters = c - firstClusterIndex;
+	}
+}
+
+// How many Clusters, starting with this one, could be read from the card in one go. At least 1, at most maxNum
+int32_t Sample::getNumContiguousClusters(int32_t clusterIndex, int32_t maxNum) {
+	int32_t i = extents.search(clusterIndex + 1, LESS);
+	if (i < 0) {
+		return 1;
+	}
+	SampleExtent* extent = (SampleExtent*)extents.getElementAddress(i);
+	int32_t numLeft = extent->firstClusterIndex + extent->numClusters - clusterIndex;
+	return std::clamp<int32_t>(numLeft, 1, maxNum);
+}
+
 int32_t Sample::getFirstClusterIndexWithAudioData() {
 	return audioDataStartPosBytes >> audioFileManager.clusterSizeMagnitude;
 }
@@ -1721,9 +1855,58 @@ int32_t Sample::getValueSpan() {
 	return (maxValueFound >> kDisplayHeightMagnitude) - (minValueFound >> kDisplayHeightMagnitude);
 }
 
+// For a losslessly compressed file, once its header's been read: swaps the Clusters standing for the file's bytes for
+// ones standing for its decoded audio, which AudioFileManager decodes into as it loads them. The audio keeps its place
+// after the header, so the first of them still gets the file's first sdAddress, which is what cache files and the like
+// know it by
+Error Sample::setUpDecodedClusters() {
+	Error error = blockIndex->check(this);
+	if (error != Error::NONE) {
+		return error;
+	}
+
+	uint64_t decodedLengthBytes = (uint64_t)blockIndex->numFrames * numChannels * byteDepth;
+	if (audioDataStartPosBytes + decodedLengthBytes > kMaxFileSize) {
+		return Error::FILE_TOO_BIG;
+	}
+
+	int32_t numFileClusters = clusters.getNumElements();
+	blockIndex->fileSDAddresses =
+	    (uint32_t*)GeneralMemoryAllocator::get().allocLowSpeed(numFileClusters * sizeof(uint32_t));
+	if (!blockIndex->fileSDAddresses) {
+		return Error::INSUFFICIENT_RAM;
+	}
+	blockIndex->numFileClusters = numFileClusters;
+	blockIndex->dataStartPosBytes = audioDataStartPosBytes;
+
+	// Any of these loaded while reading the header hold file bytes, and nothing has a reason on them by now
+	for (int32_t c = 0; c < numFileClusters; c++) {
+		SampleCluster* sampleCluster = clusters.getElement(c);
+		blockIndex->fileSDAddresses[c] = sampleCluster->sdAddress;
+		sampleCluster->~SampleCluster();
+	}
+	clusters.empty();
+	extents.empty();
+
+	int32_t numClusters =
+	    ((audioDataStartPosBytes + decodedLengthBytes - 1) >> audioFileManager.clusterSizeMagnitude) + 1;
+	error = clusters.insertSampleClustersAtEnd(numClusters);
+	if (error != Error::NONE) {
+		return error;
+	}
+	clusters.getElement(0)->sdAddress = blockIndex->fileSDAddresses[0];
+
+	audioDataLengthBytes = decodedLengthBytes;
+	clustersDecoded = true;
+	return Error::NONE;
+}
+
 void Sample::finalizeAfterLoad(uint32_t fileSize) {
 
-	audioDataLengthBytes = std::min<uint64_t>(audioDataLengthBytes, fileSize - audioDataStartPosBytes);
+	// A compressed file's audio comes out longer than the file
+	if (!clustersDecoded) {
+		audioDataLengthBytes = std::min<uint64_t>(audioDataLengthBytes, fileSize - audioDataStartPosBytes);
+	}
 
 	// If floating point file, Clusers can only be float-processed (as they're loaded) once we've found the data
 	// start-pos, which we just did, and since we've already loaded that first cluster which contains data, we'd better
@@ -1732,7 +1915,9 @@ void Sample::finalizeAfterLoad(uint32_t fileSize) {
 
 	uint32_t bytesPerSample = byteDepth * numChannels;
 
-	audioDataLengthBytes = std::min<uint64_t>(audioDataLengthBytes, fileSize - audioDataStartPosBytes);
+	if (!clustersDecoded) {
+		audioDataLengthBytes = std::min<uint64_t>(audioDataLengthBytes, fileSize - audioDataStartPosBytes);
+	}
 
 	lengthInSamples = audioDataLengthBytes / bytesPerSample;
 	audioDataLengthBytes = lengthInSamples * bytesPerSample; // Make sure it's an exact number of samples
@@ -1761,7 +1946,7 @@ void Sample::numReasonsDecreasedToZero(char const* errorCode) {
 
 			numClusterReasons += cluster->numReasonsToBeLoaded;
 
-			if (cluster == audioFileManager.clusterBeingLoaded) {
+			if (audioFileManager.isClusterBeingLoaded(cluster)) {
 				numClusterReasons--;
 			}
 		}
@@ -1776,7 +1961,7 @@ void Sample::numReasonsDecreasedToZero(char const* errorCode) {
 			if (cluster) {
 				D_PRINT("cluster->numReasonsToBeLoaded[%d]", cluster->numReasonsToBeLoaded);
 
-				if (cluster == audioFileManager.clusterBeingLoaded) {
+				if (audioFileManager.isClusterBeingLoaded(cluster)) {
 					D_PRINTLN(" (loading)");
 				}
 				else if (!cluster->loaded) {
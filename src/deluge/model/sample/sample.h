@@ -38,11 +38,19 @@
 #define MIDI_NOTE_ERROR -1000
 
 class LoadedSamplePosReason;
+class SampleBlockIndex;
 class SampleCache;
+class SamplePeakPyramid;
 class MultisampleRange;
 class TimeStretcher;
 class SampleHolder;
 
+// A run of a Sample's Clusters which sit one after another on the card
+struct SampleExtent {
+	int32_t firstClusterIndex; // Key
+	int32_t numClusters;
+};
+
 class Sample final : public AudioFile {
 public:
 	Sample();
@@ -59,10 +67,15 @@ public:
 	void deleteCache(SampleCache* cache);
 	int32_t getFirstClusterIndexWithAudioData();
 	int32_t getFirstClusterIndexWithNoAudioData();
+	void findExtents();
+	int32_t getNumContiguousClusters(int32_t clusterIndex, int32_t maxNum);
 	Error fillPercCache(TimeStretcher* timeStretcher, int32_t startPosSamples, int32_t endPosSamples,
 	                    int32_t playDirection, int32_t maxNumSamplesToProcess);
 	void percCacheClusterStolen(Cluster* cluster);
+	bool installPercCache(int32_t reversed, uint8_t const* percussiveness);
+	int32_t getPercCacheLength();
 	void deletePercCache(bool beingDestructed = false);
+	void deletePeakPyramid();
 	uint8_t* prepareToReadPercCache(int32_t pixellatedPos, int32_t playDirection, int32_t* earliestPixellatedPos,
 	                                int32_t* latestPixellatedPos);
 	bool getAveragesForCrossfade(int32_t* totals, int32_t startBytePos, int32_t crossfadeLengthSamples,
@@ -71,6 +84,7 @@ public:
 	int32_t getMaxPeakFromZero();
 	int32_t getFoundValueCentrePoint();
 	int32_t getValueSpan();
+	Error setUpDecodedClusters();
 	void finalizeAfterLoad(uint32_t fileSize);
 
 	inline void convertOneData(int32_t* value) {
@@ -133,6 +147,12 @@ public:
 	Cluster** percCacheClusters[2]; // One for each play-direction: 0=forwards; 1=reversed
 	int32_t numPercCacheClusters;
 
+	// Whether the whole perc cache was last filled in at once by SamplePercCacheFile, or it's tried and given up
+	bool percCacheFromFile;
+	bool percCacheFileFailed;
+
+	SamplePeakPyramid* peakPyramid; // For drawing the waveform. NULL if not built yet, or stolen
+
 	int32_t beginningOffsetForPitchDetection;
 	bool beginningOffsetForPitchDetectionFound;
 
@@ -140,6 +160,14 @@ public:
 
 	SampleClusterArray clusters;
 
+	// Worked out from the Clusters' sdAddresses, which themselves came from walking the file's FAT chain at load time.
+	// Empty for a Sample we're recording, whose Clusters may yet move
+	OrderedResizeableArrayWith32bitKey extents;
+
+	// For a losslessly compressed file. NULL otherwise
+	SampleBlockIndex* blockIndex;
+	bool clustersDecoded; // Once setUpDecodedClusters() has been called
+
 protected:
 #if ALPHA_OR_BETA_VERSION
 	void numReasonsDecreasedToZero(char const* errorCode);
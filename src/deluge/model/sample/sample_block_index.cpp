@@ -0,0 +1,107 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "model/sample/sample_block_index.h"
+#include "memory/general_memory_allocator.h"
+#include "model/sample/sample.h"
+#include "storage/audio/audio_file_manager.h"
+#include "storage/audio/audio_file_reader.h"
+#include "storage/audio/lossless_codec.h"
+
+SampleBlockIndex::SampleBlockIndex() {
+	numFrames = 0;
+	blockNumFrames = 0;
+	numBlocks = 0;
+	blockOffsets = NULL;
+	maxBlockNumBytes = 0;
+	dataStartPosBytes = 0;
+	fileSDAddresses = NULL;
+	numFileClusters = 0;
+}
+
+SampleBlockIndex::~SampleBlockIndex() {
+	if (blockOffsets) {
+		delugeDealloc(blockOffsets);
+	}
+	if (fileSDAddresses) {
+		delugeDealloc(fileSDAddresses);
+	}
+}
+
+Error SampleBlockIndex::readFromFile(AudioFileReader* reader, uint32_t chunkLength) {
+	uint32_t header[4];
+	if (chunkLength < sizeof(header)) {
+		return Error::FILE_CORRUPTED;
+	}
+	Error error = reader->readBytes((char*)header, sizeof(header));
+	if (error != Error::NONE) {
+		return error;
+	}
+
+	if (header[0] != kVersion) {
+		return Error::FILE_UNSUPPORTED;
+	}
+	numFrames = header[1];
+	blockNumFrames = header[2];
+	numBlocks = header[3];
+
+	if (!numFrames || !blockNumFrames || blockNumFrames > LosslessCodec::kMaxBlockNumFrames
+	    || numBlocks != (numFrames - 1) / blockNumFrames + 1
+	    || chunkLength - sizeof(header) < (numBlocks + 1) * sizeof(uint32_t)) {
+		return Error::FILE_CORRUPTED;
+	}
+
+	blockOffsets = (uint32_t*)GeneralMemoryAllocator::get().allocLowSpeed((numBlocks + 1) * sizeof(uint32_t));
+	if (!blockOffsets) {
+		return Error::INSUFFICIENT_RAM;
+	}
+	return reader->readBytes((char*)blockOffsets, (numBlocks + 1) * sizeof(uint32_t));
+}
+
+// Once the whole header's been read, makes sure the blocks all fit in the data chunk, and that no Cluster's worth of
+// them will be more than AudioFileManager can read in one go
+Error SampleBlockIndex::check(Sample* sample) {
+	if ((sample->byteDepth != 2 && sample->byteDepth != 3) || sample->rawDataFormat != RAW_DATA_FINE) {
+		return Error::FILE_UNSUPPORTED;
+	}
+
+	if (blockOffsets[0]) {
+		return Error::FILE_CORRUPTED;
+	}
+	maxBlockNumBytes = 0;
+	for (uint32_t b = 0; b < numBlocks; b++) {
+		if (blockOffsets[b + 1] < blockOffsets[b]) {
+			return Error::FILE_CORRUPTED;
+		}
+		maxBlockNumBytes = std::max(maxBlockNumBytes, blockOffsets[b + 1] - blockOffsets[b]);
+	}
+	if (blockOffsets[numBlocks] > sample->audioDataLengthBytes
+	    || maxBlockNumBytes
+	           > LosslessCodec::getMaxBlockNumBytes(blockNumFrames, sample->numChannels, sample->byteDepth)) {
+		return Error::FILE_CORRUPTED;
+	}
+
+	uint32_t blockNumBytesDecoded = blockNumFrames * sample->numChannels * sample->byteDepth;
+	uint32_t maxNumBlocksPerCluster = (audioFileManager.clusterSize - 1) / blockNumBytesDecoded + 2;
+	if ((uint64_t)maxNumBlocksPerCluster * maxBlockNumBytes + 1024 > kCoalescedReadMaxNumBytes) {
+		return Error::FILE_UNSUPPORTED;
+	}
+	if (!audioFileManager.coalescedRead.buffer || !audioFileManager.compressedBlockBuffer) {
+		return Error::INSUFFICIENT_RAM;
+	}
+	return Error::NONE;
+}
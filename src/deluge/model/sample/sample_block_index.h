@@ -0,0 +1,55 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "definitions_cxx.hpp"
+#include <algorithm>
+#include <cstdint>
+
+class AudioFileReader;
+class Sample;
+
+// Where each block of a losslessly compressed Sample (see LosslessCodec) sits in its file. WAV files holding these have
+// WAV_FORMAT_DELUGE_LOSSLESS as their format, 16 or 24 as their bits per sample, and this in a "dlix" chunk:
+//
+//   uint32_t version, numFrames, blockNumFrames, numBlocks
+//   uint32_t blockOffsets[numBlocks + 1] - in bytes from the start of the data chunk, which holds the blocks
+//
+// Every block is blockNumFrames long, other than the last. Once Sample::setUpDecodedClusters() has been called, the
+// Sample's Clusters stand for the decoded audio, and only this knows where the file's own clusters are
+class SampleBlockIndex {
+public:
+	constexpr static uint32_t kVersion = 1;
+
+	SampleBlockIndex();
+	~SampleBlockIndex();
+
+	Error readFromFile(AudioFileReader* reader, uint32_t chunkLength);
+	Error check(Sample* sample);
+	int32_t getBlockNumFrames(uint32_t b) { return std::min<uint32_t>(blockNumFrames, numFrames - b * blockNumFrames); }
+
+	uint32_t numFrames;
+	uint32_t blockNumFrames;
+	uint32_t numBlocks;
+	uint32_t* blockOffsets;
+	uint32_t maxBlockNumBytes;
+
+	uint32_t dataStartPosBytes; // Of the file's data chunk
+	uint32_t* fileSDAddresses;  // For each of the file's clusters
+	int32_t numFileClusters;
+};
@@ -19,12 +19,14 @@
 #include "io/debug/log.h"
 #include "memory/general_memory_allocator.h"
 #include "model/sample/sample.h"
+#include "model/sample/sample_cache_file.h"
 #include "storage/audio/audio_file_manager.h"
 #include "storage/cluster/cluster.h"
 #include "util/misc.h"
 
 SampleCache::SampleCache(Sample* newSample, int32_t newNumClusters, int32_t newWaveformLengthBytes,
-                         int32_t newPhaseIncrement, int32_t newTimeStretchRatio, int32_t newSkipSamplesAtStart) {
+                         int32_t newPhaseIncrement, int32_t newTimeStretchRatio, int32_t newSkipSamplesAtStart,
+                         bool newReversed) {
 	sample = newSample;
 	phaseIncrement = newPhaseIncrement;
 	timeStretchRatio = newTimeStretchRatio;
@@ -34,6 +36,9 @@ SampleCache::SampleCache(Sample* newSample, int32_t newNumClusters, int32_t newW
 #endif
 	waveformLengthBytes = newWaveformLengthBytes;
 	skipSamplesAtStart = newSkipSamplesAtStart;
+	reversed = newReversed;
+	restoringFromCard = false;
+	persistedBytes = 0;
 	/*
 	for (int32_t i = 0; i < numClusters; i++) {
 	    clusters[i] = NULL; // We don't actually have to initialize these, since writeBytePos tells us how many are
@@ -43,6 +48,7 @@ SampleCache::SampleCache(Sample* newSample, int32_t newNumClusters, int32_t newW
 }
 
 SampleCache::~SampleCache() {
+	SampleCacheFile::cacheDeleted(this);
 	unlinkClusters(0, true);
 }
 
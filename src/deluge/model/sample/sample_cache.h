@@ -25,11 +25,12 @@ class Cluster;
 class SampleCache {
 public:
 	SampleCache(Sample* newSample, int32_t newNumClusters, int32_t newWaveformLengthBytes, int32_t newPhaseIncrement,
-	            int32_t newTimeStretchRatio, int32_t newSkipSamplesAtStart);
+	            int32_t newTimeStretchRatio, int32_t newSkipSamplesAtStart, bool newReversed);
 	~SampleCache();
 	void clusterStolen(int32_t clusterIndex);
 	bool setupNewCluster(int32_t cachedClusterIndex);
 	Cluster* getCluster(int32_t clusterIndex);
+	Cluster* getClusterWithoutPrioritizing(int32_t clusterIndex) { return clusters[clusterIndex]; }
 	void setWriteBytePos(int32_t newWriteBytePos);
 
 	int32_t writeBytePos;
@@ -41,6 +42,11 @@ public:
 	int32_t phaseIncrement;
 	int32_t timeStretchRatio;
 	int32_t skipSamplesAtStart;
+	bool reversed;
+
+	// While true, SampleCacheFile is filling this from the card, and no voice may write to it
+	bool restoringFromCard;
+	int32_t persistedBytes; // How much of it is in its file on the card, as far as we know
 
 private:
 	void unlinkClusters(int32_t startAtIndex, bool beingDestructed);
@@ -0,0 +1,411 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "model/sample/sample_cache_file.h"
+#include "definitions_cxx.hpp"
+#include "io/debug/log.h"
+#include "memory/general_memory_allocator.h"
+#include "model/sample/sample.h"
+#include "model/sample/sample_cache.h"
+#include "model/sample/sample_files.h"
+#include "model/settings/runtime_feature_settings.h"
+#include "storage/audio/audio_file_manager.h"
+#include "storage/cluster/cluster.h"
+#include <algorithm>
+#include <cstring>
+
+extern "C" {
+#include "fatfs/ff.h"
+}
+
+namespace SampleCacheFile {
+
+namespace {
+
+constexpr char const* kFileExtension = ".CAC";
+constexpr uint32_t kFileVersion = 3;
+
+// Caches waiting to be read or written. Voices can add to this from the audio routine, which may run while we're
+// waiting for the card - so it only ever gets shuffled down from here, outside of any card access
+constexpr int32_t kMaxNumJobs = 8;
+
+enum class JobType : uint8_t { RESTORE, WRITE };
+
+struct Job {
+	JobType type;
+	SampleCache* cache; // Set to nullptr if the SampleCache gets deleted meanwhile
+};
+
+Job jobs[kMaxNumJobs];
+int32_t numJobs = 0;
+
+// Just for the job at the head of the queue, once it's started
+FIL file;
+bool fileOpen = false;
+String jobFilePath; // Kept, since the SampleCache might be deleted before we're done
+int32_t jobLengthBytes;
+int32_t nextClusterIndex;
+uint8_t* bounceBuffer = nullptr; // For writing. Cache Clusters might be stolen while the card's busy with them
+
+// At the start of the file on the card. If any of this but lengthBytes and writeNumber doesn't match the Sample and
+// SampleCache, the file is out of date
+struct FileHeader : SampleFiles::FileHeader {
+	uint8_t reversed;
+	int32_t phaseIncrement;
+	int32_t timeStretchRatio;
+	int32_t skipSamplesAtStart;
+	int32_t waveformLengthBytes;
+	uint32_t clusterSize;
+	int32_t lengthBytes;  // How much of the cache follows
+	uint32_t writeNumber; // See makeRoomFor()
+};
+
+bool makeFileHeader(FileHeader* header, SampleCache* cache, int32_t lengthBytes) {
+	if (!SampleFiles::makeHeader(header, cache->sample, "DCAC", kFileVersion)) {
+		return false;
+	}
+	header->reversed = cache->reversed;
+	header->phaseIncrement = cache->phaseIncrement;
+	header->timeStretchRatio = cache->timeStretchRatio;
+	header->skipSamplesAtStart = cache->skipSamplesAtStart;
+	header->waveformLengthBytes = cache->waveformLengthBytes;
+	header->clusterSize = audioFileManager.clusterSize;
+	header->lengthBytes = lengthBytes;
+	return true;
+}
+
+bool getPathInFolder(String* path, char const* name) {
+	return (path->set(kFolder) == Error::NONE && path->concatenate("/") == Error::NONE
+	        && path->concatenate(name) == Error::NONE);
+}
+
+// Named after an FNV-1a hash of the Sample's path and the cache's parameters. The header catches any collisions
+bool getFilePath(String* path, SampleCache* cache) {
+	uint32_t hash = 2166136261u;
+	auto addByte = [&](uint8_t byte) { hash = (hash ^ byte) * 16777619u; };
+	for (char const* c = cache->sample->filePath.get(); *c; c++) {
+		addByte(*c);
+	}
+	for (int32_t word : {cache->phaseIncrement, cache->timeStretchRatio, cache->skipSamplesAtStart,
+	                     (int32_t)cache->reversed}) {
+		for (int32_t b = 0; b < 4; b++) {
+			addByte(word >> (b * 8));
+		}
+	}
+
+	char hashChars[9];
+	intToHex(hash, hashChars);
+	return (getPathInFolder(path, hashChars) && path->concatenate(kFileExtension) == Error::NONE);
+}
+
+// Each Cluster is stored with the (bytesPerSample - 1) extra bytes after it, which hold the rest of any sample
+// straddling into the next one
+int32_t getBytesPerSample(SampleCache* cache) {
+	return cache->sample->numChannels * kCacheByteDepth;
+}
+
+int32_t getClusterStride(SampleCache* cache) {
+	return audioFileManager.clusterSize + getBytesPerSample(cache) - 1;
+}
+
+int32_t getNumClusters(SampleCache* cache, int32_t lengthBytes) {
+	return (lengthBytes + audioFileManager.clusterSize - getBytesPerSample(cache))
+	       >> audioFileManager.clusterSizeMagnitude;
+}
+
+// How far writeBytePos gets once the given number of Clusters are there: to the end of the last sample which starts
+// in the last of them
+int32_t getEndBytePos(SampleCache* cache, int32_t numClusters, int32_t lengthBytes) {
+	int32_t bytesPerSample = getBytesPerSample(cache);
+	int32_t end = (uint32_t)((numClusters << audioFileManager.clusterSizeMagnitude) + bytesPerSample - 1)
+	              / bytesPerSample * bytesPerSample;
+	return std::min(end, lengthBytes);
+}
+
+bool hasJobFor(SampleCache* cache) {
+	for (int32_t i = 0; i < numJobs; i++) {
+		if (jobs[i].cache == cache) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool addJob(JobType type, SampleCache* cache) {
+	if (numJobs >= kMaxNumJobs || hasJobFor(cache)) {
+		return false;
+	}
+	jobs[numJobs++] = {type, cache};
+	return true;
+}
+
+void finishJob(bool success) {
+	Job& job = jobs[0];
+
+	if (fileOpen) {
+		f_close(&file);
+		fileOpen = false;
+		if (!success && job.type == JobType::WRITE) {
+			f_unlink(jobFilePath.get()); // Don't leave half a file for next time
+		}
+	}
+
+	if (bounceBuffer) {
+		delugeDealloc(bounceBuffer);
+		bounceBuffer = nullptr;
+	}
+
+	if (job.cache) {
+		if (job.type == JobType::RESTORE) {
+			job.cache->restoringFromCard = false; // Voices may write to it again now
+		}
+		if (success) {
+			job.cache->persistedBytes = jobLengthBytes;
+		}
+	}
+
+	numJobs--;
+	memmove(&jobs[0], &jobs[1], numJobs * sizeof(Job));
+}
+
+bool startRestoreJob(SampleCache* cache) {
+	if (!getFilePath(&jobFilePath, cache) || f_open(&file, jobFilePath.get(), FA_READ) != FR_OK) {
+		return false;
+	}
+	fileOpen = true;
+
+	FileHeader expected;
+	FileHeader header;
+	if (!makeFileHeader(&expected, cache, 0) || !SampleFiles::readHeader(&file, &header)) {
+		return false;
+	}
+
+	jobLengthBytes = header.lengthBytes;
+	header.lengthBytes = 0;
+	header.writeNumber = 0;
+	if (!SampleFiles::headersMatch(header, expected) || jobLengthBytes <= 0
+	    || jobLengthBytes > cache->waveformLengthBytes || jobLengthBytes % getBytesPerSample(cache)) {
+		D_PRINTLN("sample cache file out of date: %s", jobFilePath.get());
+		return false;
+	}
+	nextClusterIndex = 0;
+	return true;
+}
+
+// Or 0 if the file's out of date or not one of ours. Just the start of it gets read
+uint32_t readWriteNumber(char const* name) {
+	String path;
+	FIL headerFile;
+	if (!getPathInFolder(&path, name) || f_open(&headerFile, path.get(), FA_READ) != FR_OK) {
+		return 0;
+	}
+	FileHeader header;
+	bool ok = SampleFiles::readHeader(&headerFile, &header);
+	f_close(&headerFile);
+	if (!ok || memcmp(header.magic, "DCAC", sizeof(header.magic)) || header.version != kFileVersion) {
+		return 0;
+	}
+	return header.writeNumber;
+}
+
+// Deletes the oldest files in kFolder until there's room for another of the given size, and returns the write number
+// for it. The files' FAT timestamps are no use for this - the card has no clock, so they're all the same
+uint32_t makeRoomFor(uint32_t numBytes) {
+	DIR dir;
+	if (f_opendir(&dir, kFolder) != FR_OK) {
+		return 1;
+	}
+	FolderScan scan;
+	FILINFO fileInfo;
+	while (f_readdir(&dir, &fileInfo) == FR_OK && fileInfo.fname[0]) {
+		if (!(fileInfo.fattrib & AM_DIR)) {
+			scan.addFile(fileInfo.fname, fileInfo.fsize, readWriteNumber(fileInfo.fname));
+		}
+	}
+	f_closedir(&dir);
+
+	while (!scan.hasRoomFor(numBytes)) {
+		char const* name = scan.removeOldest();
+		String path;
+		if (!name || !getPathInFolder(&path, name)) {
+			break;
+		}
+		D_PRINTLN("deleting old sample cache file: %s", path.get());
+		f_unlink(path.get());
+	}
+	return scan.highestWriteNumber + 1;
+}
+
+bool startWriteJob(SampleCache* cache) {
+	jobLengthBytes = cache->writeBytePos;
+	if (cache->restoringFromCard || cache->persistedBytes >= jobLengthBytes) {
+		return false;
+	}
+
+	bounceBuffer = (uint8_t*)GeneralMemoryAllocator::get().allocLowSpeed(getClusterStride(cache));
+	if (!bounceBuffer) {
+		return false;
+	}
+
+	if (!getFilePath(&jobFilePath, cache)) {
+		return false;
+	}
+	f_mkdir(kFolder); // Usually it'll be there already. Starting with a dot keeps it out of the browsers
+	uint32_t writeNumber = makeRoomFor(sizeof(FileHeader) + jobLengthBytes);
+	if (f_open(&file, jobFilePath.get(), FA_CREATE_ALWAYS | FA_WRITE) != FR_OK) {
+		return false;
+	}
+	fileOpen = true;
+
+	FileHeader header;
+	if (!makeFileHeader(&header, cache, jobLengthBytes)) {
+		return false;
+	}
+	header.writeNumber = writeNumber;
+	if (!SampleFiles::writeHeader(&file, header)) {
+		return false;
+	}
+	nextClusterIndex = 0;
+	return true;
+}
+
+// Returns false if the job's over, one way or another
+bool restoreNextCluster(Job& job, bool* success) {
+	SampleCache* cache = job.cache;
+	int32_t clusterIndex = nextClusterIndex;
+	int32_t clusterStartBytePos = clusterIndex << audioFileManager.clusterSizeMagnitude;
+
+	// A voice might have played up to the end of what we'd restored so far, and had one of its Clusters stolen
+	if (cache->writeBytePos != getEndBytePos(cache, clusterIndex, jobLengthBytes)) {
+		return false;
+	}
+
+	if (!cache->setupNewCluster(clusterIndex)) {
+		return false;
+	}
+	// Not in a stealable queue until getCluster() below, so it's ours while the card's busy
+	Cluster* cluster = cache->getClusterWithoutPrioritizing(clusterIndex);
+
+	UINT numBytes = std::min(getClusterStride(cache), jobLengthBytes - clusterStartBytePos);
+	UINT numBytesRead;
+	bool readOk = (f_read(&file, cluster->data, numBytes, &numBytesRead) == FR_OK && numBytesRead == numBytes);
+
+	// Voices may have been at the cache in the meantime
+	if (!readOk || !job.cache || cache->writeBytePos != getEndBytePos(cache, clusterIndex, jobLengthBytes)) {
+		audioFileManager.deallocateCluster(cluster);
+		return false;
+	}
+
+	cache->getCluster(clusterIndex);
+	cache->setWriteBytePos(getEndBytePos(cache, clusterIndex + 1, jobLengthBytes));
+
+	nextClusterIndex++;
+	if (nextClusterIndex >= getNumClusters(cache, jobLengthBytes)) {
+		*success = true;
+		return false;
+	}
+	return true;
+}
+
+// Returns false if the job's over, one way or another
+bool writeNextCluster(Job& job, bool* success) {
+	SampleCache* cache = job.cache;
+	int32_t clusterIndex = nextClusterIndex;
+	int32_t clusterStartBytePos = clusterIndex << audioFileManager.clusterSizeMagnitude;
+
+	if (cache->writeBytePos < jobLengthBytes) {
+		return false; // Some of it got stolen before we got to it
+	}
+
+	UINT numBytes = std::min(getClusterStride(cache), jobLengthBytes - clusterStartBytePos);
+	memcpy(bounceBuffer, cache->getClusterWithoutPrioritizing(clusterIndex)->data, numBytes);
+
+	UINT numBytesWritten;
+	if (f_write(&file, bounceBuffer, numBytes, &numBytesWritten) != FR_OK || numBytesWritten != numBytes
+	    || !job.cache) {
+		return false;
+	}
+
+	nextClusterIndex++;
+	if (nextClusterIndex >= getNumClusters(cache, jobLengthBytes)) {
+		*success = true;
+		return false;
+	}
+	return true;
+}
+
+} // namespace
+
+bool shouldUseCard() {
+	return SampleFiles::isOn(RuntimeFeatureSettingType::SampleCacheFiles);
+}
+
+bool startRestoring(SampleCache* cache) {
+	// Can't look at the card from here - we might be in the audio routine, while it's busy. continueWork() will find
+	// out whether there's a file
+	if (!shouldUseCard() || cache->sample->filePath.isEmpty() || !addJob(JobType::RESTORE, cache)) {
+		return false;
+	}
+	cache->restoringFromCard = true;
+	return true;
+}
+
+void cacheWritingFinished(SampleCache* cache) {
+	if (!shouldUseCard() || cache->restoringFromCard || cache->persistedBytes >= cache->writeBytePos
+	    || cache->sample->filePath.isEmpty()) {
+		return;
+	}
+	addJob(JobType::WRITE, cache);
+}
+
+void cacheDeleted(SampleCache* cache) {
+	for (int32_t i = 0; i < numJobs; i++) {
+		if (jobs[i].cache == cache) {
+			jobs[i].cache = nullptr;
+		}
+	}
+}
+
+void continueWork() {
+	// Playback streaming gets the card first. We'll carry on when it's had what it needs
+	if (!numJobs || audioFileManager.loadingQueue.getNumElements()) {
+		return;
+	}
+
+	Job& job = jobs[0];
+	if (!job.cache) {
+		finishJob(false);
+		return;
+	}
+
+	if (!fileOpen) {
+		bool started = (job.type == JobType::RESTORE) ? startRestoreJob(job.cache) : startWriteJob(job.cache);
+		if (!started) {
+			finishJob(false);
+		}
+		return;
+	}
+
+	bool success = false;
+	bool stillGoing =
+	    (job.type == JobType::RESTORE) ? restoreNextCluster(job, &success) : writeNextCluster(job, &success);
+	if (!stillGoing) {
+		finishJob(success);
+	}
+}
+
+} // namespace SampleCacheFile
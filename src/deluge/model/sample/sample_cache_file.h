@@ -0,0 +1,124 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+class SampleCache;
+
+// Keeps finished SampleCaches on the card, so that pitched or time-stretched playback needn't be rendered all over
+// again after a reboot or song load - if the community feature is on.
+//
+// A SampleCache is written out once a voice has written it right through to its end point, and looked for on the card
+// whenever a new one is created. While one's being read back, voices may play whatever's arrived so far, but none may
+// write to it - they play uncached instead. Files live in kFolder, which is hidden, named after a hash of the Sample's
+// path and the cache's parameters, and start with a header which must match the Sample (including its modified time)
+// and the cache exactly, or they're ignored.
+//
+// All the card access happens one Cluster at a time from continueWork(), and only while no Clusters are waiting to be
+// loaded for playback.
+//
+// So they don't fill the card, the oldest files are deleted before each new one is written, until there's room for it
+// within kMaxFolderBytes and kMaxNumFiles. There's no clock to timestamp them with, so each header holds a write
+// number instead: one more than the highest in the folder at the time.
+namespace SampleCacheFile {
+
+constexpr char const* kFolder = "SAMPLES/.CACHE";
+
+constexpr uint64_t kMaxFolderBytes = 256 << 20;
+constexpr int32_t kMaxNumFiles = 256;
+
+// Per file written, so making room doesn't hold up the card for long. The folder can go over its limits for a while if
+// there's lots to delete, e.g. after they're lowered
+constexpr int32_t kMaxDeletionsPerWrite = 4;
+
+// Totals up kFolder while it's read, and picks out the oldest files - which are the ones to go. They're named after a
+// hash, so their write numbers are all there is to go by. Files without one - out of date, or not ours - count as 0
+class FolderScan {
+public:
+	void addFile(char const* name, uint32_t size, uint32_t writeNumber) {
+		totalBytes += size;
+		numFiles++;
+		if (strlen(name) >= sizeof(OldFile::name)) {
+			return; // Not one of ours
+		}
+		highestWriteNumber = std::max(highestWriteNumber, writeNumber);
+
+		int32_t i = std::min(numOldest, kMaxDeletionsPerWrite - 1);
+		if (i == numOldest) {
+			numOldest++;
+		}
+		else if (writeNumber >= oldest[i].writeNumber) {
+			return;
+		}
+		for (; i > 0 && writeNumber < oldest[i - 1].writeNumber; i--) {
+			oldest[i] = oldest[i - 1];
+		}
+		oldest[i].size = size;
+		oldest[i].writeNumber = writeNumber;
+		strcpy(oldest[i].name, name);
+	}
+
+	// Whether another file of this size would fit within the limits
+	[[nodiscard]] bool hasRoomFor(uint32_t size) const {
+		return numFiles < kMaxNumFiles && totalBytes + size <= kMaxFolderBytes;
+	}
+
+	// Returns the name of the oldest one left, or nullptr if there's nothing we can delete
+	char const* removeOldest() {
+		if (nextOldest >= numOldest) {
+			return nullptr;
+		}
+		OldFile& file = oldest[nextOldest++];
+		totalBytes -= file.size;
+		numFiles--;
+		return file.name;
+	}
+
+	uint64_t totalBytes = 0;
+	int32_t numFiles = 0;
+	uint32_t highestWriteNumber = 0; // Of any file seen, deleted or not
+
+private:
+	struct OldFile {
+		uint32_t size;
+		uint32_t writeNumber;
+		char name[13]; // 8.3, which all of ours are
+	};
+
+	OldFile oldest[kMaxDeletionsPerWrite]; // Oldest first
+	int32_t numOldest = 0;
+	int32_t nextOldest = 0;
+};
+
+bool shouldUseCard();
+
+// For a SampleCache just created. Returns whether it's going to be read back from the card, in which case its
+// restoringFromCard will be true until that's done
+bool startRestoring(SampleCache* cache);
+
+// A voice has written the cache as far as it needs, so it's worth keeping
+void cacheWritingFinished(SampleCache* cache);
+
+void cacheDeleted(SampleCache* cache);
+
+void continueWork();
+
+} // namespace SampleCacheFile
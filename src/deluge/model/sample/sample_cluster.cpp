@@ -29,7 +29,7 @@ SampleCluster::~SampleCluster() {
 
 #if ALPHA_OR_BETA_VERSION
 		int32_t numReasonsToBeLoaded = cluster->numReasonsToBeLoaded;
-		if (cluster == audioFileManager.clusterBeingLoaded) {
+		if (audioFileManager.isClusterBeingLoaded(cluster)) {
 			numReasonsToBeLoaded--;
 		}
 
@@ -119,8 +119,14 @@ justEnqueue:
 				FREEZE_WITH_ERROR("E236"); // Cos Chris F got an E205
 			}
 
-			audioFileManager.enqueueCluster(
-			    cluster, priorityRating); // TODO: If that fails, it'll just get awkwardly forgotten about
+			// If there's no room in the queue, it'd never get loaded - so get rid of it, as for a failed must-load-now
+			if (audioFileManager.enqueueCluster(cluster, priorityRating) != Error::NONE) {
+				audioFileManager.deallocateCluster(cluster); // This removes the 1 reason that it'd still have
+				if (error != nullptr) {
+					*error = Error::INSUFFICIENT_RAM;
+				}
+				cluster = nullptr;
+			}
 #if 1 || ALPHA_OR_BETA_VERSION // Switching permanently on for now, as users on on V4.0.x have been getting E341.
 			if (cluster && cluster->numReasonsToBeLoaded <= 0) {
 				FREEZE_WITH_ERROR("i027"); // Diversifying Ron R's i004, which was diversifying Qui's E341
@@ -191,6 +197,11 @@ justEnqueue:
 			}
 		}
 
+		// Or if it's still waiting its turn to be loaded, and we need it sooner than whoever enqueued it, move it up
+		else if (loadInstruction == CLUSTER_ENQUEUE && !cluster->loaded) {
+			audioFileManager.loadingQueue.prioritize(cluster, priorityRating);
+		}
+
 		audioFileManager.addReasonToCluster(cluster);
 
 #if 1 || ALPHA_OR_BETA_VERSION // Switching permanently on for now, as users on V4.0.x have been getting E341.
@@ -0,0 +1,62 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "model/sample/sample_files.h"
+#include "model/sample/sample.h"
+#include "model/sample/sample_cache_file.h"
+#include "model/sample/sample_load_resampler.h"
+#include "model/sample/sample_peak_pyramid.h"
+#include "model/sample/sample_perc_cache_file.h"
+#include "model/settings/runtime_feature_settings.h"
+#include "storage/cluster/cluster.h"
+
+namespace SampleFiles {
+
+bool isOn(RuntimeFeatureSettingType type) {
+	return runtimeFeatureSettings.get(type) == RuntimeFeatureStateToggle::On;
+}
+
+bool startHeader(FileHeader* header, size_t size, Sample* sample, char const* magic, uint32_t version) {
+	char const* audioFilePath =
+	    sample->loadedFromAlternatePath.isEmpty() ? sample->filePath.get() : sample->loadedFromAlternatePath.get();
+	FILINFO fileInfo;
+	if (f_stat(audioFilePath, &fileInfo) != FR_OK) {
+		return false;
+	}
+
+	memset(header, 0, size);
+	memcpy(header->magic, magic, 4);
+	header->version = version;
+	header->lengthInSamples = sample->lengthInSamples;
+	header->audioDataStartPosBytes = sample->audioDataStartPosBytes;
+	header->firstClusterSDAddress = sample->clusters.getNumElements() ? sample->clusters.getElement(0)->sdAddress : 0;
+	header->modifiedTime = ((uint32_t)fileInfo.fdate << 16) | fileInfo.ftime;
+	header->sampleRate = sample->sampleRate;
+	header->numChannels = sample->numChannels;
+	header->byteDepth = sample->byteDepth;
+	header->rawDataFormat = sample->rawDataFormat;
+	return true;
+}
+
+void continueWork() {
+	SamplePeakPyramid::continueBuilding();
+	SampleCacheFile::continueWork();
+	SamplePercCacheFile::continueWork();
+	SampleLoadResampler::continueWork();
+}
+
+} // namespace SampleFiles
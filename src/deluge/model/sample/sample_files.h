@@ -0,0 +1,84 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+extern "C" {
+#include "fatfs/ff.h"
+}
+
+class Sample;
+enum RuntimeFeatureSettingType : uint32_t;
+
+// What's shared by the things kept on the card for Samples - waveform peaks, percussiveness and rendered SampleCaches -
+// and by the background work which makes them, reads them back, and resamples on load.
+namespace SampleFiles {
+
+// Each of these is a community feature, off by default
+bool isOn(RuntimeFeatureSettingType type);
+
+// The start of each kind of file's header. If any of it doesn't match the Sample, the file is out of date
+struct FileHeader {
+	char magic[4];
+	uint32_t version;
+	uint64_t lengthInSamples;
+	uint32_t audioDataStartPosBytes;
+	uint32_t firstClusterSDAddress; // Changes if the audio file is replaced with a different one of the same name
+	uint32_t modifiedTime;          // FAT date and time, of whichever file the Sample was loaded from
+	uint32_t sampleRate;
+	uint8_t numChannels;
+	uint8_t byteDepth;
+	uint8_t rawDataFormat;
+};
+
+bool startHeader(FileHeader* header, size_t size, Sample* sample, char const* magic, uint32_t version);
+
+// Zeroes all of the header - padding too, since they're compared whole - then fills in the FileHeader part. Returns
+// false if the audio file can't be found
+template <typename Header>
+bool makeHeader(Header* header, Sample* sample, char const* magic, uint32_t version) {
+	static_assert(std::is_base_of_v<FileHeader, Header> && std::is_trivially_copyable_v<Header>);
+	return startHeader(header, sizeof(Header), sample, magic, version);
+}
+
+template <typename Header>
+bool readHeader(FIL* file, Header* header) {
+	UINT numBytesRead;
+	return (f_read(file, header, sizeof(Header), &numBytesRead) == FR_OK && numBytesRead == sizeof(Header));
+}
+
+template <typename Header>
+bool writeHeader(FIL* file, Header const& header) {
+	UINT numBytesWritten;
+	return (f_write(file, &header, sizeof(Header), &numBytesWritten) == FR_OK && numBytesWritten == sizeof(Header));
+}
+
+template <typename Header>
+bool headersMatch(Header const& header, Header const& expected) {
+	return !memcmp(&header, &expected, sizeof(Header));
+}
+
+// The one background task for all of the above. Each part of it leaves the card alone while Clusters are waiting to be
+// loaded for playback
+void continueWork();
+
+} // namespace SampleFiles
@@ -25,6 +25,7 @@
 #include "storage/audio/audio_file_manager.h"
 #include "storage/cluster/cluster.h"
 #include "util/functions.h"
+#include <algorithm>
 
 SampleHolder::SampleHolder() {
 	startPos = 0;
@@ -67,7 +68,7 @@ void SampleHolder::beenClonedFrom(SampleHolder const* other, bool reversed) {
 void SampleHolder::unassignAllClusterReasons(bool beingDestructed) {
 	for (int32_t l = 0; l < kNumClustersLoadedAhead; l++) {
 		if (clustersForStart[l]) {
-			audioFileManager.removeReasonFromCluster(clustersForStart[l], "E123");
+			audioFileManager.releaseAttackHeadCluster(clustersForStart[l], "E123");
 			if (!beingDestructed) {
 				clustersForStart[l] = NULL;
 			}
@@ -153,6 +154,13 @@ void SampleHolder::setAudioFile(AudioFile* newSample, bool reversed, bool manual
 
 constexpr int32_t kMarkerSamplesBeforeToClaim = 150;
 
+// How much of the sample, from each marker, we want to keep loaded as an attack head. Tune this by the hit rate
+// AudioFileManager reports - it needs to cover how long the next Cluster takes to load once a note's started
+constexpr int32_t kAttackHeadMSec = 100;
+
+// How many Clusters from each marker we hold on to even once the attack head budget's spent
+constexpr int32_t kMinAttackHeadNumClusters = 1;
+
 // Reassesses which Clusters we want to be a "reason" for.
 // Ensure there is a sample before you call this.
 void SampleHolder::claimClusterReasons(bool reversed, int32_t clusterLoadInstruction) {
@@ -188,12 +196,43 @@ void SampleHolder::claimClusterReasons(bool reversed, int32_t clusterLoadInstruc
 }
 
 void SampleHolder::claimClusterReasonsForMarker(Cluster** clusters, uint32_t startPlaybackAtByte, int32_t playDirection,
-                                                int32_t clusterLoadInstruction) {
+                                                int32_t clusterLoadInstruction, bool justAttackHead) {
+
+	Sample* sample = (Sample*)audioFile;
 
 	int32_t clusterIndex = startPlaybackAtByte >> audioFileManager.clusterSizeMagnitude;
 
 	uint32_t posWithinCluster = startPlaybackAtByte & (audioFileManager.clusterSize - 1);
 
+	int32_t numClustersWanted = kNumClustersLoadedAhead;
+
+	// Only as many as it takes to hold kAttackHeadMSec of playback from the marker - the rest get loaded once a note
+	// starts, same as for any Cluster after that
+	if (justAttackHead) {
+		uint32_t attackHeadBytes =
+		    (uint64_t)sample->sampleRate * kAttackHeadMSec / 1000 * sample->numChannels * sample->byteDepth;
+		uint32_t bytesLeftInCluster =
+		    (playDirection == 1) ? audioFileManager.clusterSize - posWithinCluster : posWithinCluster + 1;
+		numClustersWanted = 1;
+		if (attackHeadBytes > bytesLeftInCluster) {
+			numClustersWanted += (attackHeadBytes - bytesLeftInCluster - 1) / audioFileManager.clusterSize + 1;
+		}
+		numClustersWanted = std::min(numClustersWanted, kNumClustersLoadedAhead);
+	}
+
+	// Past kMinAttackHeadNumClusters, only as many as fit in the attack head budget. Ones we alone hold now are about
+	// to be let go of, so count as spare
+	auto numClaimsByUs = [&](Cluster* cluster) {
+		return (int32_t)(std::find(clusters, clusters + kNumClustersLoadedAhead, cluster)
+		                 != clusters + kNumClustersLoadedAhead);
+	};
+	int32_t numClustersSpare = audioFileManager.getNumAttackHeadClustersSpare();
+	for (int32_t l = 0; l < kNumClustersLoadedAhead; l++) {
+		if (clusters[l] && clusters[l]->numAttackHeadClaims == 1) {
+			numClustersSpare++;
+		}
+	}
+
 	// Set up new temp list
 	Cluster* newClusters[kNumClustersLoadedAhead];
 	for (int32_t l = 0; l < kNumClustersLoadedAhead; l++) {
@@ -201,34 +240,35 @@ void SampleHolder::claimClusterReasonsForMarker(Cluster** clusters, uint32_t sta
 	}
 
 	// Populate new list
-	for (int32_t l = 0; l < kNumClustersLoadedAhead; l++) {
+	for (int32_t l = 0; l < numClustersWanted; l++) {
 
-		/*
-		// If final one, only load it if posWithinCluster is at least a quarter of the way in
-		if (l == NUM_SAMPLE_CLUSTERS_LOADED_AHEAD - 1) {
-		    if (playDirection == 1) {
-		        if (posWithinCluster < (sampleManager.clusterSize >> 2)) break;
-		    }
-		    else {
-		        if (posWithinCluster > sampleManager.clusterSize - (sampleManager.clusterSize >> 2)) break;
-		    }
-		}
-		*/
+		SampleCluster* sampleCluster = sample->clusters.getElement(clusterIndex);
 
-		SampleCluster* sampleCluster = ((Sample*)audioFile)->clusters.getElement(clusterIndex);
+		// One that another SampleHolder holds as an attack head is already paid for
+		Cluster* existingCluster = sampleCluster->cluster;
+		if (!existingCluster || existingCluster->numAttackHeadClaims <= numClaimsByUs(existingCluster)) {
+			if (l >= kMinAttackHeadNumClusters && numClustersSpare <= 0) {
+				break;
+			}
+			numClustersSpare--;
+		}
 
-		newClusters[l] = sampleCluster->getCluster(((Sample*)audioFile), clusterIndex, clusterLoadInstruction);
+		newClusters[l] = sampleCluster->getCluster(sample, clusterIndex, clusterLoadInstruction);
 
 		if (!newClusters[l]) {
 			D_PRINTLN("NULL!!");
 		}
-		else if (clusterLoadInstruction == CLUSTER_LOAD_IMMEDIATELY_OR_ENQUEUE && !newClusters[l]->loaded) {
-			D_PRINTLN("not loaded!!");
+		else {
+			audioFileManager.claimAttackHeadCluster(newClusters[l]);
+
+			if (clusterLoadInstruction == CLUSTER_LOAD_IMMEDIATELY_OR_ENQUEUE && !newClusters[l]->loaded) {
+				D_PRINTLN("not loaded!!");
+			}
 		}
 
 		clusterIndex += playDirection;
-		if (clusterIndex < ((Sample*)audioFile)->getFirstClusterIndexWithAudioData()
-		    || clusterIndex >= ((Sample*)audioFile)->getFirstClusterIndexWithNoAudioData()) {
+		if (clusterIndex < sample->getFirstClusterIndexWithAudioData()
+		    || clusterIndex >= sample->getFirstClusterIndexWithNoAudioData()) {
 			break;
 		}
 	}
@@ -236,7 +276,7 @@ void SampleHolder::claimClusterReasonsForMarker(Cluster** clusters, uint32_t sta
 	// Replace old list
 	for (int32_t l = 0; l < kNumClustersLoadedAhead; l++) {
 		if (clusters[l]) {
-			audioFileManager.removeReasonFromCluster(clusters[l], "E146");
+			audioFileManager.releaseAttackHeadCluster(clusters[l], "E146");
 		}
 		clusters[l] = newClusters[l];
 	}
@@ -52,10 +52,10 @@ public:
 
 	int32_t neutralPhaseIncrement;
 
-	Cluster* clustersForStart[kNumClustersLoadedAhead];
+	Cluster* clustersForStart[kNumClustersLoadedAhead]; // Attack head - see AudioFileManager::attackHeadNumClusters
 
 protected:
 	void claimClusterReasonsForMarker(Cluster** clusters, uint32_t startPlaybackAtByte, int32_t playDirection,
-	                                  int32_t clusterLoadInstruction);
+	                                  int32_t clusterLoadInstruction, bool justAttackHead = true);
 	virtual void sampleBeenSet(bool reversed, bool manuallySelected) {}
 };
@@ -45,7 +45,7 @@ SampleHolderForVoice::~SampleHolderForVoice() {
 	// overriding of that virtual function won't happen as we've already been destructed!
 	for (int32_t l = 0; l < kNumClustersLoadedAhead; l++) {
 		if (clustersForLoopStart[l]) {
-			audioFileManager.removeReasonFromCluster(clustersForLoopStart[l], "E247");
+			audioFileManager.releaseAttackHeadCluster(clustersForLoopStart[l], "E247");
 		}
 	}
 }
@@ -54,8 +54,8 @@ void SampleHolderForVoice::unassignAllClusterReasons(bool beingDestructed) {
 	SampleHolder::unassignAllClusterReasons(beingDestructed);
 	for (int32_t l = 0; l < kNumClustersLoadedAhead; l++) {
 		if (clustersForLoopStart[l]) {
-			audioFileManager.removeReasonFromCluster(clustersForLoopStart[l],
-			                                         "E320"); // Happened to me while auto-pilot testing, I think
+			audioFileManager.releaseAttackHeadCluster(clustersForLoopStart[l],
+			                                          "E320"); // Happened to me while auto-pilot testing, I think
 			if (!beingDestructed) {
 				clustersForLoopStart[l] = NULL;
 			}
@@ -98,14 +98,15 @@ void SampleHolderForVoice::claimClusterReasons(bool reversed, int32_t clusterLoa
 		int32_t nextClusterStartByte =
 		    ((Sample*)audioFile)->audioDataStartPosBytes + audioFileManager.clusterSizeMagnitude << 1;
 
-		claimClusterReasonsForMarker(clustersForLoopStart, nextClusterStartByte, playDirection, clusterLoadInstruction);
+		claimClusterReasonsForMarker(clustersForLoopStart, nextClusterStartByte, playDirection, clusterLoadInstruction,
+		                             false);
 	}
 
 	// Or if no loop start point now, clear out any reasons we had before
 	else {
 		for (int32_t l = 0; l < kNumClustersLoadedAhead; l++) {
 			if (clustersForLoopStart[l]) {
-				audioFileManager.removeReasonFromCluster(clustersForLoopStart[l], "E246");
+				audioFileManager.releaseAttackHeadCluster(clustersForLoopStart[l], "E246");
 				clustersForLoopStart[l] = NULL;
 			}
 		}
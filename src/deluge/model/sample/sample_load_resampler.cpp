@@ -0,0 +1,241 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "model/sample/sample_load_resampler.h"
+#include "definitions_cxx.hpp"
+#include "io/debug/log.h"
+#include "model/sample/sample.h"
+#include "model/sample/sample_cache.h"
+#include "model/sample/sample_controls.h"
+#include "model/sample/sample_files.h"
+#include "model/sample/sample_holder.h"
+#include "model/sample/sample_holder_for_voice.h"
+#include "model/sample/sample_playback_guide.h"
+#include "model/settings/runtime_feature_settings.h"
+#include "model/voice/voice_sample.h"
+#include "processing/engines/audio_engine.h"
+#include "storage/audio/audio_file_manager.h"
+#include "storage/cluster/cluster.h"
+#include "util/fixedpoint.h"
+#include "util/lookuptables/lookuptables.h"
+#include <cstring>
+
+namespace SampleLoadResampler {
+
+namespace {
+
+constexpr int32_t kMaxNumJobs = 16;
+
+// Per call to continueWork(), so the UI stays responsive
+constexpr int32_t kMaxRendersPerCall = 32;
+
+// Behind every Voice, but not so far back that loading a song waits for us (see LoadSongUI)
+constexpr uint32_t kPriorityRating = 0xFFFFFFFE;
+
+struct Job {
+	Sample* sample; // We're a reason for it until the job's done
+	int32_t phaseIncrement;
+	uint64_t startPos;
+};
+
+Job jobs[kMaxNumJobs];
+int32_t numJobs = 0;
+
+// Stands in for the SampleHolderForVoice. It doesn't claim an attack head - those are for playback, which has a budget
+// for them - so we hold on to the Cluster we're going to start from ourselves, while it loads
+class SourceHolder final : public SampleHolder {
+public:
+	void claimClusterReasons(bool reversed, int32_t clusterLoadInstruction) override {}
+};
+
+// For the job at the head of the queue - standing in for the SampleHolderForVoice and Voice that'd play it. From
+// startPos it plays to the very end, which is as far as the cache goes
+SourceHolder holder;
+Cluster* firstCluster = nullptr;
+SamplePlaybackGuide guide;
+SampleControls sampleControls; // Defaults to SMOOTH, which is all caches are made for
+VoiceSample* voiceSample = nullptr;
+
+int32_t renderBuffer[SSI_TX_BUFFER_NUM_SAMPLES * 2];
+
+bool enabled() {
+	return SampleFiles::isOn(RuntimeFeatureSettingType::ResampleOnLoad);
+}
+
+void releaseFirstCluster() {
+	if (firstCluster) {
+		audioFileManager.removeReasonFromCluster(firstCluster, "E459");
+		firstCluster = nullptr;
+	}
+}
+
+void finishJob() {
+	releaseFirstCluster();
+	if (voiceSample) {
+		voiceSample->beenUnassigned(false);
+		AudioEngine::voiceSampleUnassigned(voiceSample);
+		voiceSample = nullptr;
+	}
+	if (holder.audioFile) {
+		holder.setAudioFile(nullptr);
+	}
+
+	jobs[0].sample->removeReason("E458");
+	numJobs--;
+	memmove(&jobs[0], &jobs[1], numJobs * sizeof(Job));
+}
+
+// Returns false if it's not worth carrying on
+bool startJob(Job* job) {
+	Sample* sample = job->sample;
+
+	// Until the Cluster we start from is here, the VoiceSample has nothing to start from
+	if (!firstCluster) {
+		int32_t clusterIndex = guide.getBytePosToStartPlayback(false) >> audioFileManager.clusterSizeMagnitude;
+		firstCluster = sample->clusters.getElement(clusterIndex)
+		                   ->getCluster(sample, clusterIndex, CLUSTER_ENQUEUE, kPriorityRating);
+		if (!firstCluster) {
+			return false;
+		}
+	}
+	if (!firstCluster->loaded) {
+		return true;
+	}
+
+	voiceSample = AudioEngine::solicitVoiceSample();
+	if (!voiceSample) {
+		return true; // Try again next time
+	}
+
+	voiceSample->noteOn(&guide, 0, kPriorityRating);
+	if (!voiceSample->setupClusersForInitialPlay(&guide, sample, 0, false, kPriorityRating)) {
+		return false;
+	}
+	releaseFirstCluster(); // The VoiceSample has its own reason for it now
+
+	// If a Voice has already made this cache - or is making it, or it's coming back from the card - there's nothing
+	// for us to do
+	return voiceSample->possiblySetUpCache(&sampleControls, &guide, job->phaseIncrement, kMaxSampleValue,
+	                                       kPriorityRating, LoopType::NONE)
+	       && voiceSample->cache && voiceSample->writingToCache;
+}
+
+} // namespace
+
+void drumSampleLoaded(SampleHolderForVoice* sampleHolder, int32_t soundTranspose) {
+	Sample* sample = (Sample*)sampleHolder->audioFile;
+	if (!enabled() || !sample || sample->sampleRate == kSampleRate || !sample->tempFilePathForRecording.isEmpty()
+	    || numJobs == kMaxNumJobs) {
+		return;
+	}
+
+	int32_t phaseIncrement = getPhaseIncrementForNote(sampleHolder->neutralPhaseIncrement,
+	                                                  kNoteForDrum + soundTranspose + sampleHolder->transpose);
+	if (!phaseIncrement) {
+		return;
+	}
+	phaseIncrement = sampleHolder->fineTuner.detune(phaseIncrement);
+	if (phaseIncrement == kMaxSampleValue) {
+		return;
+	}
+
+	// Holders get cloned along with their Kit rows, and set again when their Sample's reloaded
+	for (int32_t j = 0; j < numJobs; j++) {
+		if (jobs[j].sample == sample && jobs[j].phaseIncrement == phaseIncrement
+		    && jobs[j].startPos == sampleHolder->startPos) {
+			return;
+		}
+	}
+
+	sample->addReason();
+	jobs[numJobs++] = {sample, phaseIncrement, sampleHolder->startPos};
+}
+
+void continueWork() {
+	if (!numJobs) {
+		return;
+	}
+
+	if (!enabled()) {
+		while (numJobs) {
+			finishJob();
+		}
+		return;
+	}
+
+	// Playback streaming gets the card first - and the CPU, while it's busy loading
+	if (audioFileManager.loadingQueue.getNumElements()) {
+		return;
+	}
+
+	Job* job = &jobs[0];
+	Sample* sample = job->sample;
+
+	if (sample->unplayable || sample->unloadable) {
+		finishJob();
+		return;
+	}
+
+	if (!holder.audioFile) {
+		holder.startPos = job->startPos;
+		holder.endPos = 9999999; // Which setAudioFile() makes the Sample's end
+		holder.setAudioFile(sample);
+		guide.audioFileHolder = &holder;
+		guide.sequenceSyncLengthTicks = 0;
+		guide.setupPlaybackBounds(false);
+		return;
+	}
+
+	if (!voiceSample) {
+		if (!startJob(job)) {
+			finishJob();
+		}
+		return;
+	}
+
+	for (int32_t i = 0; i < kMaxRendersPerCall; i++) {
+
+		// Unlike a Voice, we can wait for Clusters to load. So don't let the VoiceSample get to one that hasn't, or
+		// it'd give up
+		for (int32_t l = 0; l < voiceSample->numClustersLoadedAhead; l++) {
+			Cluster* cluster = voiceSample->clusters[l];
+			if (cluster && !cluster->loaded) {
+				return;
+			}
+		}
+
+		memset(renderBuffer, 0, sizeof(renderBuffer));
+		bool stillGoing = voiceSample->render(&guide, renderBuffer, SSI_TX_BUFFER_NUM_SAMPLES, sample,
+		                                      sample->numChannels, LoopType::NONE, job->phaseIncrement,
+		                                      kMaxSampleValue, 0, 0, kInterpolationMaxNumSamples,
+		                                      InterpolationMode::SMOOTH, kPriorityRating);
+
+		// Done when it reaches the end of the cache - or if a Cluster got stolen, or a Voice caught up with us and
+		// took over writing, which it'll finish itself
+		if (!stillGoing || !voiceSample->cache || !voiceSample->writingToCache) {
+			D_PRINTLN("done resampling: %s", sample->filePath.get());
+			finishJob();
+			return;
+		}
+
+		if (audioFileManager.loadingQueue.getNumElements()) {
+			return;
+		}
+	}
+}
+
+} // namespace SampleLoadResampler
@@ -0,0 +1,66 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "util/fixedpoint.h"
+#include "util/lookuptables/lookuptables.h"
+#include <cstdint>
+
+class SampleHolderForVoice;
+
+// Renders the SampleCache a Voice would otherwise have to fill in as it plays, for Samples that don't play back at the
+// system sample rate - typically 48kHz or 96kHz ones in a Kit. That's the cache for the note a Kit row plays, at the
+// Sound's and the holder's transpose and the holder's cents. Every note the row plays is at that pitch, so they then
+// all just read the cache, rather than resampling each time. A synth's notes could be at any pitch, so none of them is
+// worth rendering ahead. If the community feature is on.
+//
+// It's done by playing the Sample through a VoiceSample of our own, the same way a Voice would, so what ends up in the
+// cache is exactly what playback would have written there - and it's kept on the card too, if SampleCacheFile is on.
+// The Clusters it reads are held as for any other reader, not as an attack head.
+//
+// One Sample at a time, and only while no Clusters are waiting to be loaded for playback.
+namespace SampleLoadResampler {
+
+// Called by SoundDrum::loadAllSamples()
+void drumSampleLoaded(SampleHolderForVoice* holder, int32_t soundTranspose);
+
+void continueWork();
+
+/// The phase increment Voice::calculatePhaseIncrements() comes up with for a Sample at transposedNoteCode, before the
+/// holder's cents or any modulation. Returns 0 if that's too high to play
+inline int32_t getPhaseIncrementForNote(int32_t neutralPhaseIncrement, int32_t transposedNoteCode) {
+	int32_t noteWithinOctave = (uint16_t)(transposedNoteCode + 240) % 12;
+	int32_t octave = (uint16_t)(transposedNoteCode + 120) / 12;
+
+	uint32_t phaseIncrement = multiply_32x32_rshift32(noteIntervalTable[noteWithinOctave], neutralPhaseIncrement);
+
+	int32_t shiftRightAmount = 13 - octave;
+	if (shiftRightAmount >= 0) {
+		phaseIncrement >>= shiftRightAmount;
+	}
+	else {
+		int32_t shiftLeftAmount = 0 - shiftRightAmount;
+		if (phaseIncrement >= (2026954652 >> shiftLeftAmount)) {
+			return 0;
+		}
+		phaseIncrement <<= shiftLeftAmount;
+	}
+	return phaseIncrement;
+}
+
+} // namespace SampleLoadResampler
@@ -15,14 +15,17 @@
  * If not, see <https://www.gnu.org/licenses/>.
  */
 
+#ifdef __arm__
 #pragma GCC push_options
 #pragma GCC target("fpu=neon")
+#endif
 
 #include "model/sample/sample_low_level_reader.h"
 #include "dsp/timestretch/time_stretcher.h"
 #include "hid/display/display.h"
 #include "io/debug/log.h"
 #include "model/sample/sample.h"
+#include "model/sample/sample_read_ahead.h"
 #include "model/voice/voice.h"
 #include "model/voice/voice_sample_playback_guide.h"
 #include "storage/audio/audio_file_manager.h"
@@ -31,9 +34,12 @@
 #include "arm_neon.h"
 
 SampleLowLevelReader::SampleLowLevelReader() {
-	for (int32_t l = 0; l < kNumClustersLoadedAhead; l++) {
+	for (int32_t l = 0; l < kMaxNumClustersLoadedAhead; l++) {
 		clusters[l] = NULL;
 	}
+	numClustersLoadedAhead = kNumClustersLoadedAhead;
+	readAheadPhaseIncrement = kMaxSampleValue;
+	readAheadTimeStretchRatio = kMaxSampleValue;
 }
 
 SampleLowLevelReader::~SampleLowLevelReader() {
@@ -42,7 +48,7 @@ SampleLowLevelReader::~SampleLowLevelReader() {
 }
 
 void SampleLowLevelReader::unassignAllReasons(bool wontBeUsedAgain) {
-	for (int32_t l = 0; l < kNumClustersLoadedAhead; l++) {
+	for (int32_t l = 0; l < kMaxNumClustersLoadedAhead; l++) {
 		if (clusters[l]) {
 			audioFileManager.removeReasonFromCluster(clusters[l], "E027", wontBeUsedAgain);
 			clusters[l] = NULL;
@@ -258,7 +264,7 @@ void SampleLowLevelReader::setupReassessmentLocation(SamplePlaybackGuide* guide,
 // Make sure reasons are unassigned before you call this!
 // Call changeClusterIfNecessary() after this if byteOvershoot isn't 0
 bool SampleLowLevelReader::setupClusersForInitialPlay(SamplePlaybackGuide* guide, Sample* sample, int32_t byteOvershoot,
-                                                      bool justLooped, int32_t priorityRating) {
+                                                      bool justLooped, int32_t priorityRating, bool noteStart) {
 
 	if (sample->unplayable) {
 		return false; // TODO: this probably shouldn't be here
@@ -270,6 +276,11 @@ bool SampleLowLevelReader::setupClusersForInitialPlay(SamplePlaybackGuide* guide
 
 	bool success = setupClustersForPlayFromByte(guide, sample, startPlaybackAtByte, priorityRating);
 
+	// For a new note, see whether its attack head was there for it
+	if (noteStart && !justLooped) {
+		audioFileManager.attackHeadUsed(success && attackHeadWasLoaded());
+	}
+
 	if (!success) {
 		D_PRINTLN("setupClustersForInitialPlay fail");
 	}
@@ -277,6 +288,19 @@ bool SampleLowLevelReader::setupClusersForInitialPlay(SamplePlaybackGuide* guide
 	return success;
 }
 
+// Whether we're starting from Clusters some SampleHolder holds as an attack head, and all of those were loaded
+bool SampleLowLevelReader::attackHeadWasLoaded() {
+	if (!clusters[0] || !clusters[0]->numAttackHeadClaims) {
+		return false;
+	}
+	for (int32_t l = 0; l < kMaxNumClustersLoadedAhead && clusters[l] && clusters[l]->numAttackHeadClaims; l++) {
+		if (!clusters[l]->loaded) {
+			return false;
+		}
+	}
+	return true;
+}
+
 // Make sure reasons are unassigned before you call this!
 // Call changeClusterIfNecessary() after this if byteOvershoot isn't 0
 bool SampleLowLevelReader::setupClustersForPlayFromByte(SamplePlaybackGuide* guide, Sample* sample,
@@ -316,7 +340,8 @@ bool SampleLowLevelReader::assignClusters(SamplePlaybackGuide* guide, Sample* sa
                                           int32_t priorityRating) {
 	int32_t finalClusterIndex = guide->getFinalClusterIndex(sample, shouldObeyMarkers());
 
-	for (int32_t l = 0; l < kNumClustersLoadedAhead; l++) {
+	updateNumClustersLoadedAhead(sample);
+	for (int32_t l = 0; l < numClustersLoadedAhead; l++) {
 
 		// Grab it.
 		clusters[l] = sample->clusters.getElement(clusterIndex)
@@ -355,11 +380,11 @@ bool SampleLowLevelReader::moveOnToNextCluster(SamplePlaybackGuide* guide, Sampl
 	int32_t bytePosWithinOldCluster = (uint32_t)currentPlayPos - (uint32_t)&clusters[0]->data;
 	audioFileManager.removeReasonFromCluster(clusters[0], "E035");
 
-	for (int32_t l = 0; l < kNumClustersLoadedAhead - 1; l++) {
+	for (int32_t l = 0; l < kMaxNumClustersLoadedAhead - 1; l++) {
 		clusters[l] = clusters[l + 1];
 	}
 
-	clusters[kNumClustersLoadedAhead - 1] = NULL;
+	clusters[kMaxNumClustersLoadedAhead - 1] = NULL;
 
 	// First things first - if there is no next Cluster or it's not loaded...
 	if (!clusters[0]) {
@@ -377,29 +402,31 @@ bool SampleLowLevelReader::moveOnToNextCluster(SamplePlaybackGuide* guide, Sampl
 	// Remove the compensation we'd done on the play pos relating to the byte depth of samples
 	bytePosWithinOldCluster = bytePosWithinOldCluster + 4 - sample->byteDepth;
 
-	// And for the one at the far end, just grab the next one
-	Cluster* oldLastCluster = clusters[kNumClustersLoadedAhead - 2];
-
-	if (oldLastCluster) {
-		int32_t prevClusterIndex = oldLastCluster->clusterIndex;
+	// And at the far end, grab however many more we now want loaded ahead. A NULL means we'd reached the final Cluster
+	// (or run out of RAM, in which case no damage gets done)
+	updateNumClustersLoadedAhead(sample);
+	int32_t l = 1;
+	while (l < kMaxNumClustersLoadedAhead && clusters[l]) {
+		l++;
+	}
 
-		int32_t newClusterIndex = prevClusterIndex + guide->playDirection;
+	if (l < numClustersLoadedAhead) {
+		int32_t finalClusterIndex = guide->getFinalClusterIndex(sample, shouldObeyMarkers());
 
-		// Check that there actually is a next Cluster. If not...
-		if (newClusterIndex * guide->playDirection
-		    > guide->getFinalClusterIndex(sample, shouldObeyMarkers()) * guide->playDirection) {
-			clusters[kNumClustersLoadedAhead - 1] = NULL;
-		}
+		for (; l < numClustersLoadedAhead; l++) {
+			int32_t newClusterIndex = clusters[l - 1]->clusterIndex + guide->playDirection;
 
-		// Or if there is...
-		else {
+			// Check that there actually is a next Cluster
+			if (newClusterIndex * guide->playDirection > finalClusterIndex * guide->playDirection) {
+				break;
+			}
 
 			// Grab it.
-			clusters[kNumClustersLoadedAhead - 1] =
-			    sample->clusters.getElement(newClusterIndex)
-			        ->getCluster(sample, newClusterIndex, CLUSTER_ENQUEUE, priorityRating);
-
-			// If that failed (because no free RAM), no damage gets done.
+			clusters[l] = sample->clusters.getElement(newClusterIndex)
+			                  ->getCluster(sample, newClusterIndex, CLUSTER_ENQUEUE, priorityRating);
+			if (!clusters[l]) {
+				break;
+			}
 		}
 	}
 
@@ -410,6 +437,23 @@ bool SampleLowLevelReader::moveOnToNextCluster(SamplePlaybackGuide* guide, Sampl
 	return true;
 }
 
+// Works out how many Clusters to hold from how fast we're going through the file and how long Clusters are taking to
+// load. Only matters as we move on to each new Cluster, so gets done then rather than by setReadAheadRate() every render
+void SampleLowLevelReader::updateNumClustersLoadedAhead(Sample* sample) {
+	uint64_t framesPerSample = (uint32_t)readAheadPhaseIncrement;
+
+	// Time-stretching moves the play heads' starting points along at a different rate to the heads themselves
+	if (readAheadTimeStretchRatio != kMaxSampleValue) {
+		uint64_t framesPerSampleStretched =
+		    ((uint64_t)(uint32_t)readAheadPhaseIncrement * (uint32_t)readAheadTimeStretchRatio) >> 24;
+		framesPerSample = std::max(framesPerSample, framesPerSampleStretched);
+	}
+
+	numClustersLoadedAhead =
+	    getNumClustersToLoadAhead(framesPerSample * sample->numChannels * sample->byteDepth,
+	                              audioFileManager.clusterLoadLatency, audioFileManager.clusterSize);
+}
+
 // Returns false if stopping deliberately or clusters weren't loaded in time. In that case, caller may wish to output
 // some zeros to work through the interpolation buffer. All reasons (e.g. clusters[0]) will be unassigned / set to NULL
 // in this case.
@@ -1280,7 +1324,11 @@ bool SampleLowLevelReader::readSamplesForTimeStretching(
 
 void SampleLowLevelReader::cloneFrom(SampleLowLevelReader* other, bool stealReasons) {
 
-	for (int32_t l = 0; l < kNumClustersLoadedAhead; l++) {
+	numClustersLoadedAhead = other->numClustersLoadedAhead;
+	readAheadPhaseIncrement = other->readAheadPhaseIncrement;
+	readAheadTimeStretchRatio = other->readAheadTimeStretchRatio;
+
+	for (int32_t l = 0; l < kMaxNumClustersLoadedAhead; l++) {
 		if (clusters[l]) {
 			audioFileManager.removeReasonFromCluster(clusters[l], "E131", false);
 		}
@@ -48,8 +48,12 @@ public:
 	void setupForPlayPosMovedIntoNewCluster(SamplePlaybackGuide* guide, Sample* sample, int32_t bytePosWithinNewCluster,
 	                                        int32_t byteDepth);
 	bool setupClusersForInitialPlay(SamplePlaybackGuide* guide, Sample* sample, int32_t byteOvershoot = 0,
-	                                bool justLooped = false, int32_t priorityRating = 1);
+	                                bool justLooped = false, int32_t priorityRating = 1, bool noteStart = false);
 	bool moveOnToNextCluster(SamplePlaybackGuide* guide, Sample* sample, int32_t priorityRating = 1);
+	void setReadAheadRate(int32_t phaseIncrement, int32_t timeStretchRatio) {
+		readAheadPhaseIncrement = phaseIncrement;
+		readAheadTimeStretchRatio = timeStretchRatio;
+	}
 	bool changeClusterIfNecessary(SamplePlaybackGuide* guide, Sample* sample, bool loopingAtLowLevel,
 	                              int32_t priorityRating = 1);
 	bool considerUpcomingWindow(SamplePlaybackGuide* guide, Sample* sample, int32_t* numSamples, int32_t phaseIncrement,
@@ -99,9 +103,18 @@ public:
 
 	int16x4_t interpolationBuffer[2][kInterpolationMaxNumSamples >> 2];
 
-	Cluster* clusters[kNumClustersLoadedAhead];
+	// The one being read, then the ones after it in playback order. Only ever the first numClustersLoadedAhead are
+	// topped up, but there may be more left over from when that was higher
+	Cluster* clusters[kMaxNumClustersLoadedAhead];
+	int8_t numClustersLoadedAhead;
+
+	// As last given to setReadAheadRate()
+	int32_t readAheadPhaseIncrement;
+	int32_t readAheadTimeStretchRatio;
 
 private:
+	bool attackHeadWasLoaded();
+	void updateNumClustersLoadedAhead(Sample* sample);
 	bool assignClusters(SamplePlaybackGuide* guide, Sample* sample, int32_t clusterIndex, int32_t priorityRating);
 	bool fillInterpolationBufferForward(SamplePlaybackGuide* guide, Sample* sample, int32_t interpolationBufferSize,
 	                                    bool loopingAtLowLevel, int32_t numSpacesToFill, int32_t priorityRating);
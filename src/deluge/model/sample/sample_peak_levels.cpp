@@ -0,0 +1,96 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "model/sample/sample_peak_levels.h"
+#include <algorithm>
+
+int32_t SamplePeakLevels::getNumPeaksTotal(int32_t numPeaksAtBase) {
+	// Every level above the base adds half again, rounded up
+	int32_t numPeaksTotal = 0;
+	for (int32_t numPeaks = numPeaksAtBase; true; numPeaks = (numPeaks + 1) >> 1) {
+		numPeaksTotal += numPeaks;
+		if (numPeaks == 1) {
+			return numPeaksTotal;
+		}
+	}
+}
+
+void SamplePeakLevels::setup(Peak* newPeaks, int32_t numPeaksAtBase) {
+	peaks = newPeaks;
+
+	int32_t numPeaksTotal = 0;
+	int32_t numPeaks = numPeaksAtBase;
+	numLevels = 0;
+	while (true) {
+		numPeaksAtLevel[numLevels] = numPeaks;
+		levelStart[numLevels] = numPeaksTotal;
+		numPeaksTotal += numPeaks;
+		numLevels++;
+		if (numPeaks == 1) {
+			break;
+		}
+		numPeaks = (numPeaks + 1) >> 1;
+	}
+
+	for (int32_t i = 0; i < numPeaksTotal; i++) {
+		peaks[i].min = 32767;
+		peaks[i].max = -32768;
+	}
+}
+
+void SamplePeakLevels::clearBase() {
+	for (int32_t i = 0; i < numPeaksAtLevel[0]; i++) {
+		peaks[i].min = 32767;
+		peaks[i].max = -32768;
+	}
+}
+
+void SamplePeakLevels::fillUpperLevels() {
+	for (int32_t l = 1; l < numLevels; l++) {
+		Peak* below = &peaks[levelStart[l - 1]];
+		Peak* here = &peaks[levelStart[l]];
+		int32_t numPeaksBelow = numPeaksAtLevel[l - 1];
+		for (int32_t i = 0; i < numPeaksAtLevel[l]; i++) {
+			here[i] = below[i * 2];
+			if (i * 2 + 1 < numPeaksBelow) {
+				here[i].min = std::min(here[i].min, below[i * 2 + 1].min);
+				here[i].max = std::max(here[i].max, below[i * 2 + 1].max);
+			}
+		}
+	}
+}
+
+void SamplePeakLevels::getPeaks(uint64_t startSample, uint64_t endSample, int32_t* min, int32_t* max) const {
+	int32_t level = 0;
+	while (level < numLevels - 1 && ((uint64_t)2 << (kBaseMagnitude + level)) <= endSample - startSample) {
+		level++;
+	}
+
+	int32_t magnitude = kBaseMagnitude + level;
+	int32_t first = startSample >> magnitude;
+	int32_t last = std::min<int32_t>((endSample - 1) >> magnitude, numPeaksAtLevel[level] - 1);
+
+	Peak const* levelPeaks = &peaks[levelStart[level]];
+	int32_t minHere = 32767;
+	int32_t maxHere = -32768;
+	for (int32_t i = first; i <= last; i++) {
+		minHere = std::min<int32_t>(minHere, levelPeaks[i].min);
+		maxHere = std::max<int32_t>(maxHere, levelPeaks[i].max);
+	}
+	*min = minHere << 16;
+	*max = maxHere << 16;
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+// The ladder of resolutions in a SamplePeakPyramid, apart from anything to do with Samples or the card. Level 0 has
+// one Peak per (1 << kBaseMagnitude) samples, and each level above has half as many as the one below, rounded up,
+// until the top one has just one. The Peaks are all in one array, provided from outside - base level first.
+class SamplePeakLevels {
+public:
+	struct Peak {
+		int16_t min;
+		int16_t max;
+	};
+
+	constexpr static int32_t kBaseMagnitude = 8;
+	constexpr static int32_t kMaxNumLevels = 32;
+
+	static int32_t getNumPeaksAtBase(uint64_t lengthInSamples) {
+		return ((lengthInSamples - 1) >> kBaseMagnitude) + 1;
+	}
+	// Over all the levels
+	static int32_t getNumPeaksTotal(int32_t numPeaksAtBase);
+
+	// Lays the levels out in newPeaks, which must have room for getNumPeaksTotal(), and empties them all
+	void setup(Peak* newPeaks, int32_t numPeaksAtBase);
+	// Empties just the base level
+	void clearBase();
+
+	// Once the base level's done, works out all the others from it
+	void fillUpperLevels();
+
+	// Min and max values (in the top 16 bits) of the Peaks touching startSample up to but not including endSample, at
+	// the coarsest level where that range still spans at least one whole Peak - so no more than three are looked at
+	void getPeaks(uint64_t startSample, uint64_t endSample, int32_t* min, int32_t* max) const;
+
+	[[nodiscard]] Peak* getBase() const { return peaks; }
+	[[nodiscard]] int32_t getNumPeaksAtBase() const { return numPeaksAtLevel[0]; }
+
+private:
+	Peak* peaks;
+	int32_t numLevels;
+	int32_t numPeaksAtLevel[kMaxNumLevels];
+	int32_t levelStart[kMaxNumLevels];
+};
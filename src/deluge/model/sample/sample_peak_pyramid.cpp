@@ -0,0 +1,285 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "model/sample/sample_peak_pyramid.h"
+#include "definitions_cxx.hpp"
+#include "io/debug/log.h"
+#include "memory/general_memory_allocator.h"
+#include "model/sample/sample.h"
+#include "model/sample/sample_files.h"
+#include "model/settings/runtime_feature_settings.h"
+#include "storage/audio/audio_file_manager.h"
+#include "storage/cluster/cluster.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+extern "C" {
+#include "fatfs/ff.h"
+}
+
+namespace {
+
+// The one we're currently building. Only one at a time - it's whichever the user most recently looked at
+SamplePeakPyramid* pyramidBeingBuilt = nullptr;
+
+// Per call to continueBuilding(), so the UI stays responsive
+constexpr int32_t kMaxClustersPerCall = 4;
+
+constexpr char const* kFileExtension = ".peaks";
+constexpr uint32_t kFileVersion = 2;
+
+// At the start of the file on the card. If any of this doesn't match the Sample, the file is out of date
+struct FileHeader : SampleFiles::FileHeader {
+	uint8_t baseMagnitude;
+	uint32_t numPeaks;
+};
+
+bool makeFileHeader(FileHeader* header, Sample* sample, uint32_t numPeaks) {
+	if (!SampleFiles::makeHeader(header, sample, "DPKS", kFileVersion)) {
+		return false;
+	}
+	header->baseMagnitude = SamplePeakPyramid::kBaseMagnitude;
+	header->numPeaks = numPeaks;
+	return true;
+}
+
+bool getFilePath(String* path, Sample* sample) {
+	path->set(&sample->filePath);
+	return (path->concatenate(kFileExtension) == Error::NONE);
+}
+
+bool shouldUseCard() {
+	return SampleFiles::isOn(RuntimeFeatureSettingType::WaveformPeakFiles);
+}
+
+} // namespace
+
+SamplePeakPyramid::SamplePeakPyramid(Sample* newSample, int32_t numPeaksAtBase) {
+	sample = newSample;
+	lengthInSamples = newSample->lengthInSamples;
+	complete = false;
+	nextClusterIndex = newSample->getFirstClusterIndexWithAudioData();
+	triedReadingFromCard = false;
+	addingCluster = false;
+
+	levels.setup((Peak*)(this + 1), numPeaksAtBase);
+}
+
+SamplePeakPyramid::~SamplePeakPyramid() {
+	if (pyramidBeingBuilt == this) {
+		pyramidBeingBuilt = nullptr;
+	}
+}
+
+SamplePeakPyramid* SamplePeakPyramid::getIfReady(Sample* sample) {
+	SamplePeakPyramid* pyramid = sample->peakPyramid;
+
+	// If the Sample has changed length since (e.g. it was still being recorded), start again
+	if (pyramid && pyramid->lengthInSamples != sample->lengthInSamples) {
+		sample->deletePeakPyramid();
+		pyramid = nullptr;
+	}
+
+	if (pyramid) {
+		if (pyramid->complete) {
+			return pyramid;
+		}
+		pyramidBeingBuilt = pyramid; // In case we'd moved on to another one
+		return nullptr;
+	}
+
+	if (!sample->lengthInSamples || sample->unloadable) {
+		return nullptr;
+	}
+
+	int32_t numPeaksAtBase = SamplePeakLevels::getNumPeaksAtBase(sample->lengthInSamples);
+	void* memory = GeneralMemoryAllocator::get().allocStealable(
+	    sizeof(SamplePeakPyramid) + SamplePeakLevels::getNumPeaksTotal(numPeaksAtBase) * sizeof(Peak));
+	if (!memory) {
+		return nullptr;
+	}
+
+	pyramid = new (memory) SamplePeakPyramid(sample, numPeaksAtBase);
+	sample->peakPyramid = pyramid;
+	GeneralMemoryAllocator::get().putStealableInAppropriateQueue(pyramid);
+	pyramidBeingBuilt = pyramid;
+	return nullptr;
+}
+
+void SamplePeakPyramid::continueBuilding() {
+	SamplePeakPyramid* pyramid = pyramidBeingBuilt;
+	if (!pyramid) {
+		return;
+	}
+
+	Sample* sample = pyramid->sample;
+
+	if (!pyramid->triedReadingFromCard) {
+		pyramid->triedReadingFromCard = true;
+		if (shouldUseCard() && pyramid->readFromCard()) {
+			pyramid->levels.fillUpperLevels();
+			pyramid->complete = true;
+			pyramidBeingBuilt = nullptr;
+			return;
+		}
+	}
+
+	int32_t endClusterIndex = sample->getFirstClusterIndexWithNoAudioData();
+
+	for (int32_t i = 0; i < kMaxClustersPerCall; i++) {
+		if (pyramid->nextClusterIndex >= endClusterIndex) {
+			pyramid->levels.fillUpperLevels();
+			pyramid->complete = true;
+			pyramidBeingBuilt = nullptr;
+			if (shouldUseCard()) {
+				pyramid->writeToCard();
+			}
+			return;
+		}
+
+		// Playback streaming gets the card first. We'll carry on when it's had what it needs
+		if (audioFileManager.loadingQueue.getNumElements()) {
+			return;
+		}
+
+		SampleCluster* sampleCluster = sample->clusters.getElement(pyramid->nextClusterIndex);
+		pyramid->addingCluster = true;
+		Cluster* cluster = sampleCluster->getCluster(sample, pyramid->nextClusterIndex, CLUSTER_LOAD_IMMEDIATELY);
+		pyramid->addingCluster = false;
+
+		if (!cluster) {
+			// The file's gone. Otherwise, maybe the card's busy - try again next time
+			if (sample->unloadable) {
+				pyramidBeingBuilt = nullptr;
+			}
+			return;
+		}
+
+		pyramid->addCluster(cluster, pyramid->nextClusterIndex);
+		audioFileManager.removeReasonFromCluster(cluster, "E454");
+		pyramid->nextClusterIndex++;
+	}
+}
+
+void SamplePeakPyramid::addCluster(Cluster* cluster, int32_t clusterIndex) {
+	int32_t byteDepth = sample->byteDepth;
+	int32_t bytesPerPeak = (byteDepth * sample->numChannels) << kBaseMagnitude;
+
+	// All positions relative to the start of the audio data
+	int64_t clusterStart = ((int64_t)clusterIndex << audioFileManager.clusterSizeMagnitude)
+	                       - sample->audioDataStartPosBytes;
+	int64_t start = std::max<int64_t>(clusterStart, 0);
+	int64_t end = std::min<int64_t>(clusterStart + audioFileManager.clusterSize,
+	                                lengthInSamples * byteDepth * sample->numChannels);
+
+	// We only look at whole sample values. One which straddles into the next Cluster gets left out, which makes no
+	// visible difference
+	start += (byteDepth - (start % byteDepth)) % byteDepth;
+	end -= byteDepth - 1;
+
+	// Misalign, to align with non-32-bit data, as in WaveformRenderer::findPeaksPerCol()
+	int32_t offsetInCluster = byteDepth - 4 - clusterStart;
+
+	Peak* peaks = levels.getBase();
+	while (start < end) {
+		int32_t peakIndex = start / bytesPerPeak;
+		int64_t peakEnd = std::min<int64_t>((int64_t)(peakIndex + 1) * bytesPerPeak, end);
+
+		int32_t minHere = peaks[peakIndex].min << 16;
+		int32_t maxHere = peaks[peakIndex].max << 16;
+		for (; start < peakEnd; start += byteDepth) {
+			int32_t value = *(int32_t*)&cluster->data[start + offsetInCluster];
+			minHere = std::min(minHere, value);
+			maxHere = std::max(maxHere, value);
+		}
+		peaks[peakIndex].min = minHere >> 16;
+		peaks[peakIndex].max = maxHere >> 16;
+	}
+}
+
+bool SamplePeakPyramid::readFromCard() {
+	String path;
+	if (!getFilePath(&path, sample)) {
+		return false;
+	}
+
+	FIL file;
+	if (f_open(&file, path.get(), FA_READ) != FR_OK) {
+		return false;
+	}
+
+	FileHeader expected;
+	FileHeader header;
+	bool success = (makeFileHeader(&expected, sample, levels.getNumPeaksAtBase())
+	                && SampleFiles::readHeader(&file, &header) && SampleFiles::headersMatch(header, expected));
+
+	if (success) {
+		UINT numBytesRead;
+		UINT numBytes = levels.getNumPeaksAtBase() * sizeof(Peak);
+		success = (f_read(&file, levels.getBase(), numBytes, &numBytesRead) == FR_OK && numBytesRead == numBytes);
+	}
+
+	f_close(&file);
+
+	if (!success) {
+		D_PRINTLN("peak file out of date: %s", path.get());
+		levels.clearBase(); // In case we got partway through reading it
+	}
+	return success;
+}
+
+void SamplePeakPyramid::writeToCard() {
+	String path;
+	FileHeader header;
+	if (!getFilePath(&path, sample) || !makeFileHeader(&header, sample, levels.getNumPeaksAtBase())) {
+		return;
+	}
+
+	FIL file;
+	if (f_open(&file, path.get(), FA_CREATE_ALWAYS | FA_WRITE) != FR_OK) {
+		return;
+	}
+
+	UINT numBytesWritten;
+	UINT numBytes = levels.getNumPeaksAtBase() * sizeof(Peak);
+	bool success = (SampleFiles::writeHeader(&file, header)
+	                && f_write(&file, levels.getBase(), numBytes, &numBytesWritten) == FR_OK
+	                && numBytesWritten == numBytes);
+
+	f_close(&file);
+
+	if (!success) {
+		// Don't leave half a file for next time
+		f_unlink(path.get());
+	}
+}
+
+bool SamplePeakPyramid::mayBeStolen(void* thingNotToStealFrom) {
+	return !addingCluster;
+}
+
+void SamplePeakPyramid::steal(char const* errorCode) {
+	// Our caller will deallocate us
+	sample->peakPyramid = nullptr;
+}
+
+StealableQueue SamplePeakPyramid::getAppropriateQueue() {
+	// As much work to build again as a perc cache
+	return sample->numReasonsToBeLoaded ? StealableQueue::CURRENT_SONG_SAMPLE_DATA_PERC_CACHE
+	                                    : StealableQueue::NO_SONG_SAMPLE_DATA_PERC_CACHE;
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "definitions_cxx.hpp"
+#include "memory/stealable.h"
+#include "model/sample/sample_peak_levels.h"
+#include <cstdint>
+
+class Cluster;
+class Sample;
+
+// Min and max values of a whole Sample at a ladder of resolutions (see SamplePeakLevels), so that WaveformRenderer can
+// draw it at any zoom without reading its Clusters again.
+//
+// Built in the background, one Cluster at a time, and only while no Clusters are waiting to be loaded for playback -
+// see continueBuilding(). If the community feature is on, it's also kept on the card next to the audio file, so it
+// needn't be built again next time.
+//
+// Lives in stealable memory, so that when RAM is short it's just forgotten about, and built again if wanted.
+class SamplePeakPyramid final : public Stealable {
+public:
+	using Peak = SamplePeakLevels::Peak;
+
+	constexpr static int32_t kBaseMagnitude = SamplePeakLevels::kBaseMagnitude;
+
+	~SamplePeakPyramid();
+
+	// Returns the Sample's pyramid if it's ready. Otherwise returns NULL, and sees that one gets built
+	static SamplePeakPyramid* getIfReady(Sample* sample);
+	static void continueBuilding();
+
+	// Below this many samples per column, the pyramid has nothing to offer over reading the Clusters
+	static bool canRenderZoom(uint64_t samplesPerCol) { return samplesPerCol >= (1 << kBaseMagnitude); }
+
+	// Min and max values (in the top 16 bits) found from startSample up to but not including endSample
+	void getPeaks(uint64_t startSample, uint64_t endSample, int32_t* min, int32_t* max) const {
+		levels.getPeaks(startSample, endSample, min, max);
+	}
+
+	bool mayBeStolen(void* thingNotToStealFrom = nullptr);
+	void steal(char const* errorCode);
+	StealableQueue getAppropriateQueue();
+
+	Sample* sample;
+	uint64_t lengthInSamples; // Of the Sample, when we were created - if that changes, we're out of date
+	bool complete;
+
+private:
+	SamplePeakPyramid(Sample* newSample, int32_t numPeaksAtBase);
+
+	void addCluster(Cluster* cluster, int32_t clusterIndex);
+	bool readFromCard();
+	void writeToCard();
+
+	SamplePeakLevels levels; // Its Peaks are right after ourselves, in the same allocation
+
+	int32_t nextClusterIndex;
+	bool triedReadingFromCard;
+	bool addingCluster; // We mustn't be stolen while our Sample's Clusters are being allocated for us
+};
@@ -0,0 +1,298 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "model/sample/sample_perc_cache_file.h"
+#include "definitions_cxx.hpp"
+#include "io/debug/log.h"
+#include "memory/general_memory_allocator.h"
+#include "model/sample/sample.h"
+#include "model/sample/sample_files.h"
+#include "model/sample/sample_perc_cache_zone.h"
+#include "model/settings/runtime_feature_settings.h"
+#include "storage/audio/audio_file_manager.h"
+#include "storage/cluster/cluster.h"
+#include "util/functions.h"
+#include <algorithm>
+#include <cstring>
+
+extern "C" {
+#include "fatfs/ff.h"
+}
+
+namespace SamplePercCacheFile {
+
+namespace {
+
+constexpr uint32_t kFileVersion = 3;
+
+// Per call to continueWork(), so the UI stays responsive
+constexpr int32_t kMaxClustersPerCall = 2;
+
+enum class Stage : uint8_t { START, READING, FORWARDS, REVERSED };
+
+Sample* sampleBeingDone = nullptr;
+Stage stage;
+uint64_t lengthInSamples;          // As it was when we started, in case it's still being recorded
+int32_t length;                    // getPercCacheLength(), per play-direction
+uint8_t* percussiveness = nullptr; // Forwards, then reversed
+int32_t nextClusterIndex;
+int32_t numBytesRead;
+FIL file;
+bool fileOpen = false;
+
+// The same state fillPercCache() keeps in each zone, carried from one source Cluster to the next
+SamplePercCacheZone analysis{0};
+
+// At the start of the file on the card. If any of this doesn't match the Sample, the file is out of date
+struct FileHeader : SampleFiles::FileHeader {
+	uint8_t reductionMagnitude;
+	uint32_t length;
+};
+
+bool makeFileHeader(FileHeader* header, Sample* sample) {
+	if (!SampleFiles::makeHeader(header, sample, "DPRC", kFileVersion)) {
+		return false;
+	}
+	header->reductionMagnitude = kPercBufferReductionMagnitude;
+	header->length = length;
+	return true;
+}
+
+bool getFilePath(String* path, Sample* sample) {
+	path->set(&sample->filePath);
+	return (path->concatenate(kFileExtension) == Error::NONE);
+}
+
+bool shouldUseCard() {
+	return SampleFiles::isOn(RuntimeFeatureSettingType::PercussivenessFiles);
+}
+
+void finish(bool giveUp) {
+	if (fileOpen) {
+		f_close(&file);
+		fileOpen = false;
+	}
+	if (percussiveness) {
+		delugeDealloc(percussiveness);
+		percussiveness = nullptr;
+	}
+	if (sampleBeingDone && giveUp) {
+		sampleBeingDone->percCacheFileFailed = true; // Until it's loaded again
+	}
+	sampleBeingDone = nullptr;
+}
+
+bool openFile(Sample* sample) {
+	String path;
+	if (!getFilePath(&path, sample) || f_open(&file, path.get(), FA_READ) != FR_OK) {
+		return false;
+	}
+	fileOpen = true;
+
+	FileHeader expected;
+	FileHeader header;
+	if (!makeFileHeader(&expected, sample) || !SampleFiles::readHeader(&file, &header)
+	    || !SampleFiles::headersMatch(header, expected)) {
+		D_PRINTLN("perc file out of date: %s", path.get());
+		f_close(&file);
+		fileOpen = false;
+		return false;
+	}
+	return true;
+}
+
+void writeFile(Sample* sample) {
+	String path;
+	FileHeader header;
+	if (!getFilePath(&path, sample) || !makeFileHeader(&header, sample)) {
+		return;
+	}
+
+	if (f_open(&file, path.get(), FA_CREATE_ALWAYS | FA_WRITE) != FR_OK) {
+		return;
+	}
+
+	UINT numBytesWritten;
+	UINT numBytes = length * 2;
+	bool success = (SampleFiles::writeHeader(&file, header)
+	                && f_write(&file, percussiveness, numBytes, &numBytesWritten) == FR_OK
+	                && numBytesWritten == numBytes);
+
+	f_close(&file);
+
+	if (!success) {
+		// Don't leave half a file for next time
+		f_unlink(path.get());
+	}
+}
+
+// Just as fillPercCache() does it, but for every sample starting in this Cluster, in one go
+void analyseCluster(Sample* sample, Cluster* cluster, int32_t clusterIndex, int32_t reversed) {
+	int32_t byteDepth = sample->byteDepth;
+	int32_t numChannels = sample->numChannels;
+	int32_t bytesPerSample = byteDepth * numChannels;
+	uint32_t bitMask = sample->bitMask; // Leave out whatever's before the Cluster's data, for the first sample
+	int64_t clusterStart = ((int64_t)clusterIndex << audioFileManager.clusterSizeMagnitude)
+	                       - sample->audioDataStartPosBytes;
+
+	int64_t firstSample = std::max<int64_t>((clusterStart + bytesPerSample - 1) / bytesPerSample, 0);
+	int64_t endSample = std::min<int64_t>(
+	    (clusterStart + audioFileManager.clusterSize + bytesPerSample - 1) / bytesPerSample, lengthInSamples);
+	if (firstSample >= endSample) {
+		return;
+	}
+
+	int32_t playDirection = reversed ? -1 : 1;
+	int32_t pos = reversed ? endSample - 1 : firstSample;
+	int32_t stopPos = reversed ? firstSample - 1 : endSample;
+	uint8_t* output = &percussiveness[reversed ? length : 0];
+
+	for (; pos != stopPos; pos += playDirection) {
+		char* readPos = &cluster->data[(int64_t)pos * bytesPerSample - clusterStart] - 4 + byteDepth;
+		int32_t angle = analysis.addSample(readPos, bitMask, byteDepth, numChannels);
+
+		int32_t nextPos = pos + playDirection;
+		if ((nextPos & (kPercBufferReductionSize - 1)) == (kPercBufferReductionSize >> 1) - reversed) {
+			output[nextPos >> kPercBufferReductionMagnitude] = analysis.getPercussiveness(angle);
+		}
+
+		analysis.lastAngle = angle;
+	}
+}
+
+void install(Sample* sample) {
+	bool success = sample->installPercCache(0, percussiveness)
+	               && sample->installPercCache(1, &percussiveness[length]);
+	sample->percCacheFromFile = success;
+	finish(!success);
+}
+
+} // namespace
+
+void percCacheWanted(Sample* sample) {
+	if (sampleBeingDone || !shouldUseCard()) {
+		return;
+	}
+	sampleBeingDone = sample;
+	stage = Stage::START;
+}
+
+void sampleDeleted(Sample* sample) {
+	if (sampleBeingDone == sample) {
+		sampleBeingDone = nullptr;
+		finish(false);
+	}
+}
+
+void continueWork() {
+	Sample* sample = sampleBeingDone;
+	if (!sample) {
+		return;
+	}
+
+	if (sample->lengthInSamples != lengthInSamples && stage != Stage::START) {
+		finish(false); // Still being recorded. Start again once it's done
+		return;
+	}
+
+	if (stage == Stage::START) {
+		if (sample->unloadable || !sample->lengthInSamples) {
+			finish(true);
+			return;
+		}
+		lengthInSamples = sample->lengthInSamples;
+		length = sample->getPercCacheLength();
+		percussiveness = (uint8_t*)GeneralMemoryAllocator::get().allocLowSpeed(length * 2);
+		if (!percussiveness) {
+			finish(false);
+			return;
+		}
+		memset(percussiveness, 0, length * 2);
+
+		if (openFile(sample)) {
+			stage = Stage::READING;
+			numBytesRead = 0;
+		}
+		else {
+			stage = Stage::FORWARDS;
+			nextClusterIndex = sample->getFirstClusterIndexWithAudioData();
+			analysis = SamplePercCacheZone(0);
+		}
+		return;
+	}
+
+	// Playback streaming gets the card first. We'll carry on when it's had what it needs
+	if (audioFileManager.loadingQueue.getNumElements()) {
+		return;
+	}
+
+	if (stage == Stage::READING) {
+		UINT numBytes = std::min<int32_t>(audioFileManager.clusterSize, length * 2 - numBytesRead);
+		UINT numBytesReadNow;
+		if (f_read(&file, &percussiveness[numBytesRead], numBytes, &numBytesReadNow) != FR_OK
+		    || numBytesReadNow != numBytes) {
+			finish(true);
+			return;
+		}
+		numBytesRead += numBytes;
+		if (numBytesRead == length * 2) {
+			f_close(&file);
+			fileOpen = false;
+			install(sample);
+		}
+		return;
+	}
+
+	int32_t firstClusterIndex = sample->getFirstClusterIndexWithAudioData();
+	int32_t endClusterIndex = sample->getFirstClusterIndexWithNoAudioData();
+
+	for (int32_t i = 0; i < kMaxClustersPerCall; i++) {
+		int32_t reversed = (stage == Stage::REVERSED);
+
+		if (!reversed && nextClusterIndex >= endClusterIndex) {
+			stage = Stage::REVERSED;
+			nextClusterIndex = endClusterIndex - 1;
+			analysis = SamplePercCacheZone(0);
+			return;
+		}
+		if (reversed && nextClusterIndex < firstClusterIndex) {
+			writeFile(sample);
+			install(sample);
+			return;
+		}
+
+		if (audioFileManager.loadingQueue.getNumElements()) {
+			return;
+		}
+
+		Cluster* cluster = sample->clusters.getElement(nextClusterIndex)
+		                       ->getCluster(sample, nextClusterIndex, CLUSTER_LOAD_IMMEDIATELY);
+		if (!cluster) {
+			// The file's gone. Otherwise, maybe the card's busy - try again next time
+			if (sample->unloadable) {
+				finish(true);
+			}
+			return;
+		}
+
+		analyseCluster(sample, cluster, nextClusterIndex, reversed);
+		audioFileManager.removeReasonFromCluster(cluster, "E457");
+		nextClusterIndex += reversed ? -1 : 1;
+	}
+}
+
+} // namespace SamplePercCacheFile
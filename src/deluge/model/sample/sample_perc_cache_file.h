@@ -0,0 +1,43 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+class Sample;
+
+// Works out a Sample's whole perc cache - the percussiveness map TimeStretcher picks its hops by - in the background,
+// for both play-directions, rather than bit by bit as it plays. That way it comes out the same wherever playback
+// started, and time-stretched voices needn't spend render time on it. If the community feature is on.
+//
+// The result is kept next to the audio file, with kFileExtension added to its name, and read back from there next
+// time - including to fill back in any of it that gets stolen. The file is a FileHeader (see the .cpp) followed by
+// getPercCacheLength() bytes of percussiveness for forwards and then the same for reversed, so it could just as well be
+// made by a tool on a computer.
+//
+// One Sample at a time, and only while no Clusters are waiting to be loaded for playback.
+namespace SamplePercCacheFile {
+
+constexpr char const* kFileExtension = ".perc";
+
+// Called by Sample::fillPercCache()
+void percCacheWanted(Sample* sample);
+
+void sampleDeleted(Sample* sample);
+
+void continueWork();
+
+} // namespace SamplePercCacheFile
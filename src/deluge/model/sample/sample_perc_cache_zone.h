@@ -18,6 +18,7 @@
 #pragma once
 
 #include "definitions_cxx.hpp"
+#include "util/functions.h"
 
 class SamplePercCacheZone {
 public:
@@ -35,4 +36,38 @@ public:
 	int32_t lastAngle;
 	int32_t lastSampleRead;
 	int32_t angleLPFMem[kDifferenceLPFPoles];
+
+	// Feeds the sample ending at readPos + 3 through the analysis, and returns its smoothed "angle". Sample::
+	// fillPercCache() and SamplePercCacheFile both go through here, so they can't disagree about what's in the cache
+	[[gnu::always_inline]] int32_t addSample(char const* readPos, uint32_t bitMask, int32_t byteDepth,
+	                                         int32_t numChannels) {
+		// Have to make it smaller even if only one, so the "angle" doesn't overflow. The mask leaves out whatever's
+		// before the sample, which for the first one in a Cluster isn't audio
+		int32_t thisSampleRead = (int32_t)(*(int32_t*)readPos & bitMask) >> 2;
+		if (numChannels == 2) {
+			thisSampleRead += (int32_t)(*(int32_t*)(readPos + byteDepth) & bitMask) >> 2;
+		}
+
+		int32_t angle = thisSampleRead - lastSampleRead;
+		lastSampleRead = thisSampleRead;
+		if (angle < 0) {
+			angle = -angle;
+		}
+
+		for (auto& pole : angleLPFMem) {
+			pole += (angle - pole) >> 9;
+			angle = pole;
+		}
+		return angle;
+	}
+
+	// For the perc pixel centred on the sample whose angle this is. Doesn't update lastAngle
+	[[nodiscard]] uint8_t getPercussiveness(int32_t angle) const {
+		int32_t difference = angle - lastAngle;
+		if (difference < 0) {
+			difference = -difference;
+		}
+		int32_t percussiveness = angle ? ((uint64_t)difference * 262144 / angle) >> 1 : 0;
+		return getTanH<23>(percussiveness);
+	}
 };
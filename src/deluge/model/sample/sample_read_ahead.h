@@ -0,0 +1,44 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "definitions_cxx.hpp"
+#include <algorithm>
+#include <cstdint>
+
+/// How many Clusters a SampleLowLevelReader should hold - the one it's reading, plus those loaded ahead - so that the
+/// furthest one, which it enqueues on moving into a new Cluster, is loaded by the time it's reached.
+///
+/// bytesPerSample is how far through the file the reader moves per output sample, 24-bit fixed point. loadLatency is
+/// how long Clusters are currently taking to read, in samples - see smoothLoadLatency(). Allows twice that, for the odd
+/// slow read, and never goes below kNumClustersLoadedAhead
+constexpr int32_t getNumClustersToLoadAhead(uint64_t bytesPerSample, uint32_t loadLatency, uint32_t clusterSize) {
+	uint64_t bytesWhileLoading = (bytesPerSample * loadLatency * 2) >> 24;
+	uint64_t numClustersWhileLoading = (bytesWhileLoading + clusterSize - 1) / clusterSize;
+	return std::clamp<uint64_t>(numClustersWhileLoading + 1, kNumClustersLoadedAhead, kMaxNumClustersLoadedAhead);
+}
+
+/// Moves the load latency towards how long the latest Cluster read took, both in samples: a quarter of the way if that
+/// was slower, so a card slowing down gets caught up with within a few reads, and a sixteenth of the way if it was
+/// quicker. Neither way does one odd read swing it far
+constexpr uint32_t smoothLoadLatency(uint32_t loadLatency, uint32_t readTime) {
+	if (readTime > loadLatency) {
+		return loadLatency + ((readTime - loadLatency + 3) >> 2);
+	}
+	return loadLatency - ((loadLatency - readTime) >> 4);
+}
@@ -482,6 +482,11 @@ Error SampleRecorder::writeAnyCompletedClusters() {
 		if (error != Error::NONE) {
 			return error;
 		}
+
+		// Finishing a long recording can leave plenty of these to write
+		if (AudioEngine::yieldIsDue()) {
+			AudioEngine::routineWithClusterLoading();
+		}
 	}
 
 	return Error::NONE;
@@ -1206,7 +1211,7 @@ Error SampleRecorder::alterFile(MonitoringAction action, int32_t lshiftAmount, u
 
 	while (true) {
 
-		if (!(count & 0b11111111)) { // 10x 1's seems to work ok. So we go down to 8 to be sure
+		if (!(count & 0b1111) && AudioEngine::yieldIsDue()) {
 			AudioEngine::routineWithClusterLoading();
 
 			uiTimerManager.routine();
@@ -160,7 +160,28 @@ void RuntimeFeatureSettings::init() {
 	// EnableDxShortcuts
 	SetupOnOffSetting(settings[RuntimeFeatureSettingType::EnableDxShortcuts], STRING_FOR_COMMUNITY_FEATURE_DX_SHORTCUTS,
 	                  "enableDxShortcuts", RuntimeFeatureStateToggle::Off);
-
+	// WaveformPeakFiles
+	SetupOnOffSetting(settings[RuntimeFeatureSettingType::WaveformPeakFiles],
+	                  STRING_FOR_COMMUNITY_FEATURE_WAVEFORM_PEAK_FILES, "waveformPeakFiles",
+	                  RuntimeFeatureStateToggle::Off);
+	// SampleCacheFiles
+	SetupOnOffSetting(settings[RuntimeFeatureSettingType::SampleCacheFiles],
+	                  STRING_FOR_COMMUNITY_FEATURE_SAMPLE_CACHE_FILES, "sampleCacheFiles",
+	                  RuntimeFeatureStateToggle::Off);
+	// PercussivenessFiles
+	SetupOnOffSetting(settings[RuntimeFeatureSettingType::PercussivenessFiles],
+	                  STRING_FOR_COMMUNITY_FEATURE_PERCUSSIVENESS_FILES, "percussivenessFiles",
+	                  RuntimeFeatureStateToggle::Off);
+	// ResampleOnLoad
+	SetupOnOffSetting(settings[RuntimeFeatureSettingType::ResampleOnLoad],
+	                  STRING_FOR_COMMUNITY_FEATURE_RESAMPLE_ON_LOAD, "resampleOnLoad", RuntimeFeatureStateToggle::Off);
+	// LoadSnapshots
+	SetupOnOffSetting(settings[RuntimeFeatureSettingType::LoadSnapshots], STRING_FOR_COMMUNITY_FEATURE_LOAD_SNAPSHOTS,
+	                  "loadSnapshots", RuntimeFeatureStateToggle::Off);
+	// DelayImpulseResponse
+	SetupOnOffSetting(settings[RuntimeFeatureSettingType::DelayImpulseResponse],
+	                  STRING_FOR_COMMUNITY_FEATURE_DELAY_IMPULSE_RESPONSE, "delayImpulseResponse",
+	                  RuntimeFeatureStateToggle::Off);
 	// EmulatedDisplay
 	SetupEmulatedDisplaySetting(settings[RuntimeFeatureSettingType::EmulatedDisplay],
 	                            STRING_FOR_COMMUNITY_FEATURE_EMULATED_DISPLAY, "emulatedDisplay",
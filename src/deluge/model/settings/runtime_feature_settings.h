@@ -59,6 +59,12 @@ enum RuntimeFeatureSettingType : uint32_t {
 	LightShiftLed,
 	EnableGrainFX,
 	EnableDxShortcuts,
+	WaveformPeakFiles,
+	SampleCacheFiles,
+	PercussivenessFiles,
+	ResampleOnLoad,
+	LoadSnapshots,
+	DelayImpulseResponse,
 	EmulatedDisplay,
 	MaxElement // Keep as boundary
 };
@@ -50,6 +50,7 @@
 #include "processing/audio_output.h"
 #include "processing/engines/audio_engine.h"
 #include "processing/engines/cv_engine.h"
+#include "processing/engines/render_profiler.h"
 #include "processing/sound/sound_instrument.h"
 #include "storage/storage_manager.h"
 #include "util/lookuptables/lookuptables.h"
@@ -57,7 +58,9 @@
 #include <new>
 #include <stdint.h>
 
-extern "C" {}
+extern "C" {
+#include "RZA1/ostm/ostm.h"
+}
 
 namespace params = deluge::modulation::params;
 
@@ -1656,11 +1659,11 @@ Error Song::readFromFile(Deserializer& reader) {
 		default:
 unknownTag:
 			if (!strcmp(tagName, "firmwareVersion") || !strcmp(tagName, "earliestCompatibleFirmware")) {
-				smDeserializer.tryReadingFirmwareTagFromFile(tagName);
+				reader.tryReadingFirmwareTagFromFile(tagName);
 				reader.exitTag(tagName);
 			}
 			else if (!strcmp(tagName, "preview") || !strcmp(tagName, "previewNumPads")) {
-				smDeserializer.tryReadingFirmwareTagFromFile(tagName);
+				reader.tryReadingFirmwareTagFromFile(tagName);
 				reader.exitTag(tagName);
 			}
 			else if (!strcmp(tagName, "sessionLayout")) {
@@ -2011,7 +2014,7 @@ loadOutput:
 					return result;
 				}
 				else {
-					Error result = smDeserializer.tryReadingFirmwareTagFromFile(tagName);
+					Error result = reader.tryReadingFirmwareTagFromFile(tagName);
 					if (result != Error::NONE && result != Error::RESULT_TAG_UNUSED) {
 						return result;
 					}
@@ -2302,6 +2305,9 @@ void Song::loadAllSamples(bool mayActuallyReadFiles) {
 
 	for (Output* thisOutput = firstOutput; thisOutput; thisOutput = thisOutput->next) {
 		thisOutput->loadAllAudioFiles(mayActuallyReadFiles);
+		if (AudioEngine::yieldIsDue()) {
+			AudioEngine::routineWithClusterLoading(); // -----------------------------------
+		}
 	}
 
 	// For each Clip in session and arranger
@@ -2310,8 +2316,8 @@ traverseClips:
 	for (int32_t c = 0; c < clipArray->getNumElements(); c++) {
 
 		// If not reading files, high chance that we'll be searching through memory a lot and not reading the card
-		// (which would call the audio routine), so we'd better call the audio routine here.
-		if (!mayActuallyReadFiles && !(c & 7)) { // 31 bad. 15 seems to pass. 7 to be safe
+		// (which would call the audio routine), so we'd better call the audio routine here if it's been a while.
+		if (AudioEngine::yieldIsDue()) {
 			AudioEngine::logAction("Song::loadAllSamples");
 			AudioEngine::routineWithClusterLoading(); // -----------------------------------
 		}
@@ -2420,15 +2426,23 @@ void Song::renderAudio(StereoSample* outputBuffer, int32_t numSamples, int32_t*
 	ModelStack* modelStack = setupModelStackWithSong(modelStackMemory, this);
 
 	AudioEngine::logAction("Start output render");
+	RenderProfiler* profiler = AudioEngine::renderProfiler;
 	for (Output* output = firstOutput; output; output = output->next) {
 		if (!output->inValidState) {
+			if (profiler) {
+				profiler->outputRendered(0);
+			}
 			continue;
 		}
 
 		bool isClipActiveNow = (output->activeClip && isClipActive(output->activeClip->getClipBeingRecordedFrom()));
 
+		uint32_t startTime = profiler ? getTimerValue(0) : 0;
 		output->renderOutput(modelStack, outputBuffer, outputBuffer + numSamples, numSamples, reverbBuffer,
 		                     volumePostFX >> 1, sideChainHitPending, !isClipActiveNow, isClipActiveNow);
+		if (profiler) {
+			profiler->outputRendered(getTimerValue(0) - startTime);
+		}
 #if DO_AUDIO_LOG
 		char buf[64];
 		snprintf(buf, sizeof(buf), "complete: %s", output->name.get());
@@ -600,6 +600,7 @@ void Voice::noteOff(ModelStackWithVoice* modelStack, bool allowReleaseStage) {
 	else {
 		previouslyIgnoredNoteOff = true;
 	}
+	AudioEngine::updateVoiceCullPriority(this);
 
 	if (sound->synthMode != SynthMode::FM) {
 		for (int32_t s = 0; s < kNumSources; s++) {
@@ -705,10 +706,14 @@ uint32_t Voice::getLocalLFOPhaseIncrement() {
 // Returns false if became inactive and needs unassigning
 [[gnu::hot]] bool Voice::render(ModelStackWithVoice* modelStack, int32_t* soundBuffer, int32_t numSamples,
                                 bool soundRenderingInStereo, bool applyingPanAtVoiceLevel, uint32_t sourcesChanged,
-                                bool doLPF, bool doHPF, int32_t externalPitchAdjust) {
+                                bool doLPF, bool doHPF, int32_t externalPitchAdjust, DeferredRender* deferred) {
 
 	GeneralMemoryAllocator::get().checkStack("Voice::render");
 
+	if (deferred) {
+		deferred->pending = false;
+	}
+
 	ParamManagerForTimeline* paramManager = (ParamManagerForTimeline*)modelStack->paramManager;
 	Sound* sound = (Sound*)modelStack->modControllable;
 
@@ -1168,7 +1173,7 @@ decidedWhichBufferRenderingInto:
 	// Or if rendering to local Voice buffer, We need to do some other setting up - like wiping the buffer clean first
 	else {
 		// two first indicies are reserved in case we need stereo for unison spread
-		oscBuffer = spareRenderingBuffer[0];
+		oscBuffer = deferred ? deferred->oscBuffer : spareRenderingBuffer[0];
 		int32_t channels = stereoUnison ? 2 : 1;
 
 		int32_t const* const oscBufferEnd = oscBuffer + numSamples * channels;
@@ -1636,68 +1641,23 @@ skipUnisonPart: {}
 				dsp::foldBufferPolyApproximation(oscBuffer, oscBufferEnd, foldAmount);
 			}
 
-			filterSet.renderLong(oscBuffer, oscBufferEnd, numSamples);
-
-			// No clipping
-			if (!sound->clippingAmount) {
-				int32_t const* __restrict__ oscBufferPos = oscBuffer; // For traversal
-				int32_t* __restrict__ outputSample = soundBuffer;
-				int32_t overallOscAmplitudeNow = overallOscAmplitudeLastTime;
-
-				do {
-					int32_t output = *oscBufferPos;
-
-					if (synthMode != SynthMode::FM) {
-						overallOscAmplitudeNow += overallOscillatorAmplitudeIncrement;
-						output = multiply_32x32_rshift32_rounded(output, overallOscAmplitudeNow) << 1;
-					}
-
-					if (soundRenderingInStereo) {
-						if (doPanning) {
-							((StereoSample*)outputSample)->addPannedMono(output, amplitudeL, amplitudeR);
-						}
-						else {
-							((StereoSample*)outputSample)->addMono(output);
-						}
-						outputSample += 2;
-					}
-					else {
-						*outputSample += output;
-						outputSample++;
-					}
-				} while (++oscBufferPos != oscBufferEnd);
+			DeferredRender output = {oscBuffer,
+			                         soundBuffer,
+			                         numSamples,
+			                         overallOscAmplitudeLastTime,
+			                         overallOscillatorAmplitudeIncrement,
+			                         amplitudeL,
+			                         amplitudeR,
+			                         synthMode != SynthMode::FM,
+			                         doPanning,
+			                         soundRenderingInStereo,
+			                         true};
+			if (deferred) {
+				*deferred = output;
 			}
-
-			// Yes clipping
 			else {
-				int32_t const* __restrict__ oscBufferPos = oscBuffer; // For traversal
-				int32_t* __restrict__ outputSample = soundBuffer;
-				int32_t overallOscAmplitudeNow = overallOscAmplitudeLastTime;
-
-				do {
-					int32_t output = *oscBufferPos;
-
-					if (synthMode != SynthMode::FM) {
-						overallOscAmplitudeNow += overallOscillatorAmplitudeIncrement;
-						output = multiply_32x32_rshift32_rounded(output, overallOscAmplitudeNow) << 1;
-					}
-
-					sound->saturate(&output, &lastSaturationTanHWorkingValue[0]);
-
-					if (soundRenderingInStereo) {
-						if (doPanning) {
-							((StereoSample*)outputSample)->addPannedMono(output, amplitudeL, amplitudeR);
-						}
-						else {
-							((StereoSample*)outputSample)->addMono(output);
-						}
-						outputSample += 2;
-					}
-					else {
-						*outputSample += output;
-						outputSample++;
-					}
-				} while (++oscBufferPos != oscBufferEnd);
+				filterSet.renderLong(oscBuffer, oscBufferEnd, numSamples);
+				writeMonoOutput(sound, output);
 			}
 		}
 	}
@@ -1716,6 +1676,80 @@ renderingDone:
 	return !unassignVoiceAfter;
 }
 
+void Voice::finishRender(Sound* sound, DeferredRender& deferred, bool filtered) {
+	if (!filtered) {
+		filterSet.renderLong(deferred.oscBuffer, deferred.oscBuffer + deferred.numSamples, deferred.numSamples);
+	}
+	writeMonoOutput(sound, deferred);
+	deferred.pending = false;
+}
+
+[[gnu::hot]] void Voice::writeMonoOutput(Sound* sound, DeferredRender const& deferred) {
+	int32_t const* const oscBufferEnd = deferred.oscBuffer + deferred.numSamples;
+
+	// No clipping
+	if (!sound->clippingAmount) {
+		int32_t const* __restrict__ oscBufferPos = deferred.oscBuffer; // For traversal
+		int32_t* __restrict__ outputSample = deferred.soundBuffer;
+		int32_t overallOscAmplitudeNow = deferred.overallOscAmplitude;
+
+		do {
+			int32_t output = *oscBufferPos;
+
+			if (deferred.applyOverallOscAmplitude) {
+				overallOscAmplitudeNow += deferred.overallOscAmplitudeIncrement;
+				output = multiply_32x32_rshift32_rounded(output, overallOscAmplitudeNow) << 1;
+			}
+
+			if (deferred.soundRenderingInStereo) {
+				if (deferred.doPanning) {
+					((StereoSample*)outputSample)->addPannedMono(output, deferred.amplitudeL, deferred.amplitudeR);
+				}
+				else {
+					((StereoSample*)outputSample)->addMono(output);
+				}
+				outputSample += 2;
+			}
+			else {
+				*outputSample += output;
+				outputSample++;
+			}
+		} while (++oscBufferPos != oscBufferEnd);
+	}
+
+	// Yes clipping
+	else {
+		int32_t const* __restrict__ oscBufferPos = deferred.oscBuffer; // For traversal
+		int32_t* __restrict__ outputSample = deferred.soundBuffer;
+		int32_t overallOscAmplitudeNow = deferred.overallOscAmplitude;
+
+		do {
+			int32_t output = *oscBufferPos;
+
+			if (deferred.applyOverallOscAmplitude) {
+				overallOscAmplitudeNow += deferred.overallOscAmplitudeIncrement;
+				output = multiply_32x32_rshift32_rounded(output, overallOscAmplitudeNow) << 1;
+			}
+
+			sound->saturate(&output, &lastSaturationTanHWorkingValue[0]);
+
+			if (deferred.soundRenderingInStereo) {
+				if (deferred.doPanning) {
+					((StereoSample*)outputSample)->addPannedMono(output, deferred.amplitudeL, deferred.amplitudeR);
+				}
+				else {
+					((StereoSample*)outputSample)->addMono(output);
+				}
+				outputSample += 2;
+			}
+			else {
+				*outputSample += output;
+				outputSample++;
+			}
+		} while (++oscBufferPos != oscBufferEnd);
+	}
+}
+
 bool Voice::areAllUnisonPartsInactive(ModelStackWithVoice* modelStack) {
 	// If no noise-source, then it might be time to unassign the voice...
 	if (!modelStack->paramManager->getPatchedParamSet()->params[params::LOCAL_NOISE_VOLUME].containsSomething(
@@ -3309,6 +3343,7 @@ storePhase:
 bool Voice::doFastRelease(uint32_t releaseIncrement) {
 	if (doneFirstRender) {
 		envelopes[0].unconditionalRelease(EnvelopeStage::FAST_RELEASE, releaseIncrement);
+		AudioEngine::updateVoiceCullPriority(this);
 		return true;
 	}
 
@@ -3321,6 +3356,7 @@ bool Voice::doFastRelease(uint32_t releaseIncrement) {
 bool Voice::doImmediateRelease() {
 	if (doneFirstRender) {
 		envelopes[0].unconditionalOff();
+		AudioEngine::updateVoiceCullPriority(this);
 		return true;
 	}
 
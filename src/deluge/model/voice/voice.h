@@ -85,11 +85,34 @@ public:
 
 	Voice* nextUnassigned;
 
+	// Position in AudioEngine's VoiceCullQueue. cullRating is getPriorityRating() as of when it was last updated there
+	uint32_t cullRating = 0;
+	int32_t cullHeapIndex = -1;
+	bool softCullable = false;
+
+	/// When Sound::render() is filtering several Voices together, render() stops short of the filters for a mono Voice
+	/// and leaves what it still has to do in here, for finishRender()
+	struct DeferredRender {
+		int32_t* oscBuffer; // Set by the caller - room for SSI_TX_BUFFER_NUM_SAMPLES * 2 samples
+		int32_t* soundBuffer;
+		int32_t numSamples;
+		int32_t overallOscAmplitude;
+		int32_t overallOscAmplitudeIncrement;
+		int32_t amplitudeL;
+		int32_t amplitudeR;
+		bool applyOverallOscAmplitude;
+		bool doPanning;
+		bool soundRenderingInStereo;
+		bool pending; // Whether render() left anything to do
+	};
+
 	uint32_t getLocalLFOPhaseIncrement();
 	void setAsUnassigned(ModelStackWithVoice* modelStack, bool deletingSong = false);
 	bool render(ModelStackWithVoice* modelStack, int32_t* soundBuffer, int32_t numSamples, bool soundRenderingInStereo,
 	            bool applyingPanAtVoiceLevel, uint32_t sourcesChanged, bool doLPF, bool doHPF,
-	            int32_t externalPitchAdjust);
+	            int32_t externalPitchAdjust, DeferredRender* deferred = nullptr);
+	/// Filter oscBuffer - unless the caller already has - and add it to the soundBuffer
+	void finishRender(Sound* sound, DeferredRender& deferred, bool filtered);
 
 	void calculatePhaseIncrements(ModelStackWithVoice* modelStack);
 	bool sampleZoneChanged(ModelStackWithVoice* modelStack, int32_t s, MarkerType markerType);
@@ -129,6 +152,7 @@ private:
 	                       uint32_t* oscSyncPos, uint32_t* oscSyncPhaseIncrements, int32_t amplitudeIncrement,
 	                       uint32_t* getPhaseIncrements, bool getOutAfterPhaseIncrements, int32_t waveIndexIncrement);
 	bool adjustPitch(uint32_t* phaseIncrement, int32_t adjustment);
+	void writeMonoOutput(Sound* sound, DeferredRender const& output);
 
 	void renderSineWaveWithFeedback(int32_t* thisSample, int32_t numSamples, uint32_t* phase, int32_t amplitude,
 	                                uint32_t phaseIncrement, int32_t feedbackAmount, int32_t* lastFeedbackValue,
@@ -0,0 +1,75 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "model/voice/voice_cull_queue.h"
+
+// Same test cullVoice() used to apply to each Voice when doing a SOFT_ALWAYS cull
+bool VoiceCullQueue::isSoftCullable(Voice* voice) {
+	return voice->envelopes[0].state <= EnvelopeStage::FAST_RELEASE
+	       && voice->envelopes[0].fastReleaseIncrement < SOFT_CULL_INCREMENT;
+}
+
+// A Voice can move between the heaps, so each needs room for all of them
+void VoiceCullQueue::reserve() {
+	softCullable_.reserve(kVoiceCullQueueCapacity);
+	others_.reserve(kVoiceCullQueueCapacity);
+}
+
+bool VoiceCullQueue::add(Voice* voice) {
+	if (softCullable_.size() + others_.size() >= kVoiceCullQueueCapacity) {
+		return false;
+	}
+	voice->cullRating = voice->getPriorityRating();
+	voice->softCullable = isSoftCullable(voice);
+	heapFor(voice).push(voice);
+	return true;
+}
+
+void VoiceCullQueue::remove(Voice* voice) {
+	heapFor(voice).remove(voice);
+}
+
+void VoiceCullQueue::update(Voice* voice) {
+	if (!Heap::contains(voice)) {
+		return;
+	}
+
+	uint32_t newRating = voice->getPriorityRating();
+	bool newSoftCullable = isSoftCullable(voice);
+
+	if (newSoftCullable != voice->softCullable) {
+		heapFor(voice).remove(voice);
+		voice->cullRating = newRating;
+		voice->softCullable = newSoftCullable;
+		heapFor(voice).push(voice);
+	}
+	else if (newRating != voice->cullRating) {
+		voice->cullRating = newRating;
+		heapFor(voice).update(voice);
+	}
+}
+
+Voice* VoiceCullQueue::getBest(bool softCullableOnly) const {
+	Voice* best = softCullable_.top();
+	if (!softCullableOnly) {
+		Voice* otherBest = others_.top();
+		if (!best || (otherBest && otherBest->cullRating > best->cullRating)) {
+			best = otherBest;
+		}
+	}
+	return best;
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "memory/fallback_allocator.h"
+#include "model/voice/voice.h"
+#include "util/container/heap/intrusive_heap.h"
+
+/// More Voices than this can't be active at once. Way more than could ever be rendered in time
+constexpr int32_t kVoiceCullQueueCapacity = 256;
+
+/// Keeps every active Voice ordered by Voice::getPriorityRating(), so the best one to cull can be found without
+/// rating every Voice each time. Voices which have already been soft-culled (or are otherwise fading out fast) are
+/// kept in a separate heap, since a SOFT_ALWAYS cull has to skip them.
+///
+/// A Voice's rating changes when its envelope changes state or its Sound's numVoicesAssigned changes, so update()
+/// needs calling after those. Sound::render() also updates every Voice it renders, which catches anything else.
+///
+/// Holds no more than kVoiceCullQueueCapacity Voices, with room for them all reserve()d up front, so nothing's
+/// allocated while the audio routine is soliciting Voices.
+class VoiceCullQueue {
+public:
+	void reserve();
+	/// Fails if the queue's full
+	[[nodiscard]] bool add(Voice* voice);
+	void remove(Voice* voice);
+	void update(Voice* voice);
+
+	/// The Voice with the highest rating, optionally only considering ones which haven't been soft-culled yet
+	[[nodiscard]] Voice* getBest(bool softCullableOnly) const;
+
+	[[nodiscard]] static bool isSoftCullable(Voice* voice);
+
+private:
+	using Heap = IntrusiveHeap<Voice, uint32_t, &Voice::cullRating, &Voice::cullHeapIndex, std::greater<uint32_t>,
+	                           std::vector<Voice*, deluge::memory::fallback_allocator<Voice*>>>;
+
+	Heap& heapFor(Voice* voice) { return voice->softCullable ? softCullable_ : others_; }
+
+	Heap softCullable_;
+	Heap others_;
+};
@@ -22,6 +22,7 @@
 #include "memory/general_memory_allocator.h"
 #include "model/sample/sample.h"
 #include "model/sample/sample_cache.h"
+#include "model/sample/sample_cache_file.h"
 #include "model/voice/voice.h"
 #include "playback/playback_handler.h"
 #include "processing/engines/audio_engine.h"
@@ -199,10 +200,10 @@ LateStartAttemptStatus VoiceSample::attemptLateSampleStart(SamplePlaybackGuide*
 
 	// We load our new Clusters into a secondary array first, to preserve the reason-holding power of whatever is
 	// already in our main one until we unassign them below
-	Cluster* newClusters[kNumClustersLoadedAhead];
+	Cluster* newClusters[kMaxNumClustersLoadedAhead];
 	memset(newClusters, 0, sizeof(newClusters));
 
-	for (int32_t l = 0; l < kNumClustersLoadedAhead; l++) {
+	for (int32_t l = 0; l < numClustersLoadedAhead; l++) {
 
 		// Grab it.
 		newClusters[l] = sample->clusters.getElement(clusterIndex)->getCluster(sample, clusterIndex, CLUSTER_ENQUEUE);
@@ -426,6 +427,11 @@ bool VoiceSample::render(SamplePlaybackGuide* guide, int32_t* __restrict__ outpu
 
 	int32_t playDirection = guide->playDirection;
 
+	setReadAheadRate(phaseIncrement, timeStretchRatio);
+	if (timeStretcher) {
+		timeStretcher->olderPartReader.setReadAheadRate(phaseIncrement, timeStretchRatio);
+	}
+
 	// If there's a cache, check some stuff. Do this first, cos this can cause us to return
 	if (cache) {
 
@@ -508,7 +514,8 @@ bool VoiceSample::render(SamplePlaybackGuide* guide, int32_t* __restrict__ outpu
 					// about it. Also can't continue to write if doing linear interpolation now
 					if (cache->writeBytePos < cacheBytePos
 					    || (phaseIncrement != kMaxSampleValue
-					        && interpolationBufferSize != kInterpolationMaxNumSamples)) {
+					        && interpolationBufferSize != kInterpolationMaxNumSamples)
+					    || cache->restoringFromCard) {
 						cache = NULL;
 					}
 
@@ -666,8 +673,9 @@ readCachedWindow:
 				return false;
 			}
 
-			// If linear interpolation, no cache writing (or anything) allowed
-			if (interpolationBufferSize != kInterpolationMaxNumSamples) {
+			// If linear interpolation, no cache writing (or anything) allowed. Nor while the rest is still coming from
+			// the card
+			if (interpolationBufferSize != kInterpolationMaxNumSamples || cache->restoringFromCard) {
 				cache = NULL;
 			}
 
@@ -846,7 +854,7 @@ readCachedWindow:
 				unassignAllReasons(false); // We're going to set new "reasons".
 
 				int32_t nextUncachedClusterIndex = uncachedClusterIndex;
-				for (int32_t l = 0; l < kNumClustersLoadedAhead; l++) {
+				for (int32_t l = 0; l < numClustersLoadedAhead; l++) {
 					clusters[l] = sample->clusters.getElement(nextUncachedClusterIndex)
 					                  ->getCluster(sample, nextUncachedClusterIndex, CLUSTER_ENQUEUE);
 					if (!clusters[l]) {
@@ -895,6 +903,7 @@ uncachedPlayback:
 			    <= 0) { // Might be less than 0 if it was just changed... although the code that does that is suppose to
 				        // also detect that we're past it and restart the loop...
 				D_PRINTLN("Loop endpoint reached, writing cache");
+				SampleCacheFile::cacheWritingFinished(cache);
 				switchToReadingCacheFromWriting();
 				goto readCachedWindow;
 			}
@@ -904,6 +913,7 @@ uncachedPlayback:
 			int32_t cachingBytesTilWaveformEnd = cacheEndPointBytes - cache->writeBytePos;
 			if (cachingBytesTilWaveformEnd <= 0) { // Probably couldn't actually get below 0?
 				// D_PRINTLN("waveform end reached, writing cache");
+				SampleCacheFile::cacheWritingFinished(cache);
 				return false;
 			}
 
@@ -1771,6 +1781,11 @@ bool VoiceSample::possiblySetUpCache(SampleControls* sampleControls, SamplePlayb
 	            ->getOrCreateCache((SampleHolder*)guide->audioFileHolder, phaseIncrement, timeStretchRatio,
 	                               guide->playDirection == -1, mayCreate, &writingToCache);
 
+	// If it's only just started coming back from the card, there's nothing to read yet - and we mustn't write to it
+	if (cache && cache->restoringFromCard && !cache->writeBytePos) {
+		cache = NULL;
+	}
+
 	if (cache) {
 		// D_PRINTLN("cache gotten");
 		cacheBytePos = 0;
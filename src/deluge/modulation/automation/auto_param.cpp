@@ -1902,11 +1902,11 @@ Error AutoParam::readFromFile(Deserializer& reader, int32_t readAutomationUpToPo
 	// Or, normal case - hex and automation...
 
 	// First, read currentValue
-	char const* hexChars = reader.readNextCharsOfTagOrAttributeValue(8);
-	if (!hexChars) {
+	uint8_t currentValueBytes[4];
+	if (reader.readNextHexBytesOfTagOrAttributeValue(currentValueBytes, 4) < 4) {
 		return Error::NONE;
 	}
-	currentValue = hexToIntFixedLength(hexChars, 8);
+	currentValue = readBigEndian32(currentValueBytes);
 
 	// And now read in the automation
 	int32_t numElementsToAllocateFor = 0;
@@ -1917,10 +1917,10 @@ Error AutoParam::readFromFile(Deserializer& reader, int32_t readAutomationUpToPo
 
 		while (true) {
 
-			// Every time we've reached the end of a cluster...
+			// Every time we've reached the end of what the reader has ready for us (a cluster, or all of it)...
 			if (numElementsToAllocateFor <= 0) {
 
-				// See how many more chars before the end of the cluster. If there are any...
+				// See how many more chars there are. If there are any...
 				uint32_t charsRemaining = reader.getNumCharsRemainingInValue();
 				if (charsRemaining) {
 
@@ -1932,26 +1932,66 @@ Error AutoParam::readFromFile(Deserializer& reader, int32_t readAutomationUpToPo
 				}
 			}
 
-			hexChars = reader.readNextCharsOfTagOrAttributeValue(16);
-			if (!hexChars) {
-				return Error::NONE;
-			}
-			int32_t value = hexToIntFixedLength(hexChars, 8);
-			int32_t pos = hexToIntFixedLength(&hexChars[8], 8);
+			// Take the nodes in batches, as bytes - so there's no per-node call to the reader or hex to decode
+			constexpr int32_t kNumNodesPerBatch = 32;
+			uint8_t nodeBytes[kNumNodesPerBatch * 8];
+			int32_t numBytesRead = reader.readNextHexBytesOfTagOrAttributeValue(nodeBytes, sizeof(nodeBytes));
+			int32_t numNodesRead = numBytesRead >> 3;
+
+			// Check them all first, so the ones we're keeping can go on the end of nodes in one go. They only ever go on
+			// the end - prevPos sees to that
+			struct {
+				int32_t pos;
+				int32_t value;
+				bool interpolated;
+			} nodesToAdd[kNumNodesPerBatch];
+			int32_t numNodesToAdd = 0;
+			bool reachedEnd = false;
+			int32_t value;
+			int32_t pos;
+			bool interpolated;
+
+			for (int32_t n = 0; n < numNodesRead; n++) {
+				value = readBigEndian32(&nodeBytes[n * 8]);
+				pos = readBigEndian32(&nodeBytes[n * 8 + 4]);
+
+				interpolated = (pos & ((uint32_t)1 << 31));
+				if (interpolated) {
+					pos &= ~((uint32_t)1 << 31);
+				}
+
+				// Ensure there isn't some problem where nodes are out of order...
+				if (pos <= prevPos) {
+					D_PRINTLN("Automation nodes out of order");
+					continue;
+				}
+
+				// If we've reached the end of our allowed timeline length for automation...
+				if (pos >= readAutomationUpToPos) {
+					reachedEnd = true;
+					break;
+				}
+
+				prevPos = pos;
 
-			bool interpolated = (pos & ((uint32_t)1 << 31));
-			if (interpolated) {
-				pos &= ~((uint32_t)1 << 31);
+				nodesToAdd[numNodesToAdd++] = {pos, value, interpolated};
 			}
 
-			// Ensure there isn't some problem where nodes are out of order...
-			if (pos <= prevPos) {
-				D_PRINTLN("Automation nodes out of order");
-				continue;
+			if (numNodesToAdd) {
+				int32_t firstI = nodes.getNumElements();
+				Error error = nodes.insertAtIndex(firstI, numNodesToAdd);
+				if (error != Error::NONE) {
+					return error;
+				}
+				for (int32_t n = 0; n < numNodesToAdd; n++) {
+					ParamNode* node = nodes.getElement(firstI + n);
+					node->pos = nodesToAdd[n].pos;
+					node->value = nodesToAdd[n].value;
+					node->interpolated = nodesToAdd[n].interpolated;
+				}
 			}
 
-			// If we've reached the end of our allowed timeline length for automation...
-			if (pos >= readAutomationUpToPos) {
+			if (reachedEnd) {
 
 				// If there's a node actually right on the end-point - well, firmware <= 3.1.5 sometimes put one there
 				// when it should have been at pos 0. So, reinterpret that data to make it right.
@@ -1968,20 +2008,15 @@ Error AutoParam::readFromFile(Deserializer& reader, int32_t readAutomationUpToPo
 						firstNode->interpolated = interpolated;
 					}
 				}
-				break;
+				return Error::NONE;
 			}
 
-			prevPos = pos;
+			numElementsToAllocateFor -= numNodesRead;
 
-			int32_t nodeI = nodes.insertAtKey(pos, true);
-			if (nodeI == -1) {
-				return Error::INSUFFICIENT_RAM;
+			// Fewer bytes than we asked for means the value's finished
+			if (numBytesRead < (int32_t)sizeof(nodeBytes)) {
+				return Error::NONE;
 			}
-			ParamNode* node = nodes.getElement(nodeI);
-			node->value = value;
-			node->interpolated = interpolated;
-
-			numElementsToAllocateFor--;
 		}
 	}
 
@@ -16,6 +16,14 @@
  */
 
 #include "processing/engines/audio_engine.h"
+
+// Before anything brings in RZA1/ostm/ostm.h, whose timer functions share these ones' names. Declared after these, C++
+// takes them to be these, where the other way round is an error
+extern "C" {
+#include "RZA1/mtu/mtu.h"
+}
+
+#include "OSLikeStuff/task_scheduler.h"
 #include "definitions_cxx.hpp"
 #include "dsp/envelope_follower/absolute_value.h"
 #include "dsp/reverb/reverb.hpp"
@@ -39,11 +47,13 @@
 #include "model/sample/sample_recorder.h"
 #include "model/song/song.h"
 #include "model/voice/voice.h"
+#include "model/voice/voice_cull_queue.h"
 #include "model/voice/voice_sample.h"
 #include "model/voice/voice_vector.h"
 #include "modulation/patch/patch_cable_set.h"
 #include "processing/audio_output.h"
 #include "processing/engines/cv_engine.h"
+#include "processing/engines/voice_budget.h"
 #include "processing/live/live_input_buffer.h"
 #include "processing/metronome/metronome.h"
 #include "processing/sound/sound.h"
@@ -66,7 +76,7 @@ namespace params = deluge::modulation::params;
 #endif
 
 extern "C" {
-#include "RZA1/mtu/mtu.h"
+#include "RZA1/ostm/ostm.h"
 #include "drivers/ssi/ssi.h"
 
 #include "RZA1/intc/devdrv_intc.h"
@@ -160,6 +170,8 @@ uint32_t nextVoiceState = 1;
 bool renderInStereo = true;
 bool bypassCulling = false;
 bool audioRoutineLocked = false;
+bool renderingOffline = false;
+RenderProfiler* renderProfiler = nullptr;
 uint32_t audioSampleTimer = 0;
 uint32_t i2sTXBufferPos;
 uint32_t i2sRXBufferPos;
@@ -172,6 +184,12 @@ bool routineBeenCalled;
 uint8_t numHopsEndedThisRoutineCall;
 
 VoiceVector activeVoices{};
+VoiceCullQueue voiceCullQueue{};
+
+VoiceBudget voiceBudget{};
+// Total VoiceBudget units of all active Voices, and of just the ones which aren't already being culled
+uint32_t voiceUnitsSounding = 0;
+uint32_t voiceUnitsProjected = 0;
 
 LiveInputBuffer* liveInputBuffers[3];
 
@@ -230,6 +248,7 @@ void init() {
 	for (int32_t i = 0; i < kNumVoicesStatic; i++) {
 		staticVoices[i].nextUnassigned = (i == kNumVoicesStatic - 1) ? NULL : &staticVoices[i + 1];
 	}
+	voiceCullQueue.reserve();
 
 	i2sTXBufferPos = (uint32_t)getTxBufferStart();
 
@@ -286,22 +305,21 @@ Voice* cullVoice(bool saveVoice, CullType type, size_t numSamples, Sound* stopFr
 	bool includeAudio = !saveVoice && type == HARD;
 	// Skip releasing voices if doing a soft cull and definitely culling
 	bool skipReleasing = (type == SOFT_ALWAYS);
-	uint32_t bestRating = 0;
 	Voice* bestVoice = NULL;
-	for (int32_t v = 0; v < activeVoices.getNumElements(); v++) {
-		Voice* thisVoice = activeVoices.getVoice(v);
-
-		uint32_t ratingThisVoice = thisVoice->getPriorityRating();
-
-		if (ratingThisVoice > bestRating) {
+	if (stopFrom == nullptr) {
+		bestVoice = voiceCullQueue.getBest(skipReleasing);
+	}
+	// A single Sound's Voices are all next to each other in activeVoices, and there won't be many
+	else {
+		uint32_t bestRating = 0;
+		int32_t ends[2];
+		activeVoices.getRangeForSound(stopFrom, ends);
+		for (int32_t v = ends[0]; v < ends[1]; v++) {
+			Voice* thisVoice = activeVoices.getVoice(v);
 			// if we're not skipping releasing voices, or if we are and this one isn't in fast release
-			if (!skipReleasing
-			    || (thisVoice->envelopes[0].state <= EnvelopeStage::FAST_RELEASE
-			        && thisVoice->envelopes[0].fastReleaseIncrement < SOFT_CULL_INCREMENT)) {
-				if (stopFrom == nullptr || thisVoice->assignedToSound == stopFrom) {
-					bestRating = ratingThisVoice;
-					bestVoice = thisVoice;
-				}
+			if (thisVoice->cullRating > bestRating && (!skipReleasing || thisVoice->softCullable)) {
+				bestRating = thisVoice->cullRating;
+				bestVoice = thisVoice;
 			}
 		}
 	}
@@ -365,19 +383,55 @@ Voice* cullVoice(bool saveVoice, CullType type, size_t numSamples, Sound* stopFr
 int32_t getNumAudio() {
 	return currentSong ? currentSong->countAudioClips() : 0;
 }
+
+void updateVoiceCullPriority(Voice* voice) {
+	voiceCullQueue.update(voice);
+}
+
+void updateVoiceCullPriorities(Sound* sound) {
+	int32_t ends[2];
+	activeVoices.getRangeForSound(sound, ends);
+	for (int32_t v = ends[0]; v < ends[1]; v++) {
+		voiceCullQueue.update(activeVoices.getVoice(v));
+	}
+}
 int32_t getNumVoices() {
 	return activeVoices.getNumElements();
 }
 
+// 250us - well inside the 32 samples the audio routine can go between calls
+constexpr uint32_t kMaxTicksBetweenYields = DELUGE_CLOCKS_PER / 4000;
+uint32_t timeLastYielded = 0;
+
+bool yieldIsDue() {
+	return (getTimerValue(0) - timeLastYielded >= kMaxTicksBetweenYields);
+}
+
 void routineWithClusterLoading(bool mayProcessUserActionsBetween) {
 	logAction("AudioDriver::routineWithClusterLoading");
 
+#ifdef USE_TASK_MANAGER
+	// Let the scheduler run everything that has to keep going, in its usual order, rather than us calling routine()
+	// from wherever we happen to be. Not while the audio routine's locked though, as we might be inside it, and the
+	// offline renderer needs playback left alone
+	if (!audioRoutineLocked && !renderingOffline && yieldToTasks(kYieldPriority)) {
+		// None of those tasks deal with user actions, so if the caller's happy for them to happen, do that as
+		// loadAnyEnqueuedClusters() would have
+		if (mayProcessUserActionsBetween) {
+			playbackHandler.slowRoutine();
+		}
+		timeLastYielded = getTimerValue(0);
+		return;
+	}
+#endif
+
 	routineBeenCalled = false;
 	audioFileManager.loadAnyEnqueuedClusters(128, mayProcessUserActionsBetween);
 	if (!routineBeenCalled) {
 		logAction("from routineWithClusterLoading()");
 		routine(); // -----------------------------------
 	}
+	timeLastYielded = getTimerValue(0);
 }
 
 #define TICK_TYPE_SWUNG 1
@@ -499,100 +553,50 @@ inline void setDireness(size_t numSamples) { // Consider direness and culling -
 	}
 }
 
-/// inner loop of audio rendering, deliberately not in header
-[[gnu::hot]] void routine_() {
-#if JFTRACE
-	aeCtr.note();
-#endif
-
-#ifndef USE_TASK_MANAGER
-	playbackHandler.routine();
-#endif
-	// At this point, there may be MIDI, including clocks, waiting to be sent.
-
-	GeneralMemoryAllocator::get().checkStack("AudioDriver::routine");
-
-	saddr = (uint32_t)(getTxBufferCurrentPlace());
-	uint32_t saddrPosAtStart = saddr >> (2 + NUM_MONO_OUTPUT_CHANNELS_MAGNITUDE);
-	size_t numSamples = ((uint32_t)(saddr - i2sTXBufferPos) >> (2 + NUM_MONO_OUTPUT_CHANNELS_MAGNITUDE))
-	                    & (SSI_TX_BUFFER_NUM_SAMPLES - 1);
-
-	if (numSamples <= (10 * numRoutines)) {
-		return;
-	}
-#if AUTOMATED_TESTER_ENABLED
-	AutomatedTester::possiblyDoSomething();
-#endif
-
-	// Flush everything out of the MIDI buffer now. At this stage, it would only really have live user-triggered
-	// output and MIDI THRU in it. We want any messages like "start" to go out before we send any clocks below, and
-	// also want to give them a head-start being sent and out of the way so the clock messages can be sent on-time
-	bool anythingInMidiOutputBufferNow = midiEngine.anythingInOutputBuffer();
-	bool anythingInGateOutputBufferNow =
-	    cvEngine.gateOutputPending || cvEngine.clockOutputPending; // Not asapGateOutputPending (RUN)
-	if (anythingInMidiOutputBufferNow || anythingInGateOutputBufferNow) {
-
-		// We're only allowed to do this if the timer ISR isn't pending (i.e. we haven't enabled to timer to trigger
-		// it)
-		// - otherwise this will all get called soon anyway. I thiiiink this is 100% immune to any synchronization
-		// problems?
-		if (!isTimerEnabled(TIMER_MIDI_GATE_OUTPUT)) {
-			if (anythingInGateOutputBufferNow) {
-				cvEngine.updateGateOutputs();
-			}
-			if (anythingInMidiOutputBufferNow) {
-				midiEngine.flushMIDI();
-			}
+// not in header (private to audio engine)
+/// recount what the active Voices are estimated to cost. Once per window, before it's scheduled - solicitVoice() adds
+/// on any started after that
+void updateVoiceUnits() {
+	voiceUnitsSounding = 0;
+	voiceUnitsProjected = 0;
+	for (int32_t v = 0; v < activeVoices.getNumElements(); v++) {
+		Voice* thisVoice = activeVoices.getVoice(v);
+		uint32_t cost = estimateVoiceCost(*thisVoice->assignedToSound, thisVoice);
+		voiceUnitsSounding += cost;
+		// Voices already fading out from a cull will be gone soon, so shouldn't count towards what's coming
+		if (thisVoice->envelopes[0].state < EnvelopeStage::FAST_RELEASE
+		    || thisVoice->envelopes[0].fastReleaseIncrement < SOFT_CULL_INCREMENT) {
+			voiceUnitsProjected += cost;
 		}
 	}
+}
 
-#ifdef REPORT_CPU_USAGE
-#define MINSAMPLES NUM_SAMPLES_FOR_CPU_USAGE_REPORT
-	if (numSamples < (MINSAMPLES)) {
-		return;
-	}
-
-	numSamples = NUM_SAMPLES_FOR_CPU_USAGE_REPORT;
-	int32_t unadjustedNumSamplesBeforeLappingPlayHead = numSamples;
-#else
-
-	// this is sometimes good for debugging but super spammy
-	// audiolog doesn't work because the render that notices the failure
-	// is one after the render with the problem
-	//  if (numSamplesLastTime < numSamples) {
-	//  	D_PRINTLN("rendered ");
-	//  	D_PRINTLN(numSamplesLastTime);
-	//  	D_PRINTLN(" samples but output ");
-	//  	D_PRINTLN(numSamples);
-	//  }
-
-	setDireness(numSamples);
-
-	// Double the number of samples we're going to do - within some constraints
-	int32_t sampleThreshold = 6; // If too low, it'll lead to bigger audio windows and stuff
-	constexpr size_t maxAdjustedNumSamples = SSI_TX_BUFFER_NUM_SAMPLES;
-
-	int32_t unadjustedNumSamplesBeforeLappingPlayHead = numSamples;
+// not in header (private to audio engine)
+/// Whether VoiceBudget may have a Voice soft-culled. Never while MIN_VOICES or fewer are sounding
+inline bool mayBudgetCull() {
+	return !bypassCulling && getNumVoices() > MIN_VOICES;
+}
 
-	if (numSamples < maxAdjustedNumSamples) {
-		int32_t samplesOverThreshold = numSamples - sampleThreshold;
-		if (samplesOverThreshold > 0) {
-			samplesOverThreshold = samplesOverThreshold << 1;
-			numSamples = sampleThreshold + samplesOverThreshold;
-			numSamples = std::min(numSamples, maxAdjustedNumSamples);
-		}
+// not in header (private to audio engine)
+/// soft-cull a Voice if the ones sounding are predicted to take more CPU than we have, before the buffer actually
+/// starts running dry and setDireness() has to step in
+inline void budgetVoices() {
+	updateVoiceUnits();
+	if (!mayBudgetCull()) {
+		return;
 	}
-
-	// Want to round to be doing a multiple of 4 samples, so the NEON functions can be utilized most efficiently.
-	// Note - this can take numSamples up as high as SSI_TX_BUFFER_NUM_SAMPLES (currently 128).
-	if (numSamples >= 3) {
-		numSamples = (numSamples + 2) & ~3;
+	// Just one per window - each one fades out over a few windows anyway, and the next window will recount
+	if (voiceBudget.wouldExceed(voiceUnitsProjected, 0, cpuDireness)) {
+		cullVoice(false, SOFT_ALWAYS, numSamplesLastTime, nullptr);
+		logAction("budget cull");
 	}
+}
 
-#endif
-
-	int32_t timeWithinWindowAtWhichMIDIOrGateOccurs = -1; // -1 means none
-
+// not in header (private to audio engine)
+/// Actions any sequencer ticks due right at the start of the window, then shortens the window so it ends exactly on
+/// the next one. Returns the new window length. If a tick within the window generated MIDI or gate output, sets
+/// timeWithinWindowAtWhichMIDIOrGateOccurs to its position in the window
+size_t scheduleWindow(size_t numSamples, int32_t& timeWithinWindowAtWhichMIDIOrGateOccurs) {
 	// If a timer-tick is due during or directly after this window of audio samples...
 	if (playbackHandler.isEitherClockActive()) {
 
@@ -669,7 +673,14 @@ startAgain:
 		}
 	}
 
+	return numSamples;
+}
+
+// not in header (private to audio engine)
+/// Renders the song, reverb, sample preview, master FX and metronome for one window into renderingBuffer
+void renderWindow(size_t numSamples) {
 	numSamplesLastTime = numSamples;
+	uint32_t renderStartTime = getTimerValue(0);
 	memset(&renderingBuffer, 0, numSamples * sizeof(StereoSample));
 
 	static std::array<int32_t, SSI_TX_BUFFER_NUM_SAMPLES> reverbBuffer __attribute__((aligned(CACHE_LINE_SIZE)));
@@ -834,6 +845,107 @@ startAgain:
 
 	approxRMSLevel = envelopeFollower.calcApproxRMS(renderingBuffer.data(), numSamples);
 
+	voiceBudget.windowRendered(numSamples, getTimerValue(0) - renderStartTime, voiceUnitsSounding);
+}
+
+/// inner loop of audio rendering, deliberately not in header
+[[gnu::hot]] void routine_() {
+#if JFTRACE
+	aeCtr.note();
+#endif
+
+#ifndef USE_TASK_MANAGER
+	playbackHandler.routine();
+#endif
+	// At this point, there may be MIDI, including clocks, waiting to be sent.
+
+	GeneralMemoryAllocator::get().checkStack("AudioDriver::routine");
+
+	saddr = (uint32_t)(getTxBufferCurrentPlace());
+	uint32_t saddrPosAtStart = saddr >> (2 + NUM_MONO_OUTPUT_CHANNELS_MAGNITUDE);
+	size_t numSamples = ((uint32_t)(saddr - i2sTXBufferPos) >> (2 + NUM_MONO_OUTPUT_CHANNELS_MAGNITUDE))
+	                    & (SSI_TX_BUFFER_NUM_SAMPLES - 1);
+
+	if (numSamples <= (10 * numRoutines)) {
+		return;
+	}
+#if AUTOMATED_TESTER_ENABLED
+	AutomatedTester::possiblyDoSomething();
+#endif
+
+	// Flush everything out of the MIDI buffer now. At this stage, it would only really have live user-triggered
+	// output and MIDI THRU in it. We want any messages like "start" to go out before we send any clocks below, and
+	// also want to give them a head-start being sent and out of the way so the clock messages can be sent on-time
+	bool anythingInMidiOutputBufferNow = midiEngine.anythingInOutputBuffer();
+	bool anythingInGateOutputBufferNow =
+	    cvEngine.gateOutputPending || cvEngine.clockOutputPending; // Not asapGateOutputPending (RUN)
+	if (anythingInMidiOutputBufferNow || anythingInGateOutputBufferNow) {
+
+		// We're only allowed to do this if the timer ISR isn't pending (i.e. we haven't enabled to timer to trigger
+		// it)
+		// - otherwise this will all get called soon anyway. I thiiiink this is 100% immune to any synchronization
+		// problems?
+		if (!isTimerEnabled(TIMER_MIDI_GATE_OUTPUT)) {
+			if (anythingInGateOutputBufferNow) {
+				cvEngine.updateGateOutputs();
+			}
+			if (anythingInMidiOutputBufferNow) {
+				midiEngine.flushMIDI();
+			}
+		}
+	}
+
+#ifdef REPORT_CPU_USAGE
+#define MINSAMPLES NUM_SAMPLES_FOR_CPU_USAGE_REPORT
+	if (numSamples < (MINSAMPLES)) {
+		return;
+	}
+
+	numSamples = NUM_SAMPLES_FOR_CPU_USAGE_REPORT;
+	int32_t unadjustedNumSamplesBeforeLappingPlayHead = numSamples;
+#else
+
+	// this is sometimes good for debugging but super spammy
+	// audiolog doesn't work because the render that notices the failure
+	// is one after the render with the problem
+	//  if (numSamplesLastTime < numSamples) {
+	//  	D_PRINTLN("rendered ");
+	//  	D_PRINTLN(numSamplesLastTime);
+	//  	D_PRINTLN(" samples but output ");
+	//  	D_PRINTLN(numSamples);
+	//  }
+
+	setDireness(numSamples);
+	budgetVoices();
+
+	// Double the number of samples we're going to do - within some constraints
+	int32_t sampleThreshold = 6; // If too low, it'll lead to bigger audio windows and stuff
+	constexpr size_t maxAdjustedNumSamples = SSI_TX_BUFFER_NUM_SAMPLES;
+
+	int32_t unadjustedNumSamplesBeforeLappingPlayHead = numSamples;
+
+	if (numSamples < maxAdjustedNumSamples) {
+		int32_t samplesOverThreshold = numSamples - sampleThreshold;
+		if (samplesOverThreshold > 0) {
+			samplesOverThreshold = samplesOverThreshold << 1;
+			numSamples = sampleThreshold + samplesOverThreshold;
+			numSamples = std::min(numSamples, maxAdjustedNumSamples);
+		}
+	}
+
+	// Want to round to be doing a multiple of 4 samples, so the NEON functions can be utilized most efficiently.
+	// Note - this can take numSamples up as high as SSI_TX_BUFFER_NUM_SAMPLES (currently 128).
+	if (numSamples >= 3) {
+		numSamples = (numSamples + 2) & ~3;
+	}
+
+#endif
+
+	int32_t timeWithinWindowAtWhichMIDIOrGateOccurs = -1; // -1 means none
+	numSamples = scheduleWindow(numSamples, timeWithinWindowAtWhichMIDIOrGateOccurs);
+
+	renderWindow(numSamples);
+
 	// Monitoring setup
 	doMonitoring = false;
 	if (audioRecorder.recordingSource == AudioInputChannel::STEREO
@@ -942,6 +1054,11 @@ void routine() {
 		        // called from within this!
 	}
 
+	// The offline renderer is driving the engine itself, and SD waits while it loads clusters mustn't render as well
+	if (renderingOffline) {
+		return;
+	}
+
 	audioRoutineLocked = true;
 
 	numRoutines = 0;
@@ -960,6 +1077,36 @@ void routine() {
 	audioRoutineLocked = false;
 }
 
+std::span<StereoSample> renderOfflineWindow(size_t numSamples) {
+	numSamples = std::min(numSamples, renderingBuffer.size());
+	updateVoiceUnits();
+
+	int32_t timeWithinWindowAtWhichMIDIOrGateOccurs = -1;
+	numSamples = scheduleWindow(numSamples, timeWithinWindowAtWhichMIDIOrGateOccurs);
+
+	audioRoutineLocked = true;
+	renderWindow(numSamples);
+	audioRoutineLocked = false;
+
+	// Same as doSomeOutputting(), minus the dither
+	for (StereoSample& sample : std::span{renderingBuffer.data(), numSamples}) {
+		sample.l =
+		    lshiftAndSaturate<AUDIO_OUTPUT_GAIN_DOUBLINGS>(multiply_32x32_rshift32(sample.l, masterVolumeAdjustmentL));
+		sample.r =
+		    lshiftAndSaturate<AUDIO_OUTPUT_GAIN_DOUBLINGS>(multiply_32x32_rshift32(sample.r, masterVolumeAdjustmentR));
+	}
+
+	// Nothing will be output to the codec, so make sure a later real routine() doesn't try to either
+	renderingBufferOutputPos = renderingBuffer.begin();
+	renderingBufferOutputEnd = renderingBuffer.begin();
+
+	sideChainHitPending = 0;
+	audioSampleTimer += numSamples;
+	bypassCulling = false;
+
+	return std::span{renderingBuffer.data(), numSamples};
+}
+
 int32_t getNumSamplesLeftToOutputFromPreviousRender() {
 	return ((uint32_t)renderingBufferOutputEnd - (uint32_t)renderingBufferOutputPos) >> 3;
 }
@@ -1286,6 +1433,18 @@ void getReverbParamsFromSong(Song* song) {
 
 Voice* solicitVoice(Sound* forSound) {
 
+	// If this new Voice would take us over budget, start fading out another one now rather than waiting to run out
+	// of CPU. Not if forSound is at its voice limit though, as one of its own gets culled below anyway
+	uint32_t newVoiceCost = estimateVoiceCost(*forSound);
+	if (!renderingOffline && mayBudgetCull() && forSound->numVoicesAssigned < forSound->maxVoiceCount
+	    && voiceBudget.wouldExceed(voiceUnitsProjected, newVoiceCost, cpuDireness)) {
+		cullVoice(false, SOFT_ALWAYS, numSamplesLastTime, nullptr);
+	}
+	// So that several note-ons before the next window (e.g. a chord) all get accounted for - and it'll be sounding in
+	// the window that's about to render, which counted Voices before it was scheduled
+	voiceUnitsProjected += newVoiceCost;
+	voiceUnitsSounding += newVoiceCost;
+
 	Voice* newVoice;
 
 	if (firstUnassignedVoice) {
@@ -1323,6 +1482,11 @@ Voice* solicitVoice(Sound* forSound) {
 		disposeOfVoice(newVoice);
 		return NULL;
 	}
+	if (!voiceCullQueue.add(newVoice)) {
+		activeVoices.deleteAtKeyMultiWord(keyWords);
+		disposeOfVoice(newVoice);
+		return NULL;
+	}
 	/// @todo: maybe this should be configurable between 4/8/16/unlimited?
 	if (forSound->numVoicesAssigned >= forSound->maxVoiceCount) {
 		cullVoice(false, SOFT_ALWAYS, numSamplesLastTime, forSound);
@@ -1337,6 +1501,7 @@ void unassignVoice(Voice* voice, Sound* sound, ModelStackWithSoundFlags* modelSt
                    bool shouldDispose) {
 
 	activeVoices.checkVoiceExists(voice, sound, "E195");
+	voiceCullQueue.remove(voice);
 
 	voice->setAsUnassigned(modelStack ? modelStack->addVoice(voice) : nullptr);
 	if (removeFromVector) {
@@ -20,6 +20,7 @@
 #include "definitions_cxx.hpp"
 #include "dsp/compressor/rms_feedback.h"
 #include <cstdint>
+#include <span>
 
 extern "C" {
 #include "fatfs/ff.h"
@@ -43,6 +44,7 @@ class Metronome;
 class RMSFeedbackCompressor;
 class ModelStackWithSoundFlags;
 class SoundDrum;
+class RenderProfiler;
 
 namespace deluge::dsp {
 class Reverb;
@@ -126,8 +128,17 @@ class Reverb;
 #define DO_AUDIO_LOG 0
 
 namespace AudioEngine {
+/// When a long job calls routineWithClusterLoading() under the task manager, tasks with at most this priority carry
+/// on while it waits - rendering, reading the encoders, playback and cluster loading. See registerTasks()
+constexpr uint8_t kYieldPriority = 3;
+
 void routine();
+/// Call regularly from long jobs to keep audio going. Under the task manager this yields to the scheduler, otherwise
+/// it renders directly
 void routineWithClusterLoading(bool mayProcessUserActionsBetween = false);
+/// Whether it's been long enough since routineWithClusterLoading() last ran that a long job should call it again. Cheap
+/// enough to check every time round a loop, so that however long each time round takes, audio isn't kept waiting
+bool yieldIsDue();
 
 void init();
 void previewSample(String* path, FilePointer* filePointer, bool shouldActuallySound);
@@ -138,6 +149,11 @@ void unassignVoice(Voice* voice, Sound* sound, ModelStackWithSoundFlags* modelSt
                    bool removeFromVector = true, bool shouldDispose = true);
 void disposeOfVoice(Voice* voice);
 
+/// Call when something a Voice's priority rating depends on has changed, so cullVoice() sees it. The second version
+/// is for when the Sound's numVoicesAssigned changed, which affects all its Voices
+void updateVoiceCullPriority(Voice* voice);
+void updateVoiceCullPriorities(Sound* sound);
+
 void songSwapAboutToHappen();
 void unassignAllVoices(bool deletingSong = false);
 void logAction(char const* string);
@@ -178,6 +194,11 @@ int32_t getNumVoices();
 bool doSomeOutputting();
 void updateReverbParams();
 
+/// Renders one window of up to numSamples without touching the I2S buffers, for offline rendering / benchmarking.
+/// The window is cut short if a sequencer tick falls inside it. Returns the rendered samples, with the same gain and
+/// saturation the codec would get, but no dither so the result is repeatable.
+std::span<StereoSample> renderOfflineWindow(size_t numSamples);
+
 extern bool headphonesPluggedIn;
 extern bool micPluggedIn;
 extern bool lineInPluggedIn;
@@ -206,4 +227,6 @@ extern RMSFeedbackCompressor mastercompressor;
 extern uint32_t timeLastSideChainHit;
 extern int32_t sizeLastSideChainHit;
 extern StereoFloatSample approxRMSLevel;
+extern bool renderingOffline;
+extern RenderProfiler* renderProfiler;
 } // namespace AudioEngine
@@ -0,0 +1,293 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "processing/engines/offline_renderer.h"
+#include "OSLikeStuff/task_scheduler.h"
+#include "dsp/stereo_sample.h"
+#include "io/debug/log.h"
+#include "memory/general_memory_allocator.h"
+#include "model/output.h"
+#include "model/song/song.h"
+#include "playback/playback_handler.h"
+#include "processing/engines/audio_engine.h"
+#include "processing/engines/render_profiler.h"
+#include "storage/audio/audio_file_manager.h"
+#include "storage/storage_manager.h"
+#include "util/functions.h"
+#include "util/misc.h"
+#include "util/waves.h"
+#include <algorithm>
+#include <cstring>
+
+extern "C" {
+#include "RZA1/ostm/ostm.h"
+#include "drivers/ssi/ssi.h"
+}
+
+namespace OfflineRenderer {
+
+namespace {
+
+constexpr uint32_t kWriteBufferSize = 32768;
+constexpr int32_t kBytesPerSample = 4;
+constexpr uint32_t kWavHeaderSize = 44;
+// Fixed so any randomness in the song (osc phases, sample & hold, etc) comes out the same on every run
+constexpr uint32_t kRandomSeed = 380116160;
+
+/// Collects small writes into a bigger buffer so the card isn't written to a few bytes at a time
+class BufferedFileWriter {
+public:
+	BufferedFileWriter(FatFS::File& file, char* buffer) : file_(file), buffer_(buffer) {}
+
+	bool write(void const* data, uint32_t numBytes) {
+		char const* source = static_cast<char const*>(data);
+		while (numBytes) {
+			uint32_t numBytesNow = std::min(numBytes, kWriteBufferSize - bufferPos_);
+			memcpy(&buffer_[bufferPos_], source, numBytesNow);
+			bufferPos_ += numBytesNow;
+			source += numBytesNow;
+			numBytes -= numBytesNow;
+			if (bufferPos_ == kWriteBufferSize && !flush()) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool write(char const* string) { return write(string, strlen(string)); }
+
+	bool flush() {
+		if (bufferPos_) {
+			auto written = file_.write({reinterpret_cast<std::byte*>(buffer_), bufferPos_});
+			if (!written || written.value() != bufferPos_) {
+				return false;
+			}
+			bufferPos_ = 0;
+		}
+		return true;
+	}
+
+private:
+	FatFS::File& file_;
+	char* buffer_;
+	uint32_t bufferPos_ = 0;
+};
+
+uint32_t ticksToMicroseconds(uint64_t ticks) {
+	return (ticks * 1000000) / DELUGE_CLOCKS_PER;
+}
+
+void makeWavHeader(char* header, uint32_t numSamples) {
+	char* writePos = header;
+	uint32_t audioDataLengthBytes = numSamples * kBytesPerSample * 2;
+
+	writeInt32(&writePos, 0x46464952);                        // "RIFF"
+	writeInt32(&writePos, audioDataLengthBytes + 36);         // Chunk size
+	writeInt32(&writePos, 0x45564157);                        // "WAVE"
+	writeInt32(&writePos, 0x20746d66);                        // "fmt "
+	writeInt32(&writePos, 16);                                // Chunk size
+	writeInt16(&writePos, 0x0001);                            // Format - PCM
+	writeInt16(&writePos, 2);                                 // Num channels
+	writeInt32(&writePos, kSampleRate);                       // Sample rate
+	writeInt32(&writePos, kSampleRate * 2 * kBytesPerSample); // Data rate
+	writeInt16(&writePos, 2 * kBytesPerSample);               // Data block size
+	writeInt16(&writePos, kBytesPerSample * 8);               // Bits per sample
+	writeInt32(&writePos, 0x61746164);                        // "data"
+	writeInt32(&writePos, audioDataLengthBytes);              // Chunk size
+}
+
+bool writeWavHeader(BufferedFileWriter& writer, uint32_t numSamples) {
+	char header[kWavHeaderSize];
+	makeWavHeader(header, numSamples);
+	return writer.write(header, sizeof(header));
+}
+
+/// If writing stopped part way, the header written at the start claims more audio than there is - so rewrite it to
+/// say however much did make it into the file
+bool fixWavHeader(FatFS::File& file) {
+	if (file.size() < kWavHeaderSize) {
+		return false;
+	}
+	char header[kWavHeaderSize];
+	makeWavHeader(header, (file.size() - kWavHeaderSize) / (kBytesPerSample * 2));
+	if (!file.lseek(0)) {
+		return false;
+	}
+	auto written = file.write({reinterpret_cast<std::byte*>(header), sizeof(header)});
+	return written && written.value() == sizeof(header);
+}
+
+bool writeTimingsHeader(BufferedFileWriter& writer, Song* song) {
+	if (!writer.write("window,samples,total_us")) {
+		return false;
+	}
+	for (Output* output = song->firstOutput; output; output = output->next) {
+		if (!writer.write(",") || !writer.write(output->name.get())) {
+			return false;
+		}
+	}
+	return writer.write("\n");
+}
+
+bool writeTimingsRow(BufferedFileWriter& writer, RenderProfiler& profiler, uint32_t numSamples, uint32_t ticks) {
+	char buffer[48];
+	snprintf(buffer, sizeof(buffer), "%lu,%lu,%lu", (unsigned long)(profiler.numWindows - 1), (unsigned long)numSamples,
+	         (unsigned long)ticksToMicroseconds(ticks));
+	if (!writer.write(buffer)) {
+		return false;
+	}
+	for (int32_t i = 0; i < profiler.numOutputsThisWindow; i++) {
+		snprintf(buffer, sizeof(buffer), ",%lu", (unsigned long)ticksToMicroseconds(profiler.ticksThisWindow[i]));
+		if (!writer.write(buffer)) {
+			return false;
+		}
+	}
+	return writer.write("\n");
+}
+
+void printSummary(Song* song, RenderProfiler& profiler, uint64_t totalTicks, uint32_t maxTicks) {
+	if (!profiler.numWindows) {
+		return;
+	}
+	D_PRINTLN("offline render: %lu windows, avg %lu us, max %lu us", (unsigned long)profiler.numWindows,
+	          (unsigned long)ticksToMicroseconds(totalTicks / profiler.numWindows),
+	          (unsigned long)ticksToMicroseconds(maxTicks));
+	int32_t i = 0;
+	for (Output* output = song->firstOutput; output && i < RenderProfiler::kMaxOutputs; output = output->next, i++) {
+		D_PRINTLN("  %s: avg %lu us, max %lu us", output->name.get(),
+		          (unsigned long)ticksToMicroseconds(profiler.totalTicks[i] / profiler.numWindows),
+		          (unsigned long)ticksToMicroseconds(profiler.maxTicks[i]));
+	}
+}
+
+uint32_t scheduledNumSamples;
+uint32_t scheduledWindowSize;
+
+} // namespace
+
+Error render(uint32_t numSamples, uint32_t windowSize) {
+	Song* song = currentSong;
+	if (!song) {
+		return Error::UNSPECIFIED;
+	}
+	windowSize = std::clamp<uint32_t>(windowSize, 1, SSI_TX_BUFFER_NUM_SAMPLES);
+
+	auto wavFile = storageManager.createFile(kWavFilePath, true);
+	if (!wavFile) {
+		return wavFile.error();
+	}
+	auto timingsFile = storageManager.createFile(kTimingsFilePath, true);
+	if (!timingsFile) {
+		wavFile.value().close();
+		return timingsFile.error();
+	}
+
+	char* buffers = (char*)GeneralMemoryAllocator::get().allocLowSpeed(kWriteBufferSize * 2);
+	if (!buffers) {
+		wavFile.value().close();
+		timingsFile.value().close();
+		return Error::INSUFFICIENT_RAM;
+	}
+
+	BufferedFileWriter wavWriter{wavFile.value(), buffers};
+	BufferedFileWriter timingsWriter{timingsFile.value(), buffers + kWriteBufferSize};
+
+	Error error = Error::NONE;
+	if (!writeWavHeader(wavWriter, numSamples) || !writeTimingsHeader(timingsWriter, song)) {
+		error = Error::WRITE_FAIL;
+		goto getOut;
+	}
+
+	{
+		// The codec keeps looping its DMA buffer while we're away, so make that silence
+		memset(getTxBufferStart(), 0, (uint32_t)getTxBufferEnd() - (uint32_t)getTxBufferStart());
+
+		bool startedPlayback = false;
+		if (!playbackHandler.isEitherClockActive()) {
+			playbackHandler.setupPlaybackUsingInternalClock(0, false);
+			startedPlayback = true;
+		}
+
+		jcong = kRandomSeed;
+
+		static RenderProfiler profiler;
+		profiler.reset();
+		AudioEngine::renderProfiler = &profiler;
+		AudioEngine::renderingOffline = true;
+
+		uint64_t totalTicks = 0;
+		uint32_t maxTicks = 0;
+		uint32_t numSamplesDone = 0;
+		while (numSamplesDone < numSamples) {
+			// Let streaming fully catch up first, so how fast the card is can't change what gets rendered
+			audioFileManager.loadAnyEnqueuedClusters();
+
+			profiler.startWindow();
+			uint32_t startTime = getTimerValue(0);
+			std::span<StereoSample> window =
+			    AudioEngine::renderOfflineWindow(std::min(windowSize, numSamples - numSamplesDone));
+			uint32_t ticks = getTimerValue(0) - startTime;
+
+			totalTicks += ticks;
+			maxTicks = std::max(maxTicks, ticks);
+			numSamplesDone += window.size();
+
+			if (!wavWriter.write(window.data(), window.size_bytes())
+			    || !writeTimingsRow(timingsWriter, profiler, window.size(), ticks)) {
+				error = Error::WRITE_FAIL;
+				break;
+			}
+		}
+
+		AudioEngine::renderingOffline = false;
+		AudioEngine::renderProfiler = nullptr;
+
+		if (startedPlayback) {
+			playbackHandler.endPlayback();
+		}
+
+		printSummary(song, profiler, totalTicks, maxTicks);
+	}
+
+	if (!wavWriter.flush() || !timingsWriter.flush()) {
+		error = Error::WRITE_FAIL;
+	}
+
+getOut:
+	if (error != Error::NONE) {
+		fixWavHeader(wavFile.value());
+	}
+	delugeDealloc(buffers);
+	wavFile.value().close();
+	timingsFile.value().close();
+	return error;
+}
+
+void scheduleRender(uint32_t numSamples, uint32_t windowSize) {
+	scheduledNumSamples = numSamples;
+	scheduledWindowSize = windowSize;
+	addOnceTask(
+	    []() {
+		    Error error = render(scheduledNumSamples, scheduledWindowSize);
+		    if (error != Error::NONE) {
+			    D_PRINTLN("offline render failed: %d", util::to_underlying(error));
+		    }
+	    },
+	    100, 0.01);
+}
+
+} // namespace OfflineRenderer
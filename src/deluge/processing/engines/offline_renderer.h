@@ -0,0 +1,50 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "definitions_cxx.hpp"
+#include <cstdint>
+
+/*
+ * ================== Offline rendering / render benchmark ==================
+ *
+ * Renders the current Song from the start, as fast as the CPU allows and with every window the same fixed length,
+ * into a WAV file on the card. Alongside it goes a CSV file with one row per window giving how long the whole window
+ * took to render and how long each Output took within that, in microseconds.
+ *
+ * Between windows, every Cluster that sample playback has asked for is loaded before rendering carries on, and voice
+ * culling is never triggered (it's driven by the I2S buffer, which isn't involved), so two runs of the same song on
+ * the same firmware produce identical audio. That makes the timings a repeatable benchmark of Sound::render(), the
+ * FX chains etc., which can be compared between builds.
+ *
+ * Normal audio output stops while this runs.
+ */
+
+namespace OfflineRenderer {
+
+constexpr char const* kWavFilePath = "BENCHMARK/RENDER.WAV";
+constexpr char const* kTimingsFilePath = "BENCHMARK/RENDER.CSV";
+
+/// Render numSamples of the current Song, in windows of windowSize samples (at most SSI_TX_BUFFER_NUM_SAMPLES).
+/// Blocks until done.
+Error render(uint32_t numSamples, uint32_t windowSize);
+
+/// Ask for render() to be done from the task scheduler soon, e.g. when a request arrives in a MIDI handler
+void scheduleRender(uint32_t numSamples, uint32_t windowSize);
+
+} // namespace OfflineRenderer
@@ -0,0 +1,60 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+/// Records how long each Output of the Song took to render during the current audio window, plus running totals
+/// across all windows since reset(). Outputs are identified by their position in the Song's output list. Only
+/// consulted by Song::renderAudio() while AudioEngine::renderProfiler points to one, so costs nothing otherwise.
+/// Times are in OS timer ticks (DELUGE_CLOCKS_PER per second).
+class RenderProfiler {
+public:
+	static constexpr int32_t kMaxOutputs = 64;
+
+	void reset() {
+		numWindows = 0;
+		numOutputsThisWindow = 0;
+		totalTicks.fill(0);
+		maxTicks.fill(0);
+	}
+
+	void startWindow() {
+		numWindows++;
+		numOutputsThisWindow = 0;
+	}
+
+	/// Call once per Output, in list order, including ones which were skipped (with 0 ticks), so the columns line up
+	void outputRendered(uint32_t ticks) {
+		if (numOutputsThisWindow < kMaxOutputs) {
+			ticksThisWindow[numOutputsThisWindow] = ticks;
+			totalTicks[numOutputsThisWindow] += ticks;
+			if (ticks > maxTicks[numOutputsThisWindow]) {
+				maxTicks[numOutputsThisWindow] = ticks;
+			}
+			numOutputsThisWindow++;
+		}
+	}
+
+	uint32_t numWindows = 0;
+	int32_t numOutputsThisWindow = 0;
+	std::array<uint32_t, kMaxOutputs> ticksThisWindow{};
+	std::array<uint64_t, kMaxOutputs> totalTicks{};
+	std::array<uint32_t, kMaxOutputs> maxTicks{};
+};
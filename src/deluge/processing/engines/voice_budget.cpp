@@ -0,0 +1,112 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "processing/engines/voice_budget.h"
+#include "model/voice/voice.h"
+#include "model/voice/voice_sample.h"
+#include "processing/sound/sound.h"
+
+namespace {
+
+// Relative costs, per sample. Only their proportions to each other matter - see VoiceBudget
+constexpr uint32_t kVoiceBaseCost = 4; // Envelopes, patching, amplitude
+constexpr uint32_t kModulatorCost = 2;
+constexpr uint32_t kRingmodCost = 1;
+constexpr uint32_t kTimeStretchCost = 6;
+constexpr uint32_t kSmoothInterpolationCost = 3;
+
+uint32_t oscCost(OscType oscType) {
+	switch (oscType) {
+	case OscType::SINE:
+	case OscType::TRIANGLE:
+	case OscType::SQUARE:
+	case OscType::SAW:
+		return 2;
+	case OscType::ANALOG_SQUARE:
+	case OscType::ANALOG_SAW_2:
+		return 3;
+	case OscType::WAVETABLE:
+		return 5;
+	case OscType::SAMPLE:
+		return 4;
+	case OscType::DX7:
+		return 12;
+	default: // Live input
+		return 1;
+	}
+}
+
+uint32_t filterCost(FilterMode mode) {
+	switch (mode) {
+	case FilterMode::OFF:
+		return 0;
+	case FilterMode::SVF_BAND:
+	case FilterMode::SVF_NOTCH:
+		return 4;
+	case FilterMode::TRANSISTOR_24DB_DRIVE:
+		return 8;
+	default: // Other ladders
+		return 6;
+	}
+}
+
+} // namespace
+
+uint32_t estimateVoiceCost(Sound& sound, Voice* voice) {
+	SynthMode synthMode = sound.getSynthMode();
+	uint32_t costPerUnison = 0;
+
+	for (int32_t s = 0; s < kNumSources; s++) {
+		Source& source = sound.sources[s];
+		OscType oscType = (synthMode == SynthMode::FM) ? OscType::SINE : source.oscType;
+
+		if (voice && !voice->unisonParts[0].sources[s].active) {
+			continue;
+		}
+		costPerUnison += oscCost(oscType);
+
+		if (oscType == OscType::SAMPLE) {
+			if (source.sampleControls.interpolationMode == InterpolationMode::SMOOTH) {
+				costPerUnison += kSmoothInterpolationCost;
+			}
+			// Once a Voice exists we know for sure whether it ended up time-stretching
+			VoiceSample* voiceSample = voice ? voice->unisonParts[0].sources[s].voiceSample : nullptr;
+			bool timeStretching = voiceSample ? (voiceSample->timeStretcher != nullptr)
+			                                  : (source.repeatMode == SampleRepeatMode::STRETCH
+			                                     || source.sampleControls.pitchAndSpeedAreIndependent);
+			if (timeStretching) {
+				costPerUnison += kTimeStretchCost;
+			}
+		}
+	}
+
+	if (synthMode == SynthMode::FM) {
+		costPerUnison += kNumModulators * kModulatorCost;
+	}
+	else if (synthMode == SynthMode::RINGMOD) {
+		costPerUnison += kRingmodCost;
+	}
+
+	uint32_t cost = kVoiceBaseCost + costPerUnison * sound.numUnison;
+
+	// Filters run once per Voice, after the unison parts are summed
+	if (sound.hasFilters()) {
+		cost += filterCost(sound.lpfMode) + filterCost(sound.hpfMode);
+	}
+
+	return cost;
+}
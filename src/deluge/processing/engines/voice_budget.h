@@ -0,0 +1,106 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "definitions_cxx.hpp"
+#include <algorithm>
+#include <cstdint>
+
+extern "C" {
+#include "RZA1/ostm/ostm.h"
+}
+
+class Sound;
+class Voice;
+
+/*
+ * ================== Voice budgeting ==================
+ *
+ * Rather than waiting for the I2S buffer to run nearly dry and then culling (see setDireness()), the AudioEngine asks
+ * this how expensive the currently sounding Voices are going to be, and steals Voices *before* the CPU runs out.
+ *
+ * Every Voice gets a cost in abstract "units", worked out from its Sound's configuration - oscillator types, unison,
+ * filter modes, synth mode, time-stretching and so on (see estimateVoiceCost()). Those units only need to be right
+ * relative to each other. What a unit actually costs in CPU time is learned as we go: after every render window, the
+ * time it took is fed back in along with the total units that were sounding, giving a running estimate of
+ * "ticks per sample" = overhead + units * ticksPerUnit. The overhead (AudioClips, reverb, master FX etc.) is learned
+ * from windows where no Voices were sounding.
+ *
+ * From that we know how many units fit in the time each sample of audio gives us, less some headroom for
+ * everything else the CPU has to do. The reactive culling stays in place as a backstop for when the model is wrong.
+ */
+
+/// Cost of one Voice of the given Sound, in VoiceBudget units. Pass the Voice if it exists already, so that sources
+/// which aren't actually active in it don't get counted
+uint32_t estimateVoiceCost(Sound& sound, Voice* voice = nullptr);
+
+class VoiceBudget {
+public:
+	/// Timer ticks available to render each sample in real time
+	static constexpr float kTicksPerSampleAvailable = DELUGE_CLOCKS_PERf / kSampleRate;
+	/// Proportion of that which rendering may use. The rest is for the UI, SD streaming, MIDI etc.
+	static constexpr float kTargetLoad = 0.8f;
+	/// How quickly the estimates follow new measurements. Larger means faster but jumpier
+	static constexpr float kSmoothing = 1.f / 32;
+
+	/// Feed back how long the last render window took, and how many units of Voices were sounding during it
+	void windowRendered(uint32_t numSamples, uint32_t ticks, uint32_t unitsSounding) {
+		if (!numSamples) {
+			return;
+		}
+		float ticksPerSample = (float)ticks / numSamples;
+
+		if (!unitsSounding) {
+			overheadTicksPerSample += (ticksPerSample - overheadTicksPerSample) * kSmoothing;
+			return;
+		}
+
+		// If overhead has gone up since we last measured it, this'll over-estimate the unit cost - which errs on the
+		// safe side, and corrects itself next time there's silence
+		float measuredTicksPerUnit = (ticksPerSample - overheadTicksPerSample) / unitsSounding;
+		measuredTicksPerUnit = std::clamp(measuredTicksPerUnit, kMinTicksPerUnit, kMaxTicksPerUnit);
+		ticksPerUnit += (measuredTicksPerUnit - ticksPerUnit) * kSmoothing;
+	}
+
+	/// How many units of Voices can sound at once without exceeding the target load. The more dire things got
+	/// recently (see cpuDireness), the more headroom we leave, since that means the model was optimistic
+	uint32_t getBudget(int32_t direness = 0) const {
+		float target = kTicksPerSampleAvailable * (kTargetLoad - direness * 0.02f);
+		float available = target - overheadTicksPerSample;
+		if (available <= 0) {
+			return 0;
+		}
+		return available / ticksPerUnit;
+	}
+
+	/// Whether sounding unitsSounding + extraUnits would go over budget
+	bool wouldExceed(uint32_t unitsSounding, uint32_t extraUnits, int32_t direness = 0) const {
+		return unitsSounding + extraUnits > getBudget(direness);
+	}
+
+	float getTicksPerUnit() const { return ticksPerUnit; }
+	float getOverheadTicksPerSample() const { return overheadTicksPerSample; }
+
+private:
+	static constexpr float kMinTicksPerUnit = 0.25f;
+	static constexpr float kMaxTicksPerUnit = 64.f;
+
+	// Starting guesses, roughly what a Deluge measures. They get replaced within a second or so of audio anyway
+	float ticksPerUnit = 3.f;
+	float overheadTicksPerSample = 60.f;
+};
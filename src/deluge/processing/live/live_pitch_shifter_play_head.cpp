@@ -21,8 +21,10 @@
 #include "util/fixedpoint.h"
 #include "util/lookuptables/lookuptables.h"
 
+#ifdef __arm__
 #pragma GCC push_options
 #pragma GCC target("fpu=neon")
+#endif
 
 #include "arm_neon_shim.h"
 
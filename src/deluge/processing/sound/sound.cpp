@@ -18,6 +18,7 @@
 #include "processing/sound/sound.h"
 #include "definitions_cxx.hpp"
 #include "dsp/dx/engine.h"
+#include "dsp/filter/quad_filter.h"
 #include "gui/l10n/l10n.h"
 #include "gui/ui/root_ui.h"
 #include "gui/ui/sound_editor.h"
@@ -53,6 +54,7 @@
 #include "storage/multi_range/multi_wave_table_range.h"
 #include "storage/multi_range/multisample_range.h"
 #include "storage/storage_manager.h"
+#include "storage/xml_tags.h"
 #include "util/firmware_version.h"
 #include "util/functions.h"
 #include "util/misc.h"
@@ -62,6 +64,13 @@ namespace params = deluge::modulation::params;
 extern "C" {
 #include "RZA1/mtu/mtu.h"
 }
+
+using deluge::dsp::filter::QuadFilter;
+
+// Where Voices render to while waiting to have their filters done together - see QuadFilter
+PLACE_INTERNAL_FRUNK int32_t filterLaneBuffers[QuadFilter::kNumLanes][SSI_TX_BUFFER_NUM_SAMPLES * 2]
+    __attribute__((aligned(CACHE_LINE_SIZE)));
+
 #pragma GCC diagnostic push
 // This is supported by GCC and other compilers should error (not warn), so turn off for this file
 #pragma GCC diagnostic ignored "-Winvalid-offsetof"
@@ -471,23 +480,26 @@ void Sound::recalculatePatchingToParam(uint8_t p, ParamManagerForTimeline* param
 Error Sound::readTagFromFile(Deserializer& reader, char const* tagName, ParamManagerForTimeline* paramManager,
                              int32_t readAutomationUpToPos, ArpeggiatorSettings* arpSettings, Song* song) {
 
-	if (!strcmp(tagName, "osc1")) {
+	switch (XMLTags::find(tagName)) {
+	case XMLTags::id("osc1"): {
 		Error error = readSourceFromFile(reader, 0, paramManager, readAutomationUpToPos);
 		if (error != Error::NONE) {
 			return error;
 		}
 		reader.exitTag("osc1");
+		break;
 	}
 
-	else if (!strcmp(tagName, "osc2")) {
+	case XMLTags::id("osc2"): {
 		Error error = readSourceFromFile(reader, 1, paramManager, readAutomationUpToPos);
 		if (error != Error::NONE) {
 			return error;
 		}
 		reader.exitTag("osc2");
+		break;
 	}
 
-	else if (!strcmp(tagName, "mode")) {
+	case XMLTags::id("mode"): {
 		char const* contents = reader.readTagOrAttributeValue();
 		if (synthMode != SynthMode::RINGMOD) { // Compatibility with old XML files
 			synthMode = stringToSynthMode(contents);
@@ -495,10 +507,11 @@ Error Sound::readTagFromFile(Deserializer& reader, char const* tagName, ParamMan
 		// Uart::print("synth mode set to: ");
 		// Uart::println(synthMode);
 		reader.exitTag("mode");
+		break;
 	}
 
 	// Backwards-compatible reading of old-style oscs, from pre-mid-2016 files
-	else if (!strcmp(tagName, "oscillatorA")) {
+	case XMLTags::id("oscillatorA"): {
 		while (*(tagName = reader.readNextTagOrAttributeName())) {
 
 			if (!strcmp(tagName, "type")) {
@@ -531,9 +544,10 @@ Error Sound::readTagFromFile(Deserializer& reader, char const* tagName, ParamMan
 			}
 		}
 		reader.exitTag("oscillatorA");
+		break;
 	}
 
-	else if (!strcmp(tagName, "oscillatorB")) {
+	case XMLTags::id("oscillatorB"): {
 		while (*(tagName = reader.readNextTagOrAttributeName())) {
 			if (!strcmp(tagName, "type")) {
 				sources[1].oscType = stringToOscType(reader.readTagOrAttributeValue());
@@ -566,9 +580,10 @@ Error Sound::readTagFromFile(Deserializer& reader, char const* tagName, ParamMan
 			}
 		}
 		reader.exitTag("oscillatorB");
+		break;
 	}
 
-	else if (!strcmp(tagName, "modulator1")) {
+	case XMLTags::id("modulator1"): {
 		while (*(tagName = reader.readNextTagOrAttributeName())) {
 			if (!strcmp(tagName, "volume")) {
 				ENSURE_PARAM_MANAGER_EXISTS
@@ -593,9 +608,10 @@ Error Sound::readTagFromFile(Deserializer& reader, char const* tagName, ParamMan
 			}
 		}
 		reader.exitTag("modulator1");
+		break;
 	}
 
-	else if (!strcmp(tagName, "modulator2")) {
+	case XMLTags::id("modulator2"): {
 		while (*(tagName = reader.readNextTagOrAttributeName())) {
 			if (!strcmp(tagName, "volume")) {
 				ENSURE_PARAM_MANAGER_EXISTS
@@ -627,9 +643,10 @@ Error Sound::readTagFromFile(Deserializer& reader, char const* tagName, ParamMan
 			}
 		}
 		reader.exitTag("modulator2");
+		break;
 	}
 
-	else if (!strcmp(tagName, "arpeggiator")) {
+	case XMLTags::id("arpeggiator"): {
 		// Set default values in case they are not configured
 		arpSettings->syncType = SYNC_TYPE_EVEN;
 		arpSettings->syncLevel = SYNC_LEVEL_NONE;
@@ -721,56 +738,63 @@ Error Sound::readTagFromFile(Deserializer& reader, char const* tagName, ParamMan
 		}
 
 		reader.exitTag("arpeggiator");
+		break;
 	}
 
-	else if (!strcmp(tagName, "transpose")) {
+	case XMLTags::id("transpose"): {
 		transpose = reader.readTagOrAttributeValueInt();
 		reader.exitTag("transpose");
+		break;
 	}
 
-	else if (!strcmp(tagName, "noiseVolume")) {
+	case XMLTags::id("noiseVolume"): {
 		ENSURE_PARAM_MANAGER_EXISTS
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_NOISE_VOLUME, readAutomationUpToPos);
 		reader.exitTag("noiseVolume");
+		break;
 	}
 
-	else if (!strcmp(tagName, "ratchetAmount")) {
+	case XMLTags::id("ratchetAmount"): {
 		ENSURE_PARAM_MANAGER_EXISTS
 		unpatchedParams->readParam(reader, unpatchedParamsSummary, params::UNPATCHED_ARP_RATCHET_AMOUNT,
 		                           readAutomationUpToPos);
 		reader.exitTag("ratchetAmount");
+		break;
 	}
 
-	else if (!strcmp(tagName, "ratchetProbability")) {
+	case XMLTags::id("ratchetProbability"): {
 		ENSURE_PARAM_MANAGER_EXISTS
 		unpatchedParams->readParam(reader, unpatchedParamsSummary, params::UNPATCHED_ARP_RATCHET_PROBABILITY,
 		                           readAutomationUpToPos);
 		reader.exitTag("ratchetProbability");
+		break;
 	}
 
-	else if (!strcmp(tagName, "sequenceLength")) {
+	case XMLTags::id("sequenceLength"): {
 		ENSURE_PARAM_MANAGER_EXISTS
 		unpatchedParams->readParam(reader, unpatchedParamsSummary, params::UNPATCHED_ARP_SEQUENCE_LENGTH,
 		                           readAutomationUpToPos);
 		reader.exitTag("sequenceLength");
+		break;
 	}
 
-	else if (!strcmp(tagName, "rhythm")) {
+	case XMLTags::id("rhythm"): {
 		ENSURE_PARAM_MANAGER_EXISTS
 		unpatchedParams->readParam(reader, unpatchedParamsSummary, params::UNPATCHED_ARP_RHYTHM, readAutomationUpToPos);
 		reader.exitTag("rhythm");
+		break;
 	}
 
-	else if (!strcmp(tagName,
-	                 "portamento")) { // This is here for compatibility only for people (Lou and Ian) who saved songs
-		                              // with firmware in September 2016
+	// This is here for compatibility only for people (Lou and Ian) who saved songs with firmware in September 2016
+	case XMLTags::id("portamento"): {
 		ENSURE_PARAM_MANAGER_EXISTS
 		unpatchedParams->readParam(reader, unpatchedParamsSummary, params::UNPATCHED_PORTAMENTO, readAutomationUpToPos);
 		reader.exitTag("portamento");
+		break;
 	}
 
 	// For backwards compatibility. If off, switch off for all operators
-	else if (!strcmp(tagName, "oscillatorReset")) {
+	case XMLTags::id("oscillatorReset"): {
 		int32_t value = reader.readTagOrAttributeValueInt();
 		if (!value) {
 			for (int32_t s = 0; s < kNumSources; s++) {
@@ -781,9 +805,10 @@ Error Sound::readTagFromFile(Deserializer& reader, char const* tagName, ParamMan
 			}
 		}
 		reader.exitTag("oscillatorReset");
+		break;
 	}
 
-	else if (!strcmp(tagName, "unison")) {
+	case XMLTags::id("unison"): {
 		while (*(tagName = reader.readNextTagOrAttributeName())) {
 			if (!strcmp(tagName, "num")) {
 				int32_t contents = reader.readTagOrAttributeValueInt();
@@ -805,36 +830,41 @@ Error Sound::readTagFromFile(Deserializer& reader, char const* tagName, ParamMan
 			}
 		}
 		reader.exitTag("unison");
+		break;
 	}
 
-	else if (!strcmp(tagName, "oscAPitchAdjust")) {
+	case XMLTags::id("oscAPitchAdjust"): {
 		ENSURE_PARAM_MANAGER_EXISTS
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_OSC_A_PITCH_ADJUST, readAutomationUpToPos);
 		reader.exitTag("oscAPitchAdjust");
+		break;
 	}
 
-	else if (!strcmp(tagName, "oscBPitchAdjust")) {
+	case XMLTags::id("oscBPitchAdjust"): {
 		ENSURE_PARAM_MANAGER_EXISTS
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_OSC_B_PITCH_ADJUST, readAutomationUpToPos);
 		reader.exitTag("oscBPitchAdjust");
+		break;
 	}
 
-	else if (!strcmp(tagName, "mod1PitchAdjust")) {
+	case XMLTags::id("mod1PitchAdjust"): {
 		ENSURE_PARAM_MANAGER_EXISTS
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_MODULATOR_0_PITCH_ADJUST,
 		                         readAutomationUpToPos);
 		reader.exitTag("mod1PitchAdjust");
+		break;
 	}
 
-	else if (!strcmp(tagName, "mod2PitchAdjust")) {
+	case XMLTags::id("mod2PitchAdjust"): {
 		ENSURE_PARAM_MANAGER_EXISTS
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_MODULATOR_1_PITCH_ADJUST,
 		                         readAutomationUpToPos);
 		reader.exitTag("mod2PitchAdjust");
+		break;
 	}
 
 	// Stuff from the early-2016 format, for compatibility
-	else if (!strcmp(tagName, "fileName")) {
+	case XMLTags::id("fileName"): {
 		ENSURE_PARAM_MANAGER_EXISTS
 
 		MultisampleRange* range = (MultisampleRange*)sources[0].getOrCreateFirstRange();
@@ -858,25 +888,29 @@ Error Sound::readTagFromFile(Deserializer& reader, char const* tagName, ParamMan
 		    getParamFromUserValue(params::LOCAL_OSC_B_VOLUME, 0));
 
 		reader.exitTag("fileName");
+		break;
 	}
 
-	else if (!strcmp(tagName, "cents")) {
+	case XMLTags::id("cents"): {
 		int8_t newCents = reader.readTagOrAttributeValueInt();
 		// We don't need to call the setTranspose method here, because this will get called soon anyway, once the sample
 		// rate is known
 		sources[0].cents = (std::max((int8_t)-50, std::min((int8_t)50, newCents)));
 		reader.exitTag("cents");
+		break;
 	}
-	else if (!strcmp(tagName, "continuous")) {
+	case XMLTags::id("continuous"): {
 		sources[0].repeatMode = static_cast<SampleRepeatMode>(reader.readTagOrAttributeValueInt());
 		sources[0].repeatMode = std::min(sources[0].repeatMode, static_cast<SampleRepeatMode>(kNumRepeatModes - 1));
 		reader.exitTag("continuous");
+		break;
 	}
-	else if (!strcmp(tagName, "reversed")) {
+	case XMLTags::id("reversed"): {
 		sources[0].sampleControls.reversed = reader.readTagOrAttributeValueInt();
 		reader.exitTag("reversed");
+		break;
 	}
-	else if (!strcmp(tagName, "zone")) {
+	case XMLTags::id("zone"): {
 
 		MultisampleRange* range = (MultisampleRange*)sources[0].getOrCreateFirstRange();
 		if (!range) {
@@ -908,17 +942,19 @@ Error Sound::readTagFromFile(Deserializer& reader, char const* tagName, ParamMan
 			}
 		}
 		reader.exitTag("zone");
+		break;
 	}
 
-	else if (!strcmp(tagName, "ringMod")) {
+	case XMLTags::id("ringMod"): {
 		int32_t contents = reader.readTagOrAttributeValueInt();
 		if (contents == 1) {
 			synthMode = SynthMode::RINGMOD;
 		}
 		reader.exitTag("ringMod");
+		break;
 	}
 
-	else if (!strcmp(tagName, "modKnobs")) {
+	case XMLTags::id("modKnobs"): {
 
 		int32_t k = 0;
 		int32_t w = 0;
@@ -973,42 +1009,48 @@ Error Sound::readTagFromFile(Deserializer& reader, char const* tagName, ParamMan
 			reader.exitTag();
 		}
 		reader.exitTag("modKnobs");
+		break;
 	}
 
-	else if (!strcmp(tagName, "patchCables")) {
+	case XMLTags::id("patchCables"): {
 		ENSURE_PARAM_MANAGER_EXISTS
 		paramManager->getPatchCableSet()->readPatchCablesFromFile(reader, readAutomationUpToPos);
 		reader.exitTag("patchCables");
+		break;
 	}
 
-	else if (!strcmp(tagName, "volume")) {
+	case XMLTags::id("volume"): {
 		ENSURE_PARAM_MANAGER_EXISTS
 		patchedParams->readParam(reader, patchedParamsSummary, params::GLOBAL_VOLUME_POST_FX, readAutomationUpToPos);
 		reader.exitTag("volume");
+		break;
 	}
 
-	else if (!strcmp(tagName, "pan")) {
+	case XMLTags::id("pan"): {
 		ENSURE_PARAM_MANAGER_EXISTS
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_PAN, readAutomationUpToPos);
 		reader.exitTag("pan");
+		break;
 	}
 
-	else if (!strcmp(tagName, "pitchAdjust")) {
+	case XMLTags::id("pitchAdjust"): {
 		ENSURE_PARAM_MANAGER_EXISTS
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_PITCH_ADJUST, readAutomationUpToPos);
 		reader.exitTag("pitchAdjust");
+		break;
 	}
 
-	else if (!strcmp(tagName, "modFXType")) {
+	case XMLTags::id("modFXType"): {
 		bool result =
 		    setModFXType(stringToFXType(reader.readTagOrAttributeValue())); // This might not work if not enough RAM
 		if (!result) {
 			display->displayError(Error::INSUFFICIENT_RAM);
 		}
 		reader.exitTag("modFXType");
+		break;
 	}
 
-	else if (!strcmp(tagName, "fx")) {
+	case XMLTags::id("fx"): {
 		while (*(tagName = reader.readNextTagOrAttributeName())) {
 
 			if (!strcmp(tagName, "type")) {
@@ -1057,9 +1099,10 @@ Error Sound::readTagFromFile(Deserializer& reader, char const* tagName, ParamMan
 			}
 		}
 		reader.exitTag("fx");
+		break;
 	}
 
-	else if (!strcmp(tagName, "lfo1")) {
+	case XMLTags::id("lfo1"): {
 		// Set default values in case they are not configured.
 		lfoConfig[LFO1_ID].syncLevel = SYNC_LEVEL_NONE;
 		lfoConfig[LFO1_ID].syncType = SYNC_TYPE_EVEN;
@@ -1089,9 +1132,10 @@ Error Sound::readTagFromFile(Deserializer& reader, char const* tagName, ParamMan
 		}
 		reader.exitTag("lfo1");
 		resyncGlobalLFO();
+		break;
 	}
 
-	else if (!strcmp(tagName, "lfo2")) {
+	case XMLTags::id("lfo2"): {
 		// Set default values in case they are not configured.
 		lfoConfig[LFO2_ID].syncLevel = SYNC_LEVEL_NONE;
 		lfoConfig[LFO2_ID].syncType = SYNC_TYPE_EVEN;
@@ -1122,14 +1166,16 @@ Error Sound::readTagFromFile(Deserializer& reader, char const* tagName, ParamMan
 		}
 		reader.exitTag("lfo2");
 		// No resync for LFO2
+		break;
 	}
 
-	else if (!strcmp(tagName, "sideChainSend")) {
+	case XMLTags::id("sideChainSend"): {
 		sideChainSendLevel = reader.readTagOrAttributeValueInt();
 		reader.exitTag("sideChainSend");
+		break;
 	}
 
-	else if (!strcmp(tagName, "lpf")) {
+	case XMLTags::id("lpf"): {
 		bool switchedOn = true; // For backwards compatibility with pre November 2015 files
 		while (*(tagName = reader.readNextTagOrAttributeName())) {
 			if (!strcmp(tagName, "status")) {
@@ -1168,9 +1214,10 @@ Error Sound::readTagFromFile(Deserializer& reader, char const* tagName, ParamMan
 		}
 
 		reader.exitTag("lpf");
+		break;
 	}
 
-	else if (!strcmp(tagName, "hpf")) {
+	case XMLTags::id("hpf"): {
 		bool switchedOn = true; // For backwards compatibility with pre November 2015 files
 		while (*(tagName = reader.readNextTagOrAttributeName())) {
 			if (!strcmp(tagName, "status")) {
@@ -1205,9 +1252,10 @@ Error Sound::readTagFromFile(Deserializer& reader, char const* tagName, ParamMan
 		}
 
 		reader.exitTag("hpf");
+		break;
 	}
 
-	else if (!strcmp(tagName, "envelope1")) {
+	case XMLTags::id("envelope1"): {
 		while (*(tagName = reader.readNextTagOrAttributeName())) {
 			if (!strcmp(tagName, "attack")) {
 				ENSURE_PARAM_MANAGER_EXISTS
@@ -1239,9 +1287,10 @@ Error Sound::readTagFromFile(Deserializer& reader, char const* tagName, ParamMan
 		}
 
 		reader.exitTag("envelope1");
+		break;
 	}
 
-	else if (!strcmp(tagName, "envelope2")) {
+	case XMLTags::id("envelope2"): {
 		while (*(tagName = reader.readNextTagOrAttributeName())) {
 			if (!strcmp(tagName, "attack")) {
 				ENSURE_PARAM_MANAGER_EXISTS
@@ -1273,41 +1322,48 @@ Error Sound::readTagFromFile(Deserializer& reader, char const* tagName, ParamMan
 		}
 
 		reader.exitTag("envelope2");
+		break;
 	}
 
-	else if (!strcmp(tagName, "polyphonic")) {
+	case XMLTags::id("polyphonic"): {
 		polyphonic = stringToPolyphonyMode(reader.readTagOrAttributeValue());
 		reader.exitTag("polyphonic");
+		break;
 	}
 
-	else if (!strcmp(tagName, "maxVoices")) {
+	case XMLTags::id("maxVoices"): {
 		maxVoiceCount = reader.readTagOrAttributeValueInt();
 		reader.exitTag("maxVoices");
+		break;
 	}
 
-	else if (!strcmp(tagName, "voicePriority")) {
+	case XMLTags::id("voicePriority"): {
 		voicePriority = static_cast<VoicePriority>(reader.readTagOrAttributeValueInt());
 		reader.exitTag("voicePriority");
+		break;
 	}
 
-	else if (!strcmp(tagName, "reverbAmount")) {
+	case XMLTags::id("reverbAmount"): {
 		ENSURE_PARAM_MANAGER_EXISTS
 		patchedParams->readParam(reader, patchedParamsSummary, params::GLOBAL_REVERB_AMOUNT, readAutomationUpToPos);
 		reader.exitTag("reverbAmount");
+		break;
 	}
 
-	else if (!strcmp(tagName, "defaultParams")) {
+	case XMLTags::id("defaultParams"): {
 		ENSURE_PARAM_MANAGER_EXISTS
 		Sound::readParamsFromFile(reader, paramManager, readAutomationUpToPos);
 		reader.exitTag("defaultParams");
+		break;
 	}
-	else if (!strcmp(tagName, "waveFold")) {
+	case XMLTags::id("waveFold"): {
 		ENSURE_PARAM_MANAGER_EXISTS
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_FOLD, readAutomationUpToPos);
 		reader.exitTag("waveFold");
+		break;
 	}
 
-	else {
+	default:
 		Error result =
 		    ModControllableAudio::readTagFromFile(reader, tagName, paramManager, readAutomationUpToPos, song);
 		if (result == Error::NONE) {}
@@ -1316,7 +1372,7 @@ Error Sound::readTagFromFile(Deserializer& reader, char const* tagName, ParamMan
 		}
 		else if (readTagFromFile(reader, tagName)) {}
 		else {
-			result = smDeserializer.tryReadingFirmwareTagFromFile(tagName);
+			result = reader.tryReadingFirmwareTagFromFile(tagName);
 			if (result != Error::NONE && result != Error::RESULT_TAG_UNUSED) {
 				return result;
 			}
@@ -1674,6 +1730,9 @@ justUnassign:
 			AudioEngine::activeVoices.checkVoiceExists(newVoice, this, "E199");
 			AudioEngine::unassignVoice(newVoice, this, modelStack);
 		}
+		// The new Voice's envelope has started, and numVoicesAssigned (which all our Voices' ratings contain) may
+		// have gone up
+		AudioEngine::updateVoiceCullPriorities(this);
 	}
 
 	lastNoteCode = noteCodePostArp; // Store for porta. We store that at both note-on and note-off.
@@ -2188,6 +2247,22 @@ void Sound::stopParamLPF(ModelStackWithSoundFlags* modelStack) {
 	}
 }
 
+// Filters a full batch of Voices held back by Sound::render() together, then finishes rendering each of them
+static void renderFilterBatch(Sound* sound, Voice* (&voices)[QuadFilter::kNumLanes],
+                              Voice::DeferredRender (&renders)[QuadFilter::kNumLanes], int32_t numSamples) {
+	std::array<deluge::dsp::filter::FilterSet*, QuadFilter::kNumLanes> filterSets;
+	std::array<q31_t*, QuadFilter::kNumLanes> buffers;
+	for (int32_t i = 0; i < QuadFilter::kNumLanes; i++) {
+		filterSets[i] = &voices[i]->filterSet;
+		buffers[i] = renders[i].oscBuffer;
+	}
+	QuadFilter::renderLong(filterSets, buffers, numSamples);
+
+	for (int32_t i = 0; i < QuadFilter::kNumLanes; i++) {
+		voices[i]->finishRender(sound, renders[i], true);
+	}
+}
+
 void Sound::render(ModelStackWithThreeMainThings* modelStack, StereoSample* outputBuffer, int32_t numSamples,
                    int32_t* reverbBuffer, int32_t sideChainHitPending, int32_t reverbAmountAdjust,
                    bool shouldLimitDelayFeedback, int32_t pitchAdjust) {
@@ -2328,6 +2403,16 @@ void Sound::render(ModelStackWithThreeMainThings* modelStack, StereoSample* outp
 
 		int32_t ends[2];
 		AudioEngine::activeVoices.getRangeForSound(this, ends);
+
+		// With enough Voices, do their filters four at a time. Each one which can be is held back after rendering
+		// until there's a full batch, and any left at the end go through the usual path
+		bool batchingFilters =
+		    (ends[1] - ends[0] >= QuadFilter::kNumLanes)
+		    && QuadFilter::supports(doLPF ? lpfMode : FilterMode::OFF, doHPF ? hpfMode : FilterMode::OFF, filterRoute);
+		Voice* batchVoices[QuadFilter::kNumLanes];
+		Voice::DeferredRender batchRenders[QuadFilter::kNumLanes];
+		int32_t numInBatch = 0;
+
 		for (int32_t v = ends[0]; v < ends[1]; v++) {
 			Voice* thisVoice = AudioEngine::activeVoices.getVoice(v);
 			/*
@@ -2343,14 +2428,44 @@ void Sound::render(ModelStackWithThreeMainThings* modelStack, StereoSample* outp
 
 			ModelStackWithVoice* modelStackWithVoice = modelStackWithSoundFlags->addVoice(thisVoice);
 
-			bool stillGoing = thisVoice->render(modelStackWithVoice, soundBuffer, numSamples, renderingInStereo,
-			                                    applyingPanAtVoiceLevel, sourcesChanged, doLPF, doHPF, pitchAdjust);
+			Voice::DeferredRender* deferred = nullptr;
+			if (batchingFilters) {
+				deferred = &batchRenders[numInBatch];
+				deferred->oscBuffer = filterLaneBuffers[numInBatch];
+			}
+
+			bool stillGoing =
+			    thisVoice->render(modelStackWithVoice, soundBuffer, numSamples, renderingInStereo,
+			                      applyingPanAtVoiceLevel, sourcesChanged, doLPF, doHPF, pitchAdjust, deferred);
+
+			if (deferred && deferred->pending) {
+				// A Voice about to be unassigned has to be finished now
+				if (!stillGoing || !QuadFilter::canRender(thisVoice->filterSet)) {
+					thisVoice->finishRender(this, *deferred, false);
+				}
+				else {
+					batchVoices[numInBatch++] = thisVoice;
+					if (numInBatch == QuadFilter::kNumLanes) {
+						renderFilterBatch(this, batchVoices, batchRenders, numSamples);
+						numInBatch = 0;
+					}
+				}
+			}
+
 			if (!stillGoing) {
 				AudioEngine::activeVoices.checkVoiceExists(thisVoice, this, "E201");
 				AudioEngine::unassignVoice(thisVoice, this, modelStackWithSoundFlags);
 				v--;
 				ends[1]--;
 			}
+			else {
+				// Catches envelope stages ending during rendering, and anything else which has changed its rating
+				AudioEngine::updateVoiceCullPriority(thisVoice);
+			}
+		}
+
+		for (int32_t i = 0; i < numInBatch; i++) {
+			batchVoices[i]->finishRender(this, batchRenders[i], false);
 		}
 
 		// If just rendered in mono, double that up to stereo now
@@ -2871,6 +2986,7 @@ void Sound::voiceUnassigned(ModelStackWithVoice* modelStack) {
 
 	numVoicesAssigned--;
 	reassessRenderSkippingStatus(modelStack);
+	AudioEngine::updateVoiceCullPriorities(this);
 }
 
 // modelStack may be NULL if no voices currently active
@@ -3632,105 +3748,129 @@ bool Sound::readParamTagFromFile(Deserializer& reader, char const* tagName, Para
 	ParamCollectionSummary* patchedParamsSummary = paramManager->getPatchedParamSetSummary();
 	PatchedParamSet* patchedParams = (PatchedParamSet*)patchedParamsSummary->paramCollection;
 
-	if (!strcmp(tagName, "arpeggiatorGate")) {
+	switch (XMLTags::find(tagName)) {
+	case XMLTags::id("arpeggiatorGate"): {
 		unpatchedParams->readParam(reader, unpatchedParamsSummary, params::UNPATCHED_ARP_GATE, readAutomationUpToPos);
 		reader.exitTag("arpeggiatorGate");
+		break;
 	}
-	else if (!strcmp(tagName, "ratchetProbability")) {
+	case XMLTags::id("ratchetProbability"): {
 		unpatchedParams->readParam(reader, unpatchedParamsSummary, params::UNPATCHED_ARP_RATCHET_PROBABILITY,
 		                           readAutomationUpToPos);
 		reader.exitTag("ratchetProbability");
+		break;
 	}
-	else if (!strcmp(tagName, "ratchetAmount")) {
+	case XMLTags::id("ratchetAmount"): {
 		unpatchedParams->readParam(reader, unpatchedParamsSummary, params::UNPATCHED_ARP_RATCHET_AMOUNT,
 		                           readAutomationUpToPos);
 		reader.exitTag("ratchetAmount");
+		break;
 	}
-	else if (!strcmp(tagName, "sequenceLength")) {
+	case XMLTags::id("sequenceLength"): {
 		unpatchedParams->readParam(reader, unpatchedParamsSummary, params::UNPATCHED_ARP_SEQUENCE_LENGTH,
 		                           readAutomationUpToPos);
 		reader.exitTag("sequenceLength");
+		break;
 	}
-	else if (!strcmp(tagName, "rhythm")) {
+	case XMLTags::id("rhythm"): {
 		unpatchedParams->readParam(reader, unpatchedParamsSummary, params::UNPATCHED_ARP_RHYTHM, readAutomationUpToPos);
 		reader.exitTag("rhythm");
+		break;
 	}
-	else if (!strcmp(tagName, "portamento")) {
+	case XMLTags::id("portamento"): {
 		unpatchedParams->readParam(reader, unpatchedParamsSummary, params::UNPATCHED_PORTAMENTO, readAutomationUpToPos);
 		reader.exitTag("portamento");
+		break;
 	}
-	else if (!strcmp(tagName, "compressorShape")) {
+	case XMLTags::id("compressorShape"): {
 		unpatchedParams->readParam(reader, unpatchedParamsSummary, params::UNPATCHED_SIDECHAIN_SHAPE,
 		                           readAutomationUpToPos);
 		reader.exitTag("compressorShape");
+		break;
 	}
 
-	else if (!strcmp(tagName, "noiseVolume")) {
+	case XMLTags::id("noiseVolume"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_NOISE_VOLUME, readAutomationUpToPos);
 		reader.exitTag("noiseVolume");
+		break;
 	}
-	else if (!strcmp(tagName, "oscAVolume")) {
+	case XMLTags::id("oscAVolume"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_OSC_A_VOLUME, readAutomationUpToPos);
 		reader.exitTag("oscAVolume");
+		break;
 	}
-	else if (!strcmp(tagName, "oscBVolume")) {
+	case XMLTags::id("oscBVolume"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_OSC_B_VOLUME, readAutomationUpToPos);
 		reader.exitTag("oscBVolume");
+		break;
 	}
-	else if (!strcmp(tagName, "oscAPulseWidth")) {
+	case XMLTags::id("oscAPulseWidth"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_OSC_A_PHASE_WIDTH, readAutomationUpToPos);
 		reader.exitTag("oscAPulseWidth");
+		break;
 	}
-	else if (!strcmp(tagName, "oscBPulseWidth")) {
+	case XMLTags::id("oscBPulseWidth"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_OSC_B_PHASE_WIDTH, readAutomationUpToPos);
 		reader.exitTag("oscBPulseWidth");
+		break;
 	}
-	else if (!strcmp(tagName, "oscAWavetablePosition")) {
+	case XMLTags::id("oscAWavetablePosition"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_OSC_A_WAVE_INDEX, readAutomationUpToPos);
 		reader.exitTag();
+		break;
 	}
-	else if (!strcmp(tagName, "oscBWavetablePosition")) {
+	case XMLTags::id("oscBWavetablePosition"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_OSC_B_WAVE_INDEX, readAutomationUpToPos);
 		reader.exitTag();
+		break;
 	}
-	else if (!strcmp(tagName, "volume")) {
+	case XMLTags::id("volume"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::GLOBAL_VOLUME_POST_FX, readAutomationUpToPos);
 		reader.exitTag("volume");
+		break;
 	}
-	else if (!strcmp(tagName, "pan")) {
+	case XMLTags::id("pan"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_PAN, readAutomationUpToPos);
 		reader.exitTag("pan");
+		break;
 	}
-	else if (!strcmp(tagName, "lpfFrequency")) {
+	case XMLTags::id("lpfFrequency"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_LPF_FREQ, readAutomationUpToPos);
 		reader.exitTag("lpfFrequency");
+		break;
 	}
-	else if (!strcmp(tagName, "lpfResonance")) {
+	case XMLTags::id("lpfResonance"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_LPF_RESONANCE, readAutomationUpToPos);
 		reader.exitTag("lpfResonance");
+		break;
 	}
-	else if (!strcmp(tagName, "lpfMorph")) {
+	case XMLTags::id("lpfMorph"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_LPF_MORPH, readAutomationUpToPos);
 		reader.exitTag("lpfMorph");
+		break;
 	}
-	else if (!strcmp(tagName, "hpfFrequency")) {
+	case XMLTags::id("hpfFrequency"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_HPF_FREQ, readAutomationUpToPos);
 		reader.exitTag("hpfFrequency");
+		break;
 	}
-	else if (!strcmp(tagName, "hpfResonance")) {
+	case XMLTags::id("hpfResonance"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_HPF_RESONANCE, readAutomationUpToPos);
 		reader.exitTag("hpfResonance");
+		break;
 	}
-	else if (!strcmp(tagName, "hpfMorph")) {
+	case XMLTags::id("hpfMorph"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_HPF_MORPH, readAutomationUpToPos);
 		reader.exitTag("hpfMorph");
+		break;
 	}
-	else if (!strcmp(tagName, "waveFold")) {
+	case XMLTags::id("waveFold"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_FOLD, readAutomationUpToPos);
 		reader.exitTag("waveFold");
+		break;
 	}
 
-	else if (!strcmp(tagName, "envelope1")) {
+	case XMLTags::id("envelope1"): {
 		while (*(tagName = reader.readNextTagOrAttributeName())) {
 			if (!strcmp(tagName, "attack")) {
 				patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_ENV_0_ATTACK,
@@ -3754,8 +3894,9 @@ bool Sound::readParamTagFromFile(Deserializer& reader, char const* tagName, Para
 			}
 		}
 		reader.exitTag("envelope1");
+		break;
 	}
-	else if (!strcmp(tagName, "envelope2")) {
+	case XMLTags::id("envelope2"): {
 		while (*(tagName = reader.readNextTagOrAttributeName())) {
 			if (!strcmp(tagName, "attack")) {
 				patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_ENV_1_ATTACK,
@@ -3779,95 +3920,118 @@ bool Sound::readParamTagFromFile(Deserializer& reader, char const* tagName, Para
 			}
 		}
 		reader.exitTag("envelope2");
+		break;
 	}
-	else if (!strcmp(tagName, "lfo1Rate")) {
+	case XMLTags::id("lfo1Rate"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::GLOBAL_LFO_FREQ, readAutomationUpToPos);
 		reader.exitTag("lfo1Rate");
+		break;
 	}
-	else if (!strcmp(tagName, "lfo2Rate")) {
+	case XMLTags::id("lfo2Rate"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_LFO_LOCAL_FREQ, readAutomationUpToPos);
 		reader.exitTag("lfo2Rate");
+		break;
 	}
-	else if (!strcmp(tagName, "modulator1Amount")) {
+	case XMLTags::id("modulator1Amount"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_MODULATOR_0_VOLUME, readAutomationUpToPos);
 		reader.exitTag("modulator1Amount");
+		break;
 	}
-	else if (!strcmp(tagName, "modulator2Amount")) {
+	case XMLTags::id("modulator2Amount"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_MODULATOR_1_VOLUME, readAutomationUpToPos);
 		reader.exitTag("modulator2Amount");
+		break;
 	}
-	else if (!strcmp(tagName, "modulator1Feedback")) {
+	case XMLTags::id("modulator1Feedback"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_MODULATOR_0_FEEDBACK,
 		                         readAutomationUpToPos);
 		reader.exitTag("modulator1Feedback");
+		break;
 	}
-	else if (!strcmp(tagName, "modulator2Feedback")) {
+	case XMLTags::id("modulator2Feedback"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_MODULATOR_1_FEEDBACK,
 		                         readAutomationUpToPos);
 		reader.exitTag("modulator2Feedback");
+		break;
 	}
-	else if (!strcmp(tagName, "carrier1Feedback")) {
+	case XMLTags::id("carrier1Feedback"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_CARRIER_0_FEEDBACK, readAutomationUpToPos);
 		reader.exitTag("carrier1Feedback");
+		break;
 	}
-	else if (!strcmp(tagName, "carrier2Feedback")) {
+	case XMLTags::id("carrier2Feedback"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_CARRIER_1_FEEDBACK, readAutomationUpToPos);
 		reader.exitTag("carrier2Feedback");
+		break;
 	}
-	else if (!strcmp(tagName, "pitchAdjust")) {
+	case XMLTags::id("pitchAdjust"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_PITCH_ADJUST, readAutomationUpToPos);
 		reader.exitTag("pitchAdjust");
+		break;
 	}
-	else if (!strcmp(tagName, "oscAPitchAdjust")) {
+	case XMLTags::id("oscAPitchAdjust"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_OSC_A_PITCH_ADJUST, readAutomationUpToPos);
 		reader.exitTag("oscAPitchAdjust");
+		break;
 	}
-	else if (!strcmp(tagName, "oscBPitchAdjust")) {
+	case XMLTags::id("oscBPitchAdjust"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_OSC_B_PITCH_ADJUST, readAutomationUpToPos);
 		reader.exitTag("oscBPitchAdjust");
+		break;
 	}
-	else if (!strcmp(tagName, "mod1PitchAdjust")) {
+	case XMLTags::id("mod1PitchAdjust"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_MODULATOR_0_PITCH_ADJUST,
 		                         readAutomationUpToPos);
 		reader.exitTag("mod1PitchAdjust");
+		break;
 	}
-	else if (!strcmp(tagName, "mod2PitchAdjust")) {
+	case XMLTags::id("mod2PitchAdjust"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::LOCAL_MODULATOR_1_PITCH_ADJUST,
 		                         readAutomationUpToPos);
 		reader.exitTag("mod2PitchAdjust");
+		break;
 	}
-	else if (!strcmp(tagName, "modFXRate")) {
+	case XMLTags::id("modFXRate"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::GLOBAL_MOD_FX_RATE, readAutomationUpToPos);
 		reader.exitTag("modFXRate");
+		break;
 	}
-	else if (!strcmp(tagName, "modFXDepth")) {
+	case XMLTags::id("modFXDepth"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::GLOBAL_MOD_FX_DEPTH, readAutomationUpToPos);
 		reader.exitTag("modFXDepth");
+		break;
 	}
-	else if (!strcmp(tagName, "delayRate")) {
+	case XMLTags::id("delayRate"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::GLOBAL_DELAY_RATE, readAutomationUpToPos);
 		reader.exitTag("delayRate");
+		break;
 	}
-	else if (!strcmp(tagName, "delayFeedback")) {
+	case XMLTags::id("delayFeedback"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::GLOBAL_DELAY_FEEDBACK, readAutomationUpToPos);
 		reader.exitTag("delayFeedback");
+		break;
 	}
-	else if (!strcmp(tagName, "reverbAmount")) {
+	case XMLTags::id("reverbAmount"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::GLOBAL_REVERB_AMOUNT, readAutomationUpToPos);
 		reader.exitTag("reverbAmount");
+		break;
 	}
-	else if (!strcmp(tagName, "arpeggiatorRate")) {
+	case XMLTags::id("arpeggiatorRate"): {
 		patchedParams->readParam(reader, patchedParamsSummary, params::GLOBAL_ARP_RATE, readAutomationUpToPos);
 		reader.exitTag("arpeggiatorRate");
+		break;
 	}
-	else if (!strcmp(tagName, "patchCables")) {
+	case XMLTags::id("patchCables"): {
 		paramManager->getPatchCableSet()->readPatchCablesFromFile(reader, readAutomationUpToPos);
 		reader.exitTag("patchCables");
+		break;
 	}
-	else if (ModControllableAudio::readParamTagFromFile(reader, tagName, paramManager, readAutomationUpToPos)) {}
+	default:
+		if (ModControllableAudio::readParamTagFromFile(reader, tagName, paramManager, readAutomationUpToPos)) {}
 
-	else {
-		return false;
+		else {
+			return false;
+		}
 	}
 
 	return true;
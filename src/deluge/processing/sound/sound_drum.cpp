@@ -23,11 +23,14 @@
 #include "mem_functions.h"
 #include "model/action/action_logger.h"
 #include "model/clip/clip.h"
+#include "model/sample/sample_holder_for_voice.h"
+#include "model/sample/sample_load_resampler.h"
 #include "model/instrument/kit.h"
 #include "model/song/song.h"
 #include "model/voice/voice.h"
 #include "model/voice/voice_vector.h"
 #include "processing/engines/audio_engine.h"
+#include "storage/multi_range/multi_range.h"
 #include "storage/storage_manager.h"
 #include "util/misc.h"
 #include <new>
@@ -148,7 +151,20 @@ void SoundDrum::setupPatchingForAllParamManagers(Song* song) {
 }
 
 Error SoundDrum::loadAllSamples(bool mayActuallyReadFiles) {
-	return Sound::loadAllAudioFiles(mayActuallyReadFiles);
+	Error error = Sound::loadAllAudioFiles(mayActuallyReadFiles);
+	if (error != Error::NONE || !mayActuallyReadFiles || getSynthMode() == SynthMode::FM) {
+		return error;
+	}
+
+	for (int32_t s = 0; s < kNumSources; s++) {
+		if (sources[s].oscType == OscType::SAMPLE) {
+			for (int32_t e = 0; e < sources[s].ranges.getNumElements(); e++) {
+				SampleLoadResampler::drumSampleLoaded(
+				    (SampleHolderForVoice*)sources[s].ranges.getElement(e)->getAudioFileHolder(), transpose);
+			}
+		}
+	}
+	return Error::NONE;
 }
 
 void SoundDrum::prepareForHibernation() {
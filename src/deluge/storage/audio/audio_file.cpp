@@ -21,9 +21,11 @@
 #include "io/debug/log.h"
 #include "memory/general_memory_allocator.h"
 #include "model/sample/sample.h"
+#include "model/sample/sample_block_index.h"
 #include "storage/audio/audio_file_manager.h"
 #include "storage/audio/audio_file_reader.h"
 #include "storage/wave_table/wave_table.h"
+#include <new>
 #include <string.h>
 
 #define MAX_NUM_MARKERS 8
@@ -45,6 +47,7 @@ Error AudioFile::loadFile(AudioFileReader* reader, bool isAiff, bool makeWaveTab
 	bool foundDataChunk = false; // Also applies to AIFF file's SSND chunk
 	bool foundFmtChunk = false;  // Also applies to AIFF file's COMM chunk
 	bool fileExplicitlySpecifiesSelfAsWaveTable = false;
+	bool compressed = false;
 	uint8_t byteDepth = 255; // 255 means no "fmt " or "COMM" chunk seen yet.
 	uint8_t rawDataFormat = RAW_DATA_FINE;
 	uint32_t audioDataStartPosBytes;
@@ -158,6 +161,10 @@ doSetupWaveTable:
 				else if (format == WAV_FORMAT_FLOAT && byteDepth == 4) {
 					rawDataFormat = RAW_DATA_FLOAT;
 				}
+				else if (format == WAV_FORMAT_DELUGE_LOSSLESS && type == AudioFileType::SAMPLE
+				         && (byteDepth == 2 || byteDepth == 3)) {
+					compressed = true;
+				}
 				else {
 					return Error::FILE_UNSUPPORTED;
 				}
@@ -182,6 +189,22 @@ doSetupWaveTable:
 				break;
 			}
 
+			// Lossless compression block index - "dlix"
+			case charsToIntegerConstant('d', 'l', 'i', 'x'): {
+				if (type == AudioFileType::SAMPLE && !((Sample*)this)->blockIndex) {
+					void* memory = GeneralMemoryAllocator::get().allocLowSpeed(sizeof(SampleBlockIndex));
+					if (!memory) {
+						return Error::INSUFFICIENT_RAM;
+					}
+					((Sample*)this)->blockIndex = new (memory) SampleBlockIndex();
+					error = ((Sample*)this)->blockIndex->readFromFile(reader, bytesCurrentChunkNotRoundedUp);
+					if (error != Error::NONE) {
+						return error;
+					}
+				}
+				break;
+			}
+
 			// Sample chunk - "smpl"
 			case charsToIntegerConstant('s', 'm', 'p', 'l'): {
 				if (type == AudioFileType::SAMPLE) {
@@ -450,6 +473,11 @@ finishedWhileLoop:
 		return Error::FILE_CORRUPTED;
 	}
 
+	// Compressed files need their block index, and nothing else should have one
+	if (type == AudioFileType::SAMPLE && compressed != (((Sample*)this)->blockIndex != NULL)) {
+		return Error::FILE_CORRUPTED;
+	}
+
 	if (type == AudioFileType::SAMPLE) {
 
 		if (isAiff) {
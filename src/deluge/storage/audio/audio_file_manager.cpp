@@ -24,10 +24,14 @@
 #include "io/midi/midi_device_manager.h"
 #include "memory/general_memory_allocator.h"
 #include "model/sample/sample.h"
+#include "model/sample/sample_block_index.h"
 #include "model/sample/sample_cache.h"
+#include "model/sample/sample_read_ahead.h"
 #include "model/sample/sample_reader.h"
 #include "playback/playback_handler.h"
 #include "processing/engines/audio_engine.h"
+#include "storage/audio/lossless_codec.h"
+#include "storage/block/sd_block_device.h"
 #include "storage/cluster/cluster.h"
 #include "storage/storage_manager.h"
 #include "storage/wave_table/wave_table.h"
@@ -48,8 +52,6 @@ LBA_t clst2sect(           /* !=0:Sector number, 0:Failed (invalid cluster#) */
                 DWORD clst /* Cluster# to be converted */
 );
 
-DRESULT disk_read_without_streaming_first(BYTE pdrv, BYTE* buff, DWORD sector, UINT count);
-
 extern uint8_t currentlyAccessingCard;
 }
 
@@ -57,7 +59,11 @@ char const* const audioRecordingFolderNames[] = {"SAMPLES/CLIPS", "SAMPLES/RECOR
 
 AudioFileManager audioFileManager{};
 
-AudioFileManager::AudioFileManager() {
+AudioFileManager::AudioFileManager() : clusterReads(sdBlockDevice) {
+	clusterLoadLatency = kSampleRate / 100;
+	attackHeadNumClusters = 0;
+	attackHeadNumHits = 0;
+	attackHeadNumMisses = 0;
 	cardDisabled = false;
 	alternateLoadDirStatus = AlternateLoadDirStatus::NONE_SET;
 	thingTypeBeingLoaded = ThingType::NONE;
@@ -72,6 +78,15 @@ void AudioFileManager::init() {
 
 	clusterBeingLoaded = NULL;
 
+	loadingQueue.reserve(kLoadingQueueCapacity);
+
+	coalescedRead.buffer = (uint8_t*)GeneralMemoryAllocator::get().allocLowSpeed(kCoalescedReadMaxNumBytes);
+	coalescedRead.numClusters = 0;
+
+	compressedBlockBuffer = (uint8_t*)GeneralMemoryAllocator::get().allocLowSpeed(
+	    LosslessCodec::kMaxBlockNumFrames * (LosslessCodec::kMaxNumChannels * 3 + sizeof(int32_t)));
+	decodedBlockSample = NULL;
+
 	Error error = storageManager.initSD();
 	if (error == Error::NONE) {
 		setClusterSize(fileSystemStuff.fileSystem.csize * 512);
@@ -800,6 +815,8 @@ ramError:
 			}
 		}
 
+		((Sample*)audioFile)->findExtents();
+
 		// if (!suppliedFilePointer) f_close(&fileSystemStuff.currentFile);
 
 		((SampleReader*)reader)->currentCluster = NULL;
@@ -839,6 +856,11 @@ ensureSafeThenCheckError:
 		// f_close(&fileSystemStuff.currentFile);
 	}
 
+	// Now the header's been read, a compressed Sample's Clusters get swapped for ones its audio will be decoded into
+	if (*error == Error::NONE && type == AudioFileType::SAMPLE && ((Sample*)audioFile)->blockIndex) {
+		*error = ((Sample*)audioFile)->setUpDecodedClusters();
+	}
+
 	if (*error != Error::NONE) {
 audioFileError:
 		audioFile->~AudioFile(); // Have to call this! This removes the pointers back to the Sample / SampleClusters
@@ -928,6 +950,9 @@ bool AudioFileManager::loadCluster(Cluster* cluster, int32_t minNumReasonsAfter)
 	if (clusterBeingLoaded) {
 		return false;
 	}
+	if (!clusterReads.isIdle()) {
+		return false; // The card's still busy with reads started by loadAnyEnqueuedClusters()
+	}
 	if (AudioEngine::audioRoutineLocked) {
 		return false;
 	}
@@ -935,6 +960,249 @@ bool AudioFileManager::loadCluster(Cluster* cluster, int32_t minNumReasonsAfter)
 	clusterBeingLoaded = cluster;
 	minNumReasonsForClusterBeingLoaded = minNumReasonsAfter + 1;
 
+	int32_t numSectors = prepareToLoadCluster(cluster, minNumReasonsAfter);
+	if (!numSectors) {
+		clusterBeingLoaded = NULL;
+		return false;
+	}
+
+#if REPORT_LOAD_TIME
+	uint16_t startTime = MTU2.TCNT_0;
+#endif
+
+	cluster->timeReadStarted = AudioEngine::audioSampleTimer;
+
+	Error result;
+	if (cluster->sample->clustersDecoded) {
+		result = readCompressedCluster(cluster);
+	}
+	else {
+		result = sdBlockDevice.readAndWait(cluster->sample->clusters.getElement(cluster->clusterIndex)->sdAddress,
+		                                   numSectors, (uint8_t*)cluster->data);
+	}
+
+#if REPORT_LOAD_TIME
+	uint16_t endTime = MTU2.TCNT_0;
+	uint16_t duration = endTime - startTime;
+	int32_t uSec = timerCountToUS(duration);
+	if (uSec > 7000) {
+		D_PRINTLN(uSec);
+	}
+#endif
+
+	return finishLoadingCluster(cluster, result == Error::NONE, minNumReasonsAfter);
+}
+
+// Starts a read of the Cluster on clusterReads, for loadAnyEnqueuedClusters(), which finishes it off once it's arrived.
+// If the Clusters following it in the Sample are waiting to be loaded too, and come straight after it on the card, they
+// get read along with it - a long Sample streaming from a defragmented card then costs one command per
+// kCoalescedReadMaxNumBytes rather than one per Cluster
+bool AudioFileManager::startLoadingCluster(Cluster* cluster) {
+	int32_t numSectors = prepareToLoadCluster(cluster, 0);
+	if (!numSectors) {
+		return false;
+	}
+
+	Sample* sample = cluster->sample;
+	int32_t sectorsPerCluster = clusterSize >> 9;
+	uint8_t* buffer = (uint8_t*)cluster->data;
+	void* context = cluster;
+
+	if (coalescedRead.buffer && !coalescedRead.numClusters && numSectors == sectorsPerCluster) {
+		int32_t maxNumClusters =
+		    std::min<int32_t>(kCoalescedReadMaxNumClusters, kCoalescedReadMaxNumBytes >> clusterSizeMagnitude);
+		int32_t numContiguous = sample->getNumContiguousClusters(cluster->clusterIndex, maxNumClusters);
+
+		coalescedRead.clusters[0] = cluster;
+		coalescedRead.numClusters = 1;
+		CoalescedReadPlan plan = planCoalescedRead(numSectors, sectorsPerCluster, numContiguous, [&](int32_t i) {
+			Cluster* nextCluster = sample->clusters.getElement(cluster->clusterIndex + i)->cluster;
+			if (!nextCluster || !loadingQueue.removeIfPresent(nextCluster)) {
+				return 0;
+			}
+			int32_t nextNumSectors = prepareToLoadCluster(nextCluster, 0);
+			if (!nextNumSectors) {
+				clusterLoadFailed(nextCluster);
+				return 0;
+			}
+			coalescedRead.clusters[coalescedRead.numClusters++] = nextCluster;
+			return nextNumSectors;
+		});
+
+		// numSectors is still the first Cluster's, for if it's on its own after all
+		if (plan.numClusters > 1) {
+			buffer = coalescedRead.buffer;
+			numSectors = plan.numSectors;
+			context = &coalescedRead;
+		}
+		else {
+			coalescedRead.numClusters = 0;
+		}
+	}
+
+	cluster->timeReadStarted = AudioEngine::audioSampleTimer;
+	for (int32_t i = 1; i < coalescedRead.numClusters; i++) {
+		coalescedRead.clusters[i]->timeReadStarted = cluster->timeReadStarted;
+	}
+
+	if (!clusterReads.startRead(sample->clusters.getElement(cluster->clusterIndex)->sdAddress, numSectors, buffer,
+	                            context)) {
+		// The first Cluster's left to the caller, and the rest go back in the queue
+		for (int32_t i = 1; i < coalescedRead.numClusters; i++) {
+			Cluster* otherCluster = coalescedRead.clusters[i];
+			coalescedRead.clusters[i] = NULL;
+			removeReasonFromCluster(otherCluster, "E455");
+			clusterLoadFailed(otherCluster);
+		}
+		coalescedRead.numClusters = 0;
+		removeReasonFromCluster(cluster, "E455");
+		return false;
+	}
+	return true;
+}
+
+// Returns whether any Cluster had to go back in the loading queue
+bool AudioFileManager::finishClusterRead(BlockReadRequest* read) {
+	bool readSucceeded = (read->result == Error::NONE);
+
+	if (read->context != &coalescedRead) {
+		Cluster* cluster = (Cluster*)read->context;
+		if (finishLoadingCluster(cluster, readSucceeded)) {
+			clusterLoaded(cluster);
+			return false;
+		}
+		return clusterLoadFailed(cluster);
+	}
+
+	bool anyRequeued = false;
+	uint32_t numBytesRead = read->numSectors << 9;
+	for (int32_t i = 0; i < coalescedRead.numClusters; i++) {
+		Cluster* cluster = coalescedRead.clusters[i];
+		coalescedRead.clusters[i] = NULL; // No longer in flight, as far as removeReasonFromCluster() is concerned
+		if (readSucceeded) {
+			uint32_t offset = i << clusterSizeMagnitude;
+			memcpy(cluster->data, &coalescedRead.buffer[offset], std::min(clusterSize, numBytesRead - offset));
+		}
+		if (finishLoadingCluster(cluster, readSucceeded)) {
+			clusterLoaded(cluster);
+		}
+		else {
+			anyRequeued = clusterLoadFailed(cluster) || anyRequeued;
+		}
+	}
+	coalescedRead.numClusters = 0;
+	return anyRequeued;
+}
+
+// For a Sample whose Clusters hold its decoded audio: reads the blocks which the Cluster's audio is in, into
+// coalescedRead.buffer, and decodes them into it. Only for when the card has nothing else to do
+Error AudioFileManager::readCompressedCluster(Cluster* cluster) {
+	// init() couldn't get the RAM for these
+	if (!coalescedRead.buffer || !compressedBlockBuffer) {
+		return Error::INSUFFICIENT_RAM;
+	}
+
+	Sample* sample = cluster->sample;
+	SampleBlockIndex* index = sample->blockIndex;
+	uint32_t frameNumBytes = sample->numChannels * sample->byteDepth;
+
+	uint32_t clusterStartPos = cluster->clusterIndex << clusterSizeMagnitude;
+	uint32_t audioStartPos = std::max(clusterStartPos, sample->audioDataStartPosBytes);
+	uint32_t audioEndPos = std::min<uint64_t>(clusterStartPos + clusterSize,
+	                                          sample->audioDataStartPosBytes + sample->audioDataLengthBytes);
+	if (audioEndPos <= audioStartPos) {
+		return Error::FILE_CORRUPTED;
+	}
+
+	// Where the header was, in the file. Nothing should read it from here, but just in case
+	memset(cluster->data, 0, audioStartPos - clusterStartPos);
+
+	uint32_t firstFrame = (audioStartPos - sample->audioDataStartPosBytes) / frameNumBytes;
+	uint32_t lastFrame = (audioEndPos - sample->audioDataStartPosBytes - 1) / frameNumBytes;
+	uint32_t firstBlock = firstFrame / index->blockNumFrames;
+	uint32_t endBlock = lastFrame / index->blockNumFrames + 1;
+
+	// Copies whichever part of a decoded block is in this Cluster
+	uint8_t* decodedBlock = compressedBlockBuffer;
+	auto copyBlock = [&](uint32_t b) {
+		uint32_t blockStartPos = sample->audioDataStartPosBytes + b * index->blockNumFrames * frameNumBytes;
+		uint32_t copyStartPos = std::max(blockStartPos, audioStartPos);
+		uint32_t copyEndPos = std::min(blockStartPos + index->getBlockNumFrames(b) * frameNumBytes, audioEndPos);
+		memcpy(&cluster->data[copyStartPos - clusterStartPos], &decodedBlock[copyStartPos - blockStartPos],
+		       copyEndPos - copyStartPos);
+	};
+
+	// When reading forwards through the Sample, the first block is often the last one decoded for the previous
+	// Cluster, and still there
+	if (decodedBlockSample == sample && decodedBlockIndex == firstBlock) {
+		copyBlock(firstBlock);
+		firstBlock++;
+		if (firstBlock == endBlock) {
+			return Error::NONE;
+		}
+	}
+
+	// Read the sectors those blocks are in - one command for each run of the file's clusters which are next to each
+	// other on the card
+	uint32_t readStartPos = (index->dataStartPosBytes + index->blockOffsets[firstBlock]) & ~(uint32_t)511;
+	uint32_t readEndPos = ((index->dataStartPosBytes + index->blockOffsets[endBlock] - 1) | 511) + 1;
+	if (readEndPos - readStartPos > kCoalescedReadMaxNumBytes) {
+		return Error::FILE_CORRUPTED; // SampleBlockIndex::check() should have made sure of this
+	}
+
+	uint32_t sectorsPerCluster = clusterSize >> 9;
+	uint32_t pos = readStartPos;
+	while (pos < readEndPos) {
+		int32_t fileClusterIndex = pos >> clusterSizeMagnitude;
+		if (fileClusterIndex >= index->numFileClusters || !index->fileSDAddresses[fileClusterIndex]) {
+			return Error::FILE_CORRUPTED;
+		}
+		uint32_t sector = index->fileSDAddresses[fileClusterIndex] + ((pos & (clusterSize - 1)) >> 9);
+
+		int32_t endFileClusterIndex = fileClusterIndex + 1;
+		while (endFileClusterIndex < index->numFileClusters
+		       && ((uint32_t)endFileClusterIndex << clusterSizeMagnitude) < readEndPos
+		       && index->fileSDAddresses[endFileClusterIndex]
+		              == index->fileSDAddresses[fileClusterIndex]
+		                     + (endFileClusterIndex - fileClusterIndex) * sectorsPerCluster) {
+			endFileClusterIndex++;
+		}
+		uint32_t runEndPos = std::min<uint32_t>(readEndPos, endFileClusterIndex << clusterSizeMagnitude);
+
+		Error error =
+		    sdBlockDevice.readAndWait(sector, (runEndPos - pos) >> 9, &coalescedRead.buffer[pos - readStartPos]);
+		if (error != Error::NONE) {
+			return error;
+		}
+		pos = runEndPos;
+	}
+
+	// Decode each block, and copy whichever part of it is in this Cluster
+	int32_t* scratch =
+	    (int32_t*)&compressedBlockBuffer[LosslessCodec::kMaxBlockNumFrames * LosslessCodec::kMaxNumChannels * 3];
+	uint8_t const* compressed =
+	    &coalescedRead.buffer[index->dataStartPosBytes + index->blockOffsets[firstBlock] - readStartPos];
+
+	decodedBlockSample = NULL;
+	for (uint32_t b = firstBlock; b < endBlock; b++) {
+		int32_t numBytes = index->blockOffsets[b + 1] - index->blockOffsets[b];
+		if (!LosslessCodec::decodeBlock(compressed, numBytes, index->getBlockNumFrames(b), sample->numChannels,
+		                                sample->byteDepth, decodedBlock, scratch)) {
+			return Error::FILE_CORRUPTED;
+		}
+		compressed += numBytes;
+		copyBlock(b);
+	}
+	decodedBlockSample = sample;
+	decodedBlockIndex = endBlock - 1;
+
+	return Error::NONE;
+}
+
+// Adds a reason to the Cluster for the duration of the read, and returns how many sectors to read - or 0 if there's
+// nothing to read, in which case the reason's gone again
+int32_t AudioFileManager::prepareToLoadCluster(Cluster* cluster, int32_t minNumReasonsAfter) {
+
 	Sample* sample = cluster->sample;
 
 	if (cluster->type != ClusterType::Sample) {
@@ -957,9 +1225,8 @@ bool AudioFileManager::loadCluster(Cluster* cluster, int32_t minNumReasonsAfter)
 
 	if (false) {
 getOutEarly:
-		clusterBeingLoaded = NULL;
 		removeReasonFromCluster(cluster, "E033");
-		return false;
+		return 0;
 	}
 
 	int32_t clusterIndex = cluster->clusterIndex;
@@ -989,10 +1256,6 @@ getOutEarly:
 
 	AudioEngine::logAction("loadCluster");
 
-#if REPORT_LOAD_TIME
-	uint16_t startTime = MTU2.TCNT_0;
-#endif
-
 #if ALPHA_OR_BETA_VERSION
 	if (cluster->type != ClusterType::Sample) {
 		FREEZE_WITH_ERROR("i023"); // Happened to me while thrash testing with reduced RAM
@@ -1003,17 +1266,12 @@ getOutEarly:
 	}
 #endif
 
-	DRESULT result = disk_read_without_streaming_first(
-	    SD_PORT, (BYTE*)cluster->data, sample->clusters.getElement(cluster->clusterIndex)->sdAddress, numSectors);
+	return numSectors;
+}
 
-#if REPORT_LOAD_TIME
-	uint16_t endTime = MTU2.TCNT_0;
-	uint16_t duration = endTime - startTime;
-	int32_t uSec = timerCountToUS(duration);
-	if (uSec > 7000) {
-		D_PRINTLN(uSec);
-	}
-#endif
+// Once the Cluster's data has arrived from the card (or failed to), converts it and sorts out the extra bytes shared
+// with its neighbours, then takes away the reason prepareToLoadCluster() added
+bool AudioFileManager::finishLoadingCluster(Cluster* cluster, bool readSucceeded, int32_t minNumReasonsAfter) {
 
 #if ALPHA_OR_BETA_VERSION
 	if (cluster->type != ClusterType::Sample) {
@@ -1029,10 +1287,15 @@ getOutEarly:
 #endif
 
 	// If that failed, get out
-	if (result) {
-		goto getOutEarly;
+	if (!readSucceeded) {
+		clusterBeingLoaded = NULL;
+		removeReasonFromCluster(cluster, "E033");
+		return false;
 	}
 
+	Sample* sample = cluster->sample;
+	int32_t clusterIndex = cluster->clusterIndex;
+
 	cluster->convertDataIfNecessary();
 
 #if ALPHA_OR_BETA_VERSION
@@ -1322,49 +1585,59 @@ performActionsAndGetOut:
 			playbackHandler.slowRoutine();
 		}
 
-		Cluster* cluster = loadingQueue.grabHead();
-		if (!cluster) {
-			break;
-		}
-
-		// cluster has at least 1 "reason". If it didn't, it would have been removed from the load-queue
+		bool anyProgress = false;
+		bool anyFailed = false;
 
-		// Do the actual loading
-		if (cluster->type != ClusterType::Sample) {
-			FREEZE_WITH_ERROR("E235"); // Cos Chris F got an E205
-		}
+		// Get the card started on as many Clusters as it'll take...
+		while (clusterReads.hasRoom()) {
+			Cluster* cluster = loadingQueue.peekHead();
+			if (!cluster) {
+				break;
+			}
 
-		allowSomeUserActionsEvenWhenInCardRoutine = true; // Sorry!!
-		bool success = loadCluster(cluster);
-		allowSomeUserActionsEvenWhenInCardRoutine = false;
+			// cluster has at least 1 "reason". If it didn't, it would have been removed from the load-queue
 
-		// If that didn't work, presumably because the SD card got ejected...
-		if (!success) {
-			D_PRINTLN("load Cluster fail");
+			if (cluster->type != ClusterType::Sample) {
+				FREEZE_WITH_ERROR("E235"); // Cos Chris F got an E205
+			}
 
-			// If the Cluster is now down to 0 reasons (i.e. it lost a reason while being loaded), then it's already
-			// been made "available" and we don't have a problem
-			if (!cluster->numReasonsToBeLoaded) {}
+			// A compressed Sample's Clusters get read and decoded there and then, by loadCluster(), which needs the
+			// card to itself. They count as arriving straight away
+			bool compressed = cluster->sample->clustersDecoded;
+			if (compressed && (!clusterReads.isIdle() || count >= maxNum)) {
+				break;
+			}
+			loadingQueue.grabHead();
 
-			// Otherwise, there are still "reasons" waiting for this Cluster to become loaded, so we need to put it back
-			// in the loading queue. Presumably it won't actually get loaded for a while - only when the user re-inserts
-			// the card
-			else {
+			allowSomeUserActionsEvenWhenInCardRoutine = true; // Sorry!!
+			bool success = compressed ? loadCluster(cluster) : startLoadingCluster(cluster);
+			allowSomeUserActionsEvenWhenInCardRoutine = false;
 
-				if (cluster->type != ClusterType::Sample) {
-					FREEZE_WITH_ERROR("E237"); // Cos Chris F got an E205
+			if (!success) {
+				anyFailed = clusterLoadFailed(cluster);
+				if (anyFailed) {
+					break;
 				}
-
-				enqueueCluster(cluster); // TODO: If that fails, it'll just get awkwardly forgotten about
-
-				// Also, return now. Normally we stay here til there's nothing left in the load-queue, but now that
-				// would leave us in an infinite loop!
-				break;
 			}
+			else if (compressed) {
+				clusterLoaded(cluster);
+				count++;
+			}
+			anyProgress = true;
+		}
+
+		// ...and, while it transfers those, deal with any which have arrived
+		BlockReadRequest finishedRead;
+		while (clusterReads.takeFinished(&finishedRead)) {
+			anyFailed = finishClusterRead(&finishedRead) || anyFailed;
+			anyProgress = true;
+			count++;
 		}
 
-		count++;
-		if (count >= maxNum) {
+		// If a load failed, presumably because the SD card got ejected, normally we'd stay here til there's nothing left
+		// in the load-queue, but now that would leave us in an infinite loop! And if the card's still busy with what
+		// it's got, there's no sense waiting here - the next call will pick those up
+		if (anyFailed || !anyProgress || count >= maxNum) {
 			break; // Keep things sane?
 		}
 	}
@@ -1374,6 +1647,48 @@ performActionsAndGetOut:
 #endif
 }
 
+// For Clusters which came through the loading queue. Only the read itself is timed - however long a Cluster sat in the
+// queue first depends on its priority, and readers going deeper would only make the queue longer
+void AudioFileManager::clusterLoaded(Cluster* cluster) {
+	clusterLoadLatency = smoothLoadLatency(clusterLoadLatency, AudioEngine::audioSampleTimer - cluster->timeReadStarted);
+}
+
+// Returns whether the Cluster's been put back in the loading queue
+bool AudioFileManager::clusterLoadFailed(Cluster* cluster) {
+	D_PRINTLN("load Cluster fail");
+
+	// If the Cluster is now down to 0 reasons (i.e. it lost a reason while being loaded), then it's already been made
+	// "available" and we don't have a problem
+	if (!cluster->numReasonsToBeLoaded) {
+		return false;
+	}
+
+	// Otherwise, there are still "reasons" waiting for this Cluster to become loaded, so we need to put it back in the
+	// loading queue. Presumably it won't actually get loaded for a while - only when the user re-inserts the card
+	else {
+
+		if (cluster->type != ClusterType::Sample) {
+			FREEZE_WITH_ERROR("E237"); // Cos Chris F got an E205
+		}
+
+		enqueueCluster(cluster); // TODO: If that fails, it'll just get awkwardly forgotten about
+		return true;
+	}
+}
+
+bool AudioFileManager::isClusterBeingLoaded(Cluster* cluster) {
+	return (cluster == clusterBeingLoaded || isClusterInFlight(cluster));
+}
+
+bool AudioFileManager::isClusterInFlight(Cluster* cluster) {
+	for (int32_t i = 0; i < coalescedRead.numClusters; i++) {
+		if (coalescedRead.clusters[i] == cluster) {
+			return true;
+		}
+	}
+	return clusterReads.isReading(cluster);
+}
+
 // Currently there's no risk of trying to enqueue a cluster multiple times, because this function only gets called after
 // it's freshly allocated
 Error AudioFileManager::enqueueCluster(Cluster* cluster, uint32_t priorityRating) {
@@ -1396,6 +1711,9 @@ void AudioFileManager::removeReasonFromCluster(Cluster* cluster, char const* err
 	if (cluster == clusterBeingLoaded && cluster->numReasonsToBeLoaded < minNumReasonsForClusterBeingLoaded) {
 		FREEZE_WITH_ERROR("E041"); // Sven got this!
 	}
+	if (cluster->numReasonsToBeLoaded < 1 && isClusterInFlight(cluster)) {
+		FREEZE_WITH_ERROR("E456"); // The reason startLoadingCluster() added has gone
+	}
 
 	// If it's now zero, it's become available
 	if (cluster->numReasonsToBeLoaded == 0) {
@@ -1438,10 +1756,35 @@ void AudioFileManager::removeReasonFromCluster(Cluster* cluster, char const* err
 }
 
 bool AudioFileManager::loadingQueueHasAnyLowestPriorityElements() {
-	int32_t numElements = loadingQueue.getNumElements();
-	return (numElements
-	        && ((PriorityQueueElement*)audioFileManager.loadingQueue.getElementAddress(numElements - 1))->priorityRating
-	               == 0xFFFFFFFF);
+	return loadingQueue.hasAnyLowestPriorityElements();
+}
+
+// How many more Clusters SampleHolders may hold as attack heads. Can be negative if the cluster size has gone up
+int32_t AudioFileManager::getNumAttackHeadClustersSpare() {
+	return (int32_t)(kAttackHeadBudgetBytes / clusterSize) - attackHeadNumClusters;
+}
+
+// The caller must already hold a reason on the Cluster
+void AudioFileManager::claimAttackHeadCluster(Cluster* cluster) {
+	if (!cluster->numAttackHeadClaims++) {
+		attackHeadNumClusters++;
+	}
+}
+
+void AudioFileManager::releaseAttackHeadCluster(Cluster* cluster, char const* errorCode) {
+	if (!--cluster->numAttackHeadClaims) {
+		attackHeadNumClusters--;
+	}
+	removeReasonFromCluster(cluster, errorCode);
+}
+
+void AudioFileManager::attackHeadUsed(bool wasLoaded) {
+	if (wasLoaded) {
+		attackHeadNumHits++;
+	}
+	else {
+		attackHeadNumMisses++;
+	}
 }
 
 // Caller must also set alternateAudioFileLoadPath.
@@ -18,6 +18,7 @@
 #pragma once
 #include "definitions_cxx.hpp"
 #include "storage/audio/audio_file_vector.h"
+#include "storage/block/read_pipeline.h"
 #include "storage/cluster/cluster_priority_queue.h"
 #include <cstdint>
 #include <stdint.h>
@@ -32,6 +33,17 @@ class SampleCache;
 class String;
 class SampleRecorder;
 
+// Up to this many Clusters of a Sample which are next to each other on the card get read with one command - see
+// AudioFileManager::startLoadingCluster()
+constexpr int32_t kCoalescedReadMaxNumClusters = 8;
+constexpr int32_t kCoalescedReadMaxNumBytes = 131072;
+
+// More Clusters than could all be in RAM at once, unless they're very small
+constexpr int32_t kLoadingQueueCapacity = 4096;
+
+// How much RAM SampleHolders may keep the starts of their samples loaded in - see attackHeadNumClusters
+constexpr uint32_t kAttackHeadBudgetBytes = 16 * 1024 * 1024;
+
 enum class AlternateLoadDirStatus {
 	NONE_SET,
 	NOT_FOUND,
@@ -85,6 +97,7 @@ public:
 	Error enqueueCluster(Cluster* cluster, uint32_t priorityRating = 0xFFFFFFFF);
 	bool loadCluster(Cluster* cluster, int32_t minNumReasonsAfter = 0);
 	void loadAnyEnqueuedClusters(int32_t maxNum = 128, bool mayProcessUserActionsBetween = false);
+	bool isClusterBeingLoaded(Cluster* cluster);
 	void addReasonToCluster(Cluster* cluster);
 	void removeReasonFromCluster(Cluster* cluster, char const* errorCode, bool deletingSong = false);
 	void testQueue();
@@ -96,6 +109,10 @@ public:
 	Error setupAlternateAudioFilePath(String* newPath, int32_t dirPathLength, String* oldPath);
 	Error setupAlternateAudioFileDir(String* newPath, char const* rootDir, String* songFilenameWithoutExtension);
 	bool loadingQueueHasAnyLowestPriorityElements();
+	int32_t getNumAttackHeadClustersSpare();
+	void claimAttackHeadCluster(Cluster* cluster);
+	void releaseAttackHeadCluster(Cluster* cluster, char const* errorCode);
+	void attackHeadUsed(bool wasLoaded);
 	Error getUnusedAudioRecordingFilePath(String* filePath, String* tempFilePathForRecording,
 	                                      AudioRecordingFolder folderID, uint32_t* getNumber);
 	void deleteAnyTempRecordedSamplesFromMemory();
@@ -117,7 +134,38 @@ public:
 	bool cardEjected;
 	bool cardDisabled;
 
-	Cluster* clusterBeingLoaded;
+	// Reads started by loadAnyEnqueuedClusters(), which go on while it converts whichever arrived before them.
+	// loadCluster() doesn't use this, and won't go while it's busy
+	ReadPipeline clusterReads;
+
+	// When several Clusters are being read in one go, they land in buffer first, and get copied out to each one after
+	struct CoalescedRead {
+		uint8_t* buffer; // kCoalescedReadMaxNumBytes, or NULL if we couldn't have the RAM
+		Cluster* clusters[kCoalescedReadMaxNumClusters];
+		int32_t numClusters; // 0 when not in use
+	} coalescedRead;
+
+	// For decoding a losslessly compressed Sample's blocks into (see readCompressedCluster()), whose compressed bytes
+	// are read into coalescedRead.buffer first. NULL if we couldn't have the RAM
+	uint8_t* compressedBlockBuffer;
+
+	// Which Sample's block was decoded into compressedBlockBuffer last, if it's still there, so that a block straddling
+	// two Clusters read one after the other only gets decoded once
+	Sample* decodedBlockSample;
+	uint32_t decodedBlockIndex;
+
+	// How long Clusters have lately been taking to read from the card, in samples - see smoothLoadLatency()
+	uint32_t clusterLoadLatency;
+
+	// Attack heads are the first Clusters from each SampleHolder's start (and loop start) marker, which it holds on to
+	// so notes can start straight away rather than waiting for the card. They get kAttackHeadBudgetBytes between them,
+	// counting each Cluster once however many claim it. Once let go of they're just ordinary Clusters again. Hits and misses are note starts which
+	// did and didn't find the attack head they started from all loaded
+	int32_t attackHeadNumClusters;
+	uint32_t attackHeadNumHits;
+	uint32_t attackHeadNumMisses;
+
+	Cluster* clusterBeingLoaded; // By loadCluster()
 	int32_t minNumReasonsForClusterBeingLoaded; // Only valid when clusterBeingLoaded is set. And this exists for bug
 	                                            // hunting only.
 
@@ -132,6 +180,14 @@ public:
 private:
 	void setClusterSize(uint32_t newSize);
 	void cardReinserted();
+	bool startLoadingCluster(Cluster* cluster);
+	int32_t prepareToLoadCluster(Cluster* cluster, int32_t minNumReasonsAfter);
+	bool finishLoadingCluster(Cluster* cluster, bool readSucceeded, int32_t minNumReasonsAfter = 0);
+	bool finishClusterRead(BlockReadRequest* read);
+	Error readCompressedCluster(Cluster* cluster);
+	bool isClusterInFlight(Cluster* cluster);
+	void clusterLoaded(Cluster* cluster);
+	bool clusterLoadFailed(Cluster* cluster);
 	int32_t readBytes(char* buffer, int32_t num, int32_t* byteIndexWithinCluster, Cluster** currentCluster,
 	                  uint32_t* currentClusterIndex, uint32_t fileSize, Sample* sample);
 	int32_t loadAiff(Sample* newSample, uint32_t fileSize, Cluster** currentCluster, uint32_t* currentClusterIndex);
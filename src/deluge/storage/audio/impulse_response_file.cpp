@@ -0,0 +1,212 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "storage/audio/impulse_response_file.h"
+#include "dsp/convolution/impulse_response_processor.h"
+#include "io/debug/log.h"
+#include "memory/general_memory_allocator.h"
+#include "model/settings/runtime_feature_settings.h"
+#include "processing/engines/audio_engine.h"
+#include "storage/audio/audio_file_manager.h"
+#include "storage/storage_manager.h"
+#include "util/functions.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+extern "C" {
+#include "fatfs/ff.h"
+}
+
+namespace ImpulseResponseFile {
+
+namespace {
+
+using deluge::dsp::PartitionedConvolver;
+
+FIL file;
+
+struct Format {
+	uint16_t format = 0;
+	uint16_t numChannels = 0;
+	uint16_t byteDepth = 0;
+};
+
+bool readExactly(void* to, UINT numBytes) {
+	UINT numBytesRead;
+	return (f_read(&file, to, numBytes, &numBytesRead) == FR_OK && numBytesRead == numBytes);
+}
+
+// Leaves the file at the start of the "data" chunk, and returns how long it is
+Error findData(Format* format, uint32_t* dataLength) {
+	uint32_t riffHeader[3];
+	if (!readExactly(riffHeader, sizeof(riffHeader)) || riffHeader[0] != charsToIntegerConstant('R', 'I', 'F', 'F')
+	    || riffHeader[2] != charsToIntegerConstant('W', 'A', 'V', 'E')) {
+		return Error::FILE_UNSUPPORTED;
+	}
+
+	while (true) {
+		struct {
+			uint32_t name;
+			uint32_t length;
+		} chunk;
+		if (!readExactly(&chunk, sizeof(chunk))) {
+			return Error::FILE_CORRUPTED;
+		}
+		FSIZE_t nextChunk = f_tell(&file) + ((chunk.length + 1) & ~(uint32_t)1); // RIFF chunks are padded to even
+
+		if (chunk.name == charsToIntegerConstant('f', 'm', 't', ' ')) {
+			uint32_t header[4];
+			if (chunk.length < sizeof(header) || !readExactly(header, sizeof(header))) {
+				return Error::FILE_CORRUPTED;
+			}
+			format->format = header[0];
+			format->numChannels = header[0] >> 16;
+			format->byteDepth = (header[3] >> 16) >> 3;
+		}
+		else if (chunk.name == charsToIntegerConstant('d', 'a', 't', 'a')) {
+			if (!format->numChannels) {
+				return Error::FILE_UNSUPPORTED; // No "fmt " chunk before it
+			}
+			*dataLength = chunk.length;
+			return Error::NONE;
+		}
+
+		if (f_lseek(&file, nextChunk) != FR_OK || f_tell(&file) != nextChunk) {
+			return Error::FILE_CORRUPTED;
+		}
+	}
+}
+
+q31_t readTap(uint8_t const* frame, Format const& format) {
+	switch (format.byteDepth) {
+	case 1:
+		return (q31_t)(frame[0] - 128) << 24;
+	case 2:
+		return (q31_t)((uint32_t)frame[0] << 16 | (uint32_t)frame[1] << 24);
+	case 3:
+		return (q31_t)((uint32_t)frame[0] << 8 | (uint32_t)frame[1] << 16 | (uint32_t)frame[2] << 24);
+	default: {
+		uint32_t word;
+		memcpy(&word, frame, sizeof(word));
+		if (format.format != WAV_FORMAT_FLOAT) {
+			return (q31_t)word;
+		}
+		float value;
+		memcpy(&value, &word, sizeof(value));
+		return (q31_t)std::clamp<double>(value * 2147483648.0, INT32_MIN, INT32_MAX);
+	}
+	}
+}
+
+// Reads the first channel of numTaps frames, a Cluster at a time through the cluster buffer, since what comes back
+// from allocLowSpeed() might not be aligned for the card to read straight into
+bool readTaps(q31_t* taps, int32_t numTaps, Format const& format) {
+	int32_t frameSize = format.numChannels * format.byteDepth;
+	int32_t framesPerRead = audioFileManager.clusterSize / frameSize;
+	uint8_t* buffer = (uint8_t*)smDeserializer.fileClusterBuffer; // Nothing's being read from the card but us
+
+	for (int32_t done = 0; done < numTaps; done += framesPerRead) {
+		int32_t numFrames = std::min(framesPerRead, numTaps - done);
+		if (!readExactly(buffer, numFrames * frameSize)) {
+			return false;
+		}
+		for (int32_t i = 0; i < numFrames; i++) {
+			taps[done + i] = readTap(&buffer[i * frameSize], format);
+		}
+		AudioEngine::routineWithClusterLoading();
+	}
+	return true;
+}
+
+// Taps for ImpulseResponseProcessor are applied with multiply_32x32_rshift32_rounded(), so 2^32 would be unity gain
+// - but none can be past 2^31. Within that, white noise comes through at the level it went in
+void scaleTaps(q31_t* taps, int32_t numTaps) {
+	double sumOfSquares = 0;
+	double peak = 0;
+	for (int32_t i = 0; i < numTaps; i++) {
+		double tap = taps[i] / 2147483648.0;
+		sumOfSquares += tap * tap;
+		peak = std::max(peak, std::abs(tap));
+	}
+	if (peak == 0) {
+		return;
+	}
+	double gain = std::min(4294967296.0 / std::sqrt(sumOfSquares), 2147483520.0 / peak) / 2147483648.0;
+	for (int32_t i = 0; i < numTaps; i++) {
+		taps[i] = (q31_t)(taps[i] * gain);
+	}
+}
+
+Error load() {
+	if (f_open(&file, kPath, FA_READ) != FR_OK) {
+		return Error::FILE_NOT_FOUND;
+	}
+
+	Format format;
+	uint32_t dataLength = 0;
+	Error error = findData(&format, &dataLength);
+	if (error == Error::NONE
+	    && (format.numChannels < 1 || format.numChannels > 2 || format.byteDepth < 1 || format.byteDepth > 4
+	        || !(format.format == WAV_FORMAT_PCM || (format.format == WAV_FORMAT_FLOAT && format.byteDepth == 4)))) {
+		error = Error::FILE_UNSUPPORTED;
+	}
+
+	q31_t* taps = nullptr;
+	if (error == Error::NONE) {
+		int32_t numTaps = std::min<uint32_t>(dataLength / (format.numChannels * format.byteDepth),
+		                                     PartitionedConvolver::kMaxNumTaps);
+		taps = (q31_t*)GeneralMemoryAllocator::get().allocLowSpeed(std::max(numTaps, 1) * sizeof(q31_t));
+		if (!taps) {
+			error = Error::INSUFFICIENT_RAM;
+		}
+		else if (!readTaps(taps, numTaps, format)) {
+			error = Error::FILE_CORRUPTED;
+		}
+		else {
+			scaleTaps(taps, numTaps);
+			error = ImpulseResponseProcessor::setUserImpulseResponse({taps, (size_t)numTaps});
+		}
+	}
+	f_close(&file);
+
+	if (taps) {
+		delugeDealloc(taps);
+	}
+	return error;
+}
+
+} // namespace
+
+bool shouldUse() {
+	return runtimeFeatureSettings.get(RuntimeFeatureSettingType::DelayImpulseResponse) == RuntimeFeatureStateToggle::On;
+}
+
+Error update() {
+	ImpulseResponseProcessor::clearUserImpulseResponse();
+	if (!shouldUse()) {
+		return Error::NONE;
+	}
+
+	Error error = load();
+	if (error != Error::NONE) {
+		D_PRINTLN("couldn't load delay IR from %s", kPath);
+	}
+	return error;
+}
+
+} // namespace ImpulseResponseFile
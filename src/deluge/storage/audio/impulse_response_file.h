@@ -0,0 +1,36 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "definitions_cxx.hpp"
+
+// The user's own IR for the analog delay's feedback path, in place of the built-in one (see ImpulseResponseProcessor)
+// - if the community feature is on. It's a WAV file at kPath: 8, 16, 24 or 32-bit PCM or 32-bit float, of which only
+// the first channel and the first PartitionedConvolver::kMaxNumTaps samples are used. It's scaled to come through at
+// about the level it went in.
+namespace ImpulseResponseFile {
+
+constexpr char const* kPath = "IR/DELAY.WAV";
+
+bool shouldUse();
+
+// Loads the file if the feature's on, and otherwise goes back to the built-in IR. For at startup, and whenever the
+// feature's turned on or off
+Error update();
+
+} // namespace ImpulseResponseFile
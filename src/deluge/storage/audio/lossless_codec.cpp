@@ -0,0 +1,361 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "storage/audio/lossless_codec.h"
+
+namespace LosslessCodec {
+
+namespace {
+
+constexpr int32_t kMaxOrder = 3;
+constexpr int32_t kMaxRiceParam = 30;
+
+int32_t readSample(uint8_t const* from, int32_t byteDepth) {
+	if (byteDepth == 2) {
+		return (int16_t)(from[0] | (from[1] << 8));
+	}
+	return (int32_t)((uint32_t)(from[0] | (from[1] << 8) | (from[2] << 16)) << 8) >> 8;
+}
+
+void writeSample(uint8_t* to, int32_t value, int32_t byteDepth) {
+	to[0] = value;
+	to[1] = value >> 8;
+	if (byteDepth == 3) {
+		to[2] = value >> 16;
+	}
+}
+
+// Done unsigned so that a corrupt block can't overflow anything - for a proper one it comes out the same
+template <int32_t order>
+inline uint32_t predict(uint32_t const* at) {
+	if constexpr (order == 1) {
+		return at[-1];
+	}
+	else if constexpr (order == 2) {
+		return 2 * at[-1] - at[-2];
+	}
+	else if constexpr (order == 3) {
+		return 3 * at[-1] - 3 * at[-2] + at[-3];
+	}
+	return 0;
+}
+
+uint32_t predict(uint32_t const* at, int32_t order) {
+	switch (order) {
+	case 1:
+		return predict<1>(at);
+	case 2:
+		return predict<2>(at);
+	case 3:
+		return predict<3>(at);
+	}
+	return 0;
+}
+
+inline uint32_t zigzag(uint32_t error) {
+	return (error << 1) ^ (uint32_t)((int32_t)error >> 31);
+}
+
+inline uint32_t unzigzag(uint32_t zigzagged) {
+	return (zigzagged >> 1) ^ -(zigzagged & 1);
+}
+
+class BitWriter {
+public:
+	BitWriter(uint8_t* newPos) : pos(newPos) {}
+
+	// num may be up to 32
+	void write(uint32_t value, int32_t num) {
+		buffer = (buffer << num) | (value & (((uint64_t)1 << num) - 1));
+		numBits += num;
+		while (numBits >= 8) {
+			numBits -= 8;
+			*pos++ = buffer >> numBits;
+		}
+	}
+
+	void writeUnary(uint32_t value) {
+		while (value >= 32) {
+			write(0, 32);
+			value -= 32;
+		}
+		write(1, value + 1);
+	}
+
+	// Pads out to a whole byte, and returns where that left us
+	uint8_t* finish() {
+		if (numBits) {
+			*pos++ = buffer << (8 - numBits);
+			numBits = 0;
+		}
+		return pos;
+	}
+
+private:
+	uint8_t* pos;
+	uint64_t buffer = 0;
+	int32_t numBits = 0;
+};
+
+class BitReader {
+public:
+	BitReader(uint8_t const* newPos, uint8_t const* newEnd) : pos(newPos), end(newEnd) {}
+
+	// These return false if there weren't enough bits left
+	inline bool readUnary(uint32_t* value) {
+		uint32_t numZeros = 0;
+		while (true) {
+			refill();
+			if (!numBits) {
+				return false;
+			}
+			int32_t leadingZeros = buffer ? __builtin_clzll(buffer) : 64;
+			if (leadingZeros < numBits) {
+				buffer <<= leadingZeros + 1;
+				numBits -= leadingZeros + 1;
+				*value = numZeros + leadingZeros;
+				return true;
+			}
+			numZeros += numBits;
+			buffer = 0;
+			numBits = 0;
+		}
+	}
+
+	// num may be up to 32
+	inline bool readBits(int32_t num, uint32_t* value) {
+		if (!num) {
+			*value = 0;
+			return true;
+		}
+		refill();
+		if (numBits < num) {
+			return false;
+		}
+		*value = buffer >> (64 - num);
+		buffer <<= num;
+		numBits -= num;
+		return true;
+	}
+
+	// Where the next byte starts, with any padding at the end of the current one skipped
+	uint8_t const* getPos() { return pos - (numBits >> 3); }
+
+private:
+	// Leaves the bits MSB-aligned, and never more than 56 of them, so that a whole byte's worth can always be consumed
+	// with one shift
+	inline void refill() {
+		while (numBits <= 48 && pos < end) {
+			buffer |= (uint64_t)*pos++ << (56 - numBits);
+			numBits += 8;
+		}
+	}
+
+	uint8_t const* pos;
+	uint8_t const* end;
+	uint64_t buffer = 0;
+	int32_t numBits = 0;
+};
+
+// How many bits it takes to code samples' prediction errors with this order and Rice parameter - not counting the
+// warm-up samples or the padding
+uint64_t getRiceNumBits(int32_t const* samples, int32_t numSamples, int32_t order, int32_t riceParam) {
+	uint64_t numBits = (uint64_t)(numSamples - order) * (riceParam + 1);
+	for (int32_t n = order; n < numSamples; n++) {
+		uint32_t const* at = (uint32_t const*)&samples[n];
+		numBits += zigzag(*at - predict(at, order)) >> riceParam;
+	}
+	return numBits;
+}
+
+// Returns the cheapest Rice parameter, working out roughly where that'll be from the errors' average size and then
+// trying either side of that
+int32_t chooseRiceParam(int32_t const* samples, int32_t numSamples, int32_t order, uint64_t* numBits) {
+	uint64_t total = 0;
+	for (int32_t n = order; n < numSamples; n++) {
+		uint32_t const* at = (uint32_t const*)&samples[n];
+		total += zigzag(*at - predict(at, order));
+	}
+	uint64_t mean = total / (numSamples - order);
+	int32_t estimate = 0;
+	while (estimate < kMaxRiceParam && ((uint64_t)2 << estimate) <= mean) {
+		estimate++;
+	}
+
+	int32_t best = -1;
+	for (int32_t riceParam = estimate - 1; riceParam <= estimate + 1; riceParam++) {
+		if (riceParam < 0 || riceParam > kMaxRiceParam) {
+			continue;
+		}
+		uint64_t thisNumBits = getRiceNumBits(samples, numSamples, order, riceParam);
+		if (best == -1 || thisNumBits < *numBits) {
+			best = riceParam;
+			*numBits = thisNumBits;
+		}
+	}
+	return best;
+}
+
+template <int32_t order>
+bool decodeErrors(BitReader* reader, int32_t* samples, int32_t numSamples, int32_t riceParam) {
+	uint32_t* at = (uint32_t*)&samples[order];
+	uint32_t* end = (uint32_t*)&samples[numSamples];
+	for (; at < end; at++) {
+		uint32_t quotient;
+		uint32_t remainder;
+		if (!reader->readUnary(&quotient) || !reader->readBits(riceParam, &remainder)) {
+			return false;
+		}
+		*at = unzigzag((quotient << riceParam) | remainder) + predict<order>(at);
+	}
+	return true;
+}
+
+} // namespace
+
+int32_t encodeBlock(uint8_t const* pcm, int32_t numFrames, int32_t numChannels, int32_t byteDepth, uint8_t* output,
+                    int32_t* scratch) {
+	int32_t frameNumBytes = numChannels * byteDepth;
+	uint8_t* pos = output;
+
+	for (int32_t c = 0; c < numChannels; c++) {
+		for (int32_t n = 0; n < numFrames; n++) {
+			scratch[n] = readSample(&pcm[n * frameNumBytes + c * byteDepth], byteDepth);
+		}
+
+		uint8_t bestOrder = kVerbatim;
+		int32_t bestRiceParam = 0;
+		uint64_t bestNumBits = (uint64_t)numFrames * byteDepth * 8;
+		for (int32_t order = 0; order <= kMaxOrder && order < numFrames; order++) {
+			uint64_t numBits = 0;
+			int32_t riceParam = chooseRiceParam(scratch, numFrames, order, &numBits);
+			numBits += order * byteDepth * 8 + 7;
+			if (numBits < bestNumBits) {
+				bestOrder = order;
+				bestRiceParam = riceParam;
+				bestNumBits = numBits;
+			}
+		}
+
+		*pos++ = (bestOrder << 5) | bestRiceParam;
+
+		if (bestOrder == kVerbatim) {
+			for (int32_t n = 0; n < numFrames; n++) {
+				writeSample(pos, scratch[n], byteDepth);
+				pos += byteDepth;
+			}
+			continue;
+		}
+
+		for (int32_t n = 0; n < bestOrder; n++) {
+			writeSample(pos, scratch[n], byteDepth);
+			pos += byteDepth;
+		}
+
+		BitWriter writer(pos);
+		for (int32_t n = bestOrder; n < numFrames; n++) {
+			uint32_t const* at = (uint32_t const*)&scratch[n];
+			uint32_t zigzagged = zigzag(*at - predict(at, bestOrder));
+			writer.writeUnary(zigzagged >> bestRiceParam);
+			writer.write(zigzagged, bestRiceParam);
+		}
+		pos = writer.finish();
+	}
+
+	return pos - output;
+}
+
+bool decodeBlock(uint8_t const* input, int32_t numBytes, int32_t numFrames, int32_t numChannels, int32_t byteDepth,
+                 uint8_t* pcm, int32_t* scratch) {
+	int32_t frameNumBytes = numChannels * byteDepth;
+	uint8_t const* pos = input;
+	uint8_t const* end = input + numBytes;
+
+	for (int32_t c = 0; c < numChannels; c++) {
+		if (pos >= end) {
+			return false;
+		}
+		int32_t order = *pos >> 5;
+		int32_t riceParam = *pos & 31;
+		pos++;
+
+		uint8_t* output = &pcm[c * byteDepth];
+
+		if (order == kVerbatim) {
+			if (end - pos < numFrames * byteDepth) {
+				return false;
+			}
+			for (int32_t n = 0; n < numFrames; n++) {
+				output[0] = pos[0];
+				output[1] = pos[1];
+				if (byteDepth == 3) {
+					output[2] = pos[2];
+				}
+				output += frameNumBytes;
+				pos += byteDepth;
+			}
+			continue;
+		}
+
+		if (order > kMaxOrder || order >= numFrames || riceParam > kMaxRiceParam || end - pos < order * byteDepth) {
+			return false;
+		}
+
+		for (int32_t n = 0; n < order; n++) {
+			scratch[n] = readSample(pos, byteDepth);
+			pos += byteDepth;
+		}
+
+		BitReader reader(pos, end);
+		bool decoded;
+		switch (order) {
+		case 0:
+			decoded = decodeErrors<0>(&reader, scratch, numFrames, riceParam);
+			break;
+		case 1:
+			decoded = decodeErrors<1>(&reader, scratch, numFrames, riceParam);
+			break;
+		case 2:
+			decoded = decodeErrors<2>(&reader, scratch, numFrames, riceParam);
+			break;
+		default:
+			decoded = decodeErrors<3>(&reader, scratch, numFrames, riceParam);
+			break;
+		}
+		if (!decoded) {
+			return false;
+		}
+		pos = reader.getPos();
+
+		if (byteDepth == 2) {
+			for (int32_t n = 0; n < numFrames; n++) {
+				writeSample(output, scratch[n], 2);
+				output += frameNumBytes;
+			}
+		}
+		else {
+			for (int32_t n = 0; n < numFrames; n++) {
+				writeSample(output, scratch[n], 3);
+				output += frameNumBytes;
+			}
+		}
+	}
+
+	return pos == end;
+}
+
+} // namespace LosslessCodec
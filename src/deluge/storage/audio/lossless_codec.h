@@ -0,0 +1,53 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+// A lossless codec for Samples, made to be quick to decode in fixed point. Audio is split into blocks of up to
+// kMaxBlockNumFrames frames, each of which decodes on its own - so any part of a file can be got at by reading just the
+// blocks which hold it.
+//
+// Within a block, each channel comes in turn as a mode byte then its data. The mode's top 3 bits are either the order
+// (0 to 3) of the fixed polynomial predictor its samples were predicted with, as in FLAC, or kVerbatim if they're just
+// stored as they were. For a predicted channel, the first `order` samples follow as they were, then the rest's
+// prediction errors, zigzagged and Rice-coded with the parameter in the mode's bottom 5 bits, MSB first and padded out
+// to a whole byte.
+//
+// PCM going in and coming out is interleaved, little-endian, 16 or 24 bits - as in a WAV file's data chunk.
+namespace LosslessCodec {
+
+constexpr int32_t kMaxBlockNumFrames = 4096;
+constexpr int32_t kMaxNumChannels = 2;
+constexpr uint8_t kVerbatim = 7;
+
+// The most an encoded block can take up - which it only does if no channel would compress
+constexpr int32_t getMaxBlockNumBytes(int32_t numFrames, int32_t numChannels, int32_t byteDepth) {
+	return numChannels * (1 + numFrames * byteDepth);
+}
+
+// output needs room for getMaxBlockNumBytes(), and scratch for numFrames values. Returns how many bytes were written
+int32_t encodeBlock(uint8_t const* pcm, int32_t numFrames, int32_t numChannels, int32_t byteDepth, uint8_t* output,
+                    int32_t* scratch);
+
+// Fills pcm with numFrames frames. scratch needs room for numFrames values. Returns false if the block runs out before
+// all of them are decoded, or is otherwise not one encodeBlock() could have made
+bool decodeBlock(uint8_t const* input, int32_t numBytes, int32_t numFrames, int32_t numChannels, int32_t byteDepth,
+                 uint8_t* pcm, int32_t* scratch);
+
+} // namespace LosslessCodec
@@ -0,0 +1,171 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "storage/audio/raw_data_conversion.h"
+#include <cstring>
+
+#ifdef __arm__
+#pragma GCC push_options
+#pragma GCC target("fpu=neon")
+#include <arm_neon.h>
+#endif
+
+namespace RawDataConversion {
+
+namespace {
+
+// These are as convertFloatToIntAtMemoryLocation(), swapEndianness32() etc., but don't lean on ARM's way of
+// shifting by 32 or more giving 0, or its rev instructions, so also work the same on the host
+inline uint32_t floatToIntOne(uint32_t value) {
+	int32_t exponent = (int32_t)((value >> 23) & 255) - 127;
+	uint32_t magnitude;
+	if (exponent >= 0) {
+		magnitude = 2147483647;
+	}
+	else if (exponent <= -32) {
+		magnitude = 0;
+	}
+	else {
+		magnitude = ((value << 8) | 0x80000000) >> -exponent;
+	}
+	return (value >> 31) ? -magnitude : magnitude;
+}
+
+inline uint32_t swapEndianness32One(uint32_t value) {
+	return __builtin_bswap32(value);
+}
+
+inline uint32_t swapEndianness16One(uint32_t value) {
+	return ((value & 0x00FF00FF) << 8) | ((value >> 8) & 0x00FF00FF);
+}
+
+// Words are accessed with memcpy() since they needn't be aligned - which compiles down to plain loads and stores
+template <uint32_t (*convertOne)(uint32_t)>
+inline void convertWordsOneAtATime(int32_t* data, int32_t numWords) {
+	for (int32_t i = 0; i < numWords; i++) {
+		uint32_t value;
+		memcpy(&value, &data[i], sizeof(value));
+		value = convertOne(value);
+		memcpy(&data[i], &value, sizeof(value));
+	}
+}
+
+} // namespace
+
+#ifdef __arm__
+
+void floatToInt(int32_t* data, int32_t numWords) {
+	uint8_t* pos = (uint8_t*)data;
+	int32_t numLeft = numWords;
+	for (; numLeft >= 4; numLeft -= 4, pos += 16) {
+		uint32x4_t value = vreinterpretq_u32_u8(vld1q_u8(pos));
+
+		// A negative shift count shifts right, and by 32 or more gives 0
+		int32x4_t exponent =
+		    vsubq_s32(vreinterpretq_s32_u32(vandq_u32(vshrq_n_u32(value, 23), vdupq_n_u32(255))), vdupq_n_s32(127));
+		uint32x4_t magnitude = vshlq_u32(vorrq_u32(vshlq_n_u32(value, 8), vdupq_n_u32(0x80000000)), exponent);
+		magnitude = vbslq_u32(vcgeq_s32(exponent, vdupq_n_s32(0)), vdupq_n_u32(2147483647), magnitude);
+
+		int32x4_t result = vreinterpretq_s32_u32(magnitude);
+		result = vbslq_s32(vcltq_s32(vreinterpretq_s32_u32(value), vdupq_n_s32(0)), vnegq_s32(result), result);
+		vst1q_u8(pos, vreinterpretq_u8_s32(result));
+	}
+	convertWordsOneAtATime<floatToIntOne>((int32_t*)pos, numLeft);
+}
+
+void swapEndianness32(int32_t* data, int32_t numWords) {
+	uint8_t* pos = (uint8_t*)data;
+	int32_t numLeft = numWords;
+	for (; numLeft >= 4; numLeft -= 4, pos += 16) {
+		vst1q_u8(pos, vrev32q_u8(vld1q_u8(pos)));
+	}
+	convertWordsOneAtATime<swapEndianness32One>((int32_t*)pos, numLeft);
+}
+
+void swapEndianness16(int32_t* data, int32_t numWords) {
+	uint8_t* pos = (uint8_t*)data;
+	int32_t numLeft = numWords;
+	for (; numLeft >= 4; numLeft -= 4, pos += 16) {
+		vst1q_u8(pos, vrev16q_u8(vld1q_u8(pos)));
+	}
+	convertWordsOneAtATime<swapEndianness16One>((int32_t*)pos, numLeft);
+}
+
+void unsigned8ToSigned(int32_t* data, int32_t numWords) {
+	uint8_t* pos = (uint8_t*)data;
+	int32_t numLeft = numWords;
+	for (; numLeft >= 4; numLeft -= 4, pos += 16) {
+		vst1q_u8(pos, veorq_u8(vld1q_u8(pos), vdupq_n_u8(0x80)));
+	}
+	for (int32_t i = 0; i < numLeft * 4; i++) {
+		pos[i] ^= 0x80;
+	}
+}
+
+void swapEndianness24(uint8_t* data, int32_t numSamples) {
+	uint8_t* pos = data;
+	int32_t numLeft = numSamples;
+	for (; numLeft >= 16; numLeft -= 16, pos += 48) {
+		uint8x16x3_t bytes = vld3q_u8(pos);
+		uint8x16_t temp = bytes.val[0];
+		bytes.val[0] = bytes.val[2];
+		bytes.val[2] = temp;
+		vst3q_u8(pos, bytes);
+	}
+	for (; numLeft > 0; numLeft--, pos += 3) {
+		uint8_t temp = pos[0];
+		pos[0] = pos[2];
+		pos[2] = temp;
+	}
+}
+
+#else
+
+void floatToInt(int32_t* data, int32_t numWords) {
+	convertWordsOneAtATime<floatToIntOne>(data, numWords);
+}
+
+void swapEndianness32(int32_t* data, int32_t numWords) {
+	convertWordsOneAtATime<swapEndianness32One>(data, numWords);
+}
+
+void swapEndianness16(int32_t* data, int32_t numWords) {
+	convertWordsOneAtATime<swapEndianness16One>(data, numWords);
+}
+
+void unsigned8ToSigned(int32_t* data, int32_t numWords) {
+	uint8_t* pos = (uint8_t*)data;
+	for (int32_t i = 0; i < numWords * 4; i++) {
+		pos[i] ^= 0x80;
+	}
+}
+
+void swapEndianness24(uint8_t* data, int32_t numSamples) {
+	for (uint8_t* pos = data; numSamples > 0; numSamples--, pos += 3) {
+		uint8_t temp = pos[0];
+		pos[0] = pos[2];
+		pos[2] = temp;
+	}
+}
+
+#endif
+
+} // namespace RawDataConversion
+
+#ifdef __arm__
+#pragma GCC pop_options
+#endif
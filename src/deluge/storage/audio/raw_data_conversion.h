@@ -0,0 +1,44 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+// Converts runs of a Sample's raw data, as loaded into a Cluster, to what everything else expects to read (see
+// Sample::rawDataFormat) - the same as Sample::convertOneData() does to each word, but a whole run at a time. On the
+// Deluge these use NEON; elsewhere (i.e. in the unit tests) plain C++, which comes out identical.
+//
+// The word ones needn't be given aligned data
+namespace RawDataConversion {
+
+// RAW_DATA_FLOAT: 32-bit floats to full-scale ints, saturating, and rounding toward zero
+void floatToInt(int32_t* data, int32_t numWords);
+
+// RAW_DATA_ENDIANNESS_WRONG_32
+void swapEndianness32(int32_t* data, int32_t numWords);
+
+// RAW_DATA_ENDIANNESS_WRONG_16 - two samples per word
+void swapEndianness16(int32_t* data, int32_t numWords);
+
+// RAW_DATA_UNSIGNED_8 - four samples per word
+void unsigned8ToSigned(int32_t* data, int32_t numWords);
+
+// RAW_DATA_ENDIANNESS_WRONG_24 - 3 bytes per sample
+void swapEndianness24(uint8_t* data, int32_t numSamples);
+
+} // namespace RawDataConversion
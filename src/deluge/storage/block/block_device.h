@@ -0,0 +1,72 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "definitions_cxx.hpp"
+#include <cstdint>
+
+constexpr int32_t kBlockSizeBytes = 512;
+
+struct BlockReadRequest {
+	uint32_t sector;
+	uint32_t numSectors;
+	uint8_t* buffer;
+	void* context; // Whatever the caller wants back when the read finishes
+
+	// Set by the BlockDevice, in that order, when the read finishes - possibly from its DMA-complete interrupt
+	Error result;
+	volatile bool finished;
+};
+
+// Anything whole sectors can be read from - the SD card on the Deluge, or a fake one in the unit tests.
+//
+// Reads are started with startRead() and finish in their own time. The device fills in the request's result and then
+// sets its finished flag, which is all it may do from an interrupt - everything else is up to whoever's polling the
+// flag, which is normally ReadPipeline.
+class BlockDevice {
+public:
+	virtual ~BlockDevice() = default;
+
+	// How many reads may be started before the first of them has finished
+	virtual int32_t getMaxReadsInFlight() = 0;
+
+	// Returns false if the read couldn't even be started, in which case the request is left alone. Otherwise the
+	// request must stay put until it's finished - which it may have done before this returns
+	virtual bool startRead(BlockReadRequest* request) = 0;
+
+	// Lets the device get on with anything that can't be done from an interrupt, like starting the next of the reads
+	// it's been given. ReadPipeline calls this whenever it looks for finished reads
+	virtual void poll() {}
+
+	// For when there's nothing else to do until the data's here
+	Error readAndWait(uint32_t sector, uint32_t numSectors, uint8_t* buffer) {
+		BlockReadRequest request{sector, numSectors, buffer, nullptr, Error::NONE, false};
+		if (!startRead(&request)) {
+			return Error::SD_CARD;
+		}
+		while (!request.finished) {
+			poll();
+			whileWaiting();
+		}
+		return request.result;
+	}
+
+protected:
+	// What readAndWait() gets on with in the meantime
+	virtual void whileWaiting() {}
+};
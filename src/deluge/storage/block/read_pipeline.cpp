@@ -0,0 +1,76 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "storage/block/read_pipeline.h"
+#include <algorithm>
+
+bool ReadPipeline::hasRoom() {
+	return numInFlight < std::min(kMaxReadsInFlight, device.getMaxReadsInFlight());
+}
+
+bool ReadPipeline::isReading(void const* context) {
+	for (int32_t i = 0; i < kMaxReadsInFlight; i++) {
+		if (inUse[i] && requests[i].context == context) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool ReadPipeline::startRead(uint32_t sector, uint32_t numSectors, uint8_t* buffer, void* context) {
+	if (!hasRoom()) {
+		return false;
+	}
+
+	int32_t i = 0;
+	while (inUse[i]) {
+		i++;
+	}
+
+	BlockReadRequest* request = &requests[i];
+	request->sector = sector;
+	request->numSectors = numSectors;
+	request->buffer = buffer;
+	request->context = context;
+	request->result = Error::NONE;
+	request->finished = false;
+
+	// Claimed before the device gets it, since it might finish - or the caller might ask isReading() from somewhere
+	// the device calls out to - before startRead() returns
+	inUse[i] = true;
+	numInFlight++;
+
+	if (!device.startRead(request)) {
+		inUse[i] = false;
+		numInFlight--;
+		return false;
+	}
+	return true;
+}
+
+bool ReadPipeline::takeFinished(BlockReadRequest* finishedRead) {
+	device.poll();
+	for (int32_t i = 0; i < kMaxReadsInFlight; i++) {
+		if (inUse[i] && requests[i].finished) {
+			*finishedRead = requests[i];
+			inUse[i] = false;
+			numInFlight--;
+			return true;
+		}
+	}
+	return false;
+}
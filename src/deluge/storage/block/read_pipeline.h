@@ -0,0 +1,76 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "storage/block/block_device.h"
+#include <cstdint>
+
+// Keeps up to kMaxReadsInFlight reads going on a BlockDevice at once (or as many as the device allows, if fewer), so
+// that while the card's busy transferring one, the CPU can be dealing with the last one to finish.
+//
+// Call startRead() while there's room, and takeFinished() to collect them. Reads may finish in any order.
+class ReadPipeline {
+public:
+	constexpr static int32_t kMaxReadsInFlight = 4;
+
+	ReadPipeline(BlockDevice& newDevice) : device(newDevice) {}
+
+	bool hasRoom();
+	bool isIdle() { return !numInFlight; }
+	int32_t getNumInFlight() { return numInFlight; }
+
+	// Whether a read with this context has been started and not yet taken back by takeFinished()
+	bool isReading(void const* context);
+
+	// Returns false if there was no room, or the device wouldn't start it
+	bool startRead(uint32_t sector, uint32_t numSectors, uint8_t* buffer, void* context);
+
+	// Copies a finished read to *finishedRead and forgets about it. Returns false if none have finished
+	bool takeFinished(BlockReadRequest* finishedRead);
+
+private:
+	BlockDevice& device;
+	BlockReadRequest requests[kMaxReadsInFlight];
+	bool inUse[kMaxReadsInFlight]{};
+	int32_t numInFlight = 0;
+};
+
+struct CoalescedReadPlan {
+	int32_t numClusters;
+	uint32_t numSectors;
+};
+
+// Works out how many physically contiguous Clusters - up to maxNumClusters, the first already being ready to go with
+// firstNumSectors - can be read with one command. Only the last may be short, so it stops after one that is.
+// addNext(i) tries to get the i'th Cluster ready, returning its number of sectors - or 0 if it can't be had, in which
+// case it's not part of the read
+template <typename AddNext>
+CoalescedReadPlan planCoalescedRead(uint32_t firstNumSectors, uint32_t sectorsPerCluster, int32_t maxNumClusters,
+                                    AddNext addNext) {
+	CoalescedReadPlan plan{1, firstNumSectors};
+	uint32_t lastNumSectors = firstNumSectors;
+	while (plan.numClusters < maxNumClusters && lastNumSectors == sectorsPerCluster) {
+		lastNumSectors = addNext(plan.numClusters);
+		if (!lastNumSectors) {
+			break;
+		}
+		plan.numClusters++;
+		plan.numSectors += lastNumSectors;
+	}
+	return plan;
+}
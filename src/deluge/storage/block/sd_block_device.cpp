@@ -0,0 +1,192 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "storage/block/sd_block_device.h"
+#include "RZA1/cpu_specific.h"
+
+extern "C" {
+#include "RZA1/ostm/ostm.h"
+#include "RZA1/intc/devdrv_intc.h"
+#include "RZA1/sdhi/inc/sdif.h"
+#include "fatfs/diskio.h"
+
+DRESULT disk_read_without_streaming_first(BYTE pdrv, BYTE* buff, DWORD sector, UINT count);
+extern uint8_t currentlyAccessingCard;
+void routineForSD(void);
+}
+
+SDBlockDevice sdBlockDevice{};
+
+namespace {
+
+// As long as sddev_wait_dma_end() gives a transfer - beyond which the card's presumably been pulled out
+constexpr uint32_t kTransferTimeout = DELUGE_CLOCKS_PER * 2;
+
+int sdInterrupt(int sdPort, int) {
+	if (sdPort == SD_PORT) {
+		sdBlockDevice.transferMayHaveEnded();
+	}
+	return 0;
+}
+
+// Keeps transferMayHaveEnded() from coming in while the transfer's being given up on
+void lockOutSDInterrupt() {
+	R_INTC_Disable(INTC_ID_SDHI1_0);
+	R_INTC_Disable(INTC_ID_SDHI1_1);
+	R_INTC_Disable(INTC_ID_SDHI1_3);
+}
+
+void unlockSDInterrupt() {
+	R_INTC_Enable(INTC_ID_SDHI1_0);
+	R_INTC_Enable(INTC_ID_SDHI1_1);
+	R_INTC_Enable(INTC_ID_SDHI1_3);
+}
+
+Error toError(int sdResult) {
+	return (sdResult == SD_OK) ? Error::NONE : Error::SD_CARD;
+}
+
+} // namespace
+
+bool SDBlockDevice::startRead(BlockReadRequest* request) {
+	if (numQueued >= kMaxNumQueued) {
+		return false;
+	}
+	queue[numQueued++] = request;
+	poll();
+	return true;
+}
+
+void SDBlockDevice::poll() {
+	giveUpIfTimedOut();
+
+	// Not while FatFS is in the middle of something - it'll call back here through routineForSD()
+	while (!transferring && numQueued && !currentlyAccessingCard) {
+		startNext();
+	}
+}
+
+void SDBlockDevice::startNext() {
+	BlockReadRequest* request = queue[0];
+	numQueued--;
+	for (int32_t i = 0; i < numQueued; i++) {
+		queue[i] = queue[i + 1];
+	}
+
+	// The card might have been re-initialized since last time, which forgets the callback
+	sd_set_intcallback(SD_PORT, sdInterrupt);
+
+	// Set first, since the interrupt can come any time after the read starts
+	timeTransferStarted = getTimerValue(0);
+	transferring = request;
+
+	currentlyAccessingCard = 1; // While the commands are sent, which waits on routineForSD()
+	int result = sd_read_sect_start(SD_PORT, request->buffer, request->sector, request->numSectors);
+	currentlyAccessingCard = 0;
+
+	if (result == SD_OK) {
+		return;
+	}
+
+	transferring = nullptr;
+	if (result == SD_ERR_ILL_FUNC) {
+		result = disk_read_without_streaming_first(SD_PORT, request->buffer, request->sector, request->numSectors);
+		request->result = (result == RES_OK) ? Error::NONE : Error::SD_CARD;
+	}
+	else {
+		request->result = toError(result);
+	}
+	request->finished = true;
+}
+
+void SDBlockDevice::allowWriteBehindFrom(uint8_t const* buffer, uint32_t size) {
+	writeBehindBuffer = buffer;
+	writeBehindSize = buffer ? size : 0;
+}
+
+bool SDBlockDevice::startWriteBehind(uint8_t const* buffer, uint32_t sector, uint32_t numSectors) {
+	if (!writeBehindBuffer || buffer < writeBehindBuffer
+	    || buffer + numSectors * kBlockSizeBytes > writeBehindBuffer + writeBehindSize) {
+		return false;
+	}
+
+	waitTilIdle();
+	sd_set_intcallback(SD_PORT, sdInterrupt);
+
+	writeBehind = {sector, numSectors, (uint8_t*)buffer, nullptr, Error::NONE, false};
+	timeTransferStarted = getTimerValue(0);
+	transferring = &writeBehind;
+
+	currentlyAccessingCard = 1;
+	int result = sd_write_sect_start(SD_PORT, buffer, sector, numSectors, SD_WRITE_OVERWRITE);
+	currentlyAccessingCard = 0;
+
+	if (result == SD_OK) {
+		return true;
+	}
+
+	// Including if it failed to start - doing it the usual way is as good a retry as any
+	transferring = nullptr;
+	return false;
+}
+
+bool SDBlockDevice::takeWriteBehindFailure() {
+	bool failed = writeBehindFailed;
+	writeBehindFailed = false;
+	return failed;
+}
+
+void SDBlockDevice::finishTransfer(BlockReadRequest* request, int sdResult) {
+	request->result = toError(sdResult);
+	if (request == &writeBehind && request->result != Error::NONE) {
+		writeBehindFailed = true; // No one's waiting on it, so it's left for takeWriteBehindFailure()
+	}
+	transferring = nullptr;
+	request->finished = true;
+}
+
+void SDBlockDevice::transferMayHaveEnded() {
+	BlockReadRequest* request = transferring;
+	if (!request || !sd_sect_trns_ended(SD_PORT)) {
+		return; // The interrupt was for a command
+	}
+	finishTransfer(request, sd_sect_trns_end(SD_PORT));
+}
+
+void SDBlockDevice::giveUpIfTimedOut() {
+	if (!transferring || getTimerValue(0) - timeTransferStarted < kTransferTimeout) {
+		return;
+	}
+
+	lockOutSDInterrupt();
+	BlockReadRequest* request = transferring;
+	if (request) {
+		finishTransfer(request, sd_sect_trns_end(SD_PORT)); // Which, with no interrupt having come, is an error
+	}
+	unlockSDInterrupt();
+}
+
+void SDBlockDevice::waitTilIdle() {
+	while (transferring) {
+		giveUpIfTimedOut();
+		routineForSD();
+	}
+}
+
+void SDBlockDevice::whileWaiting() {
+	routineForSD();
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "storage/block/block_device.h"
+
+// The SD card. The SDHI controller only takes one command at a time, so reads queue up here. Each is started with
+// sd_read_sect_start(), which returns once the card's been told to send the data, and the DMAC then moves it while the
+// CPU gets on with other things. The SDHI's interrupt marks the read finished, but starting the next one means issuing
+// commands, which wait on that same interrupt - so that's left to poll().
+//
+// Reads the driver can't leave running like that - a couple of sectors, or into a buffer which isn't word-aligned - are
+// done by disk_read_without_streaming_first() instead, once they get to the front.
+//
+// FatFS doesn't go through here, so disk_read() and disk_write() wait, with waitTilIdle(), for any transfer which is
+// running to finish first. But disk_write() can leave one running itself - see startWriteBehind().
+class SDBlockDevice final : public BlockDevice {
+public:
+	constexpr static int32_t kMaxNumQueued = 4;
+
+	int32_t getMaxReadsInFlight() override { return kMaxNumQueued; }
+	bool startRead(BlockReadRequest* request) override;
+	void poll() override;
+
+	bool isTransferring() { return transferring != nullptr; }
+	void waitTilIdle();
+
+	// Lets disk_write() return as soon as writes from within this buffer have started, rather than once they're
+	// done. Whoever allows it mustn't touch the buffer again til the next transfer's started - which can't be til the
+	// write's over. Pass nullptr once FatFS is done with the buffer
+	void allowWriteBehindFrom(uint8_t const* buffer, uint32_t size);
+
+	// For disk_write(). Returns false if it's not a write that can be left running, in which case it's not started
+	bool startWriteBehind(uint8_t const* buffer, uint32_t sector, uint32_t numSectors);
+
+	// Whether any write left running has failed since this was last asked
+	bool takeWriteBehindFailure();
+
+	// For the SDHI interrupt
+	void transferMayHaveEnded();
+
+protected:
+	void whileWaiting() override;
+
+private:
+	void startNext();
+	void finishTransfer(BlockReadRequest* request, int sdResult);
+	void giveUpIfTimedOut();
+
+	BlockReadRequest* queue[kMaxNumQueued];
+	int32_t numQueued = 0;
+
+	BlockReadRequest* volatile transferring = nullptr;
+	uint32_t timeTransferStarted;
+
+	uint8_t const* writeBehindBuffer = nullptr;
+	uint32_t writeBehindSize = 0;
+	BlockReadRequest writeBehind; // Not a read, but finished the same way
+	volatile bool writeBehindFailed = false;
+};
+
+extern SDBlockDevice sdBlockDevice;
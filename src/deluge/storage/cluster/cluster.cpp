@@ -21,7 +21,9 @@
 #include "model/sample/sample_cache.h"
 #include "processing/engines/audio_engine.h"
 #include "storage/audio/audio_file_manager.h"
+#include "storage/audio/raw_data_conversion.h"
 #include "util/misc.h"
+#include <algorithm>
 #include <string.h>
 
 Cluster::Cluster() {
@@ -31,8 +33,12 @@ Cluster::Cluster() {
 	extraBytesAtStartConverted = false;
 	extraBytesAtEndConverted = false;
 	loaded = false;
+	numAttackHeadClaims = 0;
 	numReasonsHeldBySampleRecorder = 0;
 	numReasonsToBeLoaded = 0;
+	loadingQueueKey = 0;
+	loadingQueueIndex = -1;
+	timeReadStarted = 0;
 	// type is not set here, set it yourself (can't remember exact reason...)
 }
 
@@ -80,20 +86,17 @@ void Cluster::convertDataIfNecessary() {
 				endPos = &data[audioFileManager.clusterSize - 2];
 			}
 
-			while (true) {
-				char const* endPosNow = pos + 1024; // Every this many bytes, we'll pause and do an audio routine
-				if (endPosNow > endPos) {
-					endPosNow = endPos;
-				}
+			// Every this many samples (about 1kB), we'll pause and do an audio routine
+			constexpr int32_t kNumSamplesPerChunk = 342;
+			int32_t numSamplesLeft = (endPos - pos + 2) / 3;
 
-				while (pos < endPosNow) {
-					uint8_t temp = pos[0];
-					pos[0] = pos[2];
-					pos[2] = temp;
-					pos += 3;
-				}
+			while (true) {
+				int32_t numSamplesNow = std::min(numSamplesLeft, kNumSamplesPerChunk);
+				RawDataConversion::swapEndianness24((uint8_t*)pos, numSamplesNow);
+				pos += numSamplesNow * 3;
+				numSamplesLeft -= numSamplesNow;
 
-				if (pos >= endPos) {
+				if (numSamplesLeft <= 0) {
 					break;
 				}
 
@@ -123,25 +126,39 @@ void Cluster::convertDataIfNecessary() {
 				endPos = (int32_t*)&data[audioFileManager.clusterSize - 3];
 			}
 
-			// uint16_t startTime = MTU2.TCNT_0;
+			// Every this many words (1kB), we'll pause and do an audio routine
+			constexpr int32_t kNumWordsPerChunk = 256;
+			int32_t numWordsLeft = ((char*)endPos - (char*)pos + 3) >> 2;
 
-			for (; pos < endPos; pos++) {
+			while (numWordsLeft > 0) {
+				int32_t numWordsNow = std::min(numWordsLeft, kNumWordsPerChunk);
 
-				if (!((uint32_t)pos & 0b1111111100)) {
-					AudioEngine::logAction("from convert-data");
-					AudioEngine::routine(); // ----------------------------------------------------
-				}
+				switch (sample->rawDataFormat) {
+				case RAW_DATA_FLOAT:
+					RawDataConversion::floatToInt(pos, numWordsNow);
+					break;
 
-				sample->convertOneData(pos);
-			}
+				case RAW_DATA_ENDIANNESS_WRONG_32:
+					RawDataConversion::swapEndianness32(pos, numWordsNow);
+					break;
 
-			/*
-			uint16_t endTime = MTU2.TCNT_0;
+				case RAW_DATA_ENDIANNESS_WRONG_16:
+					RawDataConversion::swapEndianness16(pos, numWordsNow);
+					break;
+
+				case RAW_DATA_UNSIGNED_8:
+					RawDataConversion::unsigned8ToSigned(pos, numWordsNow);
+					break;
+				}
+
+				pos += numWordsNow;
+				numWordsLeft -= numWordsNow;
 
-			if (clusterIndex != startCluster) {
-			    D_PRINTLN("time to convert:  %d", (uint16_t)(endTime - startTime));
+				if (numWordsLeft > 0) {
+					AudioEngine::logAction("from convert-data");
+					AudioEngine::routine(); // ----------------------------------------------------
+				}
 			}
-			*/
 		}
 	}
 }
@@ -184,6 +201,12 @@ void Cluster::steal(char const* errorCode) {
 			FREEZE_WITH_ERROR("E181");
 		}
 		sample->clusters.getElement(clusterIndex)->cluster = NULL;
+
+		// A SampleHolder's claim should have stopped it being stolen, but don't leave the budget counting it if not
+		if (numAttackHeadClaims) {
+			audioFileManager.attackHeadNumClusters--;
+			numAttackHeadClaims = 0;
+		}
 		break;
 
 	case ClusterType::SAMPLE_CACHE:
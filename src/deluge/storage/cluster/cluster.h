@@ -45,6 +45,12 @@ public:
 	SampleCache* sampleCache;
 	char firstThreeBytesPreDataConversion[3];
 	bool loaded;
+	uint16_t numAttackHeadClaims; // How many SampleHolders hold it as an attack head - see attackHeadNumClusters
+
+	// For AudioFileManager::loadingQueue - see ClusterPriorityQueue
+	uint64_t loadingQueueKey;
+	int32_t loadingQueueIndex;
+	uint32_t timeReadStarted; // In audio samples, for AudioFileManager::clusterLoadLatency
 
 	char dummy[CACHE_LINE_SIZE];
 
@@ -17,21 +17,101 @@
 
 #pragma once
 
-#include "util/container/array/ordered_resizeable_array.h"
+#include "definitions_cxx.hpp"
+#include "storage/cluster/cluster.h"
+#include "util/container/heap/intrusive_heap.h"
+#include "util/containers.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
 
-class Cluster;
+/// Clusters waiting to be loaded, most urgent - lowest priorityRating - first, and first come first served among
+/// equals.
+///
+/// A min-heap, with each Cluster remembering where it is in it (its loadingQueueIndex, -1 when not queued), so adding,
+/// removing and re-prioritising a Cluster are all O(log n). A template only so the unit tests can use it with something
+/// lighter than a real Cluster, and without the GeneralMemoryAllocator.
+///
+/// Holds no more than it's been reserve()d room for, so adding never allocates.
+template <typename C, typename Container = std::vector<C*>>
+class BasicClusterPriorityQueue {
+public:
+	constexpr static uint32_t kLowestPriority = 0xFFFFFFFF;
 
-struct PriorityQueueElement {
-	uint32_t priorityRating;
-	Cluster* cluster;
-};
+	void reserve(int32_t capacity) { heap_.reserve(capacity); }
 
-class ClusterPriorityQueue final : public OrderedResizeableArrayWith32bitKey {
-public:
-	ClusterPriorityQueue();
+	/// A Cluster which is already queued just gets prioritize()d. Otherwise, fails if the queue's full
+	Error add(C* cluster, uint32_t priorityRating) {
+		if (prioritize(cluster, priorityRating)) {
+			return Error::NONE;
+		}
+		if (heap_.size() >= heap_.capacity()) {
+			return Error::INSUFFICIENT_RAM;
+		}
+		cluster->loadingQueueKey = makeKey(priorityRating);
+		heap_.push(cluster);
+		if (priorityRating == kLowestPriority) {
+			numLowestPriority_++;
+		}
+		return Error::NONE;
+	}
+
+	C* peekHead() { return heap_.top(); }
+
+	C* grabHead() {
+		C* cluster = heap_.top();
+		if (cluster) {
+			removeIfPresent(cluster);
+		}
+		return cluster;
+	}
+
+	/// Returns whether it was present
+	bool removeIfPresent(C* cluster) {
+		if (!Heap::contains(cluster)) {
+			return false;
+		}
+		if (getPriorityRating(cluster) == kLowestPriority) {
+			numLowestPriority_--;
+		}
+		heap_.remove(cluster);
+		return true;
+	}
 
-	Error add(Cluster* cluster, uint32_t priorityRating);
-	Cluster* grabHead();
-	bool removeIfPresent(Cluster* cluster);
-	bool checkPresent(Cluster* cluster);
+	bool checkPresent(C* cluster) const { return Heap::contains(cluster); }
+
+	/// If the Cluster's queued, and priorityRating is more urgent than it was queued with, moves it up the queue.
+	/// Returns whether it was queued
+	bool prioritize(C* cluster, uint32_t priorityRating) {
+		if (!Heap::contains(cluster)) {
+			return false;
+		}
+		uint32_t oldPriorityRating = getPriorityRating(cluster);
+		if (priorityRating < oldPriorityRating) {
+			if (oldPriorityRating == kLowestPriority) {
+				numLowestPriority_--;
+			}
+			cluster->loadingQueueKey = makeKey(priorityRating);
+			heap_.update(cluster);
+		}
+		return true;
+	}
+
+	[[nodiscard]] int32_t getNumElements() const { return heap_.size(); }
+	[[nodiscard]] bool hasAnyLowestPriorityElements() const { return numLowestPriority_ != 0; }
+	[[nodiscard]] static uint32_t getPriorityRating(C* cluster) { return cluster->loadingQueueKey >> 32; }
+
+private:
+	using Heap =
+	    IntrusiveHeap<C, uint64_t, &C::loadingQueueKey, &C::loadingQueueIndex, std::less<uint64_t>, Container>;
+
+	// The bottom half is a count of Clusters added, so equal priorityRatings come out in the order they went in. That
+	// only goes wrong for a moment every four billion Clusters
+	uint64_t makeKey(uint32_t priorityRating) { return ((uint64_t)priorityRating << 32) | nextSequenceNumber_++; }
+
+	Heap heap_;
+	uint32_t nextSequenceNumber_ = 0;
+	int32_t numLowestPriority_ = 0;
 };
+
+using ClusterPriorityQueue = BasicClusterPriorityQueue<Cluster, deluge::vector<Cluster*>>;
@@ -0,0 +1,341 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "storage/snapshot_deserializer.h"
+#include "memory/general_memory_allocator.h"
+#include "processing/engines/audio_engine.h"
+#include "storage/xml_scanner.h"
+#include "util/d_string.h"
+#include <algorithm>
+#include <cstring>
+
+using XMLSnapshot::Token;
+using XMLSnapshot::TokenType;
+
+SnapshotDeserializer smSnapshotDeserializer;
+
+namespace {
+
+bool isValue(TokenType type) {
+	return (type == TokenType::VALUE || type == TokenType::HEX_VALUE);
+}
+
+} // namespace
+
+Error SnapshotDeserializer::open(uint8_t* newSnapshot, int32_t size, char const* firstTagName,
+                                 char const* altTagName, bool ignoreIncorrectFirmware) {
+	close();
+	snapshot = newSnapshot;
+	pos = snapshot;
+	end = snapshot + size;
+
+	tagDepthCaller = 0;
+	tagDepthFile = 0;
+	lastTokenWasAttribute = false;
+	valueLength = 0;
+	valueCharPos = 0;
+	readCount = 0;
+
+	return readUpToFirstTag(firstTagName, altTagName, ignoreIncorrectFirmware);
+}
+
+void SnapshotDeserializer::close() {
+	if (snapshot) {
+		delugeDealloc(snapshot);
+		snapshot = nullptr;
+	}
+}
+
+// Returns where the token after it starts - or nullptr if there are no more. A broken snapshot just ends early, like a
+// truncated XML file would
+uint8_t const* SnapshotDeserializer::peekToken(Token* token) {
+	if (pos >= end) {
+		return nullptr;
+	}
+	uint8_t const* nextPos = XMLSnapshot::readToken(pos, end, token);
+	if (!nextPos) {
+		pos = end;
+	}
+	return nextPos;
+}
+
+// Tag depth changes just as it would in XMLDeserializer: up for each tag or attribute name, down at the end of each tag
+// and once an attribute's value has been got to
+void SnapshotDeserializer::skipToken(Token const& token, uint8_t const* nextPos) {
+	switch (token.type) {
+	case TokenType::TAG:
+	case TokenType::ATTRIBUTE:
+		tagDepthFile++;
+		break;
+
+	case TokenType::VALUE:
+	case TokenType::HEX_VALUE:
+		if (lastTokenWasAttribute) {
+			tagDepthFile--;
+		}
+		break;
+
+	case TokenType::END:
+		tagDepthFile--;
+		break;
+	}
+
+	lastTokenWasAttribute = (token.type == TokenType::ATTRIBUTE);
+	pos = nextPos;
+	readDone();
+}
+
+// If a value's next, moves past it and makes it the one to read chars from
+bool SnapshotDeserializer::takeValue(Token* token) {
+	uint8_t const* nextPos = peekToken(token);
+	if (!nextPos || !isValue(token->type)) {
+		valueLength = 0;
+		valueCharPos = 0;
+		return false;
+	}
+	skipToken(*token, nextPos);
+
+	valueData = token->data;
+	valueIsHex = (token->type == TokenType::HEX_VALUE);
+	valueLength = valueIsHex ? (token->length * 2 + 2) : token->length;
+	valueCharPos = 0;
+	return true;
+}
+
+char SnapshotDeserializer::getValueChar(int32_t charPos) {
+	if (!valueIsHex) {
+		return valueData[charPos];
+	}
+	if (charPos < 2) {
+		return "0x"[charPos];
+	}
+	uint8_t byte = valueData[(charPos - 2) >> 1];
+	return halfByteToHexChar((charPos & 1) ? (byte & 15) : (byte >> 4));
+}
+
+// numChars must be no more than are left, and less than kFilenameBufferSize
+char const* SnapshotDeserializer::getValueChars(int32_t numChars) {
+	char const* chars;
+	if (!valueIsHex) {
+		chars = (char const*)&valueData[valueCharPos];
+	}
+	else {
+		for (int32_t i = 0; i < numChars; i++) {
+			stringBuffer[i] = getValueChar(valueCharPos + i);
+		}
+		chars = stringBuffer;
+	}
+	valueCharPos += numChars;
+	return chars;
+}
+
+// Tokens come much quicker than XMLDeserializer's reads, so the time needn't be checked as often
+void SnapshotDeserializer::readDone() {
+	readCount++;
+	if (!(readCount & 31) && AudioEngine::yieldIsDue()) {
+		doRoutinesWhileReading();
+	}
+}
+
+char const* SnapshotDeserializer::readNextTagOrAttributeName() {
+	Token token;
+	uint8_t const* nextPos;
+
+	// Skip any value the caller didn't want
+	while ((nextPos = peekToken(&token)) && isValue(token.type)) {
+		skipToken(token, nextPos);
+	}
+	if (!nextPos) {
+		return "";
+	}
+
+	skipToken(token, nextPos);
+	if (token.type == TokenType::END) {
+		return "";
+	}
+
+	tagDepthCaller++;
+	AudioEngine::logAction((char const*)token.data);
+	return (char const*)token.data;
+}
+
+// Tags are exited by depth alone, so which one's named doesn't matter - as with XMLDeserializer
+void SnapshotDeserializer::exitTag(char const*) {
+	Token token;
+	uint8_t const* nextPos;
+	while (tagDepthFile >= tagDepthCaller && (nextPos = peekToken(&token))) {
+		skipToken(token, nextPos);
+	}
+	// As with XMLDeserializer
+	tagDepthCaller = tagDepthFile;
+}
+
+char const* SnapshotDeserializer::readTagOrAttributeValue() {
+	Token token;
+	if (!takeValue(&token)) {
+		return "";
+	}
+	if (!valueIsHex) {
+		return (char const*)valueData;
+	}
+
+	// As much of a long hex value as fits - as XMLDeserializer gives when one spans Clusters
+	int32_t numChars = std::min<int32_t>(valueLength, kFilenameBufferSize - 1);
+	getValueChars(numChars);
+	stringBuffer[numChars] = 0;
+	return stringBuffer;
+}
+
+// Just like XMLDeserializer::readIntUntilChar()
+int32_t SnapshotDeserializer::readTagOrAttributeValueInt() {
+	char const* chars = readTagOrAttributeValue();
+
+	bool isNegative = (*chars == '-');
+	if (isNegative) {
+		chars++;
+	}
+
+	uint32_t number = 0;
+	for (; *chars >= '0' && *chars <= '9'; chars++) {
+		number *= 10;
+		number += (*chars - '0');
+	}
+
+	if (isNegative) {
+		if (number >= 2147483648) {
+			return -2147483648;
+		}
+		return -(int32_t)number;
+	}
+	return number;
+}
+
+int32_t SnapshotDeserializer::readTagOrAttributeValueHex(int32_t errorValue) {
+	char const* string = readTagOrAttributeValue();
+	if (string[0] != '0' || string[1] != 'x') {
+		return errorValue;
+	}
+	return hexToInt(&string[2]);
+}
+
+int SnapshotDeserializer::readTagOrAttributeValueHexBytes(uint8_t* bytes, int32_t maxLen) {
+	Token token;
+	takeValue(&token);
+	return readHexBytesUntil(bytes, maxLen, 0);
+}
+
+// Reads the rest of the value being read one char at a time, stopping at anything that's not hex - like
+// XMLDeserializer's does. A snapshot's values already know their own length, so there's no end char to look for
+int SnapshotDeserializer::readHexBytesUntil(uint8_t* bytes, int32_t maxLen, char) {
+	int read;
+	for (read = 0; read < maxLen && valueLength - valueCharPos >= 2; read++) {
+		int highNibble, lowNibble;
+		if (!getNibble(getValueChar(valueCharPos), &highNibble)
+		    || !getNibble(getValueChar(valueCharPos + 1), &lowNibble)) {
+			break;
+		}
+		bytes[read] = (highNibble << 4) + lowNibble;
+		valueCharPos += 2;
+	}
+	valueCharPos = valueLength;
+	return read;
+}
+
+// Returns memory error
+Error SnapshotDeserializer::readTagOrAttributeValueString(String* string) {
+	Token token;
+	uint8_t const* nextPos = peekToken(&token);
+	if (nextPos && token.type == TokenType::ATTRIBUTE) {
+		return Error::FILE_CORRUPTED; // The tag has attributes rather than a value. As XMLDeserializer
+	}
+
+	if (!takeValue(&token)) {
+		string->clear();
+		return Error::NONE;
+	}
+	if (!valueIsHex) {
+		return string->set((char const*)valueData, valueLength);
+	}
+
+	string->clear();
+	for (int32_t stringPos = 0; valueCharPos < valueLength;) {
+		int32_t numChars = std::min<int32_t>(valueLength - valueCharPos, kFilenameBufferSize - 1);
+		Error error = string->concatenateAtPos(getValueChars(numChars), stringPos, numChars);
+		if (error != Error::NONE) {
+			return error;
+		}
+		stringPos += numChars;
+	}
+	return Error::NONE;
+}
+
+// Always all good to go. If there's no value, it just has no chars
+bool SnapshotDeserializer::prepareToReadTagOrAttributeValueOneCharAtATime() {
+	Token token;
+	takeValue(&token);
+	return true;
+}
+
+char SnapshotDeserializer::readNextCharOfTagOrAttributeValue() {
+	if (valueCharPos >= valueLength) {
+		return 0;
+	}
+	return getValueChar(valueCharPos++);
+}
+
+int32_t SnapshotDeserializer::getNumCharsRemainingInValue() {
+	return valueLength - valueCharPos;
+}
+
+char const* SnapshotDeserializer::readNextCharsOfTagOrAttributeValue(int32_t numChars) {
+	if (valueLength - valueCharPos < numChars) {
+		valueCharPos = valueLength;
+		return NULL;
+	}
+	readDone();
+	return getValueChars(numChars);
+}
+
+int32_t SnapshotDeserializer::readNextHexBytesOfTagOrAttributeValue(uint8_t* bytes, int32_t maxNumBytes) {
+	int32_t numBytes = 0;
+
+	// Already bytes - as long as we're at the start of one, which we will be after the "0x" and whole numbers
+	if (valueIsHex && valueCharPos >= 2 && !(valueCharPos & 1)) {
+		numBytes = std::min((valueLength - valueCharPos) >> 1, maxNumBytes);
+		memcpy(bytes, &valueData[(valueCharPos - 2) >> 1], numBytes);
+		valueCharPos += numBytes * 2;
+	}
+
+	// Or hex chars, which XMLDeserializer would decode just the same
+	else if (!valueIsHex) {
+		numBytes = std::min((valueLength - valueCharPos) >> 1, maxNumBytes);
+		XMLScanner::decodeHex((char const*)&valueData[valueCharPos], bytes, numBytes);
+		valueCharPos += numBytes * 2;
+	}
+
+	// Or, awkwardly, a hex value we've already taken some odd number of chars of
+	else {
+		for (; numBytes < maxNumBytes && valueLength - valueCharPos >= 2; numBytes++) {
+			char hexChars[2] = {getValueChar(valueCharPos), getValueChar(valueCharPos + 1)};
+			bytes[numBytes] = hexToIntFixedLength(hexChars, 2);
+			valueCharPos += 2;
+		}
+	}
+
+	readDone();
+	return numBytes;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "storage/storage_manager.h"
+#include "storage/xml_snapshot.h"
+#include <cstdint>
+
+// Reads a song or preset from a snapshot (see XMLSnapshot) held in memory, giving callers the same tags, attributes and
+// values XMLDeserializer would have from the XML file - just without the parsing. Tag depth is kept track of the same
+// way too, so that exitTag() leaves things exactly where XMLDeserializer's would.
+//
+// Long hex values come as the bytes they stand for, so readNextHexBytesOfTagOrAttributeValue() just copies them. Asked
+// for them as chars, it turns them back into hex.
+class SnapshotDeserializer : public Deserializer {
+public:
+	bool prepareToReadTagOrAttributeValueOneCharAtATime() override;
+	char const* readNextTagOrAttributeName() override;
+	char readNextCharOfTagOrAttributeValue() override;
+	int32_t getNumCharsRemainingInValue() override;
+
+	int32_t readTagOrAttributeValueInt() override;
+	int32_t readTagOrAttributeValueHex(int32_t errorValue) override;
+	int readTagOrAttributeValueHexBytes(uint8_t* bytes, int32_t maxLen) override;
+
+	int readHexBytesUntil(uint8_t* bytes, int32_t maxLen, char endPos) override;
+	char const* readNextCharsOfTagOrAttributeValue(int32_t numChars) override;
+	Error readTagOrAttributeValueString(String* string) override;
+	char const* readTagOrAttributeValue() override;
+	void exitTag(char const* exitTagName = NULL) override;
+	int32_t readNextHexBytesOfTagOrAttributeValue(uint8_t* bytes, int32_t maxNumBytes) override;
+
+	// Takes the snapshot, which must have come from allocLowSpeed(), and reads into its first tag like openXMLFile()
+	Error open(uint8_t* newSnapshot, int32_t size, char const* firstTagName, char const* altTagName,
+	           bool ignoreIncorrectFirmware = false);
+
+	// Frees the snapshot, if there is one
+	void close();
+
+private:
+	uint8_t const* peekToken(XMLSnapshot::Token* token);
+	void skipToken(XMLSnapshot::Token const& token, uint8_t const* nextPos);
+	bool takeValue(XMLSnapshot::Token* token);
+	char getValueChar(int32_t charPos);
+	char const* getValueChars(int32_t numChars);
+	void readDone();
+
+	uint8_t* snapshot = nullptr;
+	uint8_t const* pos;
+	uint8_t const* end;
+
+	int32_t tagDepthCaller; // As with XMLDeserializer
+	int32_t tagDepthFile;
+	bool lastTokenWasAttribute; // In which case the value that follows ends it
+
+	// The value being read one char at a time, if any. A hex one's length is in chars, including its "0x"
+	uint8_t const* valueData;
+	int32_t valueLength = 0;
+	int32_t valueCharPos = 0;
+	bool valueIsHex;
+
+	int32_t readCount;
+
+	char stringBuffer[kFilenameBufferSize];
+};
+
+extern SnapshotDeserializer smSnapshotDeserializer;
@@ -0,0 +1,236 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "storage/snapshot_file.h"
+#include "io/debug/log.h"
+#include "memory/general_memory_allocator.h"
+#include "model/settings/runtime_feature_settings.h"
+#include "processing/engines/audio_engine.h"
+#include "storage/audio/audio_file_manager.h"
+#include "storage/storage_manager.h"
+#include "storage/xml_snapshot.h"
+#include "util/d_string.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace SnapshotFile {
+
+namespace {
+
+constexpr char const* kFileExtension = ".SNP";
+constexpr uint32_t kFileVersion = 1;
+
+FIL file;
+
+// At the start of the file on the card. If any of this but snapshotSize and snapshotHash doesn't match the XML file,
+// the snapshot is out of date
+struct FileHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t xmlSize;
+	uint32_t xmlStartCluster;
+	uint32_t xmlModifiedTime; // FAT date and time. The Deluge has no clock, so all files it writes get the same one
+	int32_t snapshotSize;     // How much follows
+	uint32_t snapshotHash;
+};
+
+// Named after an FNV-1a hash of the XML file's path - in upper case, since FAT doesn't care about case and nor do the
+// paths we're given. The header catches any collisions
+bool getFilePath(String* path, char const* xmlPath) {
+	uint32_t hash = 2166136261u;
+	for (char const* c = xmlPath; *c; c++) {
+		hash = (hash ^ (uint8_t)toupper(*c)) * 16777619u;
+	}
+
+	char hashChars[9];
+	intToHex(hash, hashChars);
+	return (path->set(kFolder) == Error::NONE && path->concatenate("/") == Error::NONE
+	        && path->concatenate(hashChars) == Error::NONE && path->concatenate(kFileExtension) == Error::NONE);
+}
+
+bool makeFileHeader(FileHeader* header, char const* xmlPath, uint32_t xmlSize, uint32_t xmlStartCluster) {
+	FILINFO fileInfo;
+	if (f_stat(xmlPath, &fileInfo) != FR_OK) {
+		return false;
+	}
+
+	memset(header, 0, sizeof(FileHeader)); // Including padding, since we compare the whole thing
+	memcpy(header->magic, "DSNP", 4);
+	header->version = kFileVersion;
+	header->xmlSize = xmlSize;
+	header->xmlStartCluster = xmlStartCluster;
+	header->xmlModifiedTime = ((uint32_t)fileInfo.fdate << 16) | fileInfo.ftime;
+	return true;
+}
+
+// Reads the XML file, which must be open as file, through a Builder. Returns the snapshot's size - or -1 if it
+// couldn't be made
+int32_t buildSnapshot(uint8_t* snapshot, int32_t maxSize) {
+	XMLSnapshot::Builder builder(snapshot, maxSize);
+	char* buffer = smDeserializer.fileClusterBuffer; // Nothing's being read from the card but us
+
+	while (true) {
+		UINT numBytesRead;
+		if (f_read(&file, buffer, audioFileManager.clusterSize, &numBytesRead) != FR_OK) {
+			return -1;
+		}
+		if (!numBytesRead) {
+			return builder.finish();
+		}
+		if (!builder.feed(buffer, numBytesRead)) {
+			return -1;
+		}
+		AudioEngine::routineWithClusterLoading();
+	}
+}
+
+bool writeSnapshot(char const* path, FileHeader const& header, uint8_t const* snapshot) {
+	f_mkdir(kFolder); // Usually it'll be there already. Starting with a dot keeps it out of the browsers
+	if (f_open(&file, path, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK) {
+		return false;
+	}
+
+	UINT numBytesWritten;
+	bool success =
+	    (f_write(&file, &header, sizeof(header), &numBytesWritten) == FR_OK && numBytesWritten == sizeof(header));
+
+	for (int32_t pos = 0; success && pos < header.snapshotSize; pos += audioFileManager.clusterSize) {
+		UINT numBytes = std::min<int32_t>(audioFileManager.clusterSize, header.snapshotSize - pos);
+		success = (f_write(&file, &snapshot[pos], numBytes, &numBytesWritten) == FR_OK && numBytesWritten == numBytes);
+		AudioEngine::routineWithClusterLoading();
+	}
+
+	success = (f_close(&file) == FR_OK && success);
+	if (!success) {
+		f_unlink(path); // Don't leave half a file for next time
+	}
+	return success;
+}
+
+// Reads what follows the header, which must already have been read, a Cluster at a time. Through the cluster buffer,
+// since what comes back from allocLowSpeed() might not be aligned for the card to read straight into
+bool readSnapshot(uint8_t* snapshot, int32_t size) {
+	char* buffer = smDeserializer.fileClusterBuffer;
+
+	for (int32_t pos = 0; pos < size; pos += audioFileManager.clusterSize) {
+		UINT numBytes = std::min<int32_t>(audioFileManager.clusterSize, size - pos);
+		UINT numBytesRead;
+		if (f_read(&file, buffer, numBytes, &numBytesRead) != FR_OK || numBytesRead != numBytes) {
+			return false;
+		}
+		memcpy(&snapshot[pos], buffer, numBytes);
+		AudioEngine::routineWithClusterLoading();
+	}
+	return true;
+}
+
+} // namespace
+
+bool shouldUse() {
+	return runtimeFeatureSettings.get(RuntimeFeatureSettingType::LoadSnapshots) == RuntimeFeatureStateToggle::On;
+}
+
+void deleteFor(char const* xmlPath) {
+	String path;
+	if (getFilePath(&path, xmlPath)) {
+		f_unlink(path.get());
+	}
+}
+
+void writeFor(char const* xmlPath) {
+	// The old one's out of date either way. The Deluge might well have written the new XML file to the same clusters
+	// as the old one, with the same size and modified time, so this is the only way to know
+	String path;
+	if (!getFilePath(&path, xmlPath)) {
+		return;
+	}
+	f_unlink(path.get());
+
+	if (!shouldUse() || f_open(&file, xmlPath, FA_READ) != FR_OK) {
+		return;
+	}
+
+	FileHeader header;
+	uint32_t xmlSize = f_size(&file);
+	uint8_t* snapshot = nullptr;
+
+	// A snapshot's hardly ever any bigger than its XML, but there might be an odd file out there that's all short
+	// attributes
+	int32_t maxSize = xmlSize + (xmlSize >> 1) + 256;
+
+	if (makeFileHeader(&header, xmlPath, xmlSize, file.obj.sclust)) {
+		snapshot = (uint8_t*)GeneralMemoryAllocator::get().allocLowSpeed(maxSize);
+		if (snapshot) {
+			header.snapshotSize = buildSnapshot(snapshot, maxSize);
+		}
+	}
+	f_close(&file);
+
+	if (!snapshot) {
+		return;
+	}
+
+	if (header.snapshotSize < 0) {
+		D_PRINTLN("couldn't make snapshot of %s", xmlPath);
+	}
+	else {
+		header.snapshotHash = XMLSnapshot::getHash(snapshot, header.snapshotSize);
+		if (!writeSnapshot(path.get(), header, snapshot)) {
+			D_PRINTLN("couldn't write snapshot of %s", xmlPath);
+		}
+	}
+	delugeDealloc(snapshot);
+}
+
+uint8_t* read(char const* xmlPath, FilePointer* filePointer, int32_t* getSize) {
+	String path;
+	FileHeader expected;
+	if (!shouldUse() || !getFilePath(&path, xmlPath)
+	    || !makeFileHeader(&expected, xmlPath, filePointer->objsize, filePointer->sclust)
+	    || f_open(&file, path.get(), FA_READ) != FR_OK) {
+		return nullptr;
+	}
+
+	FileHeader header;
+	UINT numBytesRead;
+	uint8_t* snapshot = nullptr;
+	if (f_read(&file, &header, sizeof(header), &numBytesRead) == FR_OK && numBytesRead == sizeof(header)) {
+		int32_t size = header.snapshotSize;
+		uint32_t hash = header.snapshotHash;
+		header.snapshotSize = 0;
+		header.snapshotHash = 0;
+
+		if (memcmp(&header, &expected, sizeof(header)) || size <= 0 || f_size(&file) != sizeof(header) + size) {
+			D_PRINTLN("snapshot out of date: %s", xmlPath);
+		}
+		else {
+			snapshot = (uint8_t*)GeneralMemoryAllocator::get().allocLowSpeed(size);
+			if (snapshot && (!readSnapshot(snapshot, size) || XMLSnapshot::getHash(snapshot, size) != hash)) {
+				D_PRINTLN("snapshot damaged: %s", xmlPath);
+				delugeDealloc(snapshot);
+				snapshot = nullptr;
+			}
+			*getSize = size;
+		}
+	}
+
+	f_close(&file);
+	return snapshot;
+}
+
+} // namespace SnapshotFile
@@ -0,0 +1,48 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+extern "C" {
+#include "fatfs/ff.h"
+}
+
+// Keeps a snapshot (see XMLSnapshot) of each song or preset file saved, so that loading it can skip parsing the XML -
+// if the community feature is on. The XML file is still the real thing: a snapshot's only read if its header matches
+// the XML file's size, start cluster and modified time, and its contents still match the hash they were saved with.
+//
+// Snapshots live in kFolder, which is hidden, named after a hash of the XML file's path. They're made just after the
+// XML file's saved, by reading it back - so a snapshot never holds anything the XML file doesn't.
+namespace SnapshotFile {
+
+constexpr char const* kFolder = ".SNAPSHOTS";
+
+bool shouldUse();
+
+// Deletes any snapshot for the file at xmlPath, which has just been saved, then makes a new one if the feature's on
+void writeFor(char const* xmlPath);
+
+// For when the XML file at xmlPath is about to be overwritten, or has been deleted
+void deleteFor(char const* xmlPath);
+
+// Returns the snapshot for the XML file at xmlPath - which must be the one filePointer points to - in memory from
+// allocLowSpeed(), if there's an up to date one and the feature's on. Otherwise nullptr
+uint8_t* read(char const* xmlPath, FilePointer* filePointer, int32_t* getSize);
+
+} // namespace SnapshotFile
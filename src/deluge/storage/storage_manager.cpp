@@ -37,6 +37,10 @@
 #include "processing/sound/sound_drum.h"
 #include "processing/sound/sound_instrument.h"
 #include "storage/audio/audio_file_manager.h"
+#include "storage/block/sd_block_device.h"
+#include "storage/snapshot_deserializer.h"
+#include "storage/snapshot_file.h"
+#include "storage/xml_scanner.h"
 #include "util/firmware_version.h"
 #include "util/functions.h"
 #include "util/try.h"
@@ -168,7 +172,7 @@ cutFolderPathAndTryCreating:
 }
 
 Error StorageManager::createXMLFile(char const* filePath, XMLSerializer& writer, bool mayOverwrite,
-                                    bool displayErrors) {
+                                    bool displayErrors, uint32_t expectedSize) {
 
 	auto created = createFile(filePath, mayOverwrite);
 	writer.ms = this;
@@ -180,10 +184,31 @@ Error StorageManager::createXMLFile(char const* filePath, XMLSerializer& writer,
 		return created.error();
 	}
 	fileSystemStuff.currentFile = created.value().inner();
+	// The save UIs replace it with writeFor() once the save's done. This just stops it being read if the save fails
+	if (SnapshotFile::shouldUse()) {
+		SnapshotFile::deleteFor(filePath);
+	}
+
+	// Have FatFS start the file somewhere there's room for all of it in one piece, so its cluster chain - and the FAT
+	// sectors it's written to - stay together. Only a hint: if there's nowhere like that, or it's wrong, we carry on.
+	// Finding the room means going through the FAT with no routine calls - right through it, if there's nowhere big
+	// enough - so it's only done for files of ordinary size, while the card's known to have plenty of space free
+	constexpr uint32_t kMaxExpectedSizeToExpand = 4 << 20;
+	constexpr uint32_t kMinFreeSpaceMultiple = 16;
+	if (expectedSize && expectedSize <= kMaxExpectedSizeToExpand) {
+		FATFS* fs = fileSystemStuff.currentFile.obj.fs;
+		uint32_t numClustersNeeded = expectedSize / ((uint32_t)fs->csize * FF_MAX_SS) + 1;
+		// free_clst is only valid once it's known, e.g. from FSINFO. Counting it would mean going through the FAT too
+		bool freeSpaceKnown = (fs->free_clst <= fs->n_fatent - 2);
+		if (freeSpaceKnown && fs->free_clst >= numClustersNeeded * kMinFreeSpaceMultiple) {
+			f_expand(&fileSystemStuff.currentFile, expectedSize, 0);
+		}
+	}
 
 	writer.fileWriteBufferCurrentPos = 0;
 	writer.fileTotalBytesWritten = 0;
 	writer.fileAccessFailedDuringWrite = false;
+	sdBlockDevice.takeWriteBehindFailure(); // Any from before are nothing to do with this file
 	writer.write("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
 
 	writer.indentAmount = 0;
@@ -222,12 +247,14 @@ bool StorageManager::fileExists(char const* pathName, FilePointer* fp) {
 
 // Returns false if some error, including error while writing
 bool StorageManager::closeFile() {
+	smSnapshotDeserializer.close();
 	if (smSerializer.fileAccessFailedDuringWrite) {
 		return false; // Calling f_close if this is false might be dangerous - if access has failed, we don't want it to
 		              // flush any data to the card or anything
 	}
 	FRESULT result = f_close(&fileSystemStuff.currentFile);
-	return (result == FR_OK);
+	sdBlockDevice.waitTilIdle();
+	return (result == FR_OK && !sdBlockDevice.takeWriteBehindFailure());
 }
 
 // Gets ready to access SD card.
@@ -290,7 +317,8 @@ void StorageManager::openFilePointer(FilePointer* fp) {
 	writer.fileAccessFailedDuringWrite = false;
 }
 
-Error StorageManager::openInstrumentFile(OutputType outputType, FilePointer* filePointer) {
+Error StorageManager::openInstrumentFile(OutputType outputType, FilePointer* filePointer, String* name,
+                                         String* dirPath, Deserializer** reader) {
 
 	AudioEngine::logAction("openInstrumentFile");
 	if (!filePointer->sclust) {
@@ -310,7 +338,21 @@ Error StorageManager::openInstrumentFile(OutputType outputType, FilePointer* fil
 		firstTagName = "kit";
 	}
 
-	Error error = openXMLFile(filePointer, smDeserializer, firstTagName, altTagName);
+	// If this isn't quite the file's path, no snapshot will match it - it's only a shortcut
+	String xmlPath;
+	xmlPath.set(dirPath);
+	Error error = xmlPath.concatenate("/");
+	if (error == Error::NONE) {
+		error = xmlPath.concatenate(name);
+	}
+	if (error == Error::NONE) {
+		error = xmlPath.concatenate(".XML");
+	}
+	if (error != Error::NONE) {
+		xmlPath.clear();
+	}
+
+	error = openSongOrPresetFile(filePointer, xmlPath.get(), reader, firstTagName, altTagName);
 	return error;
 }
 
@@ -324,7 +366,8 @@ Error StorageManager::loadInstrumentFromFile(Song* song, InstrumentClip* clip, O
 	D_PRINTLN("opening instrument file -  %s %s  from FP  %lu", dirPath->get(), name->get(),
 	          (int32_t)filePointer->sclust);
 
-	Error error = openInstrumentFile(outputType, filePointer);
+	Deserializer* reader;
+	Error error = openInstrumentFile(outputType, filePointer, name, dirPath, &reader);
 	if (error != Error::NONE) {
 		D_PRINTLN("opening instrument file failed -  %s", name->get());
 		return error;
@@ -339,7 +382,7 @@ Error StorageManager::loadInstrumentFromFile(Song* song, InstrumentClip* clip, O
 		return Error::INSUFFICIENT_RAM;
 	}
 
-	error = newInstrument->readFromFile(smDeserializer, song, clip, 0);
+	error = newInstrument->readFromFile(*reader, song, clip, 0);
 
 	bool fileSuccess = closeFile();
 
@@ -366,7 +409,7 @@ deleteInstrumentAndGetOut:
 
 		// Prior to V2.0 (or was it only in V1.0 on the 40-pad?) Kits didn't have anything that would have caused the
 		// paramManager to be created when we read the Kit just now. So, just make one.
-		if (smDeserializer.firmware_version < FirmwareVersion::official({2, 2, 0, "beta"})
+		if (reader->firmware_version < FirmwareVersion::official({2, 2, 0, "beta"})
 		    && outputType == OutputType::KIT) {
 			ParamManagerForTimeline paramManager;
 			error = paramManager.setupUnpatched();
@@ -427,14 +470,15 @@ Error StorageManager::loadSynthToDrum(Song* song, InstrumentClip* clip, bool may
 
 	AudioEngine::logAction("loadSynthDrumFromFile");
 
-	Error error = openInstrumentFile(outputType, filePointer);
+	Deserializer* reader;
+	Error error = openInstrumentFile(outputType, filePointer, name, dirPath, &reader);
 	if (error != Error::NONE) {
 		return error;
 	}
 
 	AudioEngine::logAction("loadInstrumentFromFile");
 
-	error = newDrum->readFromFile(smDeserializer, song, clip, 0);
+	error = newDrum->readFromFile(*reader, song, clip, 0);
 
 	bool fileSuccess = closeFile();
 
@@ -590,18 +634,23 @@ void Serializer::writeFirmwareVersion() {
 }
 
 XMLSerializer::XMLSerializer() : fileWriteBufferCurrentPos(0), ms(NULL) {
-	void* temp = GeneralMemoryAllocator::get().allocLowSpeed(32768 + CACHE_LINE_SIZE * 2);
-	writeClusterBuffer = (char*)temp + CACHE_LINE_SIZE;
+	for (char*& buffer : writeClusterBuffers) {
+		void* temp = GeneralMemoryAllocator::get().allocLowSpeed(32768 + CACHE_LINE_SIZE * 2);
+		buffer = (char*)temp + CACHE_LINE_SIZE;
+	}
+	writeClusterBuffer = writeClusterBuffers[0];
 }
 
 XMLSerializer::~XMLSerializer() {
-	GeneralMemoryAllocator::get().dealloc(writeClusterBuffer);
+	for (char* buffer : writeClusterBuffers) {
+		GeneralMemoryAllocator::get().dealloc(buffer);
+	}
 }
 
-// TODO: this is really inefficient
 void XMLSerializer::write(char const* output) {
 
-	while (*output) {
+	int32_t numCharsLeft = strlen(output);
+	while (numCharsLeft) {
 
 		if (fileWriteBufferCurrentPos == audioFileManager.clusterSize) {
 
@@ -616,10 +665,14 @@ void XMLSerializer::write(char const* output) {
 			fileWriteBufferCurrentPos = 0;
 		}
 
-		writeClusterBuffer[fileWriteBufferCurrentPos] = *output;
+		// Copy as much as we can in one go - up to the end of the buffer, or the next time the routines below are due
+		int32_t numCharsHere = std::min<int32_t>(numCharsLeft, audioFileManager.clusterSize - fileWriteBufferCurrentPos);
+		numCharsHere = std::min<int32_t>(numCharsHere, 256 - (fileWriteBufferCurrentPos & 0b11111111));
+		memcpy(&writeClusterBuffer[fileWriteBufferCurrentPos], output, numCharsHere);
 
-		output++;
-		fileWriteBufferCurrentPos++;
+		output += numCharsHere;
+		numCharsLeft -= numCharsHere;
+		fileWriteBufferCurrentPos += numCharsHere;
 
 		// Ensure we do some of the audio routine once in a while
 		if (!(fileWriteBufferCurrentPos & 0b11111111)) {
@@ -687,10 +740,16 @@ void XMLSerializer::writeAttributeHexBytes(char const* name, uint8_t* data, int3
 	write(name);
 	write("=\"");
 
-	char buffer[3];
-	for (int i = 0; i < numBytes; i++) {
-		intToHex(data[i], &buffer[0], 2);
+	// A line's worth at a time, rather than each byte on its own
+	char buffer[129];
+	while (numBytes > 0) {
+		int32_t numBytesHere = std::min<int32_t>(numBytes, (sizeof(buffer) - 1) >> 1);
+		for (int32_t i = 0; i < numBytesHere; i++) {
+			intToHex(data[i], &buffer[i * 2], 2);
+		}
 		write(buffer);
+		data += numBytesHere;
+		numBytes -= numBytesHere;
 	}
 	write("\"");
 }
@@ -754,15 +813,26 @@ void XMLSerializer::printIndents() {
 	}
 }
 
+// Returns once the card's started on the whole sectors, which it writes straight from writeClusterBuffer while we go on
+// to fill the other buffer (see SDBlockDevice::startWriteBehind()). Any bit of a sector left over goes through FatFS's
+// own buffer as usual. Writing this one can't start til the card's done with the last, so by the time we swap back to
+// that it's free again
 Error XMLSerializer::writeXMLBufferToFile() {
+	if (sdBlockDevice.takeWriteBehindFailure()) {
+		return Error::SD_CARD; // The last Cluster didn't make it
+	}
+
 	UINT bytesWritten;
+	sdBlockDevice.allowWriteBehindFrom((uint8_t*)writeClusterBuffer, fileWriteBufferCurrentPos);
 	FRESULT result =
 	    f_write(&fileSystemStuff.currentFile, writeClusterBuffer, fileWriteBufferCurrentPos, &bytesWritten);
+	sdBlockDevice.allowWriteBehindFrom(nullptr, 0);
 	if (result != FR_OK || bytesWritten != fileWriteBufferCurrentPos) {
 		return Error::SD_CARD;
 	}
 
 	fileTotalBytesWritten += fileWriteBufferCurrentPos;
+	writeClusterBuffer = writeClusterBuffers[writeClusterBuffer == writeClusterBuffers[0]];
 
 	return Error::NONE;
 }
@@ -779,7 +849,8 @@ Error XMLSerializer::closeFileAfterWriting(char const* path, char const* beginni
 	}
 
 	FRESULT result = f_close(&fileSystemStuff.currentFile);
-	if (result) {
+	sdBlockDevice.waitTilIdle(); // For the last Cluster, if f_close() didn't have anything to write after it
+	if (result || sdBlockDevice.takeWriteBehindFailure()) {
 		return Error::WRITE_FAIL;
 	}
 
@@ -862,59 +933,64 @@ XMLDeserializer::~XMLDeserializer() {
 }
 
 // Only call this if IN_TAG_NAME
-// TODO: this is very sub-optimal and still calls readCharXML()
 char const* XMLDeserializer::readTagName() {
 
-	if (false) {
-skipToNextTag:
-		skipUntilChar('>');
-		skipUntilChar('<');
-	}
-
-	char thisChar;
 	int32_t charPos = 0;
 
-	while (readCharXML(&thisChar)) {
-		switch (thisChar) {
-		case '/':
-			goto skipPastRest;
+	while (true) {
+		readXMLFileClusterIfNecessary();
+		if (xmlReachedEnd) {
+			break;
+		}
 
-		case ' ':
-		case '\r':
-		case '\n':
-		case '\t':
-			xmlArea = IN_TAG_PAST_NAME;
-			goto getOut;
+		// Take as much of the name as this Cluster has in one go
+		char const* nameStart = &fileClusterBuffer[fileReadBufferCurrentPos];
+		char const* end = &fileClusterBuffer[currentReadBufferEndPos];
+		char const* nameEnd = XMLScanner::findTagNameEnd(nameStart, end);
+		int32_t numCharsHere = nameEnd - nameStart;
+
+		if (numCharsHere) {
+			if (!charPos) {
+				tagDepthFile++;
+			}
+
+			// Store these characters, if space in our un-ideal buffer
+			int32_t numCharsToCopy = std::min<int32_t>(numCharsHere, kFilenameBufferSize - 1 - charPos);
+			memcpy(&stringBuffer[charPos], nameStart, numCharsToCopy);
+			charPos += numCharsToCopy;
+			fileReadBufferCurrentPos += numCharsHere;
+		}
+
+		if (nameEnd == end) {
+			continue; // Name carries on into the next Cluster - or the file's ended
+		}
+
+		fileReadBufferCurrentPos++;
+		switch (*nameEnd) {
+		case '/':
+			tagDepthFile--;
+			skipUntilChar('>');
+			xmlArea = BETWEEN_TAGS;
+			goto gotName;
 
 		case '?':
-			goto skipToNextTag;
+			skipUntilChar('>');
+			skipUntilChar('<');
+			continue;
 
 		case '>':
 			xmlArea = BETWEEN_TAGS;
-			goto getOut;
-
-		default:
-			if (!charPos) {
-				tagDepthFile++;
-			}
+			break;
 
-			// Store this character, if space in our un-ideal buffer
-			if (charPos < kFilenameBufferSize - 1) {
-				stringBuffer[charPos++] = thisChar;
-			}
+		default: // Whitespace
+			xmlArea = IN_TAG_PAST_NAME;
 		}
+		break;
 	}
 
-getOut:
 	xmlReadDone();
 
-	if (false) {
-skipPastRest:
-		tagDepthFile--;
-		skipUntilChar('>');
-		xmlArea = BETWEEN_TAGS;
-	}
-
+gotName:
 	stringBuffer[charPos] = 0;
 	return stringBuffer;
 }
@@ -925,14 +1001,8 @@ char const* XMLDeserializer::readNextAttributeName() {
 	char thisChar;
 	int32_t charPos = 0;
 
-	while (readCharXML(&thisChar)) {
+	if (readNonWhitespaceCharXML(&thisChar)) {
 		switch (thisChar) {
-		case ' ':
-		case '\r':
-		case '\n':
-		case '\t':
-			break;
-
 		case '/':
 			tagDepthFile--;
 			skipUntilChar('>');
@@ -966,17 +1036,12 @@ doReadName:
 	// This is basically copied and tweaked from readUntilChar()
 	do {
 		int32_t bufferPosAtStart = fileReadBufferCurrentPos;
-		while (fileReadBufferCurrentPos < currentReadBufferEndPos) {
-			char thisChar = fileClusterBuffer[fileReadBufferCurrentPos];
-
-			switch (thisChar) {
-			case ' ':
-			case '\r':
-			case '\n':
-			case '\t':
-				xmlArea = PAST_ATTRIBUTE_NAME;
-				goto reachedNameEnd;
+		char const* end = &fileClusterBuffer[currentReadBufferEndPos];
+		char const* nameEnd = XMLScanner::findAttributeNameEnd(&fileClusterBuffer[fileReadBufferCurrentPos], end);
+		fileReadBufferCurrentPos = nameEnd - fileClusterBuffer;
 
+		if (nameEnd < end) {
+			switch (*nameEnd) {
 			case '=':
 				xmlArea = PAST_EQUALS_SIGN;
 				goto reachedNameEnd;
@@ -988,9 +1053,11 @@ doReadName:
 				goto noMoreAttributes;
 
 				// TODO: a '/' should get us outta here too...
-			}
 
-			fileReadBufferCurrentPos++;
+			default: // Whitespace
+				xmlArea = PAST_ATTRIBUTE_NAME;
+				goto reachedNameEnd;
+			}
 		}
 
 		if (false) {
@@ -1089,44 +1156,27 @@ bool XMLDeserializer::getIntoAttributeValue() {
 
 	switch (xmlArea) {
 	case PAST_ATTRIBUTE_NAME:
-		while (readCharXML(&thisChar)) {
-			switch (thisChar) {
-			case ' ':
-			case '\r':
-			case '\n':
-			case '\t':
-				break;
-
-			case '=':
-				xmlArea = PAST_EQUALS_SIGN;
-				goto pastEqualsSign;
-
-			default:
-				return false; // There shouldn't be any other characters. If there are, that's an error
-			}
+		if (!readNonWhitespaceCharXML(&thisChar)) {
+			break;
 		}
-
-		break;
+		if (thisChar != '=') {
+			return false; // There shouldn't be any other characters. If there are, that's an error
+		}
+		xmlArea = PAST_EQUALS_SIGN;
+		// No break
 
 	case PAST_EQUALS_SIGN:
-pastEqualsSign:
-		while (readCharXML(&thisChar)) {
-			switch (thisChar) {
-			case ' ':
-			case '\r':
-			case '\n':
-			case '\t':
-				break;
-
-			case '"':
-			case '\'':
-				goto inAttributeValue;
-
-			default:
-				return false; // There shouldn't be any other characters. If there are, that's an error
-			}
+		if (!readNonWhitespaceCharXML(&thisChar)) {
+			break;
+		}
+		switch (thisChar) {
+		case '"':
+		case '\'':
+			goto inAttributeValue;
+
+		default:
+			return false; // There shouldn't be any other characters. If there are, that's an error
 		}
-		break;
 	}
 
 	if (false) {
@@ -1177,27 +1227,28 @@ Error XMLDeserializer::readAttributeValueString(String* string) {
 void XMLDeserializer::xmlReadDone() {
 	xmlReadCount++; // Increment first, cos we don't want to call SD routine immediately when it's 0
 
-	if (!(xmlReadCount & 63)) { // 511 bad. 255 almost fine. 127 almost always fine
-		AudioEngine::routineWithClusterLoading();
+	// Going by the time rather than the number of reads keeps audio going however slow the reads are
+	if (!(xmlReadCount & 7) && AudioEngine::yieldIsDue()) {
+		doRoutinesWhileReading();
+	}
+}
+
+void Deserializer::doRoutinesWhileReading() {
+	AudioEngine::routineWithClusterLoading();
 
-		uiTimerManager.routine();
+	uiTimerManager.routine();
 
-		if (display->haveOLED()) {
-			oledRoutine();
-		}
-		PIC::flush();
+	if (display->haveOLED()) {
+		oledRoutine();
 	}
+	PIC::flush();
 }
 
 void XMLDeserializer::skipUntilChar(char endChar) {
 
 	readXMLFileClusterIfNecessary(); // Does this need to be here? Originally I didn't have it...
 	do {
-		while (fileReadBufferCurrentPos < currentReadBufferEndPos
-		       && fileClusterBuffer[fileReadBufferCurrentPos] != endChar) {
-			fileReadBufferCurrentPos++;
-		}
-
+		fileReadBufferCurrentPos = findCharInBuffer(endChar);
 	} while (fileReadBufferCurrentPos == currentReadBufferEndPos && readXMLFileClusterIfNecessary());
 
 	fileReadBufferCurrentPos++; // Gets us past the endChar
@@ -1211,10 +1262,7 @@ Error XMLDeserializer::readStringUntilChar(String* string, char endChar) {
 	int32_t newStringPos = 0;
 
 	do {
-		int32_t bufferPosNow = fileReadBufferCurrentPos;
-		while (bufferPosNow < currentReadBufferEndPos && fileClusterBuffer[bufferPosNow] != endChar) {
-			bufferPosNow++;
-		}
+		int32_t bufferPosNow = findCharInBuffer(endChar);
 
 		int32_t numCharsHere = bufferPosNow - fileReadBufferCurrentPos;
 
@@ -1244,10 +1292,7 @@ char const* XMLDeserializer::readUntilChar(char endChar) {
 
 	do {
 		int32_t bufferPosAtStart = fileReadBufferCurrentPos;
-		while (fileReadBufferCurrentPos < currentReadBufferEndPos
-		       && fileClusterBuffer[fileReadBufferCurrentPos] != endChar) {
-			fileReadBufferCurrentPos++;
-		}
+		fileReadBufferCurrentPos = findCharInBuffer(endChar);
 
 		// If possible, just return a pointer to the chars within the existing buffer
 		if (!charPos && fileReadBufferCurrentPos < currentReadBufferEndPos) {
@@ -1288,11 +1333,12 @@ char const* XMLDeserializer::readNextCharsOfTagOrAttributeValue(int32_t numChars
 
 		int32_t currentReadBufferEndPosNow = std::min<int32_t>(currentReadBufferEndPos, bufferPosAtEnd);
 
-		while (fileReadBufferCurrentPos < currentReadBufferEndPosNow) {
-			if (fileClusterBuffer[fileReadBufferCurrentPos] == charAtEndOfValue) {
-				goto reachedEndCharEarly;
-			}
-			fileReadBufferCurrentPos++;
+		fileReadBufferCurrentPos =
+		    XMLScanner::findChar(&fileClusterBuffer[fileReadBufferCurrentPos],
+		                         &fileClusterBuffer[currentReadBufferEndPosNow], charAtEndOfValue)
+		    - fileClusterBuffer;
+		if (fileReadBufferCurrentPos < currentReadBufferEndPosNow) {
+			goto reachedEndCharEarly;
 		}
 
 		int32_t numCharsHere = fileReadBufferCurrentPos - bufferPosAtStart;
@@ -1549,12 +1595,34 @@ Error XMLDeserializer::readTagOrAttributeValueString(String* string) {
 
 int32_t XMLDeserializer::getNumCharsRemainingInValue() {
 
-	int32_t pos = fileReadBufferCurrentPos;
-	while (pos < currentReadBufferEndPos && fileClusterBuffer[pos] != charAtEndOfValue) {
-		pos++;
+	return findCharInBuffer(charAtEndOfValue) - fileReadBufferCurrentPos;
+}
+
+int32_t XMLDeserializer::readNextHexBytesOfTagOrAttributeValue(uint8_t* bytes, int32_t maxNumBytes) {
+
+	int32_t numBytesRead = 0;
+
+	while (numBytesRead < maxNumBytes) {
+
+		// Decode as many whole bytes as this Cluster has, straight out of the buffer
+		int32_t numBytesHere = std::min(getNumCharsRemainingInValue() >> 1, maxNumBytes - numBytesRead);
+		if (numBytesHere > 0) {
+			XMLScanner::decodeHex(&fileClusterBuffer[fileReadBufferCurrentPos], &bytes[numBytesRead], numBytesHere);
+			fileReadBufferCurrentPos += numBytesHere * 2;
+			numBytesRead += numBytesHere;
+			xmlReadDone();
+			continue;
+		}
+
+		// Otherwise, either the value ends here or a byte straddles two Clusters - which this deals with
+		char const* hexChars = readNextCharsOfTagOrAttributeValue(2);
+		if (!hexChars) {
+			break;
+		}
+		bytes[numBytesRead++] = hexToIntFixedLength(hexChars, 2);
 	}
 
-	return pos - fileReadBufferCurrentPos;
+	return numBytesRead;
 }
 
 // Returns whether we're all good to go
@@ -1634,6 +1702,34 @@ uint32_t XMLDeserializer::readCharXML(char* thisChar) {
 	return 1;
 }
 
+// Like readCharXML(), but skips past any whitespace first
+uint32_t XMLDeserializer::readNonWhitespaceCharXML(char* thisChar) {
+
+	while (true) {
+		readXMLFileClusterIfNecessary();
+		if (xmlReachedEnd) {
+			return 0;
+		}
+
+		char const* end = &fileClusterBuffer[currentReadBufferEndPos];
+		char const* pos = XMLScanner::skipWhitespace(&fileClusterBuffer[fileReadBufferCurrentPos], end);
+		fileReadBufferCurrentPos = pos - fileClusterBuffer;
+
+		if (pos < end) {
+			*thisChar = *pos;
+			fileReadBufferCurrentPos++;
+			return 1;
+		}
+	}
+}
+
+// Where endChar next is in what's left of the current Cluster - or its end, if it's not there
+int32_t XMLDeserializer::findCharInBuffer(char endChar) {
+	return XMLScanner::findChar(&fileClusterBuffer[fileReadBufferCurrentPos],
+	                            &fileClusterBuffer[currentReadBufferEndPos], endChar)
+	       - fileClusterBuffer;
+}
+
 void XMLDeserializer::exitTag(char const* exitTagName) {
 	// back out the file depth to one less than the caller depth
 	while (tagDepthFile >= tagDepthCaller) {
@@ -1697,6 +1793,32 @@ Error StorageManager::openXMLFile(FilePointer* filePointer, XMLDeserializer& rea
 	return Error::FILE_CORRUPTED;
 }
 
+Error StorageManager::openSongOrPresetFile(FilePointer* filePointer, char const* xmlPath, Deserializer** reader,
+                                           char const* firstTagName, char const* altTagName,
+                                           bool ignoreIncorrectFirmware) {
+	int32_t snapshotSize;
+	uint8_t* snapshot = (xmlPath && *xmlPath) ? SnapshotFile::read(xmlPath, filePointer, &snapshotSize) : nullptr;
+	if (snapshot) {
+		AudioEngine::logAction("openSnapshot");
+
+		// The XML file gets opened too, so callers can closeFile() as usual
+		openFilePointer(filePointer);
+		Error error =
+		    smSnapshotDeserializer.open(snapshot, snapshotSize, firstTagName, altTagName, ignoreIncorrectFirmware);
+		if (error == Error::NONE) {
+			*reader = &smSnapshotDeserializer;
+			return Error::NONE;
+		}
+
+		// Shouldn't happen, but the XML file's still there to fall back on
+		smSnapshotDeserializer.close();
+		f_close(&fileSystemStuff.currentFile);
+	}
+
+	*reader = &smDeserializer;
+	return openXMLFile(filePointer, smDeserializer, firstTagName, altTagName, ignoreIncorrectFirmware);
+}
+
 Error XMLDeserializer::openXMLFile(FilePointer* filePointer, char const* firstTagName, char const* altTagName,
                                    bool ignoreIncorrectFirmware) {
 
@@ -1708,13 +1830,22 @@ Error XMLDeserializer::openXMLFile(FilePointer* filePointer, char const* firstTa
 	fileReadBufferCurrentPos = audioFileManager.clusterSize;
 	currentReadBufferEndPos = audioFileManager.clusterSize;
 
-	firmware_version = FirmwareVersion{FirmwareVersion::Type::OFFICIAL, {}};
-
 	tagDepthFile = 0;
 	tagDepthCaller = 0;
 	xmlReachedEnd = false;
 	xmlArea = BETWEEN_TAGS;
 
+	Error error = readUpToFirstTag(firstTagName, altTagName, ignoreIncorrectFirmware);
+	if (error == Error::FILE_CORRUPTED) {
+		f_close(&fileSystemStuff.currentFile);
+	}
+	return error;
+}
+
+Error Deserializer::readUpToFirstTag(char const* firstTagName, char const* altTagName, bool ignoreIncorrectFirmware) {
+
+	firmware_version = FirmwareVersion{FirmwareVersion::Type::OFFICIAL, {}};
+
 	char const* tagName;
 
 	while (*(tagName = readNextTagOrAttributeName())) {
@@ -1730,11 +1861,10 @@ Error XMLDeserializer::openXMLFile(FilePointer* filePointer, char const* firstTa
 		exitTag(tagName);
 	}
 
-	f_close(&fileSystemStuff.currentFile);
 	return Error::FILE_CORRUPTED;
 }
 
-Error XMLDeserializer::tryReadingFirmwareTagFromFile(char const* tagName, bool ignoreIncorrectFirmware) {
+Error Deserializer::tryReadingFirmwareTagFromFile(char const* tagName, bool ignoreIncorrectFirmware) {
 
 	if (!strcmp(tagName, "firmwareVersion")) {
 		char const* firmware_version_string = readTagOrAttributeValue();
@@ -108,7 +108,9 @@ public:
 
 	// Private member variables for XML display and parsing:
 public:
-	char* writeClusterBuffer;
+	// Two, so the next Cluster can be formatted into one while the card's still writing the other
+	char* writeClusterBuffers[2];
+	char* writeClusterBuffer; // Whichever of them is being filled
 	uint8_t indentAmount;
 	int32_t fileWriteBufferCurrentPos;
 	int32_t fileTotalBytesWritten;
@@ -135,8 +137,25 @@ public:
 	virtual char const* readNextCharsOfTagOrAttributeValue(int32_t numChars) = 0;
 	virtual Error readTagOrAttributeValueString(String* string) = 0;
 	virtual void exitTag(char const* exitTagName = NULL) = 0;
+
+	// For a hex value being read one char at a time, once past its "0x": reads the bytes the next chars stand for, up
+	// to maxNumBytes of them. Returns how many - which is only fewer than maxNumBytes once the value's ended
+	virtual int32_t readNextHexBytesOfTagOrAttributeValue(uint8_t* bytes, int32_t maxNumBytes) = 0;
+
+	// Of whichever file's being read. Shared between all Deserializers, since only one file's ever read at a time
+	inline static FirmwareVersion firmware_version = FirmwareVersion::current();
+	Error tryReadingFirmwareTagFromFile(char const* tagName, bool ignoreIncorrectFirmware = false);
+
+protected:
+	// Reads into the first tag named firstTagName or altTagName, reading any firmware version tags on the way
+	Error readUpToFirstTag(char const* firstTagName, char const* altTagName, bool ignoreIncorrectFirmware);
+
+	// Keeps the audio, UI timers and display going. Call every so often while reading
+	static void doRoutinesWhileReading();
 };
 
+bool getNibble(char ch, int* nibble);
+
 class XMLDeserializer : public Deserializer {
 public:
 	XMLDeserializer();
@@ -156,6 +175,7 @@ public:
 	Error readTagOrAttributeValueString(String* string) override;
 	char const* readTagOrAttributeValue() override;
 	void exitTag(char const* exitTagName = NULL) override;
+	int32_t readNextHexBytesOfTagOrAttributeValue(uint8_t* bytes, int32_t maxNumBytes) override;
 
 	Error openXMLFile(FilePointer* filePointer, char const* firstTagName, char const* altTagName = "",
 	                  bool ignoreIncorrectFirmware = false);
@@ -177,11 +197,10 @@ public:
 
 	char stringBuffer[kFilenameBufferSize];
 
-	FirmwareVersion firmware_version = FirmwareVersion::current();
-	Error tryReadingFirmwareTagFromFile(char const* tagName, bool ignoreIncorrectFirmware = false);
-
 	void skipUntilChar(char endChar);
 	uint32_t readCharXML(char* thisChar);
+	uint32_t readNonWhitespaceCharXML(char* thisChar);
+	int32_t findCharInBuffer(char endChar);
 	char const* readTagName();
 	char const* readNextAttributeName();
 	char const* readUntilChar(char endChar);
@@ -208,10 +227,16 @@ public:
 	virtual ~StorageManager();
 
 	std::expected<FatFS::File, Error> createFile(char const* filePath, bool mayOverwrite);
+	// expectedSize, if known (e.g. from the last time it was saved), lets the file be laid out contiguously
 	Error createXMLFile(char const* pathName, XMLSerializer& writer, bool mayOverwrite = false,
-	                    bool displayErrors = true);
+	                    bool displayErrors = true, uint32_t expectedSize = 0);
 	Error openXMLFile(FilePointer* filePointer, XMLDeserializer& reader, char const* firstTagName,
 	                  char const* altTagName = "", bool ignoreIncorrectFirmware = false);
+	// Like openXMLFile(), but reads from the file's snapshot instead if there's an up to date one. Gives back whichever
+	// Deserializer to read with
+	Error openSongOrPresetFile(FilePointer* filePointer, char const* xmlPath, Deserializer** reader,
+	                           char const* firstTagName, char const* altTagName = "",
+	                           bool ignoreIncorrectFirmware = false);
 
 	Error initSD();
 	bool closeFile();
@@ -238,7 +263,8 @@ public:
 
 private:
 	// ** End of member variables
-	Error openInstrumentFile(OutputType outputType, FilePointer* filePointer);
+	Error openInstrumentFile(OutputType outputType, FilePointer* filePointer, String* name, String* dirPath,
+	                         Deserializer** reader);
 };
 
 extern StorageManager storageManager;
@@ -0,0 +1,176 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "storage/xml_scanner.h"
+#include <array>
+#include <cstring>
+
+#ifdef __arm__
+#pragma GCC push_options
+#pragma GCC target("fpu=neon")
+#include <arm_neon.h>
+#endif
+
+namespace XMLScanner {
+
+namespace {
+
+enum CharClass : uint8_t {
+	WHITESPACE = 1 << 0,
+	TAG_NAME_END = 1 << 1,
+	ATTRIBUTE_NAME_END = 1 << 2,
+};
+
+constexpr std::array<uint8_t, 256> makeCharClasses() {
+	std::array<uint8_t, 256> charClasses{};
+	for (char thisChar : {' ', '\r', '\n', '\t'}) {
+		charClasses[(uint8_t)thisChar] = WHITESPACE | TAG_NAME_END | ATTRIBUTE_NAME_END;
+	}
+	for (char thisChar : {'>', '/', '?'}) {
+		charClasses[(uint8_t)thisChar] |= TAG_NAME_END;
+	}
+	for (char thisChar : {'=', '>'}) {
+		charClasses[(uint8_t)thisChar] |= ATTRIBUTE_NAME_END;
+	}
+	return charClasses;
+}
+
+constexpr std::array<uint8_t, 256> charClasses = makeCharClasses();
+
+// As hexCharToHalfByte(), kept to 8 bits - which is all that's left of it in a byte anyway
+inline uint8_t hexCharToNibble(uint8_t hexChar) {
+	return hexChar - ((hexChar >= 'A') ? 55 : 48);
+}
+
+inline void decodeHexOneAtATime(char const* hexChars, uint8_t* bytes, int32_t numBytes) {
+	for (int32_t i = 0; i < numBytes; i++) {
+		bytes[i] = (hexCharToNibble(hexChars[i * 2]) << 4) | hexCharToNibble(hexChars[i * 2 + 1]);
+	}
+}
+
+template <uint8_t charClass, bool inClass>
+inline char const* findFirstOneAtATime(char const* pos, char const* end) {
+	while (pos < end && (bool)(charClasses[(uint8_t)*pos] & charClass) != inClass) {
+		pos++;
+	}
+	return pos;
+}
+
+#ifdef __arm__
+
+inline uint8x16_t hexCharsToNibbles(uint8x16_t chars) {
+	uint8x16_t letterAdjustment = vandq_u8(vcgeq_u8(chars, vdupq_n_u8('A')), vdupq_n_u8(7));
+	return vsubq_u8(vsubq_u8(chars, vdupq_n_u8(48)), letterAdjustment);
+}
+
+inline uint8x16_t matchWhitespace(uint8x16_t chars) {
+	return vorrq_u8(vorrq_u8(vceqq_u8(chars, vdupq_n_u8(' ')), vceqq_u8(chars, vdupq_n_u8('\r'))),
+	                vorrq_u8(vceqq_u8(chars, vdupq_n_u8('\n')), vceqq_u8(chars, vdupq_n_u8('\t'))));
+}
+
+inline uint8x16_t matchTagNameEnd(uint8x16_t chars) {
+	return vorrq_u8(vorrq_u8(matchWhitespace(chars), vceqq_u8(chars, vdupq_n_u8('>'))),
+	                vorrq_u8(vceqq_u8(chars, vdupq_n_u8('/')), vceqq_u8(chars, vdupq_n_u8('?'))));
+}
+
+inline uint8x16_t matchAttributeNameEnd(uint8x16_t chars) {
+	return vorrq_u8(matchWhitespace(chars),
+	                vorrq_u8(vceqq_u8(chars, vdupq_n_u8('=')), vceqq_u8(chars, vdupq_n_u8('>'))));
+}
+
+// Looks at 16 chars at a time for the first match - or non-match, if inClass is false - and does any left over one at a
+// time. match() gives all ones for each char in charClass, and must agree with charClasses
+template <uint8x16_t (*match)(uint8x16_t), uint8_t charClass, bool inClass>
+inline char const* findFirst(char const* pos, char const* end) {
+	for (; end - pos >= 16; pos += 16) {
+		uint8x16_t matches = match(vld1q_u8((uint8_t const*)pos));
+		if (!inClass) {
+			matches = vmvnq_u8(matches);
+		}
+
+		// Narrowing each 16 bits to 8, with a shift of 4, leaves 4 bits for each char - so the whole lot fits in 64,
+		// and the first set one tells us where the first match is
+		uint64_t bits = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(matches), 4)), 0);
+		if (bits) {
+			return pos + (__builtin_ctzll(bits) >> 2);
+		}
+	}
+	return findFirstOneAtATime<charClass, inClass>(pos, end);
+}
+
+#endif
+
+} // namespace
+
+char const* findChar(char const* pos, char const* end, char thisChar) {
+	if (pos >= end) {
+		return pos;
+	}
+	char const* found = (char const*)memchr(pos, thisChar, end - pos);
+	return found ? found : end;
+}
+
+#ifdef __arm__
+
+char const* skipWhitespace(char const* pos, char const* end) {
+	return findFirst<matchWhitespace, WHITESPACE, false>(pos, end);
+}
+
+char const* findTagNameEnd(char const* pos, char const* end) {
+	return findFirst<matchTagNameEnd, TAG_NAME_END, true>(pos, end);
+}
+
+char const* findAttributeNameEnd(char const* pos, char const* end) {
+	return findFirst<matchAttributeNameEnd, ATTRIBUTE_NAME_END, true>(pos, end);
+}
+
+// 32 chars at a time, which vld2q_u8() splits into the high and low nibbles' chars for 16 bytes
+void decodeHex(char const* hexChars, uint8_t* bytes, int32_t numBytes) {
+	for (; numBytes >= 16; numBytes -= 16, hexChars += 32, bytes += 16) {
+		uint8x16x2_t chars = vld2q_u8((uint8_t const*)hexChars);
+		uint8x16_t highNibbles = hexCharsToNibbles(chars.val[0]);
+		uint8x16_t lowNibbles = hexCharsToNibbles(chars.val[1]);
+		vst1q_u8(bytes, vorrq_u8(vshlq_n_u8(highNibbles, 4), lowNibbles));
+	}
+	decodeHexOneAtATime(hexChars, bytes, numBytes);
+}
+
+#else
+
+char const* skipWhitespace(char const* pos, char const* end) {
+	return findFirstOneAtATime<WHITESPACE, false>(pos, end);
+}
+
+char const* findTagNameEnd(char const* pos, char const* end) {
+	return findFirstOneAtATime<TAG_NAME_END, true>(pos, end);
+}
+
+char const* findAttributeNameEnd(char const* pos, char const* end) {
+	return findFirstOneAtATime<ATTRIBUTE_NAME_END, true>(pos, end);
+}
+
+void decodeHex(char const* hexChars, uint8_t* bytes, int32_t numBytes) {
+	decodeHexOneAtATime(hexChars, bytes, numBytes);
+}
+
+#endif
+
+} // namespace XMLScanner
+
+#ifdef __arm__
+#pragma GCC pop_options
+#endif
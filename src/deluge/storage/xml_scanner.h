@@ -0,0 +1,49 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+// Finds the characters XMLDeserializer cares about in a run of a file already in memory, looking at a whole block of
+// it at a time rather than going through it char by char. On the Deluge these use NEON, 16 chars at a time; elsewhere
+// (i.e. in the unit tests) a lookup table, which comes out identical.
+//
+// Each returns a pointer to the first char in [pos, end) of the kind it's looking for - or end, if there isn't one. If
+// pos is already at or past end, it comes straight back
+namespace XMLScanner {
+
+constexpr bool isWhitespace(char thisChar) {
+	return thisChar == ' ' || thisChar == '\r' || thisChar == '\n' || thisChar == '\t';
+}
+
+char const* findChar(char const* pos, char const* end, char thisChar);
+
+// The first char that isn't whitespace
+char const* skipWhitespace(char const* pos, char const* end);
+
+// Whitespace, '>', '/' or '?' - anything XMLDeserializer::readTagName() has to stop at
+char const* findTagNameEnd(char const* pos, char const* end);
+
+// Whitespace, '=' or '>' - anything XMLDeserializer::readNextAttributeName() has to stop at
+char const* findAttributeNameEnd(char const* pos, char const* end);
+
+// Turns numBytes * 2 hex chars - uppercase, as the Deluge writes them - into numBytes bytes, giving exactly what
+// hexToIntFixedLength(hexChars, 2) would for each pair, even for chars that aren't hex
+void decodeHex(char const* hexChars, uint8_t* bytes, int32_t numBytes);
+
+} // namespace XMLScanner
@@ -0,0 +1,371 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "storage/xml_snapshot.h"
+#include "storage/xml_scanner.h"
+#include <cstring>
+
+namespace XMLSnapshot {
+
+namespace {
+
+constexpr uint8_t kLongLength = 255;
+
+bool isUppercaseHexChar(uint8_t thisChar) {
+	return (thisChar >= '0' && thisChar <= '9') || (thisChar >= 'A' && thisChar <= 'F');
+}
+
+uint8_t hexCharToNibble(uint8_t thisChar) {
+	return (thisChar >= 'A') ? (thisChar - 'A' + 10) : (thisChar - '0');
+}
+
+} // namespace
+
+uint8_t const* readToken(uint8_t const* pos, uint8_t const* end, Token* token) {
+	token->type = (TokenType)*pos;
+	pos++;
+	token->data = pos;
+	token->length = 0;
+
+	if (token->type == TokenType::END) {
+		return pos;
+	}
+	if (token->type > TokenType::END || pos >= end) {
+		return nullptr;
+	}
+
+	uint32_t length = *pos;
+	pos++;
+	if (length == kLongLength) {
+		if (end - pos < 4) {
+			return nullptr;
+		}
+		length = pos[0] | (pos[1] << 8) | (pos[2] << 16) | ((uint32_t)pos[3] << 24);
+		pos += 4;
+	}
+
+	uint32_t numBytes = length + (token->type != TokenType::HEX_VALUE); // Everything but HEX_VALUE has a null char
+	if ((uint32_t)(end - pos) < numBytes) {
+		return nullptr;
+	}
+	token->data = pos;
+	token->length = length;
+	return pos + numBytes;
+}
+
+uint32_t getHash(uint8_t const* data, int32_t length) {
+	uint32_t hash = 2166136261u;
+	for (int32_t i = 0; i < length; i++) {
+		hash = (hash ^ data[i]) * 16777619u;
+	}
+	return hash;
+}
+
+bool Builder::giveUp() {
+	state = State::GAVE_UP;
+	return false;
+}
+
+bool Builder::put(uint8_t byte) {
+	if (outputPos >= maxSize) {
+		return giveUp();
+	}
+	output[outputPos++] = byte;
+	return true;
+}
+
+// Leaves room for a short length, which appendToToken() will lengthen if need be
+bool Builder::beginToken(TokenType type) {
+	tokenStartPos = outputPos;
+	if (!put((uint8_t)type) || !put(0)) {
+		return false;
+	}
+	tokenDataStartPos = outputPos;
+	return true;
+}
+
+bool Builder::appendToToken(char const* chars, int32_t numChars) {
+	if (!numChars) {
+		return true;
+	}
+	if (outputPos + numChars + 4 > maxSize) {
+		return giveUp();
+	}
+
+	// Once it's too long for a one byte length, shuffle what we have along to make room for a long one. That's at most
+	// 254 bytes, once per token
+	if (output[tokenStartPos + 1] != kLongLength && outputPos - tokenDataStartPos + numChars >= kLongLength) {
+		memmove(&output[tokenDataStartPos + 4], &output[tokenDataStartPos], outputPos - tokenDataStartPos);
+		output[tokenStartPos + 1] = kLongLength;
+		tokenDataStartPos += 4;
+		outputPos += 4;
+	}
+
+	memcpy(&output[outputPos], chars, numChars);
+	outputPos += numChars;
+	return true;
+}
+
+void Builder::abandonToken() {
+	if (tokenStartPos != -1) {
+		outputPos = tokenStartPos;
+		tokenStartPos = -1;
+	}
+}
+
+bool Builder::endName() {
+	int32_t length = outputPos - tokenDataStartPos;
+	if (!length || length > kMaxNameLength) {
+		return giveUp();
+	}
+	output[tokenStartPos + 1] = length;
+	tokenStartPos = -1;
+	return put(0);
+}
+
+bool Builder::endValue() {
+	uint8_t* data = &output[tokenDataStartPos];
+	int32_t length = outputPos - tokenDataStartPos;
+
+	// Long hex values, written the way intToHex() writes them, become the bytes they stand for - halving them in place
+	int32_t numHexChars = length - 2;
+	bool isHex = (numHexChars >= kMinNumHexCharsToConvert && !(numHexChars & 1) && data[0] == '0' && data[1] == 'x');
+	for (int32_t i = 2; isHex && i < length; i++) {
+		isHex = isUppercaseHexChar(data[i]);
+	}
+	if (isHex) {
+		length = numHexChars >> 1;
+		for (int32_t i = 0; i < length; i++) {
+			data[i] = (hexCharToNibble(data[2 + i * 2]) << 4) | hexCharToNibble(data[3 + i * 2]);
+		}
+		output[tokenStartPos] = (uint8_t)TokenType::HEX_VALUE;
+		outputPos = tokenDataStartPos + length;
+	}
+
+	if (output[tokenStartPos + 1] == kLongLength) {
+		for (int32_t b = 0; b < 4; b++) {
+			output[tokenStartPos + 2 + b] = length >> (b * 8);
+		}
+	}
+	else {
+		output[tokenStartPos + 1] = length;
+	}
+	tokenStartPos = -1;
+	return isHex || put(0);
+}
+
+bool Builder::endTag() {
+	if (--tagDepth < 0) {
+		return giveUp();
+	}
+	state = State::SKIPPING_TO_CLOSING_BRACKET;
+	return put((uint8_t)TokenType::END);
+}
+
+// What follows an opening tag, up until the next '<', might be its value
+bool Builder::beginText() {
+	state = State::BETWEEN_TAGS;
+	return beginToken(TokenType::VALUE);
+}
+
+bool Builder::feed(char const* xml, int32_t length) {
+	char const* pos = xml;
+	char const* end = xml + length;
+
+	while (pos < end) {
+		char const* runEnd = end;
+
+		switch (state) {
+		case State::BETWEEN_TAGS:
+			runEnd = XMLScanner::findChar(pos, end, '<');
+			if (tokenStartPos != -1 && !appendToToken(pos, runEnd - pos)) {
+				return false;
+			}
+			if (runEnd < end) {
+				state = State::AFTER_OPENING_BRACKET;
+				runEnd++;
+			}
+			break;
+
+		case State::AFTER_OPENING_BRACKET:
+			runEnd = pos + 1;
+			if (*pos == '/') {
+				if (tokenStartPos != -1) {
+					if (outputPos == tokenDataStartPos) {
+						abandonToken();
+					}
+					else if (!endValue()) {
+						return false;
+					}
+				}
+				if (!endTag()) {
+					return false;
+				}
+			}
+			else if (*pos == '?') {
+				abandonToken();
+				state = State::SKIPPING_TO_CLOSING_BRACKET;
+			}
+			else if (XMLScanner::isWhitespace(*pos) || *pos == '<' || *pos == '>' || *pos == '=') {
+				return giveUp();
+			}
+			else {
+				// Whatever was since the last tag was just whitespace
+				abandonToken();
+				tagDepth++;
+				if (!beginToken(TokenType::TAG)) {
+					return false;
+				}
+				state = State::IN_TAG_NAME;
+				runEnd = pos; // The name starts here
+			}
+			break;
+
+		case State::IN_TAG_NAME:
+			runEnd = XMLScanner::findTagNameEnd(pos, end);
+			if (!appendToToken(pos, runEnd - pos)) {
+				return false;
+			}
+			if (runEnd < end) {
+				if (*runEnd == '?' || !endName()) {
+					return giveUp();
+				}
+				if (*runEnd == '>') {
+					if (!beginText()) {
+						return false;
+					}
+				}
+				else if (*runEnd == '/') {
+					if (!endTag()) {
+						return false;
+					}
+				}
+				else {
+					state = State::IN_TAG;
+				}
+				runEnd++;
+			}
+			break;
+
+		case State::IN_TAG:
+			runEnd = XMLScanner::skipWhitespace(pos, end);
+			if (runEnd < end) {
+				if (*runEnd == '>') {
+					if (!beginText()) {
+						return false;
+					}
+					runEnd++;
+				}
+				else if (*runEnd == '/') {
+					if (!endTag()) {
+						return false;
+					}
+					runEnd++;
+				}
+				else if (*runEnd == '<' || *runEnd == '=' || *runEnd == '"' || *runEnd == '\'') {
+					return giveUp();
+				}
+				else {
+					if (!beginToken(TokenType::ATTRIBUTE)) {
+						return false;
+					}
+					state = State::IN_ATTRIBUTE_NAME;
+				}
+			}
+			break;
+
+		case State::IN_ATTRIBUTE_NAME:
+			runEnd = XMLScanner::findAttributeNameEnd(pos, end);
+			if (!appendToToken(pos, runEnd - pos)) {
+				return false;
+			}
+			if (runEnd < end) {
+				if (*runEnd == '>' || !endName()) {
+					return giveUp();
+				}
+				state = (*runEnd == '=') ? State::BEFORE_QUOTE : State::BEFORE_EQUALS_SIGN;
+				runEnd++;
+			}
+			break;
+
+		case State::BEFORE_EQUALS_SIGN:
+			runEnd = XMLScanner::skipWhitespace(pos, end);
+			if (runEnd < end) {
+				if (*runEnd != '=') {
+					return giveUp();
+				}
+				state = State::BEFORE_QUOTE;
+				runEnd++;
+			}
+			break;
+
+		case State::BEFORE_QUOTE:
+			runEnd = XMLScanner::skipWhitespace(pos, end);
+			if (runEnd < end) {
+				if (*runEnd != '"' && *runEnd != '\'') {
+					return giveUp();
+				}
+				quoteChar = *runEnd;
+				if (!beginToken(TokenType::VALUE)) {
+					return false;
+				}
+				state = State::IN_ATTRIBUTE_VALUE;
+				runEnd++;
+			}
+			break;
+
+		case State::IN_ATTRIBUTE_VALUE:
+			runEnd = XMLScanner::findChar(pos, end, quoteChar);
+			if (!appendToToken(pos, runEnd - pos)) {
+				return false;
+			}
+			if (runEnd < end) {
+				if (!endValue()) {
+					return false;
+				}
+				state = State::IN_TAG;
+				runEnd++;
+			}
+			break;
+
+		case State::SKIPPING_TO_CLOSING_BRACKET:
+			runEnd = XMLScanner::findChar(pos, end, '>');
+			if (runEnd < end) {
+				state = State::BETWEEN_TAGS;
+				runEnd++;
+			}
+			break;
+
+		case State::GAVE_UP:
+			return false;
+		}
+
+		pos = runEnd;
+	}
+
+	return (state != State::GAVE_UP);
+}
+
+int32_t Builder::finish() {
+	if (state != State::BETWEEN_TAGS || tagDepth) {
+		return -1;
+	}
+	abandonToken(); // Anything after the last tag
+	return outputPos;
+}
+
+} // namespace XMLSnapshot
@@ -0,0 +1,106 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+// A snapshot of a song or preset file: the same tags, attributes and values as its XML, but already split up, so that
+// SnapshotDeserializer can hand them out without parsing anything - and with long hex values, like noteData, already
+// turned into the bytes they stand for.
+//
+// Each token is a TokenType byte, then:
+//	TAG, ATTRIBUTE: the name's length, then the name and a null char
+//	VALUE:          the value's length, then the value and a null char
+//	HEX_VALUE:      the number of bytes, then the bytes the hex chars after the value's "0x" stand for
+//	END:            nothing. Ends a tag, whether that was with </name> or />
+// Lengths are one byte if under 255, or otherwise 255 and then four little-endian bytes.
+//
+// Whitespace between tags is left out. Otherwise, a snapshot holds everything XMLDeserializer would have read.
+namespace XMLSnapshot {
+
+enum class TokenType : uint8_t { TAG, ATTRIBUTE, VALUE, HEX_VALUE, END };
+
+// Shorter hex values than this stay as text - for numbers and colours it's not worth it
+constexpr int32_t kMinNumHexCharsToConvert = 16;
+
+constexpr int32_t kMaxNameLength = 254;
+
+struct Token {
+	TokenType type;
+	uint8_t const* data; // For TAG, ATTRIBUTE and VALUE, a null-terminated string
+	int32_t length;
+};
+
+// Reads the token at pos, which must be before end. Returns where the next one starts - or nullptr if the snapshot's
+// broken
+uint8_t const* readToken(uint8_t const* pos, uint8_t const* end, Token* token);
+
+// FNV-1a, to tell whether a snapshot's come back from the card as it went on
+uint32_t getHash(uint8_t const* data, int32_t length);
+
+// Turns XML into a snapshot, fed through a bit at a time. Gives up if the XML's anything but the sort XMLSerializer
+// writes, or the snapshot won't fit in the output it's given - which, since a snapshot's never much bigger than its
+// XML, only happens with odd files
+class Builder {
+public:
+	Builder(uint8_t* newOutput, int32_t newMaxSize) : output(newOutput), maxSize(newMaxSize) {}
+
+	// Returns false once it's given up
+	bool feed(char const* xml, int32_t length);
+
+	// Returns the size of the finished snapshot - or -1 if the XML stopped part way through, or it gave up earlier
+	int32_t finish();
+
+private:
+	enum class State : uint8_t {
+		BETWEEN_TAGS,
+		AFTER_OPENING_BRACKET,
+		IN_TAG_NAME,
+		IN_TAG,
+		IN_ATTRIBUTE_NAME,
+		BEFORE_EQUALS_SIGN,
+		BEFORE_QUOTE,
+		IN_ATTRIBUTE_VALUE,
+		SKIPPING_TO_CLOSING_BRACKET,
+		GAVE_UP,
+	};
+
+	bool giveUp();
+	bool put(uint8_t byte);
+	bool beginToken(TokenType type);
+	bool appendToToken(char const* chars, int32_t numChars);
+	void abandonToken();
+	bool endName();
+	bool endValue();
+	bool endTag();
+	bool beginText();
+
+	uint8_t* output;
+	int32_t maxSize;
+	int32_t outputPos = 0;
+
+	// The one being written, if any
+	int32_t tokenStartPos = -1;
+	int32_t tokenDataStartPos;
+
+	State state = State::BETWEEN_TAGS;
+	char quoteChar;
+	int32_t tagDepth = 0;
+};
+
+} // namespace XMLSnapshot
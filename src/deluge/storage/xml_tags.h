@@ -0,0 +1,313 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+
+// Turns the names of tags and attributes read from song and preset files into small IDs, so that readTagFromFile() and
+// friends can switch on them rather than strcmp()ing their way down a long chain of else-ifs. find() gets the ID of a
+// name just read from a file, with one hash lookup and one comparison; id() gets it for a name at compile time, for
+// the case labels:
+//
+//	switch (XMLTags::find(tagName)) {
+//	case XMLTags::id("osc1"): {
+//
+// The lookup table is a perfect hash of kNames, worked out by the compiler, so a new name just needs adding to kNames -
+// and if it isn't, id() won't compile
+namespace XMLTags {
+
+using Id = uint16_t;
+
+// What find() gives for names not in kNames
+constexpr Id kUnknown = 0;
+
+inline constexpr std::string_view kNames[] = {
+    "affectEntire",
+    "arpeggiator",
+    "arpeggiatorGate",
+    "arpeggiatorRate",
+    "audioCompressor",
+    "bendRange",
+    "bendRangeMPE",
+    "bitCrush",
+    "carrier1Feedback",
+    "carrier2Feedback",
+    "cents",
+    "channelPressure",
+    "clippingAmount",
+    "colourOffset",
+    "compressor",
+    "compressorShape",
+    "compressorThreshold",
+    "continuous",
+    "crossScreenEditLevel",
+    "cvChannel",
+    "defaultParams",
+    "delay",
+    "delayFeedback",
+    "delayRate",
+    "drumIndex",
+    "drumsEdgeSize",
+    "drumsScrollOffset",
+    "envelope1",
+    "envelope2",
+    "equalizer",
+    "expressionData",
+    "fileName",
+    "filterRoute",
+    "fx",
+    "gateOutput",
+    "hpf",
+    "hpfFrequency",
+    "hpfMode",
+    "hpfMorph",
+    "hpfResonance",
+    "inKeyMode",
+    "inKeyRowInterval",
+    "inKeyScrollOffset",
+    "instrument",
+    "instrumentPresetFolder",
+    "instrumentPresetName",
+    "instrumentPresetSlot",
+    "instrumentPresetSubSlot",
+    "keyboardLayout",
+    "keyboardRowInterval",
+    "kit",
+    "kitParams",
+    "lastSelectedInstrumentType",
+    "lastSelectedParamArrayPosition",
+    "lastSelectedParamID",
+    "lastSelectedParamKind",
+    "lastSelectedParamShortcutX",
+    "lastSelectedParamShortcutY",
+    "lastSelectedPatchSource",
+    "length",
+    "lfo1",
+    "lfo1Rate",
+    "lfo2",
+    "lfo2Rate",
+    "lpf",
+    "lpfFrequency",
+    "lpfMode",
+    "lpfMorph",
+    "lpfResonance",
+    "maxVoices",
+    "midiBank",
+    "midiChannel",
+    "midiChannelSuffix",
+    "midiKnobs",
+    "midiPGM",
+    "midiParams",
+    "midiSub",
+    "mod1PitchAdjust",
+    "mod2PitchAdjust",
+    "modFXDepth",
+    "modFXFeedback",
+    "modFXOffset",
+    "modFXRate",
+    "modFXType",
+    "modKnobs",
+    "mode",
+    "modulator1",
+    "modulator1Amount",
+    "modulator1Feedback",
+    "modulator2",
+    "modulator2Amount",
+    "modulator2Feedback",
+    "muteMidiCommand",
+    "muted",
+    "noiseVolume",
+    "noteData",
+    "noteDataWithLift",
+    "noteRows",
+    "notes",
+    "onAutomationInstrumentClipView",
+    "onKeyboardScreen",
+    "osc1",
+    "osc2",
+    "oscAPitchAdjust",
+    "oscAPulseWidth",
+    "oscAVolume",
+    "oscAWavetablePosition",
+    "oscBPitchAdjust",
+    "oscBPulseWidth",
+    "oscBVolume",
+    "oscBWavetablePosition",
+    "oscillatorA",
+    "oscillatorB",
+    "oscillatorReset",
+    "pan",
+    "patchCables",
+    "pitchAdjust",
+    "pitchBend",
+    "polyphonic",
+    "portamento",
+    "ratchetAmount",
+    "ratchetProbability",
+    "reverbAmount",
+    "reversed",
+    "rhythm",
+    "ringMod",
+    "sampleRateReduction",
+    "sequenceDirection",
+    "sequenceLength",
+    "sideChainSend",
+    "sidechain",
+    "sound",
+    "soundMidiCommand",
+    "soundParams",
+    "stutterRate",
+    "synth",
+    "transpose",
+    "unison",
+    "voicePriority",
+    "volume",
+    "waveFold",
+    "y",
+    "yExpression",
+    "yScroll",
+    "yScrollKeyboard",
+    "zone",
+};
+
+constexpr int32_t kNumNames = std::size(kNames);
+
+namespace detail {
+
+// Two or so names per bucket, and each bucket gets its own seed which sends its names to slots no other name has
+// taken. With four times as many slots as names, seeds which do that are quick to come by
+constexpr uint32_t kNumBuckets = std::bit_ceil((uint32_t)kNumNames) / 2;
+constexpr uint32_t kNumSlots = std::bit_ceil((uint32_t)kNumNames) * 4;
+
+constexpr uint32_t kHashStart = 2166136261u;
+
+// FNV-1a, a char at a time
+constexpr uint32_t hashChar(uint32_t hash, char thisChar) {
+	return (hash ^ (uint8_t)thisChar) * 16777619u;
+}
+
+constexpr uint32_t mix(uint32_t hash) {
+	hash ^= hash >> 16;
+	hash *= 0x7FEB352Du;
+	hash ^= hash >> 15;
+	hash *= 0x846CA68Bu;
+	hash ^= hash >> 16;
+	return hash;
+}
+
+constexpr uint32_t getBucket(uint32_t hash) {
+	return mix(hash) & (kNumBuckets - 1);
+}
+
+constexpr uint32_t getSlot(uint32_t hash, uint16_t seed) {
+	return mix(hash ^ (seed * 0x9E3779B9u)) & (kNumSlots - 1);
+}
+
+struct Table {
+	std::array<uint16_t, kNumBuckets> seeds{};
+	std::array<Id, kNumSlots> ids{};
+};
+
+// Not constexpr, so if makeTable() ever gets here, it won't compile
+void twoNamesInKNamesHashTheSame();
+
+constexpr Table makeTable() {
+	Table table;
+	std::array<uint32_t, kNumNames> hashes{};
+	std::array<int32_t, kNumBuckets> bucketSizes{};
+	int32_t biggestBucketSize = 0;
+	for (int32_t i = 0; i < kNumNames; i++) {
+		uint32_t hash = kHashStart;
+		for (char thisChar : kNames[i]) {
+			hash = hashChar(hash, thisChar);
+		}
+		hashes[i] = hash;
+		biggestBucketSize = std::max(biggestBucketSize, ++bucketSizes[getBucket(hash)]);
+	}
+
+	// Biggest buckets first, while there are the most slots free
+	std::array<uint32_t, kNumNames> slotsTaken{};
+	for (int32_t size = biggestBucketSize; size > 0; size--) {
+		for (uint32_t b = 0; b < kNumBuckets; b++) {
+			if (bucketSizes[b] != size) {
+				continue;
+			}
+			for (uint16_t seed = 1;; seed++) {
+				if (!seed) {
+					twoNamesInKNamesHashTheSame();
+				}
+				int32_t numSlotsTaken = 0;
+				bool fits = true;
+				for (int32_t i = 0; i < kNumNames && fits; i++) {
+					if (getBucket(hashes[i]) == b) {
+						uint32_t slot = getSlot(hashes[i], seed);
+						fits = (table.ids[slot] == kUnknown);
+						if (fits) {
+							table.ids[slot] = i + 1;
+							slotsTaken[numSlotsTaken++] = slot;
+						}
+					}
+				}
+				if (fits) {
+					table.seeds[b] = seed;
+					break;
+				}
+				while (numSlotsTaken) {
+					table.ids[slotsTaken[--numSlotsTaken]] = kUnknown;
+				}
+			}
+		}
+	}
+	return table;
+}
+
+inline constexpr Table table = makeTable();
+
+// Not constexpr, so a name passed to id() which isn't in kNames won't compile
+void nameIsNotInKNames();
+
+} // namespace detail
+
+constexpr Id find(char const* name) {
+	uint32_t hash = detail::kHashStart;
+	size_t length = 0;
+	for (; name[length]; length++) {
+		hash = detail::hashChar(hash, name[length]);
+	}
+	Id id = detail::table.ids[detail::getSlot(hash, detail::table.seeds[detail::getBucket(hash)])];
+	if (id == kUnknown || kNames[id - 1] != std::string_view(name, length)) {
+		return kUnknown;
+	}
+	return id;
+}
+
+consteval Id id(std::string_view name) {
+	for (int32_t i = 0; i < kNumNames; i++) {
+		if (kNames[i] == name) {
+			return i + 1;
+		}
+	}
+	detail::nameIsNotInKNames();
+	return kUnknown;
+}
+
+} // namespace XMLTags
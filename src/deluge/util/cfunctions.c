@@ -33,6 +33,12 @@ int32_t getNumDecimalDigits(uint32_t number) {
 	return totalNumDigits;
 }
 
+static const char digitPairs[] = "0001020304050607080910111213141516171819"
+                                 "2021222324252627282930313233343536373839"
+                                 "4041424344454647484950515253545556575859"
+                                 "6061626364656667686970717273747576777879"
+                                 "8081828384858687888990919293949596979899";
+
 void intToString(int32_t number, char* __restrict__ buffer, int32_t minNumDigits) {
 
 	int32_t isNegative = (number < 0);
@@ -54,14 +60,19 @@ void intToString(int32_t number, char* __restrict__ buffer, int32_t minNumDigits
 
 	buffer[totalNumDigits] = 0;
 	int32_t charPos = totalNumDigits - 1;
-	while (1) {
-		if (charPos == isNegative) {
-			buffer[charPos] = '0' + number;
-			break;
-		}
-		int32_t divided = (uint32_t)number / 10;
-		buffer[charPos--] = '0' + (number - (divided * 10));
-		number = divided;
+	uint32_t remaining = number;
+
+	// Two digits at a time, while there's room for two
+	while (charPos > isNegative) {
+		uint32_t divided = remaining / 100;
+		char const* digits = &digitPairs[(remaining - divided * 100) * 2];
+		buffer[charPos] = digits[1];
+		buffer[charPos - 1] = digits[0];
+		remaining = divided;
+		charPos -= 2;
+	}
+	if (charPos == isNegative) {
+		buffer[charPos] = '0' + remaining;
 	}
 }
 
@@ -0,0 +1,164 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/// Binary heap of pointers to T, where each T stores its own key and its own position in the heap. Storing the
+/// position means an element can be found, removed, or have its key changed in O(log n) without searching for it.
+///
+/// The element which Precedes all others (by default the one with the biggest key) is at top(). After changing an
+/// element's key, call update() on it. An element's index member is -1 whenever it's not in a heap, and must be
+/// initialised that way.
+///
+/// Container can be anything vector-like, e.g. a deluge::static_vector where the maximum size is known and allocating
+/// isn't wanted.
+template <typename T, typename Key, Key T::*key, int32_t T::*heapIndex, typename Precedes = std::greater<Key>,
+          typename Container = std::vector<T*>>
+class IntrusiveHeap {
+public:
+	IntrusiveHeap() = default;
+	IntrusiveHeap(const IntrusiveHeap&) = delete;
+	IntrusiveHeap& operator=(const IntrusiveHeap&) = delete;
+
+	[[nodiscard]] bool empty() const { return elements_.empty(); }
+	[[nodiscard]] size_t size() const { return elements_.size(); }
+	[[nodiscard]] size_t capacity() const { return elements_.capacity(); }
+	void reserve(size_t n) { elements_.reserve(n); }
+	[[nodiscard]] T* top() const { return elements_.empty() ? nullptr : elements_.front(); }
+	[[nodiscard]] T* at(size_t i) const { return elements_[i]; }
+	[[nodiscard]] static bool contains(const T* element) { return element->*heapIndex >= 0; }
+
+	void push(T* element) {
+		elements_.push_back(element);
+		element->*heapIndex = elements_.size() - 1;
+		siftUp(elements_.size() - 1);
+	}
+
+	T* pop() {
+		T* element = top();
+		if (element) {
+			remove(element);
+		}
+		return element;
+	}
+
+	void remove(T* element) {
+		int32_t i = element->*heapIndex;
+		if (i < 0) {
+			return;
+		}
+		element->*heapIndex = -1;
+
+		T* last = elements_.back();
+		elements_.pop_back();
+		if (last != element) {
+			place(last, i);
+			restore(i);
+		}
+	}
+
+	/// Call after element's key has changed
+	void update(T* element) {
+		int32_t i = element->*heapIndex;
+		if (i >= 0) {
+			restore(i);
+		}
+	}
+
+	void clear() {
+		for (T* element : elements_) {
+			element->*heapIndex = -1;
+		}
+		elements_.clear();
+	}
+
+	/// Calls f on every element whose key Precedes bound, in no particular order. Only looks at those elements and
+	/// their immediate children, so this is cheap when few elements qualify. f mustn't modify the heap
+	template <typename F>
+	void forEachPreceding(const Key& bound, F&& f) const {
+		visitPreceding(0, bound, f);
+	}
+
+private:
+	template <typename F>
+	void visitPreceding(size_t i, const Key& bound, F& f) const {
+		if (i >= elements_.size() || !Precedes{}(elements_[i]->*key, bound)) {
+			return;
+		}
+		f(elements_[i]);
+		visitPreceding(2 * i + 1, bound, f);
+		visitPreceding(2 * i + 2, bound, f);
+	}
+
+	bool precedes(size_t a, size_t b) const { return Precedes{}(elements_[a]->*key, elements_[b]->*key); }
+
+	void place(T* element, size_t i) {
+		elements_[i] = element;
+		element->*heapIndex = i;
+	}
+
+	void swap(size_t a, size_t b) {
+		T* elementA = elements_[a];
+		place(elements_[b], a);
+		place(elementA, b);
+	}
+
+	void restore(size_t i) {
+		if (i > 0 && precedes(i, (i - 1) / 2)) {
+			siftUp(i);
+		}
+		else {
+			siftDown(i);
+		}
+	}
+
+	void siftUp(size_t i) {
+		while (i > 0) {
+			size_t parent = (i - 1) / 2;
+			if (!precedes(i, parent)) {
+				break;
+			}
+			swap(i, parent);
+			i = parent;
+		}
+	}
+
+	void siftDown(size_t i) {
+		size_t n = elements_.size();
+		while (true) {
+			size_t best = i;
+			size_t child = 2 * i + 1;
+			if (child < n && precedes(child, best)) {
+				best = child;
+			}
+			if (child + 1 < n && precedes(child + 1, best)) {
+				best = child + 1;
+			}
+			if (best == i) {
+				break;
+			}
+			swap(i, best);
+			i = best;
+		}
+	}
+
+	Container elements_;
+};
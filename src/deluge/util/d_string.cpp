@@ -345,7 +345,7 @@ char hexCharToHalfByte(unsigned char hexChar) {
 void intToHex(uint32_t number, char* output, int32_t numChars) {
 	output[numChars] = 0;
 	for (int32_t i = numChars - 1; i >= 0; i--) {
-		output[i] = halfByteToHexChar(number & 15);
+		output[i] = "0123456789ABCDEF"[number & 15];
 		number >>= 4;
 	}
 }
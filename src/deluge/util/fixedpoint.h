@@ -16,6 +16,7 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 // signed 31 fractional bits (e.g. one would be 1<<31 but can't be represented)
 using q31_t = int32_t;
@@ -92,30 +93,32 @@ static inline q31_t multiply_32x32_rshift32(q31_t a, q31_t b) {
 // This multiplies two numbers in signed Q31 fixed point and rounds the result
 
 static inline q31_t multiply_32x32_rshift32_rounded(q31_t a, q31_t b) {
-	return (q31_t)(((int64_t)a * (int64_t)b) >> 32);
+	return (q31_t)(((int64_t)a * (int64_t)b + 0x80000000) >> 32);
 }
 
 // Multiplies A and B, adds to sum, and returns output
 
 static inline q31_t multiply_accumulate_32x32_rshift32_rounded(q31_t sum, q31_t a, q31_t b) {
-	return sum + (q31_t)(((int64_t)a * (int64_t)b) >> 32);
+	return (q31_t)((((uint64_t)(uint32_t)sum << 32) + (uint64_t)((int64_t)a * (int64_t)b) + 0x80000000) >> 32);
 }
 
 // Multiplies A and B, subtracts from sum, and returns output
 
 static inline q31_t multiply_subtract_32x32_rshift32_rounded(q31_t sum, q31_t a, q31_t b) {
-	return sum - (q31_t)(((int64_t)a * (int64_t)b) >> 32);
+	return (q31_t)((((uint64_t)(uint32_t)sum << 32) - (uint64_t)((int64_t)a * (int64_t)b) + 0x80000000) >> 32);
 }
 
 // computes limit((val >> rshift), 2**bits)
 template <uint8_t bits>
 static inline int32_t signed_saturate(int32_t val) {
-	return std::min(val, 1 << bits);
+	constexpr int64_t limit = int64_t{1} << (bits - 1);
+	return (int32_t)std::clamp<int64_t>(val, -limit, limit - 1);
 }
 
 static inline int32_t add_saturation(int32_t a, int32_t b) __attribute__((always_inline, unused));
 static inline int32_t add_saturation(int32_t a, int32_t b) {
-	return a + b;
+	int32_t out;
+	return __builtin_add_overflow(a, b, &out) ? (a < 0 ? INT32_MIN : INT32_MAX) : out;
 }
 
 inline int32_t clz(uint32_t input) {
@@ -408,15 +408,30 @@ void dissectIterationDependence(int32_t probability, int32_t* getDivisor, int32_
 int32_t encodeIterationDependence(int32_t divisor, int32_t iterationWithinDivisor);
 
 [[gnu::always_inline]] inline uint32_t swapEndianness32(uint32_t input) {
+#if defined(__arm__)
 	int32_t out;
 	asm("rev %0, %1" : "=r"(out) : "r"(input));
 	return out;
+#else
+	return __builtin_bswap32(input);
+#endif
+}
+
+// For the big-endian numbers which songs and presets store in their hex values
+[[gnu::always_inline]] inline uint32_t readBigEndian32(uint8_t const* bytes) {
+	uint32_t value;
+	memcpy(&value, bytes, sizeof(value));
+	return swapEndianness32(value);
 }
 
 [[gnu::always_inline]] inline uint32_t swapEndianness2x16(uint32_t input) {
+#if defined(__arm__)
 	int32_t out;
 	asm("rev16 %0, %1" : "=r"(out) : "r"(input));
 	return out;
+#else
+	return ((input & 0x00FF00FF) << 8) | ((input >> 8) & 0x00FF00FF);
+#endif
 }
 
 [[gnu::always_inline]] inline int32_t getMagnitudeOld(uint32_t input) {
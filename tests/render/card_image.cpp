@@ -0,0 +1,192 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "card_image.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <unistd.h>
+
+extern "C" {
+#include "fatfs/ff.h"
+}
+
+namespace CardImage {
+
+namespace {
+
+// FatFS is built without f_mkfs(), so this lays out the volume itself - the same way a card formatted for the Deluge
+// usually is, with 32kB Clusters
+constexpr uint32_t kSectorSize = 512;
+constexpr uint32_t kSectorsPerCluster = 64;
+constexpr uint32_t kClusterSize = kSectorSize * kSectorsPerCluster;
+constexpr uint32_t kNumReservedSectors = 32;
+constexpr uint32_t kNumFats = 2;
+constexpr uint32_t kFsInfoSector = 1;
+constexpr uint32_t kBackupBootSector = 6;
+constexpr uint32_t kRootDirCluster = 2;
+// Fewer than 65526 Clusters and it'd have to be FAT16. The volume is sparse, so being bigger costs nothing
+constexpr uint64_t kMinNumClusters = 131072;
+
+void put16(uint8_t* to, uint16_t value) {
+	to[0] = value;
+	to[1] = value >> 8;
+}
+
+void put32(uint8_t* to, uint32_t value) {
+	put16(to, value);
+	put16(to + 2, value >> 16);
+}
+
+bool writeSector(int fd, uint32_t sector, uint8_t const* data) {
+	return pwrite(fd, data, kSectorSize, (off_t)sector * kSectorSize) == kSectorSize;
+}
+
+bool writeBootSectors(int fd, uint32_t numSectors, uint32_t fatSize) {
+	uint8_t boot[kSectorSize] = {0xEB, 0x58, 0x90};
+	memcpy(&boot[3], "MSWIN4.1", 8);
+	put16(&boot[11], kSectorSize);
+	boot[13] = kSectorsPerCluster;
+	put16(&boot[14], kNumReservedSectors);
+	boot[16] = kNumFats;
+	boot[21] = 0xF8; // Fixed disk
+	put16(&boot[24], 63);
+	put16(&boot[26], 255);
+	put32(&boot[32], numSectors);
+	put32(&boot[36], fatSize);
+	put32(&boot[44], kRootDirCluster);
+	put16(&boot[48], kFsInfoSector);
+	put16(&boot[50], kBackupBootSector);
+	boot[64] = 0x80;
+	boot[66] = 0x29;
+	put32(&boot[67], 0x44454C55);
+	memcpy(&boot[71], "NO NAME    FAT32   ", 19);
+	put16(&boot[510], 0xAA55);
+
+	uint8_t fsInfo[kSectorSize] = {0};
+	put32(&fsInfo[0], 0x41615252);
+	put32(&fsInfo[484], 0x61417272);
+	put32(&fsInfo[488], 0xFFFFFFFF); // Free count and next free Cluster unknown, so FatFS works them out
+	put32(&fsInfo[492], 0xFFFFFFFF);
+	put32(&fsInfo[508], 0xAA550000);
+
+	return writeSector(fd, 0, boot) && writeSector(fd, kFsInfoSector, fsInfo)
+	       && writeSector(fd, kBackupBootSector, boot) && writeSector(fd, kBackupBootSector + kFsInfoSector, fsInfo);
+}
+
+bool writeFats(int fd, uint32_t fatSize) {
+	// Media type, then the end-of-chain marker for the reserved Cluster and the root directory
+	uint8_t firstSector[kSectorSize] = {0};
+	put32(&firstSector[0], 0x0FFFFFF8);
+	put32(&firstSector[4], 0x0FFFFFFF);
+	put32(&firstSector[8], 0x0FFFFFFF);
+	for (uint32_t i = 0; i < kNumFats; i++) {
+		if (!writeSector(fd, kNumReservedSectors + i * fatSize, firstSector)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool copyFileIn(std::filesystem::path const& from, std::string const& to) {
+	std::ifstream in(from, std::ios::binary);
+	FIL file;
+	if (!in || f_open(&file, to.c_str(), FA_CREATE_ALWAYS | FA_WRITE) != FR_OK) {
+		return false;
+	}
+	std::vector<char> buffer(kClusterSize);
+	bool success = true;
+	while (success && in) {
+		in.read(buffer.data(), buffer.size());
+		UINT numBytesWritten;
+		success = (f_write(&file, buffer.data(), in.gcount(), &numBytesWritten) == FR_OK
+		           && numBytesWritten == in.gcount());
+	}
+	return (f_close(&file) == FR_OK) && success;
+}
+
+} // namespace
+
+int makeEmpty(uint64_t numBytes) {
+	// With a quarter as much again, and a good 1GB, for whatever gets written while rendering
+	uint64_t numClusters = std::max(kMinNumClusters, numBytes / kClusterSize * 5 / 4 + 32768);
+	uint32_t fatSize = ((numClusters + 2) * 4 + kSectorSize - 1) / kSectorSize;
+	uint64_t numSectors = kNumReservedSectors + kNumFats * fatSize + numClusters * kSectorsPerCluster;
+	if (numSectors > UINT32_MAX) {
+		return -1;
+	}
+
+	FILE* image = tmpfile(); // Left open til the end - closing it would delete it
+	if (!image) {
+		return -1;
+	}
+	int fd = fileno(image);
+	if (ftruncate(fd, (off_t)numSectors * kSectorSize) || !writeBootSectors(fd, numSectors, fatSize)
+	    || !writeFats(fd, fatSize)) {
+		fclose(image);
+		return -1;
+	}
+	return fd;
+}
+
+bool copyIn(std::filesystem::path const& folder) {
+	std::error_code error;
+	for (auto it = std::filesystem::recursive_directory_iterator(folder, error);
+	     !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+		std::string cardPath = it->path().lexically_relative(folder).generic_string();
+		if (it->is_directory()) {
+			FRESULT result = f_mkdir(cardPath.c_str());
+			if (result != FR_OK && result != FR_EXIST) {
+				fprintf(stderr, "couldn't make folder %s on card\n", cardPath.c_str());
+				return false;
+			}
+		}
+		else if (it->is_regular_file() && !copyFileIn(it->path(), cardPath)) {
+			fprintf(stderr, "couldn't copy %s to card\n", cardPath.c_str());
+			return false;
+		}
+	}
+	if (error) {
+		fprintf(stderr, "couldn't read %s: %s\n", folder.c_str(), error.message().c_str());
+	}
+	return !error;
+}
+
+bool copyOut(char const* cardPath, std::filesystem::path const& hostPath) {
+	FIL file;
+	if (f_open(&file, cardPath, FA_READ) != FR_OK) {
+		return false;
+	}
+	std::ofstream out(hostPath, std::ios::binary);
+	std::vector<char> buffer(kClusterSize);
+	UINT numBytesRead = 0;
+	FRESULT result = FR_OK;
+	bool success = bool(out);
+	while (success) {
+		result = f_read(&file, buffer.data(), buffer.size(), &numBytesRead);
+		if (result != FR_OK || !numBytesRead) {
+			break;
+		}
+		success = bool(out.write(buffer.data(), numBytesRead));
+	}
+	f_close(&file);
+	return success && result == FR_OK && bool(out.flush());
+}
+
+} // namespace CardImage
@@ -0,0 +1,35 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+namespace CardImage {
+
+/// Make an empty FAT32 volume, big enough to take numBytes of files plus plenty of room to write, in a temporary file
+/// which goes away when it's closed. Returns its file descriptor, or -1 if it couldn't be made
+int makeEmpty(uint64_t numBytes);
+
+/// Copy everything inside folder onto the mounted card, keeping the same paths below its root
+bool copyIn(std::filesystem::path const& folder);
+
+/// Copy the file at cardPath on the mounted card to hostPath
+bool copyOut(char const* cardPath, std::filesystem::path const& hostPath);
+
+} // namespace CardImage
@@ -0,0 +1,222 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "definitions_cxx.hpp"
+#include <cstdio>
+#include <cstring>
+
+// The hardware the firmware talks to, as a Deluge with nothing plugged in but headphones, and nobody touching it
+
+extern "C" {
+#include "RZA1/compiler/asm/inc/asm.h"
+#include "RZA1/gpio/gpio.h"
+#include "RZA1/intc/devdrv_intc.h"
+#include "RZA1/oled/oled_low_level.h"
+#include "RZA1/rspi/rspi.h"
+#include "RZA1/spibsc/r_spibsc_flash_api.h"
+#include "RZA1/spibsc/spibsc_Deluge_setup.h"
+#include "RZA1/system/rza_io_regrw.h"
+#include "RZA1/uart/sio_char.h"
+#include "drivers/oled/oled.h"
+#include "drivers/rspi/rspi.h"
+#include "drivers/ssi/ssi.h"
+
+// GPIO. Inputs read high - headphones in, no mic, encoders at rest - except line in, which is out
+
+void setPinMux(uint8_t p, uint8_t q, uint8_t mux) {
+}
+
+void setPinAsOutput(uint8_t p, uint8_t q) {
+}
+
+void setPinAsInput(uint8_t p, uint8_t q) {
+}
+
+void setOutputState(uint8_t p, uint8_t q, uint16_t state) {
+}
+
+uint16_t readInput(uint8_t p, uint8_t q) {
+	return !(p == LINE_IN_DETECT.port && q == LINE_IN_DETECT.pin);
+}
+
+// diskio.c sets up the SD card's pins through these
+void RZA_IO_RegWrite_16(volatile uint16_t* ioreg, uint16_t write_value, uint16_t shift, uint16_t mask) {
+}
+
+uint16_t RZA_IO_RegRead_16(volatile uint16_t* ioreg, uint16_t shift, uint16_t mask) {
+	return 0;
+}
+
+// Interrupts, of which there are none
+
+volatile uint32_t intc_func_active = 0;
+
+int32_t R_INTC_Enable(uint16_t int_id) {
+	return 0;
+}
+
+int32_t R_INTC_Disable(uint16_t int_id) {
+	return 0;
+}
+
+void v7_dma_flush_range(uintptr_t start, uintptr_t end) {
+}
+
+// UARTs, to the PIC and MIDI. Anything sent goes nowhere, and nothing ever comes back. Their transmit buffers are only
+// written through their uncached mirror, so the linker places them where mocks/host_memory.cpp maps that
+
+struct UartItem uartItems[NUM_UART_ITEMS] = {0};
+
+uint32_t triggerClockRisingEdgeTimes[TRIGGER_CLOCK_INPUT_NUM_TIMES_STORED] = {0};
+uint32_t triggerClockRisingEdgesReceived = 0;
+uint32_t triggerClockRisingEdgesProcessed = 0;
+
+uint8_t uartGetChar(int32_t item, char* readData) {
+	return 0;
+}
+
+uint32_t* uartGetCharWithTiming(int32_t timingCaptureItem, char* readData) {
+	return nullptr;
+}
+
+void uartPutCharBack(int32_t item) {
+}
+
+void uartFlushIfNotSending(int32_t item) {
+	uartItems[item].txBufferReadPos = uartItems[item].txBufferWritePos;
+}
+
+int32_t uartGetTxBufferFullnessByItem(int32_t item) {
+	return 0;
+}
+
+int32_t uartGetTxBufferSpace(int32_t item) {
+	return (item == UART_ITEM_MIDI) ? MIDI_TX_BUFFER_SIZE : PIC_TX_BUFFER_SIZE;
+}
+
+void uartSetBaudRate(uint8_t scifID, uint32_t baudRate) {
+}
+
+void uartPrintln(char const* output) {
+	printf("%s\n", output);
+}
+
+void uartPrint(char const* output) {
+	printf("%s", output);
+}
+
+void uartPrintNumber(int32_t number) {
+	printf("%d\n", (int)number);
+}
+
+void uartPrintlnFloat(float number) {
+	printf("%f\n", number);
+}
+
+// The OLED and CV outputs, over SPI
+
+int oledWaitingForMessage = 256; // None
+volatile bool spiTransferQueueCurrentlySending = false;
+
+void oledMainInit() {
+}
+
+void oledDMAInit() {
+}
+
+void enqueueSPITransfer(int32_t whichOled, uint8_t const* image) {
+}
+
+void oledSelectingComplete() {
+}
+
+void oledDeselectionComplete() {
+}
+
+void oledLowLevelTimerCallback() {
+}
+
+void oledRoutine() {
+}
+
+void setupSPIInterrupts() {
+}
+
+void enqueueCVMessage(int channel, uint32_t message) {
+}
+
+void R_RSPI_Create(uint8_t channel, uint32_t bitRate, uint8_t phase, uint8_t dataSize) {
+}
+
+void R_RSPI_Start(uint8_t channel) {
+}
+
+void R_RSPI_SendBasic32(uint8_t channel, uint32_t data) {
+}
+
+// The audio codec. Its DMA never moves, so only OfflineRenderer::render() makes any audio
+
+int32_t ssiTxBuffer[SSI_TX_BUFFER_NUM_SAMPLES * NUM_MONO_OUTPUT_CHANNELS];
+int32_t ssiRxBuffer[SSI_RX_BUFFER_NUM_SAMPLES * NUM_MONO_INPUT_CHANNELS];
+
+void ssiInit(uint8_t ssiChannel, uint8_t dmaChannel) {
+}
+
+int32_t* getTxBufferStart() {
+	return &ssiTxBuffer[0];
+}
+
+int32_t* getTxBufferEnd() {
+	return &ssiTxBuffer[SSI_TX_BUFFER_NUM_SAMPLES * NUM_MONO_OUTPUT_CHANNELS];
+}
+
+int32_t* getRxBufferStart() {
+	return &ssiRxBuffer[0];
+}
+
+int32_t* getRxBufferEnd() {
+	return &ssiRxBuffer[SSI_RX_BUFFER_NUM_SAMPLES * NUM_MONO_INPUT_CHANNELS];
+}
+
+void* getTxBufferCurrentPlace() {
+	return getTxBufferStart();
+}
+
+void* getRxBufferCurrentPlace() {
+	return getRxBufferStart();
+}
+
+// The SPI flash the settings live in, as it comes erased - so the firmware starts from its default settings
+
+void initSPIBSC() {
+}
+
+int32_t R_SFLASH_EraseSector(uint32_t addr, uint32_t ch_no, uint32_t dual, uint8_t data_width, uint8_t addr_mode) {
+	return 0;
+}
+
+int32_t R_SFLASH_ByteProgram(uint32_t addr, uint8_t* buf, int32_t size, uint32_t ch_no, uint32_t dual,
+                             uint8_t data_width, uint8_t addr_mode) {
+	return 0;
+}
+
+int32_t R_SFLASH_ByteRead(uint32_t addr, uint8_t* buf, int32_t size, uint32_t ch_no, uint32_t dual, uint8_t data_width,
+                          uint8_t addr_mode) {
+	memset(buf, 0xFF, size);
+	return 0;
+}
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "host_memory.h"
+#include "RZA1/cpu_specific.h"
+#include "definitions.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/mman.h>
+#include <ucontext.h>
+
+// Placed by the linker - see CMakeLists.txt
+extern uint32_t __sdram_bss_end;
+extern uint32_t __heap_start;
+extern uint32_t program_stack_start;
+extern uint32_t program_stack_end;
+extern uint8_t picTxBuffer[];
+extern char midiTxBuffer[];
+
+namespace {
+
+void mapAt(uintptr_t start, uintptr_t end) {
+	void* address = mmap((void*)start, end - start, PROT_READ | PROT_WRITE,
+	                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE | MAP_NORESERVE, -1, 0);
+	if (address != (void*)start) {
+		fprintf(stderr, "couldn't map memory at 0x%08lx\n", (unsigned long)start);
+		exit(1);
+	}
+}
+
+// Before any static constructors, since the GeneralMemoryAllocator gives out this memory to some of them
+__attribute__((constructor(101))) void mapDelugeMemory() {
+	mapAt((uintptr_t)&__sdram_bss_end, EXTERNAL_MEMORY_END);
+	mapAt((uintptr_t)&__heap_start, (uintptr_t)&program_stack_end);
+	// The UART transmit buffers only get written through their uncached mirror
+	mapAt((uintptr_t)picTxBuffer + UNCACHED_MIRROR_OFFSET,
+	      (uintptr_t)midiTxBuffer + MIDI_TX_BUFFER_SIZE + UNCACHED_MIRROR_OFFSET);
+}
+
+ucontext_t hostContext;
+ucontext_t programContext;
+
+} // namespace
+
+void runOnProgramStack(void (*function)()) {
+	getcontext(&programContext);
+	programContext.uc_stack.ss_sp = &program_stack_start;
+	programContext.uc_stack.ss_size = (uintptr_t)&program_stack_end - (uintptr_t)&program_stack_start;
+	programContext.uc_link = &hostContext;
+	makecontext(&programContext, function, 0);
+	swapcontext(&hostContext, &programContext);
+}
@@ -0,0 +1,2 @@
+// The firmware declares these itself, for its own versions in c_lib_alternatives - here they're the C library's
+#include <string.h>
@@ -0,0 +1,31 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "NE10_dsp.h"
+
+// NE10's NEON FFTs are written for 32 bit ARM, so here the firmware's calls to them go to its plain C ones, which take
+// the same configurations
+
+void ne10_fft_r2c_1d_int32_neon(ne10_fft_cpx_int32_t* fout, ne10_int32_t* fin, ne10_fft_r2c_cfg_int32_t cfg,
+                                ne10_int32_t scaled_flag) {
+	ne10_fft_r2c_1d_int32_c(fout, fin, cfg, scaled_flag);
+}
+
+void ne10_fft_c2r_1d_int32_neon(ne10_int32_t* fout, ne10_fft_cpx_int32_t* fin, ne10_fft_r2c_cfg_int32_t cfg,
+                                ne10_int32_t scaled_flag) {
+	ne10_fft_c2r_1d_int32_c(fout, fin, cfg, scaled_flag);
+}
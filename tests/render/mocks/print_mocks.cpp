@@ -0,0 +1,65 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "io/debug/print.h"
+#include <cstdio>
+
+// What would go out over RTT or MIDI goes to stdout instead
+
+namespace Debug {
+
+MIDIDevice* midiDebugDevice = nullptr;
+
+void init() {
+}
+
+void println(char const* output) {
+	printf("%s\n", output);
+}
+
+void println(int32_t number) {
+	printf("%d\n", (int)number);
+}
+
+void print(char const* output) {
+	printf("%s", output);
+}
+
+void print(int32_t number) {
+	printf("%d", (int)number);
+}
+
+void printlnfloat(float number) {
+	printf("%f\n", number);
+}
+
+void printfloat(float number) {
+	printf("%f", number);
+}
+
+void printTaskStatistics() {
+}
+
+void printAttackHeadStatistics() {
+}
+
+} // namespace Debug
+
+// For the firmware's own printf()
+extern "C" void putchar_(char c) {
+	putchar(c);
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sd_card.h"
+#include "RZA1/sdhi/inc/sdif.h"
+#include <cstdint>
+#include <unistd.h>
+
+// Stands in for the SDHI driver underneath src/RZA1/diskio.c. Every transfer is done by the time the call returns, so
+// the asynchronous ones say they can't be started, and SDBlockDevice does them the synchronous way instead
+
+namespace {
+
+constexpr off_t kSectorSize = 512;
+
+int cardImage = -1;
+
+} // namespace
+
+void insertCardImage(int fd) {
+	cardImage = fd;
+}
+
+int sd_init(int sd_port, unsigned long base, void* workarea, int cd_port) {
+	return (cardImage >= 0) ? SD_OK : SD_ERR_NO_CARD;
+}
+
+int sd_cd_int(int sd_port, int enable, int (*callback)(int, int)) {
+	return SD_OK;
+}
+
+int sd_mount(int sd_port, unsigned long mode, unsigned long voltage) {
+	return (cardImage >= 0) ? SD_OK : SD_ERR_NO_CARD;
+}
+
+int sd_iswp(int sd_port) {
+	return 0;
+}
+
+int sd_read_sect(int sd_port, unsigned char* buff, unsigned long psn, long cnt) {
+	ssize_t numBytes = cnt * kSectorSize;
+	return (pread(cardImage, buff, numBytes, psn * kSectorSize) == numBytes) ? SD_OK : SD_ERR;
+}
+
+int sd_write_sect(int sd_port, unsigned char const* buff, unsigned long psn, long cnt, int writemode) {
+	ssize_t numBytes = cnt * kSectorSize;
+	return (pwrite(cardImage, buff, numBytes, psn * kSectorSize) == numBytes) ? SD_OK : SD_ERR;
+}
+
+int sd_read_sect_start(int sd_port, unsigned char* buff, unsigned long psn, long cnt) {
+	return SD_ERR_ILL_FUNC;
+}
+
+int sd_write_sect_start(int sd_port, unsigned char const* buff, unsigned long psn, long cnt, int writemode) {
+	return SD_ERR_ILL_FUNC;
+}
+
+int sd_sect_trns_ended(int sd_port) {
+	return 1;
+}
+
+int sd_sect_trns_end(int sd_port) {
+	return SD_OK;
+}
+
+int sd_set_intcallback(int sd_port, int (*callback)(int, int)) {
+	return SD_OK;
+}
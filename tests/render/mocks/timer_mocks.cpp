@@ -0,0 +1,54 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <chrono>
+extern "C" {
+#include "RZA1/ostm/ostm.h"
+
+// Unlike the unit tests' timers, these follow the real clock - the renderer's timings are the point of it
+
+std::chrono::time_point<std::chrono::steady_clock> timerStarts[2] = {std::chrono::steady_clock::now(),
+                                                                      std::chrono::steady_clock::now()};
+uint32_t timerStartValues[2]{0};
+
+void enableTimer(int timerNo) {
+}
+
+void disableTimer(int timerNo) {
+}
+
+bool isTimerEnabled(int timerNo) {
+	return true;
+}
+
+void setOperatingMode(int timerNo, enum OSTimerOperatingMode mode, bool enable_interrupt) {
+}
+
+void setTimerValue(int timerNo, uint32_t timerValue) {
+	timerStarts[timerNo] = std::chrono::steady_clock::now();
+	timerStartValues[timerNo] = timerValue;
+}
+
+// returns ticks at the rate the deluge clock would generate them
+uint32_t getTimerValue(int timerNo) {
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - timerStarts[timerNo];
+	return timerStartValues[timerNo] + (uint64_t)(elapsed.count() * DELUGE_CLOCKS_PER);
+}
+
+double getTimerValueSeconds(int timerNo) {
+	return (double)getTimerValue(timerNo) / DELUGE_CLOCKS_PERf;
+}
+}
@@ -0,0 +1,29 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef DELUGE_TIMERS_INTERRUPTS_H
+#define DELUGE_TIMERS_INTERRUPTS_H
+
+// Nothing interrupts the renderer, so there's nothing to disable
+
+static inline __attribute__((no_instrument_function)) void DISABLE_ALL_INTERRUPTS() {
+}
+
+static inline __attribute__((no_instrument_function)) void ENABLE_INTERRUPTS() {
+}
+
+#endif // DELUGE_TIMERS_INTERRUPTS_H
@@ -0,0 +1,59 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "definitions_cxx.hpp"
+
+// A USB port with nothing ever plugged into it
+
+extern "C" {
+#include "RZA1/system/iodefine.h"
+#include "RZA1/usb/r_usb_basic/r_usb_basic_if.h"
+#include "RZA1/usb/r_usb_basic/src/driver/inc/r_usb_extern.h"
+#include "RZA1/usb/r_usb_hmidi/src/inc/r_usb_hmidi.h"
+#include "RZA1/usb/userdef/r_usb_hmidi_config.h"
+
+uint16_t g_usb_usbmode;
+uint16_t g_usb_peri_connected = USB_FALSE;
+uint8_t anythingInitiallyAttachedAsUSBHost = 0;
+uint16_t g_usb_hmidi_tmp_ep_tbl[USB_NUM_USBIP][MAX_NUM_USB_MIDI_DEVICES][(USB_EPL * 2) + 1];
+usb_utr_t* g_p_usb_pipe[USB_MAX_PIPE_NO + 1u];
+
+void openUSBHost(void) {
+}
+
+void closeUSBHost() {
+}
+
+void openUSBPeripheral() {
+}
+
+void usb_cstd_usb_task(void) {
+}
+
+usb_regadr_t usb_hstd_get_usb_ip_adr(uint16_t ipno) {
+	return nullptr;
+}
+
+void change_destination_of_send_pipe(usb_utr_t* ptr, uint16_t pipe, uint16_t* tbl, int32_t sq) {
+}
+
+void usb_send_start_rohan(usb_utr_t* ptr, uint16_t pipe, uint8_t const* data, int32_t size) {
+}
+
+void usb_receive_start_rohan_midi(uint16_t pipe) {
+}
+}
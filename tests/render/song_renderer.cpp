@@ -0,0 +1,247 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * ================== SongRenderer ==================
+ *
+ * Runs the firmware on the host to render a song to a WAV file, with no Deluge involved:
+ *
+ *     SongRenderer CARD SONG OUTPUT.WAV [SECONDS] [WINDOW_SIZE]
+ *
+ * CARD is either a folder laid out like a Deluge's SD card, which gets copied onto a temporary card image, or an
+ * image of a whole card (a FAT volume with no partition table). SONG is the song's path on the card, e.g.
+ * SONGS/SONG001.XML. It's loaded the same way as the startup song, then rendered from the start by
+ * OfflineRenderer::render() for SECONDS (default 10) in windows of WINDOW_SIZE samples (default and most
+ * SSI_TX_BUFFER_NUM_SAMPLES). The audio goes to OUTPUT.WAV, and the per-window timings go beside it with the extension
+ * .csv. Debug output goes to stdout.
+ *
+ * Two runs of the same song on the same build give identical audio, so comparing the output of two builds shows
+ * whether a change to the DSP altered the sound. The timings are the host's, so only comparable on the same machine.
+ */
+
+#include "card_image.h"
+#include "definitions_cxx.hpp"
+#include "gui/ui/load/load_song_ui.h"
+#include "gui/ui/ui.h"
+#include "hid/display/seven_segment.h"
+#include "hid/encoders.h"
+#include "host_memory.h"
+#include "io/midi/midi_device_manager.h"
+#include "io/midi/midi_follow.h"
+#include "memory/general_memory_allocator.h"
+#include "model/settings/runtime_feature_settings.h"
+#include "model/song/song.h"
+#include "playback/mode/session.h"
+#include "processing/engines/audio_engine.h"
+#include "processing/engines/offline_renderer.h"
+#include "sd_card.h"
+#include "storage/audio/audio_file_manager.h"
+#include "storage/audio/impulse_response_file.h"
+#include "storage/flash_storage.h"
+#include "storage/storage_manager.h"
+#include "task_scheduler.h"
+#include "util/functions.h"
+#include "util/pack.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace encoders = deluge::hid::encoders;
+
+extern void registerTasks();
+
+namespace deluge::hid::display {
+extern std::string_view getErrorMessage(Error error);
+}
+
+namespace {
+
+std::filesystem::path cardPath;
+std::string songPath;
+std::filesystem::path wavPath;
+uint32_t numSamples = 10 * kSampleRate;
+uint32_t windowSize = SSI_TX_BUFFER_NUM_SAMPLES;
+bool readingSong = false;
+
+/// The firmware never expects to stop, so its statics aren't meant to be destroyed - just leave
+[[noreturn]] void finish(int exitCode) {
+	fflush(nullptr);
+	_Exit(exitCode);
+}
+
+/// A numeric display which prints what it pops up - not all of which goes through the virtual displayPopup() - and which
+/// quits rather than freezing, or rather than carrying on after failing to read the song
+class HostDisplay final : public deluge::hid::display::SevenSegment {
+public:
+	using SevenSegment::displayPopup;
+
+	void displayPopup(char const* newText, int8_t numFlashes, bool alignRight, uint8_t drawDot, int32_t blinkSpeed,
+	                  DisplayPopupType type) override {
+		printf("popup: %s\n", newText);
+		SevenSegment::displayPopup(newText, numFlashes, alignRight, drawDot, blinkSpeed, type);
+	}
+
+	void popupText(char const* text, DisplayPopupType type) override {
+		printf("popup: %s\n", text);
+		SevenSegment::popupText(text, type);
+	}
+
+	void popupTextTemporary(char const* text, DisplayPopupType type) override {
+		printf("popup: %s\n", text);
+		SevenSegment::popupTextTemporary(text, type);
+	}
+
+	void displayError(Error error) override {
+		if (error != Error::NONE && error != Error::ABORTED_BY_USER) {
+			printf("error: %s\n", deluge::hid::display::getErrorMessage(error).data());
+			// The firmware would set up a blank song instead, which needs hardware that isn't here
+			if (readingSong) {
+				fprintf(stderr, "couldn't read %s\n", songPath.c_str());
+				finish(1);
+			}
+		}
+		SevenSegment::displayError(error);
+	}
+
+	void freezeWithError(char const* text) override {
+		fprintf(stderr, "froze with error %s\n", text);
+		finish(1);
+	}
+};
+
+bool insertCard() {
+	std::error_code error;
+	if (!std::filesystem::is_directory(cardPath, error)) {
+		int fd = open(cardPath.c_str(), O_RDWR);
+		if (fd < 0) {
+			return false;
+		}
+		insertCardImage(fd);
+		return true;
+	}
+
+	uint64_t numBytes = 0;
+	for (auto const& entry : std::filesystem::recursive_directory_iterator(cardPath, error)) {
+		if (entry.is_regular_file()) {
+			numBytes += entry.file_size();
+		}
+	}
+	int fd = CardImage::makeEmpty(numBytes);
+	if (fd < 0) {
+		return false;
+	}
+	insertCardImage(fd);
+	return (storageManager.initSD() == Error::NONE) && CardImage::copyIn(cardPath);
+}
+
+/// As setupStartupSong() does, but for the song asked for. Returns whether loading it got going - the rest happens in
+/// tasks, til the song's UI is up
+bool startLoadingSong() {
+	if (!storageManager.fileExists(songPath.c_str())) {
+		fprintf(stderr, "no song at %s\n", songPath.c_str());
+		return false;
+	}
+	void* songMemory = GeneralMemoryAllocator::get().allocMaxSpeed(sizeof(Song));
+	currentSong = new (songMemory) Song();
+	currentSong->setSongFullPath(songPath.c_str());
+	if (!openUI(&loadSongUI)) {
+		return false;
+	}
+	readingSong = true;
+	loadSongUI.performLoad(storageManager);
+	readingSong = false;
+	return currentUIMode == UI_MODE_LOADING_SONG_ESSENTIAL_SAMPLES;
+}
+
+void renderOnceLoaded() {
+	if (getCurrentUI() == &loadSongUI) {
+		return;
+	}
+
+	Error error = OfflineRenderer::render(numSamples, windowSize);
+	if (error != Error::NONE) {
+		fprintf(stderr, "render failed: error %d\n", util::to_underlying(error));
+		finish(1);
+	}
+
+	std::filesystem::path timingsPath = wavPath;
+	timingsPath.replace_extension(".csv");
+	if (!CardImage::copyOut(OfflineRenderer::kWavFilePath, wavPath)
+	    || !CardImage::copyOut(OfflineRenderer::kTimingsFilePath, timingsPath)) {
+		fprintf(stderr, "couldn't copy the render off the card\n");
+		finish(1);
+	}
+	finish(0);
+}
+
+/// The parts of deluge_main() which aren't about hardware that isn't there
+void runFirmware() {
+	functionsInit();
+	currentPlaybackMode = &session;
+	display = new HostDisplay;
+	deluge::hid::display::have_oled_screen = false;
+
+	encoders::init();
+	init_crc_table();
+	AudioEngine::init();
+
+	if (!insertCard()) {
+		fprintf(stderr, "couldn't set up a card from %s\n", cardPath.c_str());
+		finish(1);
+	}
+	audioFileManager.init();
+
+	FlashStorage::readSettings();
+	runtimeFeatureSettings.init();
+	runtimeFeatureSettings.readSettingsFromFile(storageManager);
+	ImpulseResponseFile::update();
+	MIDIDeviceManager::readDevicesFromFile(storageManager);
+	midiFollow.readDefaultsFromFile(storageManager);
+
+	if (!startLoadingSong()) {
+		fprintf(stderr, "couldn't load %s\n", songPath.c_str());
+		finish(1);
+	}
+
+	registerTasks();
+	addRepeatingTask(&renderOnceLoaded, 40, 0.01, 0.01, 0.1);
+	startTaskManager();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	if (argc < 4 || argc > 6) {
+		fprintf(stderr, "usage: %s CARD SONG OUTPUT.WAV [SECONDS] [WINDOW_SIZE]\n", argv[0]);
+		return 2;
+	}
+	cardPath = argv[1];
+	songPath = argv[2];
+	wavPath = argv[3];
+	if (argc > 4) {
+		numSamples = atof(argv[4]) * kSampleRate;
+	}
+	if (argc > 5) {
+		windowSize = atoi(argv[5]);
+	}
+
+	runOnProgramStack(&runFirmware);
+	return 1; // runFirmware() finishes the program itself
+}
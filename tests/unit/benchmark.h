@@ -0,0 +1,34 @@
+#pragma once
+
+// Timing for the benchmarks, which are only built into the opt-in UnitBenchmarks target (configure with
+// -DDELUGE_BENCHMARKS=ON). They're not pass/fail on timing - they print how long the code takes against the simpler
+// code it replaced. Their TEST_GROUPs all end in "Benchmark", so `UnitBenchmarks -g Benchmark` runs just them.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+#include <utility>
+
+/// Runs job once, and returns how many nanoseconds it took per item, for the numItems it worked through
+template <typename Job>
+uint64_t nanosecondsPerItem(uint64_t numItems, Job&& job) {
+	auto start = std::chrono::steady_clock::now();
+	job();
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / std::max<uint64_t>(numItems, 1);
+}
+
+/// Prints one line of results, like "cull, 48 voices: scan 200ns/cull, heap 50ns/cull"
+inline void printBenchmark(std::string const& what, std::initializer_list<std::pair<char const*, uint64_t>> results,
+                           char const* unit) {
+	std::cout << what << ":";
+	char const* separator = " ";
+	for (auto [name, nanoseconds] : results) {
+		std::cout << separator << name << " " << nanoseconds << "ns/" << unit;
+		separator = ", ";
+	}
+	std::cout << std::endl;
+}
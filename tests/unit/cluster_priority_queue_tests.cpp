@@ -0,0 +1,282 @@
+#include "CppUTest/TestHarness.h"
+#include "benchmark.h"
+#include "storage/cluster/cluster_priority_queue.h"
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct FakeCluster {
+	uint64_t loadingQueueKey = 0;
+	int32_t loadingQueueIndex = -1;
+};
+
+struct Queue : BasicClusterPriorityQueue<FakeCluster> {
+	Queue(int32_t capacity = 100000) { reserve(capacity); }
+};
+
+// How the queue used to work: an array kept sorted by priorityRating, so adding and removing move everything after
+// the spot along, and removing has to search for the Cluster first. Re-prioritising is a remove and an add
+class SortedArrayQueue {
+public:
+	void add(FakeCluster* cluster, uint32_t priorityRating) {
+		Element element{priorityRating, cluster};
+		auto at = std::upper_bound(elements_.begin(), elements_.end(), element,
+		                           [](auto& a, auto& b) { return a.priorityRating < b.priorityRating; });
+		elements_.insert(at, element);
+	}
+	FakeCluster* grabHead() {
+		if (elements_.empty()) {
+			return nullptr;
+		}
+		FakeCluster* cluster = elements_.front().cluster;
+		elements_.erase(elements_.begin());
+		return cluster;
+	}
+	bool removeIfPresent(FakeCluster* cluster) {
+		for (auto it = elements_.begin(); it != elements_.end(); it++) {
+			if (it->cluster == cluster) {
+				elements_.erase(it);
+				return true;
+			}
+		}
+		return false;
+	}
+	bool prioritize(FakeCluster* cluster, uint32_t priorityRating) {
+		for (auto& element : elements_) {
+			if (element.cluster == cluster) {
+				if (priorityRating < element.priorityRating) {
+					removeIfPresent(cluster);
+					add(cluster, priorityRating);
+				}
+				return true;
+			}
+		}
+		return false;
+	}
+
+private:
+	struct Element {
+		uint32_t priorityRating;
+		FakeCluster* cluster;
+	};
+	std::vector<Element> elements_;
+};
+
+enum class Op { ADD, GRAB, REMOVE, PRIORITIZE };
+
+struct TraceEntry {
+	Op op;
+	int32_t cluster;
+	uint32_t priorityRating;
+};
+
+// A trace like one taken from AudioFileManager while numVoices long samples stream: each voice enqueues the Cluster
+// kNumClustersLoadedAhead past the one it's playing whenever it moves on, the loader grabs a few heads per render
+// window, voices end and have their Clusters taken back out of the queue, and now and then a voice wants a Cluster
+// another has already enqueued, but sooner
+std::vector<TraceEntry> makeTrace(int32_t numVoices, int32_t numWindows, int32_t* numClusters, std::mt19937& rng) {
+	struct StreamingVoice {
+		uint32_t priorityRating;
+		std::vector<int32_t> clusters;
+	};
+
+	std::vector<TraceEntry> trace;
+	std::vector<StreamingVoice> voices(numVoices);
+	int32_t nextCluster = 0;
+
+	auto startVoice = [&](StreamingVoice& voice) {
+		voice.priorityRating = rng() >> 8;
+		voice.clusters.clear();
+		for (int32_t i = 0; i < 2; i++) {
+			voice.clusters.push_back(nextCluster);
+			trace.push_back({Op::ADD, nextCluster++, voice.priorityRating});
+		}
+	};
+
+	for (auto& voice : voices) {
+		startVoice(voice);
+	}
+
+	for (int32_t w = 0; w < numWindows; w++) {
+		for (auto& voice : voices) {
+			uint32_t event = rng() % 64;
+			if (event < 6) {
+				voice.clusters.push_back(nextCluster);
+				trace.push_back({Op::ADD, nextCluster++, voice.priorityRating});
+			}
+			else if (event == 6) {
+				for (int32_t cluster : voice.clusters) {
+					trace.push_back({Op::REMOVE, cluster, 0});
+				}
+				startVoice(voice);
+			}
+			else if (event == 7 && !voices.empty()) {
+				auto& other = voices[rng() % voices.size()];
+				trace.push_back({Op::PRIORITIZE, other.clusters.back(), voice.priorityRating});
+			}
+		}
+		int32_t numGrabs = rng() % 48;
+		for (int32_t i = 0; i < numGrabs; i++) {
+			trace.push_back({Op::GRAB, -1, 0});
+		}
+	}
+
+	*numClusters = nextCluster;
+	return trace;
+}
+
+// Returns the Clusters grabbed, in order
+template <typename Q>
+std::vector<int32_t> replay(Q& queue, std::vector<TraceEntry> const& trace, std::vector<FakeCluster>& clusters) {
+	std::vector<int32_t> grabbed;
+	for (auto& entry : trace) {
+		switch (entry.op) {
+		case Op::ADD:
+			queue.add(&clusters[entry.cluster], entry.priorityRating);
+			break;
+		case Op::GRAB:
+			if (FakeCluster* cluster = queue.grabHead()) {
+				grabbed.push_back(cluster - clusters.data());
+			}
+			break;
+		case Op::REMOVE:
+			queue.removeIfPresent(&clusters[entry.cluster]);
+			break;
+		case Op::PRIORITIZE:
+			queue.prioritize(&clusters[entry.cluster], entry.priorityRating);
+			break;
+		}
+	}
+	while (FakeCluster* cluster = queue.grabHead()) {
+		grabbed.push_back(cluster - clusters.data());
+	}
+	return grabbed;
+}
+
+TEST_GROUP(ClusterPriorityQueueTest){};
+
+TEST(ClusterPriorityQueueTest, mostUrgentFirstThenFirstComeFirstServed) {
+	std::vector<FakeCluster> clusters(5);
+	Queue queue;
+	queue.add(&clusters[0], 100);
+	queue.add(&clusters[1], 50);
+	queue.add(&clusters[2], 100);
+	queue.add(&clusters[3], Queue::kLowestPriority);
+	queue.add(&clusters[4], 50);
+	CHECK_EQUAL(5, queue.getNumElements());
+	CHECK(queue.hasAnyLowestPriorityElements());
+
+	POINTERS_EQUAL(&clusters[1], queue.grabHead());
+	POINTERS_EQUAL(&clusters[4], queue.grabHead());
+	POINTERS_EQUAL(&clusters[0], queue.grabHead());
+	POINTERS_EQUAL(&clusters[2], queue.grabHead());
+	POINTERS_EQUAL(&clusters[3], queue.grabHead());
+	CHECK_FALSE(queue.hasAnyLowestPriorityElements());
+	POINTERS_EQUAL(nullptr, queue.grabHead());
+	CHECK_EQUAL(-1, clusters[1].loadingQueueIndex);
+}
+
+TEST(ClusterPriorityQueueTest, prioritizeOnlyEverMovesUp) {
+	std::vector<FakeCluster> clusters(3);
+	Queue queue;
+	queue.add(&clusters[0], 10);
+	queue.add(&clusters[1], 20);
+	queue.add(&clusters[2], Queue::kLowestPriority);
+
+	CHECK(queue.prioritize(&clusters[1], 30));
+	CHECK_EQUAL(20, Queue::getPriorityRating(&clusters[1]));
+	CHECK(queue.prioritize(&clusters[2], 5));
+	CHECK_FALSE(queue.hasAnyLowestPriorityElements());
+	CHECK_EQUAL(3, queue.getNumElements());
+
+	POINTERS_EQUAL(&clusters[2], queue.grabHead());
+	POINTERS_EQUAL(&clusters[0], queue.grabHead());
+	CHECK_FALSE(queue.prioritize(&clusters[0], 1));
+
+	// Adding one that's already there doesn't queue it twice
+	queue.add(&clusters[1], 15);
+	CHECK_EQUAL(1, queue.getNumElements());
+	CHECK_EQUAL(15, Queue::getPriorityRating(&clusters[1]));
+}
+
+TEST(ClusterPriorityQueueTest, removeIfPresent) {
+	std::vector<FakeCluster> clusters(3);
+	Queue queue;
+	queue.add(&clusters[0], 1);
+	queue.add(&clusters[1], Queue::kLowestPriority);
+	CHECK(queue.removeIfPresent(&clusters[1]));
+	CHECK_FALSE(queue.removeIfPresent(&clusters[1]));
+	CHECK_FALSE(queue.removeIfPresent(&clusters[2]));
+	CHECK_FALSE(queue.checkPresent(&clusters[1]));
+	CHECK(queue.checkPresent(&clusters[0]));
+	CHECK_FALSE(queue.hasAnyLowestPriorityElements());
+	CHECK_EQUAL(1, queue.getNumElements());
+}
+
+TEST(ClusterPriorityQueueTest, addFailsOnceFull) {
+	std::vector<FakeCluster> clusters(3);
+	Queue queue(2);
+	CHECK(queue.add(&clusters[0], 5) == Error::NONE);
+	CHECK(queue.add(&clusters[1], 5) == Error::NONE);
+	CHECK(queue.add(&clusters[2], 1) == Error::INSUFFICIENT_RAM);
+	CHECK_FALSE(queue.checkPresent(&clusters[2]));
+	CHECK_EQUAL(2, queue.getNumElements());
+
+	// Re-prioritising one that's there still works, and so does adding once there's room again
+	CHECK(queue.add(&clusters[1], 1) == Error::NONE);
+	CHECK_EQUAL(&clusters[1], queue.grabHead());
+	CHECK(queue.add(&clusters[2], 1) == Error::NONE);
+	CHECK_EQUAL(&clusters[2], queue.peekHead());
+}
+
+TEST(ClusterPriorityQueueTest, replaysTraceLikeSortedArray) {
+	std::mt19937 rng(1);
+	int32_t numClusters;
+	std::vector<TraceEntry> trace = makeTrace(64, 500, &numClusters, rng);
+
+	std::vector<FakeCluster> heapClusters(numClusters);
+	Queue heapQueue;
+	std::vector<int32_t> heapGrabbed = replay(heapQueue, trace, heapClusters);
+
+	std::vector<FakeCluster> arrayClusters(numClusters);
+	SortedArrayQueue arrayQueue;
+	std::vector<int32_t> arrayGrabbed = replay(arrayQueue, trace, arrayClusters);
+
+	CHECK(!heapGrabbed.empty());
+	CHECK(heapGrabbed == arrayGrabbed);
+}
+
+#if DELUGE_BENCHMARKS
+
+TEST_GROUP(ClusterPriorityQueueBenchmark){};
+
+TEST(ClusterPriorityQueueBenchmark, replay) {
+	for (int32_t numVoices : {32, 256, 1024}) {
+		std::mt19937 rng(2);
+		int32_t numClusters;
+		std::vector<TraceEntry> trace = makeTrace(numVoices, 2000, &numClusters, rng);
+
+		std::vector<FakeCluster> arrayClusters(numClusters);
+		SortedArrayQueue arrayQueue;
+		std::vector<int32_t> arrayGrabbed;
+		uint64_t arrayTime =
+		    nanosecondsPerItem(trace.size(), [&] { arrayGrabbed = replay(arrayQueue, trace, arrayClusters); });
+
+		std::vector<FakeCluster> heapClusters(numClusters);
+		Queue heapQueue;
+		std::vector<int32_t> heapGrabbed;
+		uint64_t heapTime =
+		    nanosecondsPerItem(trace.size(), [&] { heapGrabbed = replay(heapQueue, trace, heapClusters); });
+
+		CHECK(heapGrabbed == arrayGrabbed);
+		printBenchmark("cluster queue, " + std::to_string(numVoices) + " voices",
+		               {{"sorted array", arrayTime}, {"heap", heapTime}}, "op");
+	}
+}
+
+#endif
+
+} // namespace
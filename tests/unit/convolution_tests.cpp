@@ -0,0 +1,239 @@
+#include "CppUTest/TestHarness.h"
+#include "benchmark.h"
+#include "dsp/convolution/impulse_response_processor.h"
+#include "dsp/convolution/partitioned_convolver.h"
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using deluge::dsp::PartitionedConvolver;
+
+namespace {
+
+constexpr int32_t kBlockSize = PartitionedConvolver::kBlockSize;
+
+// The same transposed direct form as ImpulseResponseProcessor, but with any number of taps
+class DirectFormFIR {
+public:
+	DirectFormFIR(std::vector<q31_t> taps) : taps_(std::move(taps)), buffer_(taps_.size()) {}
+
+	void process(StereoSample& sample) {
+		StereoSample input = sample;
+		sample.l = buffer_[0].l + multiply_32x32_rshift32_rounded(input.l, taps_[0]);
+		sample.r = buffer_[0].r + multiply_32x32_rshift32_rounded(input.r, taps_[0]);
+		size_t last = taps_.size() - 1;
+		for (size_t i = 1; i < last; i++) {
+			buffer_[i - 1].l = buffer_[i].l + multiply_32x32_rshift32_rounded(input.l, taps_[i]);
+			buffer_[i - 1].r = buffer_[i].r + multiply_32x32_rshift32_rounded(input.r, taps_[i]);
+		}
+		buffer_[last - 1].l = multiply_32x32_rshift32_rounded(input.l, taps_[last]);
+		buffer_[last - 1].r = multiply_32x32_rshift32_rounded(input.r, taps_[last]);
+	}
+
+private:
+	std::vector<q31_t> taps_;
+	std::vector<StereoSample> buffer_;
+};
+
+// A decaying noise burst, roughly unity gain overall
+std::vector<q31_t> makeImpulseResponse(size_t numTaps, std::mt19937& rng) {
+	std::vector<q31_t> taps(numTaps);
+	double amplitude = 4294967296.0 / std::sqrt((double)numTaps) / 2;
+	for (size_t i = 0; i < numTaps; i++) {
+		double decay = 1.0 - (double)i / (double)numTaps;
+		taps[i] = (q31_t)(std::uniform_real_distribution<double>(-1, 1)(rng) * amplitude * decay);
+	}
+	return taps;
+}
+
+std::vector<StereoSample> makeInput(size_t numSamples, std::mt19937& rng) {
+	std::vector<StereoSample> input(numSamples);
+	for (auto& sample : input) {
+		sample.l = (int32_t)rng() >> 3;
+		sample.r = (int32_t)rng() >> 3;
+	}
+	return input;
+}
+
+bool sameSamples(std::vector<StereoSample> const& a, std::vector<StereoSample> const& b) {
+	return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+	                  [](StereoSample x, StereoSample y) { return x.l == y.l && x.r == y.r; });
+}
+
+TEST_GROUP(PartitionedConvolverTest){};
+
+TEST(PartitionedConvolverTest, impulseGivesImpulseResponseAfterOneBlock) {
+	std::mt19937 rng(1);
+	std::vector<q31_t> taps = makeImpulseResponse(300, rng);
+	PartitionedConvolver::ImpulseResponse ir;
+	CHECK(ir.set(taps) == Error::NONE);
+	CHECK_EQUAL(3, ir.getNumPartitions());
+	PartitionedConvolver convolver;
+	CHECK(convolver.setImpulseResponse(ir) == Error::NONE);
+	CHECK_EQUAL(3, convolver.getNumPartitions());
+
+	std::vector<StereoSample> buffer(kBlockSize + taps.size() + kBlockSize);
+	buffer[0].l = ONE_Q31;
+	buffer[0].r = -ONE_Q31;
+	convolver.process(buffer);
+
+	for (int32_t i = 0; i < kBlockSize; i++) {
+		CHECK_EQUAL(0, buffer[i].l);
+	}
+	for (size_t i = 0; i < taps.size(); i++) {
+		int32_t expected = multiply_32x32_rshift32_rounded(ONE_Q31, taps[i]);
+		CHECK(std::abs(buffer[kBlockSize + i].l - expected) < 256);
+		CHECK(std::abs(buffer[kBlockSize + i].r + expected) < 256);
+	}
+	for (size_t i = kBlockSize + taps.size(); i < buffer.size(); i++) {
+		CHECK(std::abs(buffer[i].l) < 256);
+	}
+}
+
+TEST(PartitionedConvolverTest, matchesDirectForm) {
+	std::mt19937 rng(2);
+	for (size_t numTaps : {26, 128, 1000, 4096}) {
+		std::vector<q31_t> taps = makeImpulseResponse(numTaps, rng);
+		std::vector<StereoSample> input = makeInput(kBlockSize * 48 + 37, rng);
+
+		DirectFormFIR fir(taps);
+		std::vector<StereoSample> expected = input;
+		for (auto& sample : expected) {
+			fir.process(sample);
+		}
+
+		PartitionedConvolver::ImpulseResponse ir;
+		CHECK(ir.set(taps) == Error::NONE);
+		PartitionedConvolver convolver;
+		CHECK(convolver.setImpulseResponse(ir) == Error::NONE);
+		std::vector<StereoSample> output = input;
+		// In uneven pieces, as the audio engine would
+		for (size_t done = 0; done < output.size();) {
+			size_t length = std::min<size_t>(1 + rng() % 200, output.size() - done);
+			convolver.process(std::span{output}.subspan(done, length));
+			done += length;
+		}
+
+		int64_t maxError = 0;
+		for (size_t i = kBlockSize; i < output.size(); i++) {
+			maxError = std::max<int64_t>(maxError, std::abs((int64_t)output[i].l - expected[i - kBlockSize].l));
+			maxError = std::max<int64_t>(maxError, std::abs((int64_t)output[i].r - expected[i - kBlockSize].r));
+		}
+		// Better than -110dB relative to full scale
+		CHECK(maxError < (ONE_Q31 >> 18));
+	}
+}
+
+TEST(PartitionedConvolverTest, rejectsBadImpulseResponses) {
+	PartitionedConvolver::ImpulseResponse ir;
+	CHECK(ir.set({}) != Error::NONE);
+	CHECK_FALSE(ir.isValid());
+	std::vector<q31_t> tooLong(PartitionedConvolver::kMaxNumTaps + 1, 1);
+	CHECK(ir.set(tooLong) != Error::NONE);
+	CHECK_FALSE(ir.isValid());
+
+	PartitionedConvolver convolver;
+	CHECK(convolver.setImpulseResponse(ir) != Error::NONE);
+	CHECK_FALSE(convolver.isActive());
+}
+
+TEST(PartitionedConvolverTest, convolversShareAnImpulseResponse) {
+	std::mt19937 rng(5);
+	PartitionedConvolver::ImpulseResponse ir;
+	CHECK(ir.set(makeImpulseResponse(1000, rng)) == Error::NONE);
+	std::vector<StereoSample> input = makeInput(kBlockSize * 12, rng);
+
+	PartitionedConvolver first;
+	PartitionedConvolver second;
+	CHECK(first.setImpulseResponse(ir) == Error::NONE);
+	CHECK(second.setImpulseResponse(ir) == Error::NONE);
+
+	// Interleaved, so each has to keep its own history
+	std::vector<StereoSample> firstOutput = input;
+	std::vector<StereoSample> secondOutput = input;
+	for (size_t done = 0; done < input.size(); done += 100) {
+		size_t length = std::min<size_t>(100, input.size() - done);
+		first.process(std::span{firstOutput}.subspan(done, length));
+		second.process(std::span{secondOutput}.subspan(done, length));
+	}
+	CHECK(sameSamples(firstOutput, secondOutput));
+}
+
+TEST(PartitionedConvolverTest, impulseResponseProcessorSwitchesToUserIR) {
+	std::mt19937 rng(4);
+	std::vector<StereoSample> input = makeInput(kBlockSize * 4, rng);
+
+	ImpulseResponseProcessor builtIn;
+	std::vector<StereoSample> expectedBuiltIn = input;
+	for (auto& sample : expectedBuiltIn) {
+		builtIn.process(sample, sample);
+	}
+
+	std::vector<q31_t> taps = makeImpulseResponse(1000, rng);
+	PartitionedConvolver::ImpulseResponse ir;
+	CHECK(ir.set(taps) == Error::NONE);
+	PartitionedConvolver convolver;
+	CHECK(convolver.setImpulseResponse(ir) == Error::NONE);
+	std::vector<StereoSample> expectedUser = input;
+	convolver.process(expectedUser);
+
+	ImpulseResponseProcessor processor;
+	std::vector<StereoSample> output = input;
+	processor.process(output);
+	CHECK(sameSamples(output, expectedBuiltIn));
+
+	CHECK(ImpulseResponseProcessor::setUserImpulseResponse(taps) == Error::NONE);
+	output = input;
+	processor.process(output);
+	CHECK(sameSamples(output, expectedUser));
+
+	ImpulseResponseProcessor::clearUserImpulseResponse();
+	CHECK_FALSE(ImpulseResponseProcessor::hasUserImpulseResponse());
+	ImpulseResponseProcessor another;
+	output = input;
+	another.process(output);
+	CHECK(sameSamples(output, expectedBuiltIn));
+}
+
+#if DELUGE_BENCHMARKS
+
+TEST_GROUP(PartitionedConvolverBenchmark){};
+
+TEST(PartitionedConvolverBenchmark, againstDirectForm) {
+	constexpr size_t kNumSamples = 44100;
+
+	for (size_t numTaps : {26, 256, 4096}) {
+		std::mt19937 rng(3);
+		std::vector<q31_t> taps = makeImpulseResponse(numTaps, rng);
+		std::vector<StereoSample> input = makeInput(kNumSamples, rng);
+
+		DirectFormFIR fir(taps);
+		std::vector<StereoSample> direct = input;
+		uint64_t directTime = nanosecondsPerItem(kNumSamples, [&] {
+			for (auto& sample : direct) {
+				fir.process(sample);
+			}
+		});
+
+		PartitionedConvolver::ImpulseResponse ir;
+		CHECK(ir.set(taps) == Error::NONE);
+		PartitionedConvolver convolver;
+		CHECK(convolver.setImpulseResponse(ir) == Error::NONE);
+		std::vector<StereoSample> partitioned = input;
+		uint64_t partitionedTime = nanosecondsPerItem(kNumSamples, [&] {
+			// One render window at a time
+			for (size_t done = 0; done < partitioned.size(); done += kBlockSize) {
+				convolver.process(
+				    std::span{partitioned}.subspan(done, std::min<size_t>(kBlockSize, partitioned.size() - done)));
+			}
+		});
+
+		printBenchmark("convolution, " + std::to_string(numTaps) + " taps",
+		               {{"direct form", directTime}, {"partitioned", partitionedTime}}, "sample");
+	}
+}
+
+#endif
+
+} // namespace
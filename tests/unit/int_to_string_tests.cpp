@@ -0,0 +1,57 @@
+#include "CppUTest/TestHarness.h"
+#include "util/cfunctions.h"
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+
+namespace {
+
+std::string toString(int32_t number, int32_t minNumDigits = 1) {
+	char buffer[16];
+	intToString(number, buffer, minNumDigits);
+	return buffer;
+}
+
+// What intToString() always gave, one digit at a time
+std::string expected(int32_t number, int32_t minNumDigits = 1) {
+	// Not "%0*ld", since printf counts the '-' as one of the digits and intToString() doesn't
+	char buffer[16];
+	uint32_t magnitude = (number < 0) ? 0 - (uint32_t)number : number;
+	snprintf(buffer, sizeof(buffer), "%s%0*lu", (number < 0) ? "-" : "", (int)minNumDigits, (unsigned long)magnitude);
+	return buffer;
+}
+
+TEST_GROUP(IntToStringTest){};
+
+TEST(IntToStringTest, edges) {
+	STRCMP_EQUAL("0", toString(0).c_str());
+	STRCMP_EQUAL("9", toString(9).c_str());
+	STRCMP_EQUAL("10", toString(10).c_str());
+	STRCMP_EQUAL("-1", toString(-1).c_str());
+	STRCMP_EQUAL("2147483647", toString(INT32_MAX).c_str());
+	STRCMP_EQUAL("-2147483648", toString(INT32_MIN).c_str());
+}
+
+TEST(IntToStringTest, padsToMinNumDigits) {
+	STRCMP_EQUAL("000", toString(0, 3).c_str());
+	STRCMP_EQUAL("007", toString(7, 3).c_str());
+	STRCMP_EQUAL("1234", toString(1234, 3).c_str());
+	STRCMP_EQUAL("-007", toString(-7, 3).c_str()); // The '-' doesn't count as a digit
+	STRCMP_EQUAL("0000000000042", toString(42, 13).c_str());
+	STRCMP_EQUAL("-02147483648", toString(INT32_MIN, 11).c_str());
+}
+
+TEST(IntToStringTest, matchesPrintf) {
+	std::mt19937 rng(1);
+	for (int32_t i = 0; i < 100000; i++) {
+		int32_t number = (int32_t)rng() >> (rng() % 32);
+		int32_t minNumDigits = 1 + rng() % 12;
+		STRCMP_EQUAL(expected(number, minNumDigits).c_str(), toString(number, minNumDigits).c_str());
+	}
+	for (int32_t number = -1000; number <= 1000; number++) {
+		STRCMP_EQUAL(expected(number).c_str(), toString(number).c_str());
+	}
+}
+
+} // namespace
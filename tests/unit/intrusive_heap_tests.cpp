@@ -0,0 +1,186 @@
+#include "CppUTest/TestHarness.h"
+#include "benchmark.h"
+#include "util/container/heap/intrusive_heap.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Stand-in for Voice, with the same sort of packed rating as Voice::getPriorityRating()
+struct FakeVoice {
+	uint32_t priority;      // 0-3
+	uint32_t numSiblings;   // 0-7
+	uint32_t envelopeState; // 0-6
+	uint32_t timeEntered;
+
+	uint32_t getPriorityRating() const {
+		return (priority << 30) + (numSiblings << 27) + (envelopeState << 24) + (-timeEntered & (0xFFFFFFFF >> 8));
+	}
+
+	uint32_t cullRating = 0;
+	int32_t cullHeapIndex = -1;
+};
+
+using Heap = IntrusiveHeap<FakeVoice, uint32_t, &FakeVoice::cullRating, &FakeVoice::cullHeapIndex>;
+
+FakeVoice* bestByScan(std::vector<FakeVoice>& voices, std::vector<bool>& active) {
+	uint32_t bestRating = 0;
+	FakeVoice* best = nullptr;
+	for (size_t v = 0; v < voices.size(); v++) {
+		if (!active[v]) {
+			continue;
+		}
+		uint32_t rating = voices[v].getPriorityRating();
+		if (rating > bestRating) {
+			bestRating = rating;
+			best = &voices[v];
+		}
+	}
+	return best;
+}
+
+void randomise(FakeVoice& voice, std::mt19937& rng, uint32_t& time) {
+	voice.priority = rng() % 4;
+	voice.numSiblings = rng() % 8;
+	voice.envelopeState = rng() % 7;
+	voice.timeEntered = time++;
+}
+
+TEST_GROUP(IntrusiveHeapTest){};
+
+TEST(IntrusiveHeapTest, popsInOrder) {
+	std::vector<FakeVoice> voices(100);
+	Heap heap;
+	std::mt19937 rng(1);
+	for (auto& voice : voices) {
+		voice.cullRating = rng();
+		heap.push(&voice);
+	}
+	uint32_t last = 0xFFFFFFFF;
+	while (!heap.empty()) {
+		FakeVoice* voice = heap.pop();
+		CHECK(voice->cullRating <= last);
+		CHECK_EQUAL(-1, voice->cullHeapIndex);
+		last = voice->cullRating;
+	}
+}
+
+TEST(IntrusiveHeapTest, matchesLinearScan) {
+	constexpr size_t kNumVoices = 128;
+	std::vector<FakeVoice> voices(kNumVoices);
+	std::vector<bool> active(kNumVoices, true);
+	std::mt19937 rng(2);
+	uint32_t time = 0;
+	Heap heap;
+	for (auto& voice : voices) {
+		randomise(voice, rng, time);
+		voice.cullRating = voice.getPriorityRating();
+		heap.push(&voice);
+	}
+
+	for (int i = 0; i < 10000; i++) {
+		size_t v = rng() % kNumVoices;
+		switch (rng() % 3) {
+		case 0: // Change of state
+			randomise(voices[v], rng, time);
+			voices[v].cullRating = voices[v].getPriorityRating();
+			heap.update(&voices[v]);
+			break;
+		case 1: // Culled, or back again
+			if (active[v]) {
+				heap.remove(&voices[v]);
+			}
+			else {
+				voices[v].cullRating = voices[v].getPriorityRating();
+				heap.push(&voices[v]);
+			}
+			active[v] = !active[v];
+			break;
+		case 2:
+			heap.update(&voices[v]); // No change
+			break;
+		}
+		POINTERS_EQUAL(bestByScan(voices, active), heap.top());
+	}
+}
+
+TEST(IntrusiveHeapTest, removeNotContainedIsHarmless) {
+	FakeVoice a{}, b{};
+	a.cullRating = 1;
+	Heap heap;
+	heap.push(&a);
+	heap.remove(&b);
+	heap.update(&b);
+	CHECK_EQUAL(1, heap.size());
+	POINTERS_EQUAL(&a, heap.top());
+	heap.clear();
+	CHECK(!Heap::contains(&a));
+}
+
+#if DELUGE_BENCHMARKS
+
+TEST_GROUP(IntrusiveHeapBenchmark){};
+
+// How long finding the best Voice to cull takes by scanning every Voice, as AudioEngine::cullVoice() used to, against
+// keeping them in a heap, for various numbers of Voices. Each round changes the state of a few Voices and then culls
+// (and replaces) one, as happens under overload.
+TEST(IntrusiveHeapBenchmark, cull) {
+	constexpr int kRounds = 20000;
+	constexpr int kStateChangesPerRound = 4;
+
+	for (size_t numVoices : {48, 96, 128, 192, 256}) {
+		std::vector<FakeVoice> voices(numVoices);
+		std::vector<bool> active(numVoices, true);
+		std::mt19937 rng(3);
+		uint32_t time = 0;
+		for (auto& voice : voices) {
+			randomise(voice, rng, time);
+		}
+
+		volatile uintptr_t sink = 0;
+
+		uint64_t scanTime = nanosecondsPerItem(kRounds, [&] {
+			for (int i = 0; i < kRounds; i++) {
+				for (int c = 0; c < kStateChangesPerRound; c++) {
+					randomise(voices[rng() % numVoices], rng, time);
+				}
+				FakeVoice* victim = bestByScan(voices, active);
+				sink = sink + (uintptr_t)victim;
+				randomise(*victim, rng, time);
+			}
+		});
+
+		rng.seed(3);
+		time = 0;
+		Heap heap;
+		for (auto& voice : voices) {
+			randomise(voice, rng, time);
+			voice.cullRating = voice.getPriorityRating();
+			heap.push(&voice);
+		}
+
+		uint64_t heapTime = nanosecondsPerItem(kRounds, [&] {
+			for (int i = 0; i < kRounds; i++) {
+				for (int c = 0; c < kStateChangesPerRound; c++) {
+					FakeVoice& voice = voices[rng() % numVoices];
+					randomise(voice, rng, time);
+					voice.cullRating = voice.getPriorityRating();
+					heap.update(&voice);
+				}
+				FakeVoice* victim = heap.pop();
+				sink = sink + (uintptr_t)victim;
+				randomise(*victim, rng, time);
+				victim->cullRating = victim->getPriorityRating();
+				heap.push(victim);
+			}
+		});
+
+		printBenchmark("cull, " + std::to_string(numVoices) + " voices", {{"scan", scanTime}, {"heap", heapTime}},
+		               "cull");
+	}
+}
+
+#endif
+
+} // namespace
@@ -0,0 +1,148 @@
+#include "CppUTest/TestHarness.h"
+#include "storage/audio/lossless_codec.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+using namespace LosslessCodec;
+
+void putSample(std::vector<uint8_t>& pcm, int32_t value, int32_t byteDepth) {
+	for (int32_t i = 0; i < byteDepth; i++) {
+		pcm.push_back(value >> (i * 8));
+	}
+}
+
+// A decaying tone with a little noise on it, like a sampled instrument
+std::vector<uint8_t> makeTone(int32_t numFrames, int32_t numChannels, int32_t byteDepth, std::mt19937& rng) {
+	std::vector<uint8_t> pcm;
+	std::normal_distribution<double> noise(0, 4 << ((byteDepth - 2) * 8));
+	double fullScale = (1 << (byteDepth * 8 - 1)) - 1;
+	for (int32_t n = 0; n < numFrames; n++) {
+		double envelope = std::exp(-3.0 * n / numFrames);
+		for (int32_t c = 0; c < numChannels; c++) {
+			double value = 0.7 * fullScale * envelope * std::sin(n * 0.031 + c * 0.5) + noise(rng);
+			putSample(pcm, std::clamp<double>(std::round(value), -fullScale - 1, fullScale), byteDepth);
+		}
+	}
+	return pcm;
+}
+
+std::vector<uint8_t> makeNoise(int32_t numFrames, int32_t numChannels, int32_t byteDepth, std::mt19937& rng) {
+	std::vector<uint8_t> pcm(numFrames * numChannels * byteDepth);
+	for (auto& byte : pcm) {
+		byte = rng();
+	}
+	return pcm;
+}
+
+// Encodes the whole lot in blocks the way a file would be, decodes each block again and checks it came back exactly.
+// Returns the encoded size
+size_t roundTrip(std::vector<uint8_t> const& pcm, int32_t numChannels, int32_t byteDepth, int32_t blockNumFrames) {
+	int32_t frameNumBytes = numChannels * byteDepth;
+	int32_t numFrames = pcm.size() / frameNumBytes;
+	std::vector<int32_t> scratch(blockNumFrames);
+	std::vector<uint8_t> encoded(getMaxBlockNumBytes(blockNumFrames, numChannels, byteDepth));
+	std::vector<uint8_t> decoded(blockNumFrames * frameNumBytes);
+	size_t totalNumBytes = 0;
+
+	for (int32_t start = 0; start < numFrames; start += blockNumFrames) {
+		int32_t thisNumFrames = std::min(blockNumFrames, numFrames - start);
+		int32_t numBytes = encodeBlock(&pcm[start * frameNumBytes], thisNumFrames, numChannels, byteDepth,
+		                               encoded.data(), scratch.data());
+		CHECK(numBytes <= getMaxBlockNumBytes(thisNumFrames, numChannels, byteDepth));
+
+		std::fill(decoded.begin(), decoded.end(), 0xAA);
+		CHECK(decodeBlock(encoded.data(), numBytes, thisNumFrames, numChannels, byteDepth, decoded.data(),
+		                  scratch.data()));
+		CHECK(!std::memcmp(decoded.data(), &pcm[start * frameNumBytes], thisNumFrames * frameNumBytes));
+		totalNumBytes += numBytes;
+	}
+	return totalNumBytes;
+}
+
+TEST_GROUP(LosslessCodecTest){};
+
+TEST(LosslessCodecTest, roundTripsExactly) {
+	std::mt19937 rng(1);
+	for (int32_t byteDepth : {2, 3}) {
+		for (int32_t numChannels : {1, 2}) {
+			// Ending part way through a block, as most files do
+			std::vector<uint8_t> tone = makeTone(10000, numChannels, byteDepth, rng);
+			size_t numBytes = roundTrip(tone, numChannels, byteDepth, 1024);
+			CHECK(numBytes < tone.size());
+
+			std::vector<uint8_t> noise = makeNoise(3000, numChannels, byteDepth, rng);
+			roundTrip(noise, numChannels, byteDepth, kMaxBlockNumFrames);
+
+			std::vector<uint8_t> silence(5000 * numChannels * byteDepth);
+			CHECK(roundTrip(silence, numChannels, byteDepth, 1024) < silence.size() / 8);
+		}
+	}
+}
+
+TEST(LosslessCodecTest, roundTripsTinyBlocks) {
+	std::mt19937 rng(2);
+	std::vector<uint8_t> tone = makeTone(40, 2, 3, rng);
+	for (int32_t blockNumFrames = 1; blockNumFrames <= 5; blockNumFrames++) {
+		roundTrip(tone, 2, 3, blockNumFrames);
+	}
+}
+
+TEST(LosslessCodecTest, fullScaleExtremes) {
+	for (int32_t byteDepth : {2, 3}) {
+		std::vector<uint8_t> pcm;
+		int32_t max = (1 << (byteDepth * 8 - 1)) - 1;
+		for (int32_t n = 0; n < 2000; n++) {
+			putSample(pcm, (n & 1) ? max : -max - 1, byteDepth);
+			putSample(pcm, (n % 3) ? -max - 1 : max, byteDepth);
+		}
+		roundTrip(pcm, 2, byteDepth, 512);
+	}
+}
+
+TEST(LosslessCodecTest, noiseFallsBackToVerbatim) {
+	std::mt19937 rng(3);
+	std::vector<uint8_t> noise = makeNoise(1024, 2, 2, rng);
+	CHECK_EQUAL(getMaxBlockNumBytes(1024, 2, 2), (int32_t)roundTrip(noise, 2, 2, 1024));
+}
+
+TEST(LosslessCodecTest, rejectsDamagedBlocks) {
+	std::mt19937 rng(4);
+	std::vector<uint8_t> tone = makeTone(1024, 2, 2, rng);
+	std::vector<int32_t> scratch(1024);
+	std::vector<uint8_t> encoded(getMaxBlockNumBytes(1024, 2, 2));
+	std::vector<uint8_t> decoded(1024 * 4);
+	int32_t numBytes = encodeBlock(tone.data(), 1024, 2, 2, encoded.data(), scratch.data());
+
+	// Cut short, or with bytes left over
+	for (int32_t wrongNumBytes : {0, 1, numBytes / 2, numBytes - 1, numBytes + 1}) {
+		CHECK_FALSE(decodeBlock(encoded.data(), wrongNumBytes, 1024, 2, 2, decoded.data(), scratch.data()));
+	}
+
+	// A mode which doesn't exist
+	encoded[0] = (5 << 5);
+	CHECK_FALSE(decodeBlock(encoded.data(), numBytes, 1024, 2, 2, decoded.data(), scratch.data()));
+
+	// Anything else may decode to nonsense, but mustn't go outside the buffers
+	for (int32_t i = 0; i < 1000; i++) {
+		std::vector<uint8_t> garbage = makeNoise(rng() % 4096, 1, 1, rng);
+		decodeBlock(garbage.data(), garbage.size(), 1024, 2, 2, decoded.data(), scratch.data());
+	}
+}
+
+TEST(LosslessCodecTest, compressionRatio) {
+	std::mt19937 rng(5);
+	for (int32_t byteDepth : {2, 3}) {
+		std::vector<uint8_t> tone = makeTone(441000, 2, byteDepth, rng);
+		size_t numBytes = roundTrip(tone, 2, byteDepth, 1024);
+
+		// The noise is as loud either way, so takes a byte more per sample to code at 24 bits
+		CHECK(numBytes * (byteDepth == 2 ? 2 : 3) < tone.size() * (byteDepth == 2 ? 1 : 2));
+	}
+}
+
+} // namespace
@@ -0,0 +1,3 @@
+#pragma once
+// The firmware's NEON code, on x86, through SIMDe (SIMDE_ENABLE_NATIVE_ALIASES gives the intrinsics their ARM names)
+#include <simde/arm/neon.h>
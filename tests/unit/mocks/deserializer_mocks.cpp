@@ -0,0 +1,113 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// What SnapshotDeserializer needs from the rest of the firmware - which is far too tied up with the hardware and the
+// memory allocator to build here
+#include "processing/engines/audio_engine.h"
+#include "storage/storage_manager.h"
+#include "util/d_string.h"
+#include <cstdlib>
+#include <cstring>
+
+void AudioEngine::logAction(char const* string) {
+}
+
+bool AudioEngine::yieldIsDue() {
+	return false;
+}
+
+void Deserializer::doRoutinesWhileReading() {
+}
+
+// As the real one, without the firmware version checks
+Error Deserializer::readUpToFirstTag(char const* firstTagName, char const* altTagName, bool ignoreIncorrectFirmware) {
+	char const* tagName;
+	while (*(tagName = readNextTagOrAttributeName())) {
+		if (!strcmp(tagName, firstTagName) || !strcmp(tagName, altTagName)) {
+			return Error::NONE;
+		}
+		exitTag(tagName);
+	}
+	return Error::FILE_CORRUPTED;
+}
+
+bool getNibble(char ch, int* nibble) {
+	if ('0' <= ch && ch <= '9') {
+		*nibble = ch - '0';
+	}
+	else if ('a' <= ch && ch <= 'f') {
+		*nibble = ch - 'a' + 10;
+	}
+	else if ('A' <= ch && ch <= 'F') {
+		*nibble = ch - 'A' + 10;
+	}
+	else {
+		return false;
+	}
+	return true;
+}
+
+char halfByteToHexChar(uint8_t thisHalfByte) {
+	return "0123456789ABCDEF"[thisHalfByte & 15];
+}
+
+uint32_t hexToIntFixedLength(char const* __restrict__ hexChars, int32_t length) {
+	uint32_t output = 0;
+	for (int32_t i = 0; i < length; i++) {
+		output = (output << 4) | ((hexChars[i] >= 'A') ? (hexChars[i] - 55) : (hexChars[i] - '0'));
+	}
+	return output;
+}
+
+uint32_t hexToInt(char const* string) {
+	return hexToIntFixedLength(string, strlen(string));
+}
+
+// Just enough of String, on the heap
+const char nothing = 0;
+
+String::~String() {
+	clear(true);
+}
+
+void String::clear(bool destructing) {
+	free(stringMemory);
+	stringMemory = nullptr;
+}
+
+Error String::set(char const* newChars, int32_t newLength) {
+	clear();
+	return concatenateAtPos(newChars, 0, newLength);
+}
+
+Error String::concatenateAtPos(char const* newChars, int32_t pos, int32_t newCharsLength) {
+	if (newCharsLength < 0) {
+		newCharsLength = strlen(newChars);
+	}
+	if (!pos && !newCharsLength) {
+		clear();
+		return Error::NONE;
+	}
+	char* newMemory = (char*)realloc(stringMemory, pos + newCharsLength + 1);
+	if (!newMemory) {
+		return Error::INSUFFICIENT_RAM;
+	}
+	stringMemory = newMemory;
+	memcpy(&stringMemory[pos], newChars, newCharsLength);
+	stringMemory[pos + newCharsLength] = 0;
+	return Error::NONE;
+}
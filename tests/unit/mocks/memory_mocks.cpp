@@ -0,0 +1,45 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "memory/memory_allocator_interface.h"
+#include <cstdlib>
+
+void* allocMaxSpeed(uint32_t requiredSize, void*) {
+	return malloc(requiredSize);
+}
+
+void* allocLowSpeed(uint32_t requiredSize, void*) {
+	return malloc(requiredSize);
+}
+
+extern "C" {
+void* delugeAlloc(unsigned int requiredSize, bool) {
+	return malloc(requiredSize);
+}
+
+void delugeDealloc(void* address) {
+	free(address);
+}
+
+// NE10 calls this while setting up an FFT, to keep audio going
+void routineWithClusterLoading() {
+}
+
+// Referenced by NE10_fft.c, but only for float FFTs, which the firmware doesn't build
+void* ne10_fft_alloc_c2c_float32_c(int) {
+	return nullptr;
+}
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright © 2024 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// What util/functions.cpp needs from the UI, which the filters only link against for instantTan() and quickLog()
+#include "gui/l10n/l10n.h"
+#include "gui/ui/qwerty_ui.h"
+#include "hid/display/display.h"
+#include "hid/encoder.h"
+#include "hid/encoders.h"
+#include "processing/engines/audio_engine.h"
+
+uint32_t currentUIMode = 0;
+bool QwertyUI::predictionInterrupted;
+deluge::hid::Display* display = nullptr;
+
+namespace deluge::hid::encoders {
+Encoder::Encoder() {
+	encPos = 0;
+	detentPos = 0;
+	encLastChange = 0;
+	pinALastSwitch = 1;
+	pinBLastSwitch = 1;
+	pinALastRead = 1;
+	pinBLastRead = 1;
+	doDetents = true;
+	valuesNow[0] = true;
+	valuesNow[1] = true;
+}
+
+Encoder& getEncoder(EncoderName which) {
+	static Encoder encoders[util::to_underlying(EncoderName::MAX_ENCODER)];
+	return encoders[util::to_underlying(which)];
+}
+} // namespace deluge::hid::encoders
+
+const char* deluge::l10n::get(deluge::l10n::String string) {
+	return "";
+}
+
+int32_t AudioEngine::cpuDireness = 0;
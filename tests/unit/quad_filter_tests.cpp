@@ -0,0 +1,148 @@
+#include "CppUTest/TestHarness.h"
+#include "dsp/filter/filter_set.h"
+#include "dsp/filter/quad_filter.h"
+#include "util/waves.h"
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+using deluge::dsp::filter::FilterSet;
+using deluge::dsp::filter::QuadFilter;
+
+namespace {
+
+constexpr int32_t kNumLanes = QuadFilter::kNumLanes;
+
+// Not a multiple of kNumLanes, so the samples left over at the end get done too
+constexpr int32_t kNumSamples = 4 * 64 + 3;
+
+// With the 24dB ladder's noise drawn in the same order, QuadFilter should give exactly what FilterSet does. This allows
+// for vqdmulh() saturating -1 * -1, should it ever come up
+constexpr int32_t kTolerance = 4;
+
+struct Setup {
+	FilterMode lpfMode;
+	FilterMode hpfMode;
+	FilterRoute routing;
+};
+
+// The same modes in every lane, as QuadFilter needs, but each with its own random frequencies, resonances and morphs -
+// so each has its own coefficients
+void configure(std::array<FilterSet, kNumLanes>& filterSets, Setup const& setup, std::mt19937& rng) {
+	std::uniform_int_distribution<int32_t> frequency(1 << 24, 1 << 30);
+	std::uniform_int_distribution<int32_t> resonanceOrMorph(0, (1 << 29) - 1);
+	for (FilterSet& filterSet : filterSets) {
+		filterSet = FilterSet{};
+		filterSet.reset();
+		filterSet.setConfig(frequency(rng), resonanceOrMorph(rng), setup.lpfMode, resonanceOrMorph(rng), frequency(rng),
+		                    resonanceOrMorph(rng), setup.hpfMode, resonanceOrMorph(rng), ONE_Q31 >> 1, setup.routing,
+		                    false, nullptr);
+	}
+}
+
+std::array<std::vector<q31_t>, kNumLanes> makeInput(std::mt19937& rng) {
+	std::array<std::vector<q31_t>, kNumLanes> input;
+	for (auto& lane : input) {
+		lane.resize(kNumSamples);
+		for (q31_t& sample : lane) {
+			sample = (int32_t)rng() >> 2;
+		}
+	}
+	return input;
+}
+
+// Each FilterSet's scalar path, one sample at a time from each lane in turn - which is the order QuadFilter draws the
+// 24dB ladder's noise in
+void renderScalar(std::array<FilterSet, kNumLanes>& filterSets, std::array<std::vector<q31_t>, kNumLanes>& buffers) {
+	for (int32_t i = 0; i < kNumSamples; i++) {
+		for (int32_t l = 0; l < kNumLanes; l++) {
+			filterSets[l].renderLong(&buffers[l][i], &buffers[l][i + 1], 1);
+		}
+	}
+}
+
+void renderQuad(std::array<FilterSet, kNumLanes>& filterSets, std::array<std::vector<q31_t>, kNumLanes>& buffers) {
+	std::array<FilterSet*, kNumLanes> filterSetPointers;
+	std::array<q31_t*, kNumLanes> bufferPointers;
+	for (int32_t l = 0; l < kNumLanes; l++) {
+		CHECK(QuadFilter::canRender(filterSets[l]));
+		filterSetPointers[l] = &filterSets[l];
+		bufferPointers[l] = buffers[l].data();
+	}
+	QuadFilter::renderLong(filterSetPointers, bufferPointers, kNumSamples);
+}
+
+int32_t maxDifference(std::array<std::vector<q31_t>, kNumLanes> const& a,
+                      std::array<std::vector<q31_t>, kNumLanes> const& b) {
+	int64_t difference = 0;
+	for (int32_t l = 0; l < kNumLanes; l++) {
+		for (int32_t i = 0; i < kNumSamples; i++) {
+			difference = std::max<int64_t>(difference, std::abs((int64_t)a[l][i] - b[l][i]));
+		}
+	}
+	return difference;
+}
+
+// A setup against FilterSet, for a few random sets of coefficients. Then each carries on with the other's FilterSets,
+// so the state QuadFilter reads in and writes back has to be right too
+void checkAgainstFilterSet(Setup const& setup) {
+	std::mt19937 rng(util::to_underlying(setup.lpfMode) * 100 + util::to_underlying(setup.hpfMode) * 10
+	                 + util::to_underlying(setup.routing));
+	CHECK(QuadFilter::supports(setup.lpfMode, setup.hpfMode, setup.routing));
+
+	for (int32_t attempt = 0; attempt < 8; attempt++) {
+		std::array<FilterSet, kNumLanes> scalarFilterSets;
+		configure(scalarFilterSets, setup, rng);
+		std::array<FilterSet, kNumLanes> quadFilterSets = scalarFilterSets;
+		std::array<std::vector<q31_t>, kNumLanes> input = makeInput(rng);
+
+		jcong = 12345;
+		std::array<std::vector<q31_t>, kNumLanes> expected = input;
+		renderScalar(scalarFilterSets, expected);
+
+		jcong = 12345;
+		std::array<std::vector<q31_t>, kNumLanes> output = input;
+		renderQuad(quadFilterSets, output);
+
+		CHECK(maxDifference(output, expected) <= kTolerance);
+
+		input = makeInput(rng);
+		jcong = 54321;
+		expected = input;
+		renderScalar(quadFilterSets, expected);
+
+		jcong = 54321;
+		output = input;
+		renderQuad(scalarFilterSets, output);
+
+		CHECK(maxDifference(output, expected) <= kTolerance);
+	}
+}
+
+TEST_GROUP(QuadFilterTest){};
+
+TEST(QuadFilterTest, svfLowPass) {
+	checkAgainstFilterSet({FilterMode::SVF_BAND, FilterMode::OFF, FilterRoute::HIGH_TO_LOW});
+	checkAgainstFilterSet({FilterMode::SVF_NOTCH, FilterMode::OFF, FilterRoute::HIGH_TO_LOW});
+}
+
+TEST(QuadFilterTest, svfHighPass) {
+	checkAgainstFilterSet({FilterMode::OFF, FilterMode::SVF_BAND, FilterRoute::HIGH_TO_LOW});
+	checkAgainstFilterSet({FilterMode::OFF, FilterMode::SVF_NOTCH, FilterRoute::LOW_TO_HIGH});
+}
+
+TEST(QuadFilterTest, ladder) {
+	checkAgainstFilterSet({FilterMode::TRANSISTOR_24DB, FilterMode::OFF, FilterRoute::HIGH_TO_LOW});
+}
+
+TEST(QuadFilterTest, ladderThenSVF) {
+	checkAgainstFilterSet({FilterMode::TRANSISTOR_24DB, FilterMode::SVF_BAND, FilterRoute::LOW_TO_HIGH});
+	checkAgainstFilterSet({FilterMode::TRANSISTOR_24DB, FilterMode::SVF_NOTCH, FilterRoute::HIGH_TO_LOW});
+}
+
+TEST(QuadFilterTest, svfThenSVF) {
+	checkAgainstFilterSet({FilterMode::SVF_NOTCH, FilterMode::SVF_BAND, FilterRoute::LOW_TO_HIGH});
+}
+
+} // namespace
@@ -0,0 +1,159 @@
+#include "CppUTest/TestHarness.h"
+#include "storage/audio/raw_data_conversion.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr int32_t kMaxNumWords = 70;
+constexpr int32_t kGuardNumBytes = 8;
+
+// What each format's words should become, worked out the long way round
+uint32_t floatToIntReference(uint32_t bits) {
+	float value;
+	std::memcpy(&value, &bits, sizeof(value));
+	bool negative = bits >> 31;
+	double magnitude = std::fabs((double)value);
+	int32_t result = (std::isnan(value) || magnitude >= 1) ? 2147483647 : (int32_t)std::trunc(magnitude * 2147483648.0);
+	return negative ? -result : result;
+}
+
+uint32_t swapEndianness32Reference(uint32_t bits) {
+	return (bits >> 24) | ((bits >> 8) & 0xFF00) | ((bits << 8) & 0xFF0000) | (bits << 24);
+}
+
+uint32_t swapEndianness16Reference(uint32_t bits) {
+	uint32_t low = bits & 0xFFFF;
+	uint32_t high = bits >> 16;
+	return ((low >> 8) | ((low & 0xFF) << 8)) | (((high >> 8) | ((high & 0xFF) << 8)) << 16);
+}
+
+uint32_t unsigned8ToSignedReference(uint32_t bits) {
+	uint32_t result = 0;
+	for (int32_t i = 0; i < 4; i++) {
+		int32_t sample = (int32_t)((bits >> (i * 8)) & 0xFF) - 128;
+		result |= (uint32_t)(sample & 0xFF) << (i * 8);
+	}
+	return result;
+}
+
+std::vector<uint32_t> makeWords(std::mt19937& rng) {
+	std::vector<uint32_t> words(kMaxNumWords);
+	for (auto& word : words) {
+		word = rng();
+	}
+	return words;
+}
+
+// Floats a WAV could hold: mostly within full scale, with every sort of edge case mixed in
+std::vector<uint32_t> makeFloats(std::mt19937& rng) {
+	std::vector<float> special{0.0f,
+	                           -0.0f,
+	                           1.0f,
+	                           -1.0f,
+	                           0.99999994f,
+	                           -0.99999994f,
+	                           0.5f,
+	                           1.5f,
+	                           -3.0f,
+	                           std::numeric_limits<float>::infinity(),
+	                           -std::numeric_limits<float>::infinity(),
+	                           std::numeric_limits<float>::quiet_NaN(),
+	                           -std::numeric_limits<float>::quiet_NaN(),
+	                           std::numeric_limits<float>::denorm_min(),
+	                           std::numeric_limits<float>::min(),
+	                           std::ldexp(1.0f, -31),
+	                           std::ldexp(1.0f, -32),
+	                           -std::ldexp(1.0f, -33)};
+	std::uniform_real_distribution<float> inRange(-1.0f, 1.0f);
+	std::vector<uint32_t> words(kMaxNumWords);
+	for (size_t i = 0; i < words.size(); i++) {
+		float value = (i < special.size()) ? special[i] : inRange(rng) * std::ldexp(1.0f, -(int32_t)(rng() % 40));
+		std::memcpy(&words[i], &value, sizeof(value));
+	}
+	std::shuffle(words.begin(), words.end(), rng);
+	return words;
+}
+
+// Runs the converter on every length up to kMaxNumWords, at every misalignment, and checks each word came out as the
+// reference says, and nothing either side was touched
+void checkWordConverter(void (*convert)(int32_t*, int32_t), uint32_t (*reference)(uint32_t),
+                        std::vector<uint32_t> const& words) {
+	std::vector<uint8_t> buffer(kMaxNumWords * 4 + 4 + kGuardNumBytes * 2);
+	for (int32_t numWords = 0; numWords <= kMaxNumWords; numWords++) {
+		for (int32_t misalignment = 0; misalignment < 4; misalignment++) {
+			std::fill(buffer.begin(), buffer.end(), 0x5A);
+			uint8_t* data = &buffer[kGuardNumBytes + misalignment];
+			std::memcpy(data, words.data(), numWords * 4);
+
+			convert((int32_t*)data, numWords);
+
+			for (int32_t i = 0; i < numWords; i++) {
+				uint32_t word;
+				std::memcpy(&word, &data[i * 4], 4);
+				UNSIGNED_LONGS_EQUAL(reference(words[i]), word);
+			}
+			for (int32_t i = 0; i < kGuardNumBytes + misalignment; i++) {
+				CHECK_EQUAL(0x5A, buffer[i]);
+			}
+			for (size_t i = kGuardNumBytes + misalignment + numWords * 4; i < buffer.size(); i++) {
+				CHECK_EQUAL(0x5A, buffer[i]);
+			}
+		}
+	}
+}
+
+TEST_GROUP(RawDataConversionTest){};
+
+TEST(RawDataConversionTest, floatToInt) {
+	std::mt19937 rng(1);
+	for (int32_t i = 0; i < 20; i++) {
+		checkWordConverter(RawDataConversion::floatToInt, floatToIntReference, makeFloats(rng));
+	}
+	checkWordConverter(RawDataConversion::floatToInt, floatToIntReference, makeWords(rng));
+}
+
+TEST(RawDataConversionTest, swapEndianness32) {
+	std::mt19937 rng(2);
+	checkWordConverter(RawDataConversion::swapEndianness32, swapEndianness32Reference, makeWords(rng));
+}
+
+TEST(RawDataConversionTest, swapEndianness16) {
+	std::mt19937 rng(3);
+	checkWordConverter(RawDataConversion::swapEndianness16, swapEndianness16Reference, makeWords(rng));
+}
+
+TEST(RawDataConversionTest, unsigned8ToSigned) {
+	std::mt19937 rng(4);
+	checkWordConverter(RawDataConversion::unsigned8ToSigned, unsigned8ToSignedReference, makeWords(rng));
+}
+
+TEST(RawDataConversionTest, swapEndianness24) {
+	std::mt19937 rng(5);
+	std::vector<uint8_t> original(kMaxNumWords * 3);
+	for (auto& byte : original) {
+		byte = rng();
+	}
+	std::vector<uint8_t> buffer(original.size() + kGuardNumBytes * 2);
+	for (int32_t numSamples = 0; numSamples <= kMaxNumWords; numSamples++) {
+		std::fill(buffer.begin(), buffer.end(), 0x5A);
+		std::memcpy(&buffer[kGuardNumBytes], original.data(), numSamples * 3);
+
+		RawDataConversion::swapEndianness24(&buffer[kGuardNumBytes], numSamples);
+
+		for (int32_t i = 0; i < numSamples; i++) {
+			CHECK_EQUAL(original[i * 3 + 2], buffer[kGuardNumBytes + i * 3]);
+			CHECK_EQUAL(original[i * 3 + 1], buffer[kGuardNumBytes + i * 3 + 1]);
+			CHECK_EQUAL(original[i * 3], buffer[kGuardNumBytes + i * 3 + 2]);
+		}
+		for (int32_t i = 0; i < kGuardNumBytes; i++) {
+			CHECK_EQUAL(0x5A, buffer[i]);
+			CHECK_EQUAL(0x5A, buffer[kGuardNumBytes + numSamples * 3 + i]);
+		}
+	}
+}
+
+} // namespace
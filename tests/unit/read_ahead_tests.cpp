@@ -0,0 +1,70 @@
+#include "CppUTest/TestHarness.h"
+#include "model/sample/sample_read_ahead.h"
+
+namespace {
+
+constexpr uint32_t kClusterSize = 32768;
+
+// Stereo 24-bit at normal speed
+constexpr uint64_t kBytesPerSampleStereo24 = (uint64_t)6 << 24;
+
+TEST_GROUP(ReadAheadTest){};
+
+TEST(ReadAheadTest, normalPlaybackKeepsTheOldDepth) {
+	// 10ms of load latency is a couple of kB at most
+	CHECK_EQUAL(kNumClustersLoadedAhead, getNumClustersToLoadAhead(kBytesPerSampleStereo24, 441, kClusterSize));
+	CHECK_EQUAL(kNumClustersLoadedAhead, getNumClustersToLoadAhead(0, 441, kClusterSize));
+	CHECK_EQUAL(kNumClustersLoadedAhead, getNumClustersToLoadAhead(kBytesPerSampleStereo24, 0, kClusterSize));
+}
+
+TEST(ReadAheadTest, goesDeeperWithSpeedAndLatency) {
+	// 100ms while pitched up two octaves: 4 * 6 * 4410 * 2 = 211680 bytes, which is 7 Clusters - so the most
+	CHECK_EQUAL(kMaxNumClustersLoadedAhead, getNumClustersToLoadAhead(kBytesPerSampleStereo24 * 4, 4410, kClusterSize));
+
+	// 100ms at normal speed: 52920 bytes, or 2 Clusters, plus the one being read
+	CHECK_EQUAL(3, getNumClustersToLoadAhead(kBytesPerSampleStereo24, 4410, kClusterSize));
+
+	// Smaller Clusters need more of them
+	CHECK_EQUAL(5, getNumClustersToLoadAhead(kBytesPerSampleStereo24, 4410, kClusterSize / 2));
+
+	int32_t last = 0;
+	for (uint32_t latency = 0; latency < 44100; latency += 441) {
+		int32_t numClusters = getNumClustersToLoadAhead(kBytesPerSampleStereo24, latency, kClusterSize);
+		CHECK(numClusters >= last);
+		last = numClusters;
+	}
+	CHECK_EQUAL(kMaxNumClustersLoadedAhead, last);
+}
+
+TEST(ReadAheadTest, loadLatencySmoothsBothWays) {
+	// One slow read only takes it a quarter of the way up
+	CHECK_EQUAL(441 + 1000, smoothLoadLatency(441, 441 + 4000));
+
+	// And one quick one a sixteenth of the way down
+	CHECK_EQUAL(4410 - 250, smoothLoadLatency(4410, 4410 - 4000));
+
+	CHECK_EQUAL(441, smoothLoadLatency(441, 441));
+
+	// A card that's gone slow gets caught up with, rounding all the way up to it...
+	uint32_t latency = 441;
+	int32_t numReads = 0;
+	while (latency != 4410) {
+		latency = smoothLoadLatency(latency, 4410);
+		numReads++;
+	}
+	CHECK(numReads < 40);
+
+	// ...and one that's gone fast again gets eased back down to
+	numReads = 0;
+	while (latency > 441 + 15) {
+		latency = smoothLoadLatency(latency, 441);
+		numReads++;
+	}
+	CHECK(numReads > 10);
+	CHECK(numReads < 100);
+}
+
+// A whole second's latency, at the fastest a reader goes
+static_assert(getNumClustersToLoadAhead(kBytesPerSampleStereo24 * 256, 44100, 512) == kMaxNumClustersLoadedAhead);
+
+} // namespace
@@ -0,0 +1,351 @@
+#include "CppUTest/TestHarness.h"
+#include "storage/block/read_pipeline.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+
+// A card backed by a temporary file on the host, which keeps its own time. Each read waits accessLatencyUS (during
+// which others may be waiting too - as with a card that queues commands), then holds the bus for usPerSector per sector
+// while its data transfers. Reads which would be finished by the time they're started finish straight away
+class FakeCard final : public BlockDevice {
+public:
+	FakeCard(std::vector<uint8_t> const& contents, int32_t maxReadsInFlight, uint64_t accessLatencyUS,
+	         uint64_t usPerSector)
+	    : maxReadsInFlight_(maxReadsInFlight), accessLatencyUS_(accessLatencyUS), usPerSector_(usPerSector),
+	      numSectors_(contents.size() / kBlockSizeBytes) {
+		file_ = std::tmpfile();
+		std::fwrite(contents.data(), 1, contents.size(), file_);
+	}
+	~FakeCard() override { std::fclose(file_); }
+
+	int32_t getMaxReadsInFlight() override { return maxReadsInFlight_; }
+
+	bool startRead(BlockReadRequest* request) override {
+		if ((int32_t)pending_.size() >= maxReadsInFlight_) {
+			return false;
+		}
+		uint64_t transferStart = std::max(now + accessLatencyUS_, busFreeAt_);
+		busFreeAt_ = transferStart + request->numSectors * usPerSector_;
+		pending_.push_back({request, busFreeAt_});
+		numReadsStarted++;
+		maxNumReadsSeenInFlight = std::max<int32_t>(maxNumReadsSeenInFlight, pending_.size());
+		advanceTo(now);
+		return true;
+	}
+
+	// Nothing to do but wait for the next read to finish
+	void waitForNext() {
+		if (!pending_.empty()) {
+			uint64_t next = pending_[0].finishTime;
+			for (auto& read : pending_) {
+				next = std::min(next, read.finishTime);
+			}
+			advanceTo(next);
+		}
+	}
+
+	void advanceTo(uint64_t time) {
+		now = std::max(now, time);
+		std::sort(pending_.begin(), pending_.end(), [](auto& a, auto& b) { return a.finishTime < b.finishTime; });
+		while (!pending_.empty() && pending_[0].finishTime <= now) {
+			finish(pending_[0].request);
+			pending_.erase(pending_.begin());
+		}
+	}
+
+	uint64_t now = 0;
+	int32_t numReadsStarted = 0;
+	int32_t maxNumReadsSeenInFlight = 0;
+
+private:
+	struct PendingRead {
+		BlockReadRequest* request;
+		uint64_t finishTime;
+	};
+
+	void finish(BlockReadRequest* request) {
+		if (request->sector + request->numSectors > numSectors_) {
+			request->result = Error::SD_CARD;
+		}
+		else {
+			std::fseek(file_, request->sector * kBlockSizeBytes, SEEK_SET);
+			size_t numBytes = request->numSectors * kBlockSizeBytes;
+			request->result =
+			    (std::fread(request->buffer, 1, numBytes, file_) == numBytes) ? Error::NONE : Error::SD_CARD;
+		}
+		request->finished = true;
+	}
+
+	std::FILE* file_;
+	int32_t maxReadsInFlight_;
+	uint64_t accessLatencyUS_;
+	uint64_t usPerSector_;
+	uint64_t busFreeAt_ = 0;
+	uint32_t numSectors_;
+	std::vector<PendingRead> pending_;
+};
+
+constexpr int32_t kSectorsPerCluster = 64; // 32kB, as on most cards
+constexpr int32_t kClusterSizeBytes = kSectorsPerCluster * kBlockSizeBytes;
+
+std::vector<uint8_t> makeCardContents(int32_t numClusters, std::mt19937& rng) {
+	std::vector<uint8_t> contents(numClusters * kClusterSizeBytes);
+	for (auto& byte : contents) {
+		byte = rng();
+	}
+	return contents;
+}
+
+// Loads the given clusters the way AudioFileManager::loadAnyEnqueuedClusters() does: keeping the card as busy as it
+// can be, and spending convertUS of its own time on each one as it arrives. Returns the order they arrived in
+std::vector<int32_t> loadClusters(FakeCard& card, ReadPipeline& pipeline, std::vector<int32_t> const& clustersOnCard,
+                                  std::vector<std::vector<uint8_t>>& buffers, uint64_t convertUS) {
+	std::vector<int32_t> arrived;
+	size_t numStarted = 0;
+	while (arrived.size() < clustersOnCard.size()) {
+		while (numStarted < clustersOnCard.size() && pipeline.hasRoom()) {
+			CHECK(pipeline.startRead(clustersOnCard[numStarted] * kSectorsPerCluster, kSectorsPerCluster,
+			                         buffers[numStarted].data(), &buffers[numStarted]));
+			numStarted++;
+		}
+
+		BlockReadRequest finishedRead;
+		if (pipeline.takeFinished(&finishedRead)) {
+			CHECK(finishedRead.result == Error::NONE);
+			CHECK_FALSE(pipeline.isReading(finishedRead.context));
+			arrived.push_back((std::vector<uint8_t>*)finishedRead.context - buffers.data());
+			card.advanceTo(card.now + convertUS);
+		}
+		else {
+			card.waitForNext();
+		}
+	}
+	CHECK(pipeline.isIdle());
+	return arrived;
+}
+
+TEST_GROUP(ReadPipelineTest){};
+
+TEST(ReadPipelineTest, readsArriveIntact) {
+	std::mt19937 rng(1);
+	constexpr int32_t kNumClusters = 40;
+	std::vector<uint8_t> contents = makeCardContents(kNumClusters, rng);
+
+	// Scattered about the card, as a fragmented file's would be
+	std::vector<int32_t> clustersOnCard(kNumClusters);
+	std::iota(clustersOnCard.begin(), clustersOnCard.end(), 0);
+	std::shuffle(clustersOnCard.begin(), clustersOnCard.end(), rng);
+
+	for (int32_t maxReadsInFlight : {1, 3, 8}) {
+		FakeCard card(contents, maxReadsInFlight, 500, 25);
+		ReadPipeline pipeline(card);
+		std::vector<std::vector<uint8_t>> buffers(kNumClusters, std::vector<uint8_t>(kClusterSizeBytes));
+
+		std::vector<int32_t> arrived = loadClusters(card, pipeline, clustersOnCard, buffers, 100);
+
+		CHECK_EQUAL(kNumClusters, (int32_t)arrived.size());
+		CHECK_EQUAL(std::min(maxReadsInFlight, ReadPipeline::kMaxReadsInFlight), card.maxNumReadsSeenInFlight);
+		for (int32_t i = 0; i < kNumClusters; i++) {
+			CHECK(!std::memcmp(buffers[i].data(), &contents[clustersOnCard[i] * kClusterSizeBytes], kClusterSizeBytes));
+		}
+	}
+}
+
+TEST(ReadPipelineTest, readsWhichFinishRightAwayAreCollected) {
+	std::mt19937 rng(2);
+	std::vector<uint8_t> contents = makeCardContents(4, rng);
+	FakeCard card(contents, 1, 0, 0);
+	ReadPipeline pipeline(card);
+	std::vector<uint8_t> buffer(kClusterSizeBytes);
+
+	CHECK(pipeline.startRead(2 * kSectorsPerCluster, kSectorsPerCluster, buffer.data(), &buffer));
+	CHECK_FALSE(pipeline.hasRoom());
+	CHECK(pipeline.isReading(&buffer));
+
+	BlockReadRequest finishedRead;
+	CHECK(pipeline.takeFinished(&finishedRead));
+	POINTERS_EQUAL(&buffer, finishedRead.context);
+	CHECK(finishedRead.result == Error::NONE);
+	CHECK(!std::memcmp(buffer.data(), &contents[2 * kClusterSizeBytes], kClusterSizeBytes));
+	CHECK(pipeline.isIdle());
+	CHECK_FALSE(pipeline.takeFinished(&finishedRead));
+}
+
+TEST(ReadPipelineTest, failedReadsAreHandedBack) {
+	std::mt19937 rng(3);
+	std::vector<uint8_t> contents = makeCardContents(2, rng);
+	FakeCard card(contents, 2, 100, 10);
+	ReadPipeline pipeline(card);
+	std::vector<uint8_t> buffer(kClusterSizeBytes);
+
+	CHECK(pipeline.startRead(5 * kSectorsPerCluster, kSectorsPerCluster, buffer.data(), &buffer));
+	BlockReadRequest finishedRead;
+	CHECK_FALSE(pipeline.takeFinished(&finishedRead));
+	card.waitForNext();
+	CHECK(pipeline.takeFinished(&finishedRead));
+	CHECK(finishedRead.result == Error::SD_CARD);
+	CHECK(pipeline.isIdle());
+}
+
+TEST(ReadPipelineTest, neverStartsMoreThanTheCardTakes) {
+	std::mt19937 rng(4);
+	std::vector<uint8_t> contents = makeCardContents(4, rng);
+	FakeCard card(contents, 2, 100, 10);
+	ReadPipeline pipeline(card);
+	std::vector<std::vector<uint8_t>> buffers(3, std::vector<uint8_t>(kClusterSizeBytes));
+
+	CHECK(pipeline.startRead(0, kSectorsPerCluster, buffers[0].data(), &buffers[0]));
+	CHECK(pipeline.startRead(kSectorsPerCluster, kSectorsPerCluster, buffers[1].data(), &buffers[1]));
+	CHECK_FALSE(pipeline.hasRoom());
+	CHECK_FALSE(pipeline.startRead(0, kSectorsPerCluster, buffers[2].data(), &buffers[2]));
+	CHECK_FALSE(pipeline.isReading(&buffers[2]));
+	CHECK_EQUAL(2, pipeline.getNumInFlight());
+	CHECK_EQUAL(2, card.numReadsStarted);
+}
+
+// Takes one read at a time, like SDBlockDevice: the rest wait in a queue til poll() starts them, and the one that's going
+// is finished by endTransfer() - standing in for the interrupt
+class QueueingCard final : public BlockDevice {
+public:
+	int32_t getMaxReadsInFlight() override { return 4; }
+
+	bool startRead(BlockReadRequest* request) override {
+		queue.push_back(request);
+		poll();
+		return true;
+	}
+
+	void poll() override {
+		if (!transferring && !queue.empty()) {
+			transferring = queue.front();
+			queue.erase(queue.begin());
+			numReadsStarted++;
+		}
+	}
+
+	void endTransfer() {
+		std::memset(transferring->buffer, transferring->sector, transferring->numSectors * kBlockSizeBytes);
+		transferring->result = Error::NONE;
+		transferring->finished = true;
+		transferring = nullptr;
+	}
+
+	BlockReadRequest* transferring = nullptr;
+	std::vector<BlockReadRequest*> queue;
+	int32_t numReadsStarted = 0;
+
+protected:
+	void whileWaiting() override {
+		if (transferring) {
+			endTransfer();
+		}
+	}
+};
+
+TEST(ReadPipelineTest, queuedReadsStartWhenThePipelineLooks) {
+	QueueingCard card;
+	ReadPipeline pipeline(card);
+	std::vector<std::vector<uint8_t>> buffers(3, std::vector<uint8_t>(kBlockSizeBytes));
+
+	for (int32_t i = 0; i < 3; i++) {
+		CHECK(pipeline.startRead(i + 1, 1, buffers[i].data(), &buffers[i]));
+	}
+	CHECK_EQUAL(1, card.numReadsStarted);
+	CHECK_EQUAL(3, pipeline.getNumInFlight());
+
+	BlockReadRequest finishedRead;
+	for (int32_t i = 0; i < 3; i++) {
+		card.endTransfer();
+		CHECK(pipeline.takeFinished(&finishedRead));
+		POINTERS_EQUAL(&buffers[i], finishedRead.context);
+		CHECK_EQUAL(i + 1, buffers[i][0]);
+		// Looking was enough to get the next one going
+		CHECK_EQUAL(std::min(i + 2, 3), card.numReadsStarted);
+	}
+	CHECK(pipeline.isIdle());
+
+	// And readAndWait() gets its turn after what's already queued
+	CHECK(pipeline.startRead(4, 1, buffers[0].data(), &buffers[0]));
+	CHECK(card.readAndWait(5, 1, buffers[1].data()) == Error::NONE);
+	CHECK_EQUAL(5, buffers[1][0]);
+	CHECK(pipeline.takeFinished(&finishedRead));
+	CHECK_EQUAL(4, buffers[0][0]);
+}
+
+// Clusters of the given numbers of sectors, 0 meaning one that can't be had
+CoalescedReadPlan planFor(uint32_t firstNumSectors, std::vector<uint32_t> const& nextNumSectors, int32_t maxNumClusters,
+                          int32_t* numAsked) {
+	*numAsked = 0;
+	return planCoalescedRead(firstNumSectors, kSectorsPerCluster, maxNumClusters, [&](int32_t i) {
+		CHECK_EQUAL(*numAsked + 1, i);
+		(*numAsked)++;
+		return nextNumSectors[i - 1];
+	});
+}
+
+TEST(ReadPipelineTest, coalescesContiguousClusters) {
+	int32_t numAsked;
+	CoalescedReadPlan plan = planFor(kSectorsPerCluster, {kSectorsPerCluster, kSectorsPerCluster, 64}, 3, &numAsked);
+	CHECK_EQUAL(3, plan.numClusters);
+	CHECK_EQUAL(3 * kSectorsPerCluster, plan.numSectors);
+	CHECK_EQUAL(2, numAsked);
+
+	// A short one ends it
+	plan = planFor(kSectorsPerCluster, {10, kSectorsPerCluster}, 8, &numAsked);
+	CHECK_EQUAL(2, plan.numClusters);
+	CHECK_EQUAL(kSectorsPerCluster + 10, plan.numSectors);
+	CHECK_EQUAL(1, numAsked);
+
+	// As does one that can't be had - without taking anything off what's already there
+	plan = planFor(kSectorsPerCluster, {kSectorsPerCluster, 0, kSectorsPerCluster}, 8, &numAsked);
+	CHECK_EQUAL(2, plan.numClusters);
+	CHECK_EQUAL(2 * kSectorsPerCluster, plan.numSectors);
+
+	// Including when it's the very next one, leaving the first to be read on its own as it was
+	plan = planFor(kSectorsPerCluster, {0}, 8, &numAsked);
+	CHECK_EQUAL(1, plan.numClusters);
+	CHECK_EQUAL(kSectorsPerCluster, plan.numSectors);
+
+	// And a short first one's never joined by anything
+	plan = planFor(20, {kSectorsPerCluster}, 8, &numAsked);
+	CHECK_EQUAL(1, plan.numClusters);
+	CHECK_EQUAL(20, plan.numSectors);
+	CHECK_EQUAL(0, numAsked);
+}
+
+TEST(ReadPipelineTest, moreInFlightLoadsFaster) {
+	std::mt19937 rng(5);
+	constexpr int32_t kNumClusters = 256;
+	std::vector<uint8_t> contents = makeCardContents(kNumClusters, rng);
+	std::vector<int32_t> clustersOnCard(kNumClusters);
+	std::iota(clustersOnCard.begin(), clustersOnCard.end(), 0);
+
+	// Roughly a class 10 card: 20MB/s once it gets going. Converting 24-bit data takes the CPU a while too
+	constexpr uint64_t kAccessLatencyUS = 500;
+	constexpr uint64_t kUSPerSector = 25;
+	constexpr uint64_t kConvertUS = 400;
+
+	uint64_t oneAtATimeUS = 0;
+	for (int32_t maxReadsInFlight : {1, 2, 4}) {
+		FakeCard card(contents, maxReadsInFlight, kAccessLatencyUS, kUSPerSector);
+		ReadPipeline pipeline(card);
+		std::vector<std::vector<uint8_t>> buffers(kNumClusters, std::vector<uint8_t>(kClusterSizeBytes));
+
+		loadClusters(card, pipeline, clustersOnCard, buffers, kConvertUS);
+
+		if (maxReadsInFlight == 1) {
+			oneAtATimeUS = card.now;
+			CHECK_EQUAL(kNumClusters * (kAccessLatencyUS + kSectorsPerCluster * kUSPerSector + kConvertUS), card.now);
+		}
+		else {
+			CHECK(card.now < oneAtATimeUS);
+		}
+	}
+}
+
+} // namespace
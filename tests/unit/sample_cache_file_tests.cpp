@@ -0,0 +1,118 @@
+#include "CppUTest/TestHarness.h"
+#include "model/sample/sample_cache_file.h"
+#include <cstdio>
+
+namespace {
+
+using SampleCacheFile::FolderScan;
+using SampleCacheFile::kMaxDeletionsPerWrite;
+using SampleCacheFile::kMaxFolderBytes;
+using SampleCacheFile::kMaxNumFiles;
+
+constexpr uint32_t kMegabyte = 1 << 20;
+
+TEST_GROUP(SampleCacheFileTest){};
+
+TEST(SampleCacheFileTest, emptyFolderHasRoom) {
+	FolderScan scan;
+	CHECK(scan.hasRoomFor(kMaxFolderBytes));
+	CHECK(!scan.hasRoomFor(kMaxFolderBytes + 1));
+	POINTERS_EQUAL(nullptr, scan.removeOldest());
+}
+
+// Directory order has nothing to do with age - a deleted file's entry gets reused by the next one written
+TEST(SampleCacheFileTest, deletesOldestFirst) {
+	FolderScan scan;
+	scan.addFile("0000000D.CAC", kMegabyte, 13);
+	scan.addFile("0000000B.CAC", kMegabyte, 11);
+	scan.addFile("0000000E.CAC", kMegabyte, 14);
+	scan.addFile("0000000C.CAC", kMegabyte, 12);
+	CHECK_EQUAL(4 * kMegabyte, scan.totalBytes);
+	CHECK_EQUAL(4, scan.numFiles);
+	CHECK_EQUAL(14, scan.highestWriteNumber);
+
+	STRCMP_EQUAL("0000000B.CAC", scan.removeOldest());
+	STRCMP_EQUAL("0000000C.CAC", scan.removeOldest());
+	STRCMP_EQUAL("0000000D.CAC", scan.removeOldest());
+	STRCMP_EQUAL("0000000E.CAC", scan.removeOldest());
+	POINTERS_EQUAL(nullptr, scan.removeOldest());
+	CHECK_EQUAL(0, scan.totalBytes);
+	CHECK_EQUAL(0, scan.numFiles);
+	CHECK_EQUAL(14, scan.highestWriteNumber);
+}
+
+TEST(SampleCacheFileTest, keepsTheNewestEvenIfItComesFirst) {
+	FolderScan scan;
+	for (uint32_t writeNumber : {9, 1, 2, 3, 4, 5}) {
+		char name[13];
+		snprintf(name, sizeof(name), "%08lX.CAC", (unsigned long)writeNumber);
+		scan.addFile(name, kMegabyte, writeNumber);
+	}
+
+	for (int32_t i = 0; i < kMaxDeletionsPerWrite; i++) {
+		char expected[13];
+		snprintf(expected, sizeof(expected), "%08lX.CAC", (unsigned long)(i + 1));
+		STRCMP_EQUAL(expected, scan.removeOldest());
+	}
+	POINTERS_EQUAL(nullptr, scan.removeOldest());
+	CHECK_EQUAL(9, scan.highestWriteNumber);
+}
+
+TEST(SampleCacheFileTest, filesWithoutAWriteNumberGoFirst) {
+	FolderScan scan;
+	scan.addFile("00000001.CAC", kMegabyte, 7);
+	scan.addFile("00000002.CAC", kMegabyte, 0); // An old version's
+	scan.addFile("00000003.CAC", kMegabyte, 8);
+	CHECK_EQUAL(8, scan.highestWriteNumber);
+
+	STRCMP_EQUAL("00000002.CAC", scan.removeOldest());
+	STRCMP_EQUAL("00000001.CAC", scan.removeOldest());
+}
+
+TEST(SampleCacheFileTest, keepsOnlyAsManyAsCanBeDeletedAtOnce) {
+	FolderScan scan;
+	for (uint32_t writeNumber = 100; writeNumber > 0; writeNumber--) {
+		char name[13];
+		snprintf(name, sizeof(name), "%08lX.CAC", (unsigned long)writeNumber);
+		scan.addFile(name, kMegabyte, writeNumber);
+	}
+	CHECK_EQUAL(100, scan.numFiles);
+
+	for (int32_t i = 0; i < kMaxDeletionsPerWrite; i++) {
+		char expected[13];
+		snprintf(expected, sizeof(expected), "%08lX.CAC", (unsigned long)(i + 1));
+		STRCMP_EQUAL(expected, scan.removeOldest());
+	}
+	POINTERS_EQUAL(nullptr, scan.removeOldest());
+	CHECK_EQUAL(100 - kMaxDeletionsPerWrite, scan.numFiles);
+}
+
+TEST(SampleCacheFileTest, overTheSizeLimit) {
+	FolderScan scan;
+	scan.addFile("00000001.CAC", kMaxFolderBytes - kMegabyte, 1);
+	scan.addFile("00000002.CAC", kMegabyte / 2, 2);
+	CHECK(scan.hasRoomFor(kMegabyte / 2));
+	CHECK(!scan.hasRoomFor(kMegabyte));
+
+	scan.removeOldest();
+	CHECK(scan.hasRoomFor(kMegabyte));
+}
+
+TEST(SampleCacheFileTest, overTheFileLimit) {
+	FolderScan scan;
+	for (int32_t i = 0; i < kMaxNumFiles; i++) {
+		scan.addFile("00000001.CAC", 1, i);
+	}
+	CHECK(!scan.hasRoomFor(1));
+	scan.removeOldest();
+	CHECK(scan.hasRoomFor(1));
+}
+
+TEST(SampleCacheFileTest, countsButWontDeleteFilesThatArentOurs) {
+	FolderScan scan;
+	scan.addFile("someone else's long file name.wav", kMegabyte, 0);
+	CHECK_EQUAL(kMegabyte, scan.totalBytes);
+	POINTERS_EQUAL(nullptr, scan.removeOldest());
+}
+
+} // namespace
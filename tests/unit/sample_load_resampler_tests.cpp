@@ -0,0 +1,43 @@
+#include "CppUTest/TestHarness.h"
+#include "definitions_cxx.hpp"
+#include "model/sample/sample_load_resampler.h"
+
+namespace {
+
+using SampleLoadResampler::getPhaseIncrementForNote;
+
+// What SampleHolderForVoice::sampleBeenSet() works out for a 48kHz Sample
+constexpr int32_t kNeutral48k = ((uint64_t)48000 << 24) / kSampleRate;
+
+TEST_GROUP(SampleLoadResamplerTest){};
+
+TEST(SampleLoadResamplerTest, drumNotePlaysAtTheSamplesOwnRate) {
+	// Near enough - it's worked out at a quarter of the rate, then shifted up
+	int32_t phaseIncrement = getPhaseIncrementForNote(kNeutral48k, kNoteForDrum);
+	CHECK(phaseIncrement <= kNeutral48k);
+	CHECK(phaseIncrement >= kNeutral48k - 3);
+
+	CHECK_EQUAL(kMaxSampleValue, getPhaseIncrementForNote(kMaxSampleValue, kNoteForDrum));
+}
+
+TEST(SampleLoadResamplerTest, octavesDoubleAndHalve) {
+	int32_t atNote = getPhaseIncrementForNote(kNeutral48k, kNoteForDrum);
+	CHECK_EQUAL(atNote >> 1, getPhaseIncrementForNote(kNeutral48k, kNoteForDrum - 12));
+	CHECK_EQUAL(atNote << 1, getPhaseIncrementForNote(kNeutral48k, kNoteForDrum + 12));
+
+	// And semitones go up in between
+	int32_t last = getPhaseIncrementForNote(kNeutral48k, kNoteForDrum - 12);
+	for (int32_t note = kNoteForDrum - 11; note <= kNoteForDrum + 12; note++) {
+		int32_t phaseIncrement = getPhaseIncrementForNote(kNeutral48k, note);
+		CHECK(phaseIncrement > last);
+		last = phaseIncrement;
+	}
+}
+
+TEST(SampleLoadResamplerTest, tooHighToPlay) {
+	// Seven octaves up is 128 times the rate, which a Voice won't render either
+	CHECK_EQUAL(0, getPhaseIncrementForNote(kNeutral48k, kNoteForDrum + 84));
+	CHECK(getPhaseIncrementForNote(kNeutral48k, kNoteForDrum + 72) > 0);
+}
+
+} // namespace
@@ -0,0 +1,121 @@
+#include "CppUTest/TestHarness.h"
+#include "model/sample/sample_peak_levels.h"
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr int32_t kSamplesPerBasePeak = 1 << SamplePeakLevels::kBaseMagnitude;
+
+// A random walk, so that different stretches have different peaks
+std::vector<int32_t> makeAudio(size_t numSamples, std::mt19937& rng) {
+	std::vector<int32_t> audio(numSamples);
+	int64_t value = 0;
+	for (auto& sample : audio) {
+		value = std::clamp<int64_t>(value + ((int32_t)rng() >> 8), INT32_MIN, INT32_MAX);
+		sample = (int32_t)value;
+	}
+	return audio;
+}
+
+// What the levels should say, straight from the audio - with only the top 16 bits, as the Peaks keep
+void bruteForcePeaks(std::vector<int32_t> const& audio, uint64_t start, uint64_t end, int32_t* min, int32_t* max) {
+	start = std::min<uint64_t>(start, audio.size());
+	end = std::min<uint64_t>(end, audio.size());
+	auto [lowest, highest] = std::minmax_element(audio.begin() + start, audio.begin() + end);
+	*min = (*lowest >> 16) << 16;
+	*max = (*highest >> 16) << 16;
+}
+
+// As SamplePeakPyramid would, a base Peak at a time
+struct Levels {
+	Levels(std::vector<int32_t> const& audio) {
+		int32_t numPeaksAtBase = SamplePeakLevels::getNumPeaksAtBase(audio.size());
+		peaks.resize(SamplePeakLevels::getNumPeaksTotal(numPeaksAtBase));
+		levels.setup(peaks.data(), numPeaksAtBase);
+
+		SamplePeakLevels::Peak* base = levels.getBase();
+		for (int32_t i = 0; i < numPeaksAtBase; i++) {
+			int32_t min, max;
+			bruteForcePeaks(audio, (uint64_t)i * kSamplesPerBasePeak, (uint64_t)(i + 1) * kSamplesPerBasePeak, &min,
+			                &max);
+			base[i] = {(int16_t)(min >> 16), (int16_t)(max >> 16)};
+		}
+		levels.fillUpperLevels();
+	}
+
+	std::vector<SamplePeakLevels::Peak> peaks;
+	SamplePeakLevels levels;
+};
+
+TEST_GROUP(SamplePeakLevelsTest){};
+
+TEST(SamplePeakLevelsTest, countsPeaks) {
+	CHECK_EQUAL(1, SamplePeakLevels::getNumPeaksAtBase(1));
+	CHECK_EQUAL(1, SamplePeakLevels::getNumPeaksAtBase(kSamplesPerBasePeak));
+	CHECK_EQUAL(2, SamplePeakLevels::getNumPeaksAtBase(kSamplesPerBasePeak + 1));
+	CHECK_EQUAL(1, SamplePeakLevels::getNumPeaksTotal(1));
+	CHECK_EQUAL(5 + 3 + 2 + 1, SamplePeakLevels::getNumPeaksTotal(5));
+	CHECK_EQUAL(8 + 4 + 2 + 1, SamplePeakLevels::getNumPeaksTotal(8));
+}
+
+// Columns lined up with the Peaks at their zoom are exact, all the way up to the whole Sample
+TEST(SamplePeakLevelsTest, alignedColumnsMatchTheAudio) {
+	std::mt19937 rng(1);
+	// Not a power of two Peaks, so some levels have an odd one out, and the last base Peak is only partly there
+	std::vector<int32_t> audio = makeAudio(kSamplesPerBasePeak * 1000 + 77, rng);
+	Levels levels(audio);
+
+	for (uint64_t samplesPerCol = kSamplesPerBasePeak; samplesPerCol < audio.size() * 2; samplesPerCol <<= 1) {
+		for (uint64_t start = 0; start < audio.size(); start += samplesPerCol) {
+			int32_t min, max, expectedMin, expectedMax;
+			levels.levels.getPeaks(start, start + samplesPerCol, &min, &max);
+			bruteForcePeaks(audio, start, start + samplesPerCol, &expectedMin, &expectedMax);
+			CHECK_EQUAL(expectedMin, min);
+			CHECK_EQUAL(expectedMax, max);
+		}
+	}
+}
+
+// Otherwise a column gets the Peaks it touches, which may reach a little past it either side - but never further than
+// its own width
+TEST(SamplePeakLevelsTest, unalignedColumnsAreCloseToTheAudio) {
+	std::mt19937 rng(2);
+	std::vector<int32_t> audio = makeAudio(kSamplesPerBasePeak * 1000 + 77, rng);
+	Levels levels(audio);
+
+	for (uint64_t samplesPerCol : {256, 300, 1000, 4096, 5000, 77777}) {
+		for (int32_t i = 0; i < 200; i++) {
+			uint64_t start = rng() % audio.size();
+			uint64_t end = std::min<uint64_t>(start + samplesPerCol, audio.size());
+
+			int32_t min, max, exactMin, exactMax, outerMin, outerMax;
+			levels.levels.getPeaks(start, end, &min, &max);
+			bruteForcePeaks(audio, start, end, &exactMin, &exactMax);
+			bruteForcePeaks(audio, start - std::min(start, samplesPerCol), end + samplesPerCol, &outerMin, &outerMax);
+			CHECK(min <= exactMin && min >= outerMin);
+			CHECK(max >= exactMax && max <= outerMax);
+		}
+	}
+}
+
+TEST(SamplePeakLevelsTest, shorterThanOnePeak) {
+	std::mt19937 rng(3);
+	std::vector<int32_t> audio = makeAudio(100, rng);
+	Levels levels(audio);
+
+	int32_t min, max, expectedMin, expectedMax;
+	levels.levels.getPeaks(0, 100, &min, &max);
+	bruteForcePeaks(audio, 0, 100, &expectedMin, &expectedMax);
+	CHECK_EQUAL(expectedMin, min);
+	CHECK_EQUAL(expectedMax, max);
+
+	// Past the end, the zoomed-out view still asks about whole columns
+	levels.levels.getPeaks(0, 1 << 20, &min, &max);
+	CHECK_EQUAL(expectedMin, min);
+	CHECK_EQUAL(expectedMax, max);
+}
+
+} // namespace
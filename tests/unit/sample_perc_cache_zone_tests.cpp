@@ -0,0 +1,82 @@
+#include "CppUTest/TestHarness.h"
+#include "model/sample/sample_perc_cache_zone.h"
+#include <algorithm>
+
+namespace {
+
+// What Sample::bitMask is for 16-bit audio
+constexpr uint32_t kBitMask16 = 0xFFFF0000;
+
+// A 16-bit Sample's data, with the 2 bytes before it - which addSample() reads, then masks off - set to junk
+struct Data16 {
+	int16_t junk;
+	int16_t samples[64];
+
+	char const* readPos(int32_t i) const { return (char const*)&samples[i] - 2; }
+};
+
+TEST_GROUP(SamplePercCacheZoneTest){};
+
+TEST(SamplePercCacheZoneTest, leavesOutWhatsBeforeTheSample) {
+	Data16 data;
+	for (int32_t i = 0; i < 64; i++) {
+		data.samples[i] = (i & 8) ? 20000 : -20000;
+	}
+
+	SamplePercCacheZone clean{0};
+	SamplePercCacheZone dirty{0};
+	for (int32_t i = 0; i < 64; i++) {
+		// The junk before the first sample, then the sample before each later one
+		data.junk = 0;
+		int32_t angle = clean.addSample(data.readPos(i), kBitMask16, 2, 1);
+		data.junk = 0x7FFF;
+		CHECK_EQUAL(angle, dirty.addSample(data.readPos(i), kBitMask16, 2, 1));
+	}
+	CHECK(clean.angleLPFMem[kDifferenceLPFPoles - 1] > 0);
+}
+
+TEST(SamplePercCacheZoneTest, stereoSumsBothChannels) {
+	int16_t stereo[3] = {0, 12345, -12345};
+	SamplePercCacheZone zone{0};
+	CHECK_EQUAL(0, zone.addSample((char const*)&stereo[1] - 2, kBitMask16, 2, 2));
+	CHECK_EQUAL(0, zone.lastSampleRead);
+}
+
+TEST(SamplePercCacheZoneTest, silenceIsntPercussive) {
+	Data16 data{};
+	SamplePercCacheZone zone{0};
+	int32_t angle = 0;
+	for (int32_t i = 0; i < 64; i++) {
+		angle = zone.addSample(data.readPos(i), kBitMask16, 2, 1);
+		zone.lastAngle = angle;
+	}
+	CHECK_EQUAL(0, angle);
+	CHECK_EQUAL(0, zone.getPercussiveness(angle)); // And no division by zero
+}
+
+TEST(SamplePercCacheZoneTest, onsetIsMorePercussiveThanSteadyTone) {
+	// Long enough for the angle filter to settle on the quiet tone, then the loud one
+	constexpr int32_t kLength = 16384;
+	static int16_t samples[kLength * 2 + 1];
+	for (int32_t i = 1; i <= kLength * 2; i++) {
+		samples[i] = ((i & 1) ? 1000 : -1000) * ((i > kLength) ? 30 : 1);
+	}
+
+	SamplePercCacheZone zone{0};
+	uint8_t steady = 0;
+	uint8_t onset = 0;
+	for (int32_t i = 1; i <= kLength * 2; i++) {
+		int32_t angle = zone.addSample((char const*)&samples[i] - 2, kBitMask16, 2, 1);
+		uint8_t percussiveness = zone.getPercussiveness(angle);
+		if (i == kLength) {
+			steady = percussiveness;
+		}
+		else if (i > kLength) {
+			onset = std::max(onset, percussiveness);
+		}
+		zone.lastAngle = angle;
+	}
+	CHECK(onset > steady);
+}
+
+} // namespace
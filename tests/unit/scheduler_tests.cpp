@@ -1,9 +1,11 @@
 #include "CppUTest/TestHarness.h"
 #include "CppUTestExt/MockSupport.h"
 #include "OSLikeStuff/task_scheduler.cpp"
+#include "benchmark.h"
 #include "cstdint"
 #include "mocks/timer_mocks.h"
 #include <iostream>
+#include <utility>
 #include <stdlib.h>
 
 #ifdef _WIN32
@@ -187,4 +189,249 @@ TEST(Scheduler, overSchedule) {
 	mock().checkExpectations();
 };
 
+TEST(Scheduler, statistics) {
+	mock().disable();
+	TaskID fiftyns = addRepeatingTask(sleep_50ns, 10, 0.001, 0.001, 0.001);
+	TaskID twoms = addRepeatingTask(sleep_2ms, 100, 0.001, 0.002, 0.005);
+	setTaskName(twoms, "two ms");
+	addOnceTask(sleep_20ns, 0, 0.001);
+	taskManager.start(0.0099);
+	mock().enable();
+
+	TaskStatistics stats;
+	CHECK(getTaskStatistics(twoms, &stats));
+	STRCMP_EQUAL("two ms", stats.name);
+	CHECK_EQUAL(2, stats.numCalls);
+	DOUBLES_EQUAL(0.002, stats.minRunTime, 0.00001);
+	DOUBLES_EQUAL(0.002, stats.maxRunTime, 0.00001);
+	CHECK(stats.p99RunTime <= stats.maxRunTime);
+
+	// the 2ms task makes the 1ms one miss its max time, by around a millisecond each time
+	CHECK(getTaskStatistics(fiftyns, &stats));
+	CHECK(stats.numMaxTimeViolations >= 2);
+	CHECK(stats.lateness[11] >= 2);
+	uint32_t total = 0;
+	for (uint32_t count : stats.lateness) {
+		total += count;
+	}
+	CHECK_EQUAL(stats.numCalls, total);
+
+	getOnceTaskStatistics(&stats);
+	CHECK_EQUAL(1, stats.numCalls);
+
+	resetTaskStatistics();
+	CHECK(getTaskStatistics(fiftyns, &stats));
+	CHECK_EQUAL(0, stats.numCalls);
+	CHECK(!getTaskStatistics(kMaxTasks - 1, &stats));
+};
+
+TaskID lateAddedTask = -1;
+TEST(Scheduler, firstCallIsOnTime) {
+	mock().disable();
+	// added 5ms in, well past its max time since the scheduler started - but there was no call before it to be late
+	// after
+	addOnceTask([]() { lateAddedTask = addRepeatingTask(sleep_20ns, 0, 0.001, 0.001, 0.0015); }, 0, 0.005);
+	taskManager.start(0.0099);
+	TaskID id = lateAddedTask;
+	mock().enable();
+
+	TaskStatistics stats;
+	CHECK(getTaskStatistics(id, &stats));
+	CHECK(stats.numCalls > 1);
+	CHECK_EQUAL(0, stats.numMaxTimeViolations);
+};
+
+TEST(Scheduler, statisticsOnlyForFirstRepeatingTasks) {
+	TaskStatistics stats;
+	TaskID first = addRepeatingTask(sleep_20ns, 0, 0.001, 0.001, 0.001);
+	for (int i = 1; i < kMaxTasksWithTelemetry; i++) {
+		addRepeatingTask(sleep_20ns, 0, 0.001, 0.001, 0.001);
+	}
+	TaskID extra = addRepeatingTask(sleep_20ns, 0, 0.001, 0.001, 0.001);
+	CHECK(extra >= 0);
+	CHECK(getTaskStatistics(first, &stats));
+	CHECK(!getTaskStatistics(extra, &stats));
+
+	// once a task's gone, its statistics' space goes to the next one
+	removeTask(first);
+	TaskID next = addRepeatingTask(sleep_20ns, 0, 0.001, 0.001, 0.001);
+	CHECK(getTaskStatistics(next, &stats));
+	CHECK(!getTaskStatistics(addOnceTask(sleep_20ns, 0, 0.001), &stats));
+};
+
+int numImportantCalls = 0;
+int numUnimportantCalls = 0;
+int numUnimportantCallsDuringJob = -1;
+/// takes 10ms, yielding every 100us
+void longJob() {
+	int before = numUnimportantCalls;
+	for (int i = 0; i < 100; i++) {
+		passMockTime(0.0001);
+		yieldToTasks(5);
+	}
+	numUnimportantCallsDuringJob = numUnimportantCalls - before;
+}
+
+TEST(Scheduler, yieldDuringLongJob) {
+	numImportantCalls = numUnimportantCalls = 0;
+	numUnimportantCallsDuringJob = -1;
+	TaskID important = addRepeatingTask(
+	    []() {
+		    numImportantCalls++;
+		    passMockTime(0.00001);
+	    },
+	    0, 0.001, 0.001, 0.002);
+	addRepeatingTask([]() { numUnimportantCalls++; }, 50, 0.001, 0.001, 0.1);
+	addOnceTask(longJob, 10, 0.001);
+	taskManager.start(0.02);
+
+	// the important task kept to its 1ms period throughout, the unimportant one had to wait until the job finished
+	CHECK(numImportantCalls >= 18);
+	CHECK_EQUAL(0, numUnimportantCallsDuringJob);
+	TaskStatistics stats;
+	CHECK(getTaskStatistics(important, &stats));
+	CHECK_EQUAL(0, stats.numMaxTimeViolations);
+
+	// and the time spent yielding doesn't count as the job's
+	getOnceTaskStatistics(&stats);
+	CHECK_EQUAL(1, stats.numCalls);
+	DOUBLES_EQUAL(0.01, stats.maxRunTime, 0.0002);
+};
+
+/// takes 50ms, yielding every 100us
+void longerJob() {
+	for (int i = 0; i < 500; i++) {
+		passMockTime(0.0001);
+		yieldToTasks(5);
+	}
+}
+
+TEST(Scheduler, yieldPassesOverOverdueLowPriorityTasks) {
+	numImportantCalls = numUnimportantCalls = 0;
+	TaskID important = addRepeatingTask(
+	    []() {
+		    numImportantCalls++;
+		    passMockTime(0.00001);
+	    },
+	    0, 0.001, 0.001, 0.002);
+	// like the UI timers - goes overdue 10ms into the job, and stays that way until it's over
+	addRepeatingTask([]() { numUnimportantCalls++; }, 50, 0.001, 0.005, 0.01);
+	addOnceTask(longerJob, 10, 0.001);
+	taskManager.start(0.06);
+
+	// the important task still ran every 1ms right through the job
+	CHECK(numImportantCalls >= 55);
+	TaskStatistics stats;
+	CHECK(getTaskStatistics(important, &stats));
+	CHECK_EQUAL(0, stats.numMaxTimeViolations);
+	CHECK(numUnimportantCalls > 0);
+};
+
+// A realistic load: the repeating tasks the firmware registers, plus lots of once tasks coming and going
+
+void registerFirmwareLikeTasks() {
+	// periods are roughly those in deluge.cpp's registerTasks()
+	uint8_t p = 0;
+	addRepeatingTask([]() { passMockTime(0.00005); }, p++, 8 / 44100., 16 / 44100., 32 / 44100.);
+	addRepeatingTask([]() { passMockTime(0.000005); }, p++, 0.0005, 0.001, 0.001);
+	addRepeatingTask([]() { passMockTime(0.00001); }, p++, 8 / 44100., 16 / 44100, 32 / 44100.);
+	addRepeatingTask([]() { passMockTime(0.000002); }, p++, 0.00001, 0.00001, 0.00002);
+	addRepeatingTask([]() { passMockTime(0.00002); }, p++, 0.001, 0.005, 0.05);
+	addRepeatingTask([]() { passMockTime(0.00001); }, p++, 0.005, 0.005, 0.01);
+	addRepeatingTask([]() { passMockTime(0.000005); }, p++, 0.005, 0.005, 0.01);
+	addRepeatingTask([]() { passMockTime(0.0001); }, p++, 0.01, 0.01, 0.03);
+	addRepeatingTask([]() { passMockTime(0.000005); }, p++, 0.005, 0.005, 0.01);
+	addRepeatingTask([]() { passMockTime(0.00002); }, p++, 0.1, 0.1, 0.2);
+	addRepeatingTask([]() { passMockTime(0.00001); }, p++, 0.01, 0.1, 0.1);
+	addRepeatingTask([]() { passMockTime(0.00001); }, p++, 0.001, 0.001, 0.02);
+	addRepeatingTask([]() { passMockTime(0.00005); }, p++, 0.01, 0.01, 0.02);
+	addRepeatingTask([]() { passMockTime(0.000005); }, p++, 0.0001, 0.0007, 0.01);
+}
+
+struct OnceTaskStats {
+	int numRun = 0;
+	int numLate = 0; // ran after their max time (10x the wait they asked for)
+	double totalLateness = 0;
+	double maxLateness = 0;
+};
+OnceTaskStats onceStats;
+// the once tasks currently queued, by when they were added and how long they asked to wait for
+std::array<std::pair<double, double>, kMaxTasks> onceTaskRequests;
+uint32_t benchmarkRandom = 1;
+
+template <int slot>
+void benchmarkOnceTask();
+
+template <int slot>
+void addBenchmarkOnceTask() {
+	benchmarkRandom = benchmarkRandom * 1103515245 + 12345;
+	double wait = 0.0001 + (benchmarkRandom >> 16) % 100 * 0.0001; // 0.1ms to 10ms
+	// same as addOnceTask() - before the scheduler starts, the clock is about to be reset
+	onceTaskRequests[slot] = {taskManager.running ? getTimerValueSeconds(0) : 0, wait};
+	addOnceTask(benchmarkOnceTask<slot>, 20 + slot % 10, wait);
+}
+
+template <int slot>
+void benchmarkOnceTask() {
+	auto [addedAt, wait] = onceTaskRequests[slot];
+	double lateness = getTimerValueSeconds(0) - (addedAt + wait);
+	onceStats.numRun++;
+	onceStats.totalLateness += std::max(lateness, 0.0);
+	onceStats.maxLateness = std::max(onceStats.maxLateness, lateness);
+	if (lateness > 9 * wait) {
+		onceStats.numLate++;
+	}
+	passMockTime(0.00001);
+	addBenchmarkOnceTask<slot>(); // and go again
+}
+
+template <int... slots>
+void addBenchmarkOnceTasks(std::integer_sequence<int, slots...>) {
+	(addBenchmarkOnceTask<slots>(), ...);
+}
+
+constexpr int kNumBenchmarkOnceTasks = 80;
+
+TEST(Scheduler, onceTasksRunOnTimeUnderLoad) {
+	onceStats = OnceTaskStats{};
+	benchmarkRandom = 1;
+	registerFirmwareLikeTasks();
+	addBenchmarkOnceTasks(std::make_integer_sequence<int, kNumBenchmarkOnceTasks>{});
+	taskManager.start(0.5);
+
+	CHECK(onceStats.numRun > kNumBenchmarkOnceTasks);
+	CHECK_EQUAL(0, onceStats.numLate);
+}
+
+#if DELUGE_BENCHMARKS
+
+TEST_GROUP(SchedulerBenchmark){void setup(){taskManager = TaskManager();
+}
+}
+;
+
+TEST(SchedulerBenchmark, throughput) {
+	registerFirmwareLikeTasks();
+	addBenchmarkOnceTasks(std::make_integer_sequence<int, kNumBenchmarkOnceTasks>{});
+	taskManager.running = true;
+
+	constexpr int kNumDecisions = 200000;
+	int numTasksRun = 0;
+	uint64_t decisionTime = nanosecondsPerItem(kNumDecisions, [&] {
+		for (int i = 0; i < kNumDecisions; i++) {
+			TaskID task = taskManager.chooseBestTask(taskManager.mustEndBefore);
+			if (task >= 0) {
+				taskManager.runTask(task);
+				numTasksRun++;
+			}
+		}
+	});
+
+	CHECK(numTasksRun > 0);
+	printBenchmark("scheduler, " + std::to_string(taskManager.numActiveTasks) + " tasks",
+	               {{"choosing and running", decisionTime}}, "decision");
+}
+
+#endif
+
 } // namespace
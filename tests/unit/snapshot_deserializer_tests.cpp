@@ -0,0 +1,197 @@
+#include "CppUTest/TestHarness.h"
+#include "storage/snapshot_deserializer.h"
+#include "util/d_string.h"
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Laid out like XMLSerializer writes a song, plus the things people's hand-edited files have: whitespace around '=',
+// single quotes, and empty and self-closing tags
+std::string const kSong = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                          "<song\n"
+                          "\tfirmwareVersion=\"4.1.0\"\n"
+                          "\tearliestCompatibleFirmware=\"4.1.0-alpha\"\n"
+                          "\tpreview=\"0x0000000000000000000000000000000000000001\">\n"
+                          "\t<modeNotes>\n"
+                          "\t\t<modeNote>0</modeNote>\n"
+                          "\t\t<modeNote>2</modeNote>\n"
+                          "\t</modeNotes>\n"
+                          "\t<reverb\n"
+                          "\t\troomSize=\"1073741824\"\n"
+                          "\t\tdampening = '-5'>\n"
+                          "\t\t<compressor attack=\"327244\" />\n"
+                          "\t</reverb>\n"
+                          "\t<name></name>\n"
+                          "\t<tempo>120</tempo>\n"
+                          "\t<patch>0A1B2C</patch>\n"
+                          "\t<instrumentClips>\n"
+                          "\t\t<midiClip inKeyMode=\"1\">\n"
+                          "\t\t\t<noteRows>\n"
+                          "\t\t\t\t<noteRow y=\"60\"\n"
+                          "\t\t\t\t\tnoteDataWithLift=\"0x0000000000000060000000600000000000000000\" />\n"
+                          "\t\t\t</noteRows>\n"
+                          "\t\t</midiClip>\n"
+                          "\t</instrumentClips>\n"
+                          "\t<sections/>\n"
+                          "</song>\n";
+
+// The tags which have others inside them
+std::set<std::string> const kContainers = {"modeNotes", "reverb",   "compressor", "instrumentClips",
+                                           "midiClip",  "noteRows", "noteRow"};
+
+// Opens a snapshot of the XML, into its first tag, just as a song's loaded
+void open(SnapshotDeserializer& reader, std::string const& xml) {
+	auto* snapshot = (uint8_t*)malloc(xml.size() + 64);
+	XMLSnapshot::Builder builder(snapshot, xml.size() + 64);
+	builder.feed(xml.data(), xml.size());
+	int32_t size = builder.finish();
+	CHECK(size > 0);
+	CHECK(reader.open(snapshot, size, "song", "song") == Error::NONE);
+}
+
+// The way the firmware's read functions go through a file: each name, then either what's inside it or its value,
+// then exitTag(). Containers listed in skip are exited without looking inside
+std::string walk(Deserializer& reader, std::set<std::string> const& skip = {}) {
+	std::string description;
+	char const* name;
+	while (*(name = reader.readNextTagOrAttributeName())) {
+		description += name;
+		if (skip.contains(name)) {
+			description += " ";
+		}
+		else if (kContainers.contains(name)) {
+			description += "{ " + walk(reader, skip) + "} ";
+		}
+		else {
+			description += "=" + std::string(reader.readTagOrAttributeValue()) + " ";
+		}
+		reader.exitTag(name);
+	}
+	return description;
+}
+
+TEST_GROUP(SnapshotDeserializerTest) {
+	SnapshotDeserializer reader;
+	void teardown() { reader.close(); }
+};
+
+// Spelled out from what XMLDeserializer reads from kSong
+TEST(SnapshotDeserializerTest, readsWhatXMLDeserializerWould) {
+	open(reader, kSong);
+	std::string description = walk(reader);
+	STRCMP_EQUAL("firmwareVersion=4.1.0 earliestCompatibleFirmware=4.1.0-alpha "
+	             "preview=0x0000000000000000000000000000000000000001 "
+	             "modeNotes{ modeNote=0 modeNote=2 } "
+	             "reverb{ roomSize=1073741824 dampening=-5 compressor{ attack=327244 } } "
+	             "name= tempo=120 patch=0A1B2C "
+	             "instrumentClips{ midiClip{ inKeyMode=1 noteRows{ noteRow{ y=60 "
+	             "noteDataWithLift=0x0000000000000060000000600000000000000000 } } } } "
+	             "sections= ",
+	             description.c_str());
+	STRCMP_EQUAL("", reader.readNextTagOrAttributeName()); // And nothing after
+}
+
+TEST(SnapshotDeserializerTest, skippingTagsLeavesTheRestInPlace) {
+	open(reader, kSong);
+	std::string description = walk(reader, {"modeNotes", "compressor", "instrumentClips"});
+	STRCMP_EQUAL("firmwareVersion=4.1.0 earliestCompatibleFirmware=4.1.0-alpha "
+	             "preview=0x0000000000000000000000000000000000000001 "
+	             "modeNotes reverb{ roomSize=1073741824 dampening=-5 compressor } "
+	             "name= tempo=120 patch=0A1B2C instrumentClips sections= ",
+	             description.c_str());
+}
+
+TEST(SnapshotDeserializerTest, valuesLeftUnreadAreSkipped) {
+	open(reader, kSong);
+	std::string names;
+	char const* name;
+	while (*(name = reader.readNextTagOrAttributeName())) {
+		names += std::string(name) + " ";
+		reader.exitTag(name);
+	}
+	STRCMP_EQUAL("firmwareVersion earliestCompatibleFirmware preview modeNotes reverb name tempo patch "
+	             "instrumentClips sections ",
+	             names.c_str());
+}
+
+// Finds the named tag or attribute among the ones at the current depth, going into it
+void goTo(Deserializer& reader, char const* wanted) {
+	char const* name;
+	while (*(name = reader.readNextTagOrAttributeName())) {
+		if (!strcmp(name, wanted)) {
+			return;
+		}
+		reader.exitTag(name);
+	}
+	FAIL(wanted);
+}
+
+TEST(SnapshotDeserializerTest, numbers) {
+	open(reader, kSong);
+	goTo(reader, "reverb");
+	goTo(reader, "roomSize");
+	CHECK_EQUAL(1073741824, reader.readTagOrAttributeValueInt());
+	reader.exitTag("roomSize");
+	goTo(reader, "dampening");
+	CHECK_EQUAL(-5, reader.readTagOrAttributeValueInt());
+	reader.exitTag("dampening");
+	reader.exitTag("reverb");
+
+	goTo(reader, "tempo");
+	CHECK_EQUAL(120, reader.readTagOrAttributeValueInt());
+}
+
+TEST(SnapshotDeserializerTest, hexBytes) {
+	open(reader, kSong);
+	goTo(reader, "patch");
+	uint8_t bytes[8];
+	int32_t numBytes = reader.readTagOrAttributeValueHexBytes(bytes, 8);
+	CHECK_EQUAL(3, numBytes);
+	CHECK_EQUAL(0x0A, bytes[0]);
+	CHECK_EQUAL(0x1B, bytes[1]);
+	CHECK_EQUAL(0x2C, bytes[2]);
+}
+
+// XMLDeserializer stops at the 'x', since it isn't hex
+TEST(SnapshotDeserializerTest, hexBytesOfLongHexValue) {
+	open(reader, kSong);
+	for (char const* name : {"instrumentClips", "midiClip", "noteRows", "noteRow", "noteDataWithLift"}) {
+		goTo(reader, name);
+	}
+	uint8_t bytes[32];
+	int32_t numBytes = reader.readTagOrAttributeValueHexBytes(bytes, 32);
+	CHECK_EQUAL(0, numBytes);
+	reader.exitTag("noteDataWithLift");
+	STRCMP_EQUAL("", reader.readNextTagOrAttributeName()); // The value's gone, either way
+}
+
+TEST(SnapshotDeserializerTest, longHexValueOneCharAtATime) {
+	open(reader, kSong);
+	for (char const* name : {"instrumentClips", "midiClip", "noteRows", "noteRow", "noteDataWithLift"}) {
+		goTo(reader, name);
+	}
+	CHECK(reader.prepareToReadTagOrAttributeValueOneCharAtATime());
+	CHECK_EQUAL(42, reader.getNumCharsRemainingInValue());
+	STRCMP_EQUAL("0x", std::string(reader.readNextCharsOfTagOrAttributeValue(2), 2).c_str());
+
+	// Then 8 chars for each note's position, like InstrumentClip reads them
+	uint8_t bytes[4];
+	CHECK_EQUAL(4, reader.readNextHexBytesOfTagOrAttributeValue(bytes, 4));
+	CHECK_EQUAL(0, bytes[3]);
+	STRCMP_EQUAL("00000060", std::string(reader.readNextCharsOfTagOrAttributeValue(8), 8).c_str());
+	CHECK_EQUAL(24, reader.getNumCharsRemainingInValue());
+}
+
+TEST(SnapshotDeserializerTest, longHexValueAsString) {
+	open(reader, kSong);
+	goTo(reader, "preview");
+	String string;
+	CHECK(reader.readTagOrAttributeValueString(&string) == Error::NONE);
+	STRCMP_EQUAL("0x0000000000000000000000000000000000000001", string.get());
+}
+
+} // namespace
@@ -0,0 +1,50 @@
+#include "CppUTest/TestHarness.h"
+#include "processing/engines/voice_budget.h"
+
+TEST_GROUP(VoiceBudgetTest){};
+
+TEST(VoiceBudgetTest, learnsOverheadFromSilence) {
+	VoiceBudget budget;
+	for (int i = 0; i < 1000; i++) {
+		budget.windowRendered(128, 128 * 100, 0);
+	}
+	DOUBLES_EQUAL(100, budget.getOverheadTicksPerSample(), 0.5);
+}
+
+TEST(VoiceBudgetTest, learnsUnitCost) {
+	VoiceBudget budget;
+	for (int i = 0; i < 1000; i++) {
+		budget.windowRendered(128, 128 * 100, 0);
+	}
+	// 50 units costing 5 ticks each, on top of the overhead
+	for (int i = 0; i < 1000; i++) {
+		budget.windowRendered(128, 128 * (100 + 50 * 5), 50);
+	}
+	DOUBLES_EQUAL(5, budget.getTicksPerUnit(), 0.05);
+
+	uint32_t expected = (VoiceBudget::kTicksPerSampleAvailable * VoiceBudget::kTargetLoad - 100) / 5;
+	CHECK(budget.getBudget() >= expected - 1 && budget.getBudget() <= expected + 1);
+	CHECK(!budget.wouldExceed(expected - 10, 5));
+	CHECK(budget.wouldExceed(expected, 10));
+}
+
+TEST(VoiceBudgetTest, direnessShrinksBudget) {
+	VoiceBudget budget;
+	CHECK(budget.getBudget(5) < budget.getBudget(0));
+}
+
+TEST(VoiceBudgetTest, noBudgetWhenOverheadAloneIsTooMuch) {
+	VoiceBudget budget;
+	for (int i = 0; i < 1000; i++) {
+		budget.windowRendered(128, 128 * 1000, 0);
+	}
+	CHECK_EQUAL(0, budget.getBudget());
+	CHECK(budget.wouldExceed(0, 1));
+}
+
+TEST(VoiceBudgetTest, ignoresEmptyWindows) {
+	VoiceBudget budget;
+	float before = budget.getOverheadTicksPerSample();
+	budget.windowRendered(0, 12345, 0);
+	CHECK_EQUAL(before, budget.getOverheadTicksPerSample());
+}
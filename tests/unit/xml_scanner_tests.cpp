@@ -0,0 +1,398 @@
+#include "CppUTest/TestHarness.h"
+#include "benchmark.h"
+#include "storage/xml_scanner.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int32_t kClusterSize = 32768;
+
+// Hands out a file a Cluster at a time, like XMLDeserializer's fileClusterBuffer
+class ClusterReader {
+public:
+	ClusterReader(std::string const& file) : file_(file) {}
+
+	char const* pos = nullptr;
+	char const* end = nullptr;
+
+	bool readNextCluster() {
+		if (fileOffset_ >= file_.size()) {
+			return false;
+		}
+		size_t numBytes = std::min<size_t>(kClusterSize, file_.size() - fileOffset_);
+		memcpy(buffer_, &file_[fileOffset_], numBytes);
+		fileOffset_ += numBytes;
+		pos = buffer_;
+		end = buffer_ + numBytes;
+		return true;
+	}
+
+	bool haveMore() { return pos < end || readNextCluster(); }
+
+private:
+	std::string const& file_;
+	size_t fileOffset_ = 0;
+	char buffer_[kClusterSize];
+};
+
+// How XMLDeserializer used to find things: every char fetched by its own call, which checks whether it's time for the
+// next Cluster, then looked at by a switch
+struct CharAtATime {
+	[[gnu::noinline]] static bool readChar(ClusterReader& reader, char* thisChar) {
+		if (!reader.haveMore()) {
+			return false;
+		}
+		*thisChar = *reader.pos++;
+		return true;
+	}
+
+	// Each leaves reader.pos at the char it stops at, and returns false if the file ends first
+	static bool findChar(ClusterReader& reader, char endChar) {
+		char thisChar;
+		while (readChar(reader, &thisChar)) {
+			if (thisChar == endChar) {
+				reader.pos--;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	static bool skipWhitespace(ClusterReader& reader, std::string*) {
+		char thisChar;
+		while (readChar(reader, &thisChar)) {
+			switch (thisChar) {
+			case ' ':
+			case '\r':
+			case '\n':
+			case '\t':
+				break;
+
+			default:
+				reader.pos--;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	static bool readName(ClusterReader& reader, std::string* name, bool isTag) {
+		char thisChar;
+		while (readChar(reader, &thisChar)) {
+			switch (thisChar) {
+			case ' ':
+			case '\r':
+			case '\n':
+			case '\t':
+			case '>':
+				reader.pos--;
+				return true;
+
+			case '/':
+			case '?':
+				if (isTag) {
+					reader.pos--;
+					return true;
+				}
+				break;
+
+			case '=':
+				if (!isTag) {
+					reader.pos--;
+					return true;
+				}
+				break;
+			}
+			*name += thisChar;
+		}
+		return false;
+	}
+
+	static bool readUntil(ClusterReader& reader, std::string* value, char endChar) {
+		char thisChar;
+		while (readChar(reader, &thisChar)) {
+			if (thisChar == endChar) {
+				reader.pos--;
+				return true;
+			}
+			*value += thisChar;
+		}
+		return false;
+	}
+};
+
+// How it does now, with XMLScanner looking at what's left of each Cluster in one go
+struct BlockAtATime {
+	template <typename Find>
+	static bool take(ClusterReader& reader, std::string* taken, Find find) {
+		while (reader.haveMore()) {
+			char const* found = find(reader.pos, reader.end);
+			if (taken) {
+				taken->append(reader.pos, found);
+			}
+			reader.pos = found;
+			if (found < reader.end) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	static bool findChar(ClusterReader& reader, char endChar) {
+		return take(reader, nullptr, [=](char const* pos, char const* end) {
+			return XMLScanner::findChar(pos, end, endChar);
+		});
+	}
+
+	static bool skipWhitespace(ClusterReader& reader, std::string*) {
+		return take(reader, nullptr, XMLScanner::skipWhitespace);
+	}
+
+	static bool readName(ClusterReader& reader, std::string* name, bool isTag) {
+		return take(reader, name, isTag ? XMLScanner::findTagNameEnd : XMLScanner::findAttributeNameEnd);
+	}
+
+	static bool readUntil(ClusterReader& reader, std::string* value, char endChar) {
+		return take(reader, value, [=](char const* pos, char const* end) {
+			return XMLScanner::findChar(pos, end, endChar);
+		});
+	}
+};
+
+// Splits a file into tag names, attribute names, and values, skipping anything else - much as XMLDeserializer would
+// while something reads everything it has
+template <typename Scan>
+std::vector<std::string> tokenize(std::string const& file) {
+	std::vector<std::string> tokens;
+	ClusterReader reader(file);
+
+	while (Scan::findChar(reader, '<')) {
+		reader.pos++;
+		std::string token;
+		if (!Scan::readName(reader, &token, true)) {
+			break;
+		}
+		if (token.empty()) { // A closing tag, or <?xml ...?>
+			Scan::findChar(reader, '>');
+			continue;
+		}
+		tokens.push_back(std::move(token));
+
+		// Attributes, if any
+		while (Scan::skipWhitespace(reader, nullptr) && *reader.pos != '>' && *reader.pos != '/') {
+			token.clear();
+			if (!Scan::readName(reader, &token, false) || !Scan::findChar(reader, '"')) {
+				return tokens;
+			}
+			tokens.push_back(std::move(token));
+			reader.pos++;
+			token.clear();
+			if (!Scan::readUntil(reader, &token, '"')) {
+				return tokens;
+			}
+			tokens.push_back(std::move(token));
+			reader.pos++;
+		}
+		if (!reader.haveMore()) {
+			break;
+		}
+
+		// Contents, if it's not a />
+		if (*reader.pos == '>') {
+			reader.pos++;
+			token.clear();
+			if (!Scan::readUntil(reader, &token, '<')) {
+				break;
+			}
+			if (token.find_first_not_of(" \r\n\t") != std::string::npos) {
+				tokens.push_back(std::move(token));
+			}
+		}
+	}
+	return tokens;
+}
+
+std::string hexWord(uint32_t value) {
+	char hex[9];
+	snprintf(hex, sizeof(hex), "%08X", value);
+	return hex;
+}
+
+// Something shaped like a big song: Kits full of Sounds, each with a pile of params, plenty of them automated, and
+// Clips with long note rows - so mostly long hex values in attributes, which is what takes the time
+std::string makeSong(int32_t numSounds, std::mt19937& rng) {
+	static char const* const kParamNames[] = {"volume", "pan", "lpfFrequency", "lpfResonance", "hpfFrequency",
+	                                          "oscAVolume", "oscBVolume", "envelope1Attack", "envelope1Release",
+	                                          "delayRate", "delayFeedback", "reverbAmount", "modFXDepth"};
+
+	std::ostringstream song;
+	song << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+	song << "<song\n\tfirmwareVersion=\"4.1.0\"\n\tearliestCompatibleFirmware=\"4.1.0\"\n\tpreviewNumPads=\"144\">\n";
+	song << "\t<instruments>\n\t\t<kit\n\t\t\tpresetSlot=\"3\"\n\t\t\tpresetName=\"Big kit\">\n\t\t\t<soundSources>\n";
+	for (int32_t s = 0; s < numSounds; s++) {
+		song << "\t\t\t\t<sound\n\t\t\t\t\tname=\"Sound " << s << "\"\n\t\t\t\t\tpolyphonic=\"poly\">\n";
+		song << "\t\t\t\t\t<osc1>\n\t\t\t\t\t\t<type>sample</type>\n\t\t\t\t\t\t<fileName>SAMPLES/DRUMS/"
+		     << rng() % 1000 << ".WAV</fileName>\n\t\t\t\t\t</osc1>\n";
+		song << "\t\t\t\t\t<defaultParams\n";
+		for (char const* paramName : kParamNames) {
+			song << "\t\t\t\t\t\t" << paramName << "=\"0x" << hexWord(rng());
+			if (rng() % 3 == 0) { // Automated
+				for (int32_t n = rng() % 64; n; n--) {
+					song << hexWord(rng()) << hexWord(rng() % 65536);
+				}
+			}
+			song << "\"\n";
+		}
+		song << "\t\t\t\t\t\t/>\n\t\t\t\t</sound>\n";
+	}
+	song << "\t\t\t</soundSources>\n\t\t</kit>\n\t</instruments>\n\t<sessionClips>\n";
+	for (int32_t c = 0; c < numSounds / 4; c++) {
+		song << "\t\t<instrumentClip\n\t\t\tlength=\"" << 96 * (1 + rng() % 16) << "\">\n\t\t\t<noteRows>\n";
+		for (int32_t r = 0; r < 8; r++) {
+			song << "\t\t\t\t<noteRow\n\t\t\t\t\ty=\"" << r << "\"\n\t\t\t\t\tnoteDataWithLift=\"0x";
+			for (int32_t n = rng() % 32; n; n--) {
+				song << hexWord(rng()) << hexWord(rng()) << hexWord(rng());
+			}
+			song << "\"\n\t\t\t\t\tdrumIndex=\"" << r << "\" />\n";
+		}
+		song << "\t\t\t</noteRows>\n\t\t</instrumentClip>\n";
+	}
+	song << "\t</sessionClips>\n</song>\n";
+	return song.str();
+}
+
+// Every way of looking for a char, at every offset and length up to a couple of NEON blocks and a bit, against what
+// the one-at-a-time way finds
+template <typename Find, typename Stops>
+void checkFinds(Find find, Stops stops) {
+	std::mt19937 rng(1);
+	static char const kChars[] = "ab< >=/?\"\t\r\n'x0F";
+	std::vector<char> text(64);
+	for (int32_t i = 0; i < 2000; i++) {
+		for (char& thisChar : text) {
+			// Mostly ordinary chars, so there are long stretches with nothing to find
+			thisChar = (rng() % 8) ? 'a' + rng() % 26 : kChars[rng() % (sizeof(kChars) - 1)];
+		}
+		int32_t start = rng() % 16;
+		int32_t length = rng() % (text.size() - start);
+		char const* pos = &text[start];
+		char const* end = pos + length;
+
+		char const* expected = pos;
+		while (expected < end && !stops(*expected)) {
+			expected++;
+		}
+		POINTERS_EQUAL(expected, find(pos, end));
+	}
+}
+
+TEST_GROUP(XMLScannerTest){};
+
+TEST(XMLScannerTest, findsWhatTheOneAtATimeWayWould) {
+	checkFinds([](char const* pos, char const* end) { return XMLScanner::findChar(pos, end, '"'); },
+	           [](char thisChar) { return thisChar == '"'; });
+	checkFinds(XMLScanner::skipWhitespace, [](char thisChar) { return !XMLScanner::isWhitespace(thisChar); });
+	checkFinds(XMLScanner::findTagNameEnd, [](char thisChar) {
+		return XMLScanner::isWhitespace(thisChar) || thisChar == '>' || thisChar == '/' || thisChar == '?';
+	});
+	checkFinds(XMLScanner::findAttributeNameEnd, [](char thisChar) {
+		return XMLScanner::isWhitespace(thisChar) || thisChar == '=' || thisChar == '>';
+	});
+}
+
+TEST(XMLScannerTest, emptyAndPastEnd) {
+	char const text[] = "abc";
+	POINTERS_EQUAL(&text[1], XMLScanner::findChar(&text[1], &text[1], 'a'));
+	POINTERS_EQUAL(&text[2], XMLScanner::findChar(&text[2], &text[1], 'a'));
+	POINTERS_EQUAL(&text[1], XMLScanner::skipWhitespace(&text[1], &text[1]));
+	POINTERS_EQUAL(&text[2], XMLScanner::findTagNameEnd(&text[2], &text[1]));
+}
+
+TEST(XMLScannerTest, tokenizesSongLikeCharAtATime) {
+	std::mt19937 rng(2);
+	std::string song = makeSong(40, rng);
+	CHECK(song.size() > 3 * kClusterSize); // So names and values get split across Clusters
+
+	std::vector<std::string> expected = tokenize<CharAtATime>(song);
+	std::vector<std::string> tokens = tokenize<BlockAtATime>(song);
+	CHECK(expected.size() > 1000);
+	CHECK(tokens == expected);
+	CHECK(tokens[0] == "song");
+	CHECK(tokens[1] == "firmwareVersion");
+	CHECK(tokens[2] == "4.1.0");
+}
+
+// What hexToIntFixedLength(hexChars, 2) in util/d_string.cpp gives, for any two chars
+uint8_t hexToIntFixedLength2(char const* hexChars) {
+	auto hexCharToHalfByte = [](unsigned char hexChar) -> char { return hexChar - ((hexChar >= 65) ? 55 : 48); };
+	uint32_t output = hexCharToHalfByte(hexChars[0]);
+	output <<= 4;
+	output |= hexCharToHalfByte(hexChars[1]);
+	return output;
+}
+
+TEST(XMLScannerTest, decodesHexLikeHexToIntFixedLength) {
+	// Every pair of chars, hex or not
+	std::string hexChars;
+	for (int32_t high = 0; high < 256; high++) {
+		for (int32_t low = 0; low < 256; low++) {
+			hexChars += (char)high;
+			hexChars += (char)low;
+		}
+	}
+
+	// From every alignment, and with every length around the block size
+	for (int32_t start : {0, 1, 2, 15, 16, 17, 31}) {
+		for (int32_t numBytes : {0, 1, 15, 16, 17, 33, 1000, 32768 - start}) {
+			std::vector<uint8_t> bytes(numBytes + 1, 0xA5);
+			XMLScanner::decodeHex(&hexChars[start * 2], bytes.data(), numBytes);
+			for (int32_t i = 0; i < numBytes; i++) {
+				CHECK_EQUAL(hexToIntFixedLength2(&hexChars[(start + i) * 2]), bytes[i]);
+			}
+			CHECK_EQUAL(0xA5, bytes[numBytes]);
+		}
+	}
+
+	uint8_t bytes[8];
+	XMLScanner::decodeHex("0123456789ABCDEF", bytes, 8);
+	uint8_t expected[8] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF};
+	MEMCMP_EQUAL(expected, bytes, 8);
+}
+
+#if DELUGE_BENCHMARKS
+
+TEST_GROUP(XMLScannerBenchmark){};
+
+// Set DELUGE_XML_BENCHMARK_FILE to time a real song or preset instead
+TEST(XMLScannerBenchmark, tokenize) {
+	std::string song;
+	char const* path = getenv("DELUGE_XML_BENCHMARK_FILE");
+	if (path) {
+		std::ifstream file(path, std::ios::binary);
+		song.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+	if (song.empty()) {
+		std::mt19937 rng(3);
+		song = makeSong(400, rng);
+	}
+
+	std::vector<std::string> charTokens;
+	uint64_t charTime = nanosecondsPerItem(song.size(), [&] { charTokens = tokenize<CharAtATime>(song); });
+	std::vector<std::string> blockTokens;
+	uint64_t blockTime = nanosecondsPerItem(song.size(), [&] { blockTokens = tokenize<BlockAtATime>(song); });
+
+	CHECK(blockTokens == charTokens);
+	printBenchmark("xml tokenizer, " + std::to_string(song.size() / 1024) + "kB",
+	               {{"char at a time", charTime}, {"block at a time", blockTime}}, "byte");
+}
+
+#endif
+
+} // namespace
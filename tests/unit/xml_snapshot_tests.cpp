@@ -0,0 +1,132 @@
+#include "CppUTest/TestHarness.h"
+#include "storage/xml_snapshot.h"
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace XMLSnapshot;
+
+// Feeds the XML through chunkSize chars at a time. Returns an empty snapshot if the Builder gave up
+std::vector<uint8_t> build(std::string const& xml, int32_t chunkSize = 0, int32_t maxSize = 0) {
+	std::vector<uint8_t> output(maxSize ? maxSize : xml.size() + 64);
+	Builder builder(output.data(), output.size());
+	if (!chunkSize) {
+		chunkSize = xml.size();
+	}
+	for (size_t i = 0; i < xml.size(); i += chunkSize) {
+		builder.feed(&xml[i], std::min<size_t>(chunkSize, xml.size() - i));
+	}
+	int32_t size = builder.finish();
+	output.resize(std::max(size, 0));
+	return output;
+}
+
+// One line per token, for comparing against what's expected
+std::string describe(std::vector<uint8_t> const& snapshot) {
+	std::string description;
+	uint8_t const* pos = snapshot.data();
+	uint8_t const* end = pos + snapshot.size();
+	while (pos < end) {
+		Token token;
+		pos = readToken(pos, end, &token);
+		if (!pos) {
+			return description + "broken";
+		}
+		switch (token.type) {
+		case TokenType::TAG:
+			description += "<" + std::string((char const*)token.data) + " ";
+			break;
+		case TokenType::ATTRIBUTE:
+			description += std::string((char const*)token.data) + "=";
+			break;
+		case TokenType::VALUE:
+			CHECK_EQUAL(token.length, (int32_t)strlen((char const*)token.data));
+			description += "\"" + std::string((char const*)token.data) + "\" ";
+			break;
+		case TokenType::HEX_VALUE:
+			description += "bytes(" + std::to_string(token.length) + ") ";
+			break;
+		case TokenType::END:
+			description += "> ";
+			break;
+		}
+	}
+	return description;
+}
+
+TEST_GROUP(XMLSnapshotTest){};
+
+TEST(XMLSnapshotTest, holdsWhatTheXMLDoes) {
+	std::string xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+	                  "<song\n\tfirmwareVersion=\"4.1.0\"\n\tearliestCompatibleFirmware = '4.1.0-alpha'>\n"
+	                  "\t<tempo>120</tempo>\n"
+	                  "\t<name></name>\n"
+	                  "\t<osc1 type=\"sine\" />\n"
+	                  "\t<instrumentClips>\n\t\t<midiClip/>\n\t</instrumentClips>\n"
+	                  "</song>\n";
+	STRCMP_EQUAL("<song firmwareVersion=\"4.1.0\" earliestCompatibleFirmware=\"4.1.0-alpha\" <tempo \"120\" > <name > "
+	             "<osc1 type=\"sine\" > <instrumentClips <midiClip > > > ",
+	             describe(build(xml)).c_str());
+}
+
+TEST(XMLSnapshotTest, longHexValuesBecomeBytes) {
+	std::string xml = "<noteRow noteData=\"0x0000000000000060000000600000000000000000\" colour=\"0x00FF00\">"
+	                  "<lowerCase>0x00000000000000ff</lowerCase><odd>0x00000000000000000</odd>"
+	                  "<notHex>0x000000000000000G</notHex><asContent>0x0123456789ABCDEF</asContent></noteRow>";
+	std::vector<uint8_t> snapshot = build(xml);
+	STRCMP_EQUAL("<noteRow noteData=bytes(20) colour=\"0x00FF00\" <lowerCase \"0x00000000000000ff\" > "
+	             "<odd \"0x00000000000000000\" > <notHex \"0x000000000000000G\" > <asContent bytes(8) > > ",
+	             describe(snapshot).c_str());
+
+	uint8_t const* pos = snapshot.data();
+	uint8_t const* end = pos + snapshot.size();
+	Token token;
+	pos = readToken(readToken(pos, end, &token), end, &token);
+	pos = readToken(pos, end, &token);
+	CHECK(token.type == TokenType::HEX_VALUE);
+	uint8_t expected[20] = {0, 0, 0, 0, 0, 0, 0, 0x60, 0, 0, 0, 0x60};
+	MEMCMP_EQUAL(expected, token.data, 20);
+}
+
+TEST(XMLSnapshotTest, sameSnapshotHoweverTheXMLArrives) {
+	std::mt19937 rng(1);
+	std::string xml = "<song>";
+	for (int32_t i = 0; i < 200; i++) {
+		xml += "\n\t<tag" + std::to_string(i) + " attribute=\"" + std::string(rng() % 600, 'a') + "\">";
+		if (rng() % 2) {
+			xml += "0x" + std::string((rng() % 200) * 2 + 16, '7');
+		}
+		else {
+			xml += std::string(rng() % 600, 'b');
+		}
+		xml += "</tag" + std::to_string(i) + ">";
+	}
+	xml += "\n</song>\n";
+
+	std::vector<uint8_t> wholeSnapshot = build(xml);
+	CHECK(!wholeSnapshot.empty());
+	CHECK(describe(wholeSnapshot).find("broken") == std::string::npos);
+	for (int32_t chunkSize : {1, 2, 3, 7, 255, 256, 4096}) {
+		CHECK(build(xml, chunkSize) == wholeSnapshot);
+	}
+}
+
+TEST(XMLSnapshotTest, givesUpOnOddXML) {
+	std::vector<std::string> oddXML = {"<song><tempo>120</tempo>", "<song></song></song>", "<song attribute></song>",
+	                                   "<song attribute=value></song>", "<song =\"1\"></song>", "< song></song>",
+	                                   "<" + std::string(255, 'x') + "/>"};
+	for (std::string const& xml : oddXML) {
+		CHECK(build(xml).empty());
+	}
+	CHECK(!build("<" + std::string(254, 'x') + "/>").empty());
+
+	// Doesn't fit
+	std::string xml = "<song><name>" + std::string(1000, 'x') + "</name></song>";
+	CHECK(build(xml, 0, 1000).empty());
+	CHECK(!build(xml, 0, 1100).empty());
+}
+
+} // namespace
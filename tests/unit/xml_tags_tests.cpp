@@ -0,0 +1,90 @@
+#include "CppUTest/TestHarness.h"
+#include "benchmark.h"
+#include "storage/xml_tags.h"
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+static_assert(XMLTags::id("osc1") != XMLTags::kUnknown);
+static_assert(XMLTags::id("osc1") != XMLTags::id("osc2"));
+static_assert(XMLTags::find("osc1") == XMLTags::id("osc1"));
+
+// How the handlers used to pick a branch: strcmp() against each name in turn until one matches
+XMLTags::Id findByStrcmp(char const* name) {
+	for (int32_t i = 0; i < XMLTags::kNumNames; i++) {
+		if (!strcmp(name, XMLTags::kNames[i].data())) {
+			return i + 1;
+		}
+	}
+	return XMLTags::kUnknown;
+}
+
+TEST_GROUP(XMLTagsTest){};
+
+TEST(XMLTagsTest, everyNameIsFound) {
+	for (int32_t i = 0; i < XMLTags::kNumNames; i++) {
+		std::string name(XMLTags::kNames[i]);
+		CHECK_EQUAL(i + 1, XMLTags::find(name.c_str()));
+	}
+}
+
+TEST(XMLTagsTest, otherNamesAreUnknown) {
+	for (char const* name : {"", "osc", "osc11", "Osc1", "modFXType ", "lpfMode\x01", "thisIsNoTagAtAll"}) {
+		CHECK_EQUAL(XMLTags::kUnknown, XMLTags::find(name));
+	}
+
+	// Everything a name's one char or one edit away from, which might well hash to the same slot
+	for (auto knownName : XMLTags::kNames) {
+		std::string name(knownName);
+		name.pop_back();
+		CHECK_EQUAL(findByStrcmp(name.c_str()), XMLTags::find(name.c_str()));
+		name = std::string(knownName) + "x";
+		CHECK_EQUAL(findByStrcmp(name.c_str()), XMLTags::find(name.c_str()));
+		name = std::string(knownName);
+		name[0] ^= 0x20;
+		CHECK_EQUAL(findByStrcmp(name.c_str()), XMLTags::find(name.c_str()));
+	}
+}
+
+#if DELUGE_BENCHMARKS
+
+TEST_GROUP(XMLTagsBenchmark){};
+
+TEST(XMLTagsBenchmark, lookup) {
+	// Mostly names the handlers know, and some they'll skip, as in a song from a newer firmware
+	std::mt19937 rng(1);
+	std::vector<std::string> names;
+	for (int32_t i = 0; i < 100000; i++) {
+		if (rng() % 8) {
+			names.emplace_back(XMLTags::kNames[rng() % XMLTags::kNumNames]);
+		}
+		else {
+			names.push_back("unknownTag" + std::to_string(rng() % 100));
+		}
+	}
+
+	uint32_t strcmpTotal = 0;
+	uint64_t strcmpTime = nanosecondsPerItem(names.size(), [&] {
+		for (auto& name : names) {
+			strcmpTotal += findByStrcmp(name.c_str());
+		}
+	});
+
+	uint32_t hashTotal = 0;
+	uint64_t hashTime = nanosecondsPerItem(names.size(), [&] {
+		for (auto& name : names) {
+			hashTotal += XMLTags::find(name.c_str());
+		}
+	});
+
+	CHECK_EQUAL(strcmpTotal, hashTotal);
+	printBenchmark("xml tags, " + std::to_string(XMLTags::kNumNames) + " names",
+	               {{"strcmp chain", strcmpTime}, {"perfect hash", hashTime}}, "lookup");
+}
+
+#endif
+
+} // namespace